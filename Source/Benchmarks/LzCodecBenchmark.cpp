@@ -0,0 +1,300 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+// Compares block decompression of LzCodec (word copies of literals and matches) with the decompression, which it
+// has replaced (exact std::memcpy of literals, matches are copied in chunks, which do not exceed offset). 16 MB of
+// data are compressed in blocks of 64 KB: floats (shuffled and delta encoded, as vertex streams are packed), text
+// (short words and numbers) and mixed data (runs of zeros and noise).
+//
+// Results (Release build of the Linux Makefile, g++ 12.2, x86_64 virtual machine with 1 core, median of 5 runs,
+// median of 5 launches):
+//
+//     floats: old 1091.2 MB/s, new 1935.8 MB/s
+//     text:   old  334.4 MB/s, new  861.7 MB/s
+//     mixed:  old 1217.8 MB/s, new 1490.0 MB/s
+//
+// Decoder is still slower than reference LZ4 decoder (which copies 16-byte words and relies on the safety margin
+// at the end of the block), since it keeps exact copies near the end of the output and checks each sequence.
+
+#include "../Engine/Core/Helpers/LzCodec.h"
+
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cmath>
+
+namespace selene
+{
+
+        /**
+         * Represents LZ decoder, which has been replaced by LzCodec::decompress (kept for comparison).
+         */
+        class BaselineLzDecoder
+        {
+        public:
+                /**
+                 * \brief Decompresses block.
+                 * \param[in] source compressed block
+                 * \param[in] size size of the compressed block
+                 * \param[out] destination uncompressed block
+                 * \param[in] originalSize size of the uncompressed block
+                 * \return true if block has been successfully decompressed (false if block is corrupted)
+                 */
+                static bool decompress(const uint8_t* source, uint32_t size, uint8_t* destination,
+                                       uint32_t originalSize)
+                {
+                        const uint8_t* input = source;
+                        const uint8_t* inputEnd = source + size;
+                        uint8_t* output = destination;
+                        uint8_t* outputEnd = destination + originalSize;
+
+                        while(input < inputEnd)
+                        {
+                                uint8_t token = *input++;
+
+                                // copy literals
+                                uint32_t numLiterals = token >> 4;
+                                if(numLiterals == 15 && !readLength(numLiterals, input, inputEnd))
+                                        return false;
+
+                                if(numLiterals > static_cast<uint32_t>(inputEnd - input) ||
+                                   numLiterals > static_cast<uint32_t>(outputEnd - output))
+                                        return false;
+
+                                std::memcpy(output, input, numLiterals);
+                                output += numLiterals;
+                                input  += numLiterals;
+
+                                // the last sequence has no match
+                                if(input == inputEnd)
+                                        break;
+
+                                // copy match
+                                if(inputEnd - input < 2)
+                                        return false;
+
+                                uint32_t offset = static_cast<uint32_t>(input[0]) |
+                                                  (static_cast<uint32_t>(input[1]) << 8);
+                                input += 2;
+
+                                if(offset == 0 || offset > static_cast<uint32_t>(output - destination))
+                                        return false;
+
+                                uint32_t matchLength = token & 15;
+                                if(matchLength == 15 && !readLength(matchLength, input, inputEnd))
+                                        return false;
+
+                                matchLength += 4;
+                                if(matchLength > static_cast<uint32_t>(outputEnd - output))
+                                        return false;
+
+                                // match might overlap output, so it is copied in chunks, which do not
+                                // exceed offset
+                                const uint8_t* match = output - offset;
+
+                                while(matchLength > 0)
+                                {
+                                        uint32_t chunkSize = (matchLength < offset) ? matchLength : offset;
+                                        std::memcpy(output, match, chunkSize);
+
+                                        output += chunkSize;
+                                        match  += chunkSize;
+                                        matchLength -= chunkSize;
+                                }
+                        }
+
+                        return (output == outputEnd);
+                }
+
+        private:
+                /**
+                 * \brief Reads length, which does not fit into token.
+                 * \param[in,out] length length
+                 * \param[in,out] source pointer to the input
+                 * \param[in] end end of the input
+                 * \return true if length has been read
+                 */
+                static bool readLength(uint32_t& length, const uint8_t*& source, const uint8_t* end)
+                {
+                        uint8_t value = 255;
+
+                        while(value == 255)
+                        {
+                                if(source >= end)
+                                        return false;
+
+                                value = *source++;
+                                length += value;
+
+                                if(length > 0x7FFFFFFFU)
+                                        return false;
+                        }
+
+                        return true;
+                }
+
+        };
+
+}
+
+using namespace selene;
+
+/// Helper constants
+enum
+{
+        DATA_SIZE = 16 * 1024 * 1024,
+        BLOCK_SIZE = 64 * 1024,
+        NUM_OF_PASSES = 4,
+        NUM_OF_RUNS = 5
+};
+
+typedef std::chrono::steady_clock Clock;
+typedef bool (*Decoder)(const uint8_t*, uint32_t, uint8_t*, uint32_t);
+
+/**
+ * Represents data, which has been compressed in blocks.
+ */
+struct CompressedData
+{
+        std::vector<uint8_t> blocks;
+        std::vector<uint32_t> offsets;
+};
+
+/**
+ * \brief Measures given benchmark.
+ * \param[in] benchmark benchmark, which returns speed in MB/s
+ * \return median speed in MB/s
+ */
+static double measure(const std::function<double()>& benchmark)
+{
+        std::vector<double> measurements;
+        for(uint32_t i = 0; i < NUM_OF_RUNS; ++i)
+                measurements.push_back(benchmark());
+
+        std::sort(measurements.begin(), measurements.end());
+        return measurements[measurements.size() / 2];
+}
+
+/**
+ * \brief Compresses data in blocks.
+ * \param[in] data data
+ * \param[in] shouldFilter flag, which indicates that floats should be shuffled and delta encoded
+ * \return compressed data
+ */
+static CompressedData compress(const std::vector<uint8_t>& data, bool shouldFilter)
+{
+        CompressedData compressedData;
+        std::vector<uint8_t> filteredBlock(BLOCK_SIZE);
+        std::vector<uint8_t> compressedBlock(LzCodec::getMaxCompressedSize(BLOCK_SIZE));
+
+        for(uint32_t i = 0; i < DATA_SIZE; i += BLOCK_SIZE)
+        {
+                const uint8_t* block = &data[i];
+                if(shouldFilter)
+                {
+                        LzCodec::shuffle(block, &filteredBlock[0], BLOCK_SIZE, sizeof(float));
+                        LzCodec::encodeDelta(&filteredBlock[0], BLOCK_SIZE);
+                        block = &filteredBlock[0];
+                }
+
+                uint32_t size = LzCodec::compress(block, BLOCK_SIZE, &compressedBlock[0], compressedBlock.size());
+
+                compressedData.offsets.push_back(compressedData.blocks.size());
+                compressedData.blocks.insert(compressedData.blocks.end(), compressedBlock.begin(),
+                                             compressedBlock.begin() + size);
+        }
+
+        compressedData.offsets.push_back(compressedData.blocks.size());
+        return compressedData;
+}
+
+//----------------------------------------------------------------------------------
+static double decompress(Decoder decoder, const CompressedData& compressedData, std::vector<uint8_t>& output)
+{
+        Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < NUM_OF_PASSES; ++i)
+        {
+                for(uint32_t j = 0; j + 1 < compressedData.offsets.size(); ++j)
+                {
+                        uint32_t offset = compressedData.offsets[j];
+                        uint32_t size = compressedData.offsets[j + 1] - offset;
+
+                        if(!decoder(&compressedData.blocks[offset], size, &output[j * BLOCK_SIZE], BLOCK_SIZE))
+                        {
+                                std::cout << "error: could not decompress block" << std::endl;
+                                std::exit(EXIT_FAILURE);
+                        }
+                }
+        }
+
+        double time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        return static_cast<double>(NUM_OF_PASSES) * DATA_SIZE / time;
+}
+
+/**
+ * \brief Measures both decoders and checks their output.
+ * \param[in] name name of the data
+ * \param[in] data data
+ * \param[in] shouldFilter flag, which indicates that floats should be shuffled and delta encoded
+ */
+static void run(const char* name, const std::vector<uint8_t>& data, bool shouldFilter)
+{
+        CompressedData compressedData = compress(data, shouldFilter);
+        std::vector<uint8_t> oldOutput(DATA_SIZE), newOutput(DATA_SIZE);
+
+        double oldSpeed = measure(std::bind(decompress, BaselineLzDecoder::decompress, std::cref(compressedData),
+                                            std::ref(oldOutput)));
+        double newSpeed = measure(std::bind(decompress, LzCodec::decompress, std::cref(compressedData),
+                                            std::ref(newOutput)));
+
+        std::cout << name << "old " << oldSpeed << " MB/s, new " << newSpeed << " MB/s" << std::endl;
+
+        if(oldOutput != newOutput)
+        {
+                std::cout << "error: outputs of the decoders differ" << std::endl;
+                std::exit(EXIT_FAILURE);
+        }
+}
+
+int main()
+{
+        std::vector<uint8_t> floats(DATA_SIZE);
+        for(uint32_t i = 0; i < DATA_SIZE / sizeof(float); ++i)
+        {
+                float value = std::sin(static_cast<float>(i) * 0.001f) * 10.0f + static_cast<float>(i % 3);
+                std::memcpy(&floats[i * sizeof(float)], &value, sizeof(float));
+        }
+
+        static const char* words[] =
+        {
+                "mesh ", "texture ", "material ", "vertex ", "index ",
+                "bone ", "animation ", "the ", "and ", "of "
+        };
+
+        std::string text;
+        std::srand(3);
+        while(text.size() < DATA_SIZE)
+        {
+                text += words[std::rand() % 10];
+                if(std::rand() % 5 == 0)
+                        text += std::to_string(std::rand() % 1000) + " ";
+        }
+
+        std::vector<uint8_t> mixed(DATA_SIZE);
+        for(uint32_t i = 0; i < DATA_SIZE; ++i)
+                mixed[i] = ((i / 64) % 7 == 0) ? 0 : static_cast<uint8_t>((i * 2654435761U) >> 24) & 0x0F;
+
+        std::cout.setf(std::ios::fixed);
+        std::cout.precision(1);
+
+        run("floats: ", floats, true);
+        run("text:   ", std::vector<uint8_t>(text.begin(), text.begin() + DATA_SIZE), false);
+        run("mixed:  ", mixed, false);
+
+        return EXIT_SUCCESS;
+}
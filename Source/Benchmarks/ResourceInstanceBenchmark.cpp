@@ -0,0 +1,302 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+// Compares Resource::Instance (reference counted link, which is reset by the resource) with the instance, which it
+// has replaced (std::weak_ptr to the resource, which is checked on each dereference, and atomic counter of the
+// requests). 4096 instances of 64 resources are dereferenced (and field of the resource is read), copied and
+// destroyed, and assigned.
+//
+// Results (Release build of the Linux Makefile, g++ 12.2, x86_64 virtual machine with 1 core, median of 5 runs,
+// middle of 3 launches):
+//
+//     dereference:    old  1.5 ns, new  1.2 ns
+//     copy + destroy: old 37.7 ns, new 23.5 ns
+//     assignment:     old 38.4 ns, new 20.7 ns
+//
+// Intrusive list of the instances, which is reset by the resource under its mutex, has been measured as well:
+// dereference is 0.6 ns, but copy + destroy is 54 ns and assignment is 49 ns.
+
+#include "../Engine/Core/Resources/Resource.h"
+
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace selene
+{
+
+        /**
+         * Represents resource, which counts requests of the baseline instances.
+         */
+        class BaselineResource: public Resource
+        {
+        public:
+                /**
+                 * Represents resource instance, which has been replaced by Resource::Instance (kept for
+                 * comparison).
+                 */
+                template <class T> class Instance
+                {
+                public:
+                        Instance(const std::shared_ptr<Resource>& sharedPointer): Instance()
+                        {
+                                initialize(dynamic_cast<T*>(sharedPointer.get()));
+
+                                if(resource_ != nullptr)
+                                        weakPointer_ = sharedPointer;
+                        }
+                        Instance(const Instance<T>& instance): Instance()
+                        {
+                                *this = instance;
+                        }
+                        Instance(): weakPointer_(), resource_(nullptr) {}
+                        ~Instance()
+                        {
+                                if(weakPointer_.expired())
+                                        return;
+
+                                resource_->release();
+                        }
+
+                        Instance<T>& operator =(const Instance<T>& instance)
+                        {
+                                if(!weakPointer_.expired())
+                                {
+                                        weakPointer_.reset();
+                                        resource_->release();
+                                }
+
+                                resource_ = nullptr;
+
+                                if(!instance.weakPointer_.expired())
+                                {
+                                        initialize(instance.resource_);
+
+                                        if(resource_ != nullptr)
+                                                weakPointer_ = instance.weakPointer_;
+                                }
+
+                                return *this;
+                        }
+
+                        T* operator *() const
+                        {
+                                if(!weakPointer_.expired())
+                                        return resource_;
+
+                                return nullptr;
+                        }
+
+                private:
+                        std::weak_ptr<Resource> weakPointer_;
+                        T* resource_;
+
+                        void initialize(T* resource)
+                        {
+                                if(resource == nullptr)
+                                        return;
+
+                                if(!resource->request())
+                                        return;
+
+                                resource_ = resource;
+                        }
+
+                };
+
+                /**
+                 * \brief Constructs resource.
+                 */
+                BaselineResource(): Resource("baseline"), field(1), numRequests_(0) {}
+                BaselineResource(const BaselineResource&) = delete;
+                ~BaselineResource() {}
+                BaselineResource& operator =(const BaselineResource&) = delete;
+
+                /**
+                 * \brief Does nothing.
+                 * \return true
+                 */
+                bool retain()
+                {
+                        return true;
+                }
+
+                /**
+                 * \brief Does nothing.
+                 */
+                void discard() {}
+
+                /// Field, which is read through the instances
+                uint32_t field;
+
+        private:
+                std::atomic<uint32_t> numRequests_;
+
+                /**
+                 * \brief Requests resource.
+                 * \return true if request has been granted
+                 */
+                bool request()
+                {
+                        uint32_t numRequests = numRequests_.load();
+                        do
+                        {
+                                if(numRequests == std::numeric_limits<uint32_t>::max())
+                                        return false;
+                        }
+                        while(!numRequests_.compare_exchange_weak(numRequests, numRequests + 1));
+
+                        return true;
+                }
+
+                /**
+                 * \brief Releases resource.
+                 */
+                void release()
+                {
+                        uint32_t numRequests = numRequests_.load();
+                        do
+                        {
+                                if(numRequests == 0)
+                                        return;
+                        }
+                        while(!numRequests_.compare_exchange_weak(numRequests, numRequests - 1));
+                }
+
+        };
+
+}
+
+using namespace selene;
+
+/// Helper constants
+enum
+{
+        NUM_OF_RESOURCES = 64,
+        NUM_OF_INSTANCES = 4096,
+        NUM_OF_DEREFERENCE_PASSES = 2000,
+        NUM_OF_COPY_PASSES = 200,
+        NUM_OF_RUNS = 5
+};
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * \brief Measures given benchmark.
+ * \param[in] benchmark benchmark, which returns time in nanoseconds
+ * \return median time in nanoseconds
+ */
+static double measure(const std::function<double()>& benchmark)
+{
+        std::vector<double> measurements;
+        for(uint32_t i = 0; i < NUM_OF_RUNS; ++i)
+                measurements.push_back(benchmark());
+
+        std::sort(measurements.begin(), measurements.end());
+        return measurements[measurements.size() / 2];
+}
+
+/**
+ * \brief Returns time in nanoseconds from given point.
+ * \param[in] start start point
+ * \param[in] numOperations number of the measured operations
+ * \return time of one operation in nanoseconds
+ */
+static double getTime(Clock::time_point start, uint32_t numOperations)
+{
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / numOperations;
+}
+
+/// Sum of the fields, which prevents optimizing dereferences away
+static volatile uint32_t sink = 0;
+
+//----------------------------------------------------------------------------------
+template <class I> static double dereference(const std::vector<I>& instances)
+{
+        uint32_t sum = 0;
+
+        Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < NUM_OF_DEREFERENCE_PASSES; ++i)
+        {
+                for(auto it = instances.begin(); it != instances.end(); ++it)
+                {
+                        BaselineResource* resource = **it;
+                        if(resource != nullptr)
+                                sum += resource->field;
+                }
+        }
+
+        sink = sum;
+        return getTime(start, NUM_OF_DEREFERENCE_PASSES * NUM_OF_INSTANCES);
+}
+
+//----------------------------------------------------------------------------------
+template <class I> static double copy(const std::vector<I>& instances)
+{
+        Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < NUM_OF_COPY_PASSES; ++i)
+        {
+                std::vector<I> copies(instances);
+                sink = static_cast<uint32_t>(copies.size());
+        }
+
+        return getTime(start, NUM_OF_COPY_PASSES * NUM_OF_INSTANCES);
+}
+
+//----------------------------------------------------------------------------------
+template <class I> static double assign(const std::vector<I>& instances)
+{
+        I instance;
+
+        Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < NUM_OF_COPY_PASSES; ++i)
+        {
+                for(auto it = instances.begin(); it != instances.end(); ++it)
+                        instance = *it;
+        }
+
+        return getTime(start, NUM_OF_COPY_PASSES * NUM_OF_INSTANCES);
+}
+
+int main()
+{
+        // engine always runs worker threads, and reference counters of std::shared_ptr are not atomic in the
+        // process, which has not started any threads
+        std::thread([]() {}).join();
+
+        typedef BaselineResource::Instance<BaselineResource> OldInstance;
+        typedef Resource::Instance<BaselineResource> NewInstance;
+
+        std::vector<std::shared_ptr<Resource>> resources;
+        for(uint32_t i = 0; i < NUM_OF_RESOURCES; ++i)
+                resources.push_back(std::shared_ptr<Resource>(new BaselineResource()));
+
+        std::vector<OldInstance> oldInstances;
+        std::vector<NewInstance> newInstances;
+        for(uint32_t i = 0; i < NUM_OF_INSTANCES; ++i)
+        {
+                oldInstances.push_back(OldInstance(resources[i % NUM_OF_RESOURCES]));
+                newInstances.push_back(NewInstance(resources[i % NUM_OF_RESOURCES]));
+        }
+
+        std::cout.setf(std::ios::fixed);
+        std::cout.precision(1);
+
+        std::cout << "dereference:    old " << measure(std::bind(dereference<OldInstance>, std::cref(oldInstances))) <<
+                     " ns, new " << measure(std::bind(dereference<NewInstance>, std::cref(newInstances))) << " ns" <<
+                     std::endl;
+        std::cout << "copy + destroy: old " << measure(std::bind(copy<OldInstance>, std::cref(oldInstances))) <<
+                     " ns, new " << measure(std::bind(copy<NewInstance>, std::cref(newInstances))) << " ns" <<
+                     std::endl;
+        std::cout << "assignment:     old " << measure(std::bind(assign<OldInstance>, std::cref(oldInstances))) <<
+                     " ns, new " << measure(std::bind(assign<NewInstance>, std::cref(newInstances))) << " ns" <<
+                     std::endl;
+
+        return EXIT_SUCCESS;
+}
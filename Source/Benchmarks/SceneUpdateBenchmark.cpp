@@ -0,0 +1,396 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+// Measures Scene::updateAndRender with the renderer, which renders nothing. Scene contains grid of static actors
+// (every fourth actor is rotated each frame, every third actor casts shadows), skinned actors with 32 bones, which
+// play animation, and 8 shadow-casting point lights, so the frame consists of the math of the scene update: node
+// transforms, bounding boxes, frustum and light culling, and skinning.
+//
+// Results (Release build of the Linux Makefile, g++ 12.2, x86_64 virtual machine with 1 core, median of 5 runs,
+// median of 5 launches), engine before and after vector, quaternion and matrix operations have been defined inline
+// in the headers:
+//
+//     2000 static + 200 skinned actors:  out-of-line 877.2 us/frame, inline 579.7 us/frame
+//     500 static + 1000 skinned actors:  out-of-line 937.6 us/frame, inline 700.5 us/frame
+//
+// Checksum of the scene (number of visible nodes, final bone transforms and bounding boxes) is printed as well, and
+// it is identical for both builds.
+
+#include "../Engine/Rendering/Renderer.h"
+#include "../Engine/Scene/Nodes/Actor.h"
+#include "../Engine/Scene/Nodes/Camera.h"
+#include "../Engine/Scene/Nodes/Light.h"
+#include "../Engine/Scene/Scene.h"
+
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cmath>
+
+namespace selene
+{
+
+        /**
+         * Represents renderer, which renders nothing.
+         */
+        class EmptyRenderer: public Renderer
+        {
+        public:
+                EmptyRenderer() {}
+                ~EmptyRenderer() {}
+
+                /**
+                 * \brief Does nothing.
+                 * \return true
+                 */
+                bool initialize(const Parameters&)
+                {
+                        return true;
+                }
+
+                /**
+                 * \brief Does nothing.
+                 */
+                void destroy() {}
+
+                /**
+                 * \brief Does nothing.
+                 */
+                void render(const Camera&) {}
+
+        };
+
+        /**
+         * Represents mesh, which is filled by the benchmark.
+         */
+        class BenchmarkMesh: public Mesh
+        {
+        public:
+                BenchmarkMesh(const char* name): Mesh(name) {}
+                ~BenchmarkMesh() {}
+
+                /**
+                 * \brief Does nothing.
+                 * \return true
+                 */
+                bool retain()
+                {
+                        return true;
+                }
+
+                /**
+                 * \brief Does nothing.
+                 */
+                void discard() {}
+
+        };
+
+        /**
+         * Represents mesh animation, which is filled by the benchmark.
+         */
+        class BenchmarkMeshAnimation: public MeshAnimation
+        {
+        public:
+                BenchmarkMeshAnimation(const char* name): MeshAnimation(name) {}
+                ~BenchmarkMeshAnimation() {}
+
+                /**
+                 * \brief Does nothing.
+                 * \return true
+                 */
+                bool retain()
+                {
+                        return true;
+                }
+
+                /**
+                 * \brief Does nothing.
+                 */
+                void discard() {}
+
+        };
+
+}
+
+using namespace selene;
+
+/// Helper constants
+enum
+{
+        NUM_OF_BONES = 32,
+        NUM_OF_KEYS = 24,
+        NUM_OF_LIGHTS = 8,
+        NUM_OF_FRAMES = 200,
+        NUM_OF_RUNS = 5
+};
+
+/**
+ * \brief Fills mesh data with unit box.
+ * \param[out] data mesh data
+ * \param[in] material material of the box
+ */
+static void createBox(Mesh::Data& data, const std::shared_ptr<Material>& material)
+{
+        static const uint16_t faces[36] =
+        {
+                0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5
+        };
+
+        const uint32_t tangentStride = sizeof(Vector3d) + sizeof(Vector4d);
+
+        data.vertices[0].create(8, sizeof(Vector3d));
+        data.vertices[1].create(8, tangentStride);
+        data.vertices[2].create(8, sizeof(Vector2d));
+
+        for(uint32_t i = 0; i < 8; ++i)
+        {
+                Vector3d position((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+                Vector4d tangent(1.0f, 0.0f, 0.0f, 1.0f);
+
+                std::memcpy(&data.vertices[0][i * sizeof(Vector3d)], &position, sizeof(Vector3d));
+                std::memcpy(&data.vertices[1][i * tangentStride], &position, sizeof(Vector3d));
+                std::memcpy(&data.vertices[1][i * tangentStride + sizeof(Vector3d)], &tangent, sizeof(Vector4d));
+        }
+
+        data.faces.create(12, sizeof(uint16_t), 3);
+        std::memcpy(&data.faces[0], faces, sizeof(faces));
+
+        data.subsets.create(1);
+        data.subsets[0].vertexIndex = 0;
+        data.subsets[0].numVertices = 8;
+        data.subsets[0].faceIndex = 0;
+        data.subsets[0].numFaces = 12;
+        data.subsets[0].material = material;
+
+        data.boundingBox.define(Vector3d(), 1.0f, 1.0f, 1.0f);
+}
+
+/**
+ * \brief Creates skeleton, which is a chain of bones.
+ * \param[out] data mesh data
+ * \return true if skeleton has been successfully created
+ */
+static bool createSkeleton(Mesh::Data& data)
+{
+        std::shared_ptr<Skeleton> skeleton(new Skeleton);
+        if(!skeleton->getBones().create(NUM_OF_BONES))
+                return false;
+
+        for(uint32_t i = 0; i < NUM_OF_BONES; ++i)
+        {
+                Skeleton::Bone& bone = skeleton->getBones()[i];
+
+                bone.name = "bone" + std::to_string(i);
+                bone.parent = static_cast<int32_t>(i) - 1;
+                bone.offsetTransform.position = Vector3d(0.0f, -0.1f * i, 0.0f);
+                bone.offsetTransform.rotation = Quaternion();
+        }
+
+        data.skeleton = skeleton;
+        return skeleton->initialize();
+}
+
+/**
+ * \brief Creates animation, which bends chain of bones.
+ * \param[out] data mesh animation data
+ * \return true if animation has been successfully created
+ */
+static bool createAnimation(MeshAnimation::Data& data)
+{
+        if(!data.keys.create(NUM_OF_KEYS) || !data.helperKey.create(NUM_OF_BONES))
+                return false;
+
+        for(uint32_t i = 0; i < NUM_OF_KEYS; ++i)
+        {
+                if(!data.keys[i].create(NUM_OF_BONES))
+                        return false;
+
+                for(uint32_t j = 0; j < NUM_OF_BONES; ++j)
+                {
+                        Skeleton::BoneTransform& boneTransform = data.keys[i][j];
+                        float angle = 0.05f * i + 0.01f * j;
+
+                        boneTransform.boneName = "bone" + std::to_string(j);
+                        boneTransform.transform.rotation = Quaternion(Vector3d(0.0f, 0.0f, 1.0f) * std::sin(angle),
+                                                                      std::cos(angle));
+                        boneTransform.transform.position = Vector3d(0.0f, 0.1f, 0.0f);
+                }
+        }
+
+        data.length = NUM_OF_KEYS;
+        data.lengthInv = 1.0f / NUM_OF_KEYS;
+        return true;
+}
+
+/**
+ * \brief Builds scene and measures its update.
+ * \param[in] numStaticActors number of the static actors
+ * \param[in] numSkinnedActors number of the skinned actors
+ * \param[out] checksum checksum of the scene
+ * \return median time of the frame in microseconds, or negative value if scene could not be built
+ */
+static double measure(uint32_t numStaticActors, uint32_t numSkinnedActors, double& checksum)
+{
+        std::shared_ptr<Material> material(new Material);
+        BenchmarkMesh boxMesh("box"), skinnedMesh("skinned");
+        BenchmarkMeshAnimation meshAnimation("animation");
+
+        createBox(boxMesh.getData(), material);
+        createBox(skinnedMesh.getData(), material);
+
+        if(!createSkeleton(skinnedMesh.getData()) || !createAnimation(meshAnimation.getData()))
+                return -1.0;
+
+        // resources are owned by the benchmark
+        std::shared_ptr<Resource> boxResource(&boxMesh, [](Resource*) {});
+        std::shared_ptr<Resource> skinnedResource(&skinnedMesh, [](Resource*) {});
+        std::shared_ptr<Resource> animationResource(&meshAnimation, [](Resource*) {});
+
+        Resource::Instance<Mesh> box(boxResource), skinned(skinnedResource);
+        Resource::Instance<MeshAnimation> animation(animationResource);
+
+        EmptyRenderer renderer;
+        Scene scene;
+
+        uint32_t side = static_cast<uint32_t>(std::sqrt(static_cast<double>(numStaticActors)));
+        std::vector<std::shared_ptr<Actor>> rotatedActors, skinnedActors;
+
+        for(uint32_t i = 0; i < numStaticActors; ++i)
+        {
+                std::string name = "actor" + std::to_string(i);
+                scene.addNode(new(std::nothrow) Actor(name.c_str(), box,
+                                                      Vector3d(2.0f * (i % side), 0.0f, 2.0f * (i / side))));
+
+                std::shared_ptr<Actor> actor = scene.getActor(name.c_str()).lock();
+                if(!actor)
+                        return -1.0;
+
+                if((i % 3) == 0)
+                        actor->setFlags(Scene::Node::SHADOW_CASTER);
+
+                if((i % 4) == 0)
+                        rotatedActors.push_back(actor);
+        }
+
+        for(uint32_t i = 0; i < numSkinnedActors; ++i)
+        {
+                std::string name = "skinned" + std::to_string(i);
+                scene.addNode(new(std::nothrow) Actor(name.c_str(), skinned,
+                                                      Vector3d(2.0f * (i % side) + 1.0f, 0.0f,
+                                                               2.0f * (i / side) + 1.0f)));
+
+                std::shared_ptr<Actor> actor = scene.getActor(name.c_str()).lock();
+                if(!actor || !actor->addMeshAnimation(animation, 0.0f, 0.0f, 0.0f, 0.01f * i, 1.0f))
+                        return -1.0;
+
+                actor->setFlags(Scene::Node::SHADOW_CASTER);
+                skinnedActors.push_back(actor);
+        }
+
+        for(uint32_t i = 0; i < NUM_OF_LIGHTS; ++i)
+        {
+                std::string name = "light" + std::to_string(i);
+                scene.addNode(new(std::nothrow) PointLight(name.c_str(),
+                                                           Vector3d(0.5f * side * (i % 4), 3.0f,
+                                                                    0.5f * side * (i / 4)),
+                                                           Vector3d(1.0f, 1.0f, 1.0f), 1.0f, 12.0f));
+
+                std::shared_ptr<Light> light = scene.getLight(name.c_str()).lock();
+                if(!light)
+                        return -1.0;
+
+                light->setFlags(Scene::Node::SHADOW_CASTER);
+        }
+
+        scene.addNode(new(std::nothrow) Camera("camera", renderer, Vector3d(side, 30.0f, -10.0f),
+                                               Vector3d(0.0f, -0.7f, 1.0f), Vector3d(0.0f, 1.0f, 0.0f),
+                                               Vector4d(60.0f, 1.0f, 0.1f, 500.0f)));
+        if(!scene.setActiveCamera("camera"))
+                return -1.0;
+
+        scene.getCamera("camera").lock()->getEffect(Name("Shadows")).setQuality(1);
+
+        std::vector<double> measurements;
+        checksum = 0.0;
+
+        for(uint32_t i = 0; i < NUM_OF_RUNS; ++i)
+        {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for(uint32_t j = 0; j < NUM_OF_FRAMES; ++j)
+                {
+                        for(uint32_t k = 0; k < rotatedActors.size(); ++k)
+                        {
+                                float angle = 0.01f * j + 0.1f * k;
+                                rotatedActors[k]->setRotation(Quaternion(Vector3d(0.0f, 1.0f, 0.0f) *
+                                                                         std::sin(angle), std::cos(angle)));
+                        }
+
+                        if(!scene.updateAndRender(1.0f / 60.0f, renderer))
+                                return -1.0;
+
+                        checksum += scene.getNumVisibleActors() + scene.getNumVisibleLights();
+                }
+
+                measurements.push_back(std::chrono::duration<double, std::micro>(
+                                       std::chrono::steady_clock::now() - start).count() / NUM_OF_FRAMES);
+        }
+
+        for(auto it = skinnedActors.begin(); it != skinnedActors.end(); ++it)
+        {
+                const Array<Skeleton::Transform, uint16_t>& transforms =
+                        (*it)->getSkeletonInstance().getFinalBoneTransforms();
+
+                for(uint16_t i = 0; i < transforms.getSize(); ++i)
+                        checksum += transforms[i].position.y + transforms[i].rotation.w;
+        }
+
+        for(auto it = rotatedActors.begin(); it != rotatedActors.end(); ++it)
+                checksum += (*it)->getBoundingBox().getVertices()[0].x;
+
+        std::sort(measurements.begin(), measurements.end());
+        return measurements[measurements.size() / 2];
+}
+
+/**
+ * \brief Measures scene update and prints results.
+ * \param[in] numStaticActors number of the static actors
+ * \param[in] numSkinnedActors number of the skinned actors
+ * \return true if scene has been successfully measured
+ */
+static bool run(uint32_t numStaticActors, uint32_t numSkinnedActors)
+{
+        double checksum = 0.0;
+        double time = measure(numStaticActors, numSkinnedActors, checksum);
+
+        if(time < 0.0)
+        {
+                std::cout << "error: could not build scene" << std::endl;
+                return false;
+        }
+
+        std::cout.precision(1);
+        std::cout << numStaticActors << " static + " << numSkinnedActors << " skinned actors: " << time <<
+                     " us/frame, checksum ";
+        std::cout.precision(3);
+        std::cout << checksum << std::endl;
+        return true;
+}
+
+int main()
+{
+        if(!Renderer::initializeMemoryBuffer(64 * 1024 * 1024))
+                return EXIT_FAILURE;
+
+        std::cout.setf(std::ios::fixed);
+
+        if(!run(2000, 200) || !run(500, 1000))
+                return EXIT_FAILURE;
+
+        return EXIT_SUCCESS;
+}
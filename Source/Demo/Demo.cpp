@@ -18,7 +18,8 @@ namespace selene
 
         DemoApplication::DemoApplication(const char* name, uint32_t width, uint32_t height):
                 Platform::Application(name, width, height), textureManager_(), meshManager_(),
-                meshAnimationManager_(), fileManager_(), scene_(), gui_(), camera_(),
+                meshAnimationManager_(), fileManager_(), packFileManager_(&fileManager_),
+                textureStreamer_(&packFileManager_), scene_(), gui_(), camera_(),
                 buttonToggleSsao_(), buttonToggleBloom_(), buttonToggleShadows_(),
                 buttonToggleSettings_(), actor_(),
                 isCameraRotationEnabled_(false),
@@ -61,6 +62,15 @@ namespace selene
 
                 for(uint32_t i = 0; i < numFolders; ++i)
                         fileManager_.addFolder(folders[i]);
+
+                // mount asset pack (if it exists), its folders are searched as well
+                const char* packFolders[] = {"Meshes/", "Textures/", "Animations/"};
+                const uint32_t numPackFolders = sizeof(packFolders) / sizeof(packFolders[0]);
+
+                for(uint32_t i = 0; i < numPackFolders; ++i)
+                        packFileManager_.addFolder(packFolders[i]);
+
+                packFileManager_.mount("Assets.sdpf");
         }
         DemoApplication::~DemoApplication() {}
 
@@ -159,24 +169,48 @@ namespace selene
         //-----------------------------------------------------------------------------------------------------------
         void DemoApplication::loadResources()
         {
-                MeshFactory<Platform::Mesh> meshFactory(&fileManager_);
-                TextureFactory<Platform::Texture> textureFactory(&fileManager_);
-                MeshAnimationFactory<MeshAnimation> meshAnimationFactory(&fileManager_);
+                MeshFactory<Platform::Mesh> meshFactory(&packFileManager_);
+                TextureFactory<Platform::Texture> textureFactory(&packFileManager_);
+                MeshAnimationFactory<MeshAnimation> meshAnimationFactory(&packFileManager_);
+
+                // textures are created with coarse mip maps, finer mip maps are streamed in
+                textureFactory.setMaxSize(TEXTURE_COARSE_MIP_MAP_SIZE);
+                textureStreamer_.setMinSize(TEXTURE_COARSE_MIP_MAP_SIZE);
+                textureStreamer_.setReferenceSize(Platform::getDefaultScreenHeight());
+                textureStreamer_.setBudget(TEXTURE_BUDGET);
+
+                // mip maps are loaded in the rendering thread, so loading is spread across frames
+                textureStreamer_.setMaxLoadSize(TEXTURE_MAX_LOAD_SIZE);
+                scene_.setTextureStreamer(&textureStreamer_);
 
                 meshFactory.setResourceFactory(&textureFactory);
                 meshFactory.setResourceManager(&textureManager_);
 
-                const char* meshes[] = {"girl.sdmf", "floor.sdmf"};
-                const uint32_t numMeshes = sizeof(meshes) / sizeof(meshes[0]);
+                // meshes with identical materials share them, so they are rendered with the same state
+                MaterialRegistry materialRegistry;
+                meshFactory.setMaterialRegistry(&materialRegistry);
 
-                for(uint32_t i = 0; i < numMeshes; ++i)
+                // resources are created by workers and retained in this thread
+                size_t numWorkers = std::thread::hardware_concurrency();
+                ThreadPool threadPool(numWorkers > 0 ? numWorkers : 2);
+
+                // compressed files of the pack are decoded in parallel as well
+                packFileManager_.setThreadPool(&threadPool);
+
+                auto callback = [](const char* name, RESULT result)
                 {
-                        std::cout << "Loading mesh '" << meshes[i] << "'...";
-                        if(meshManager_.createResource(meshes[i], meshFactory) != SUCCESS)
+                        std::cout << "Loading '" << name << "'...";
+                        if(result != SUCCESS)
                                 std::cout << "FAILED" << std::endl;
                         else
                                 std::cout << "SUCCEEDED" << std::endl;
-                }
+                };
+
+                const char* meshes[] = {"girl.sdmf", "floor.sdmf"};
+                const uint32_t numMeshes = sizeof(meshes) / sizeof(meshes[0]);
+
+                for(uint32_t i = 0; i < numMeshes; ++i)
+                        meshManager_.loadResource<Mesh>(meshes[i], meshFactory, threadPool, callback);
 
                 const char* meshAnimations[] =
                 {
@@ -186,12 +220,15 @@ namespace selene
 
                 for(uint32_t i = 0; i < numMeshAnimations; ++i)
                 {
-                        std::cout << "Loading mesh animation '" << meshAnimations[i] << "'...";
-                        if(meshAnimationManager_.createResource(meshAnimations[i], meshAnimationFactory) != SUCCESS)
-                                std::cout << "FAILED" << std::endl;
-                        else
-                                std::cout << "SUCCEEDED" << std::endl;
+                        meshAnimationManager_.loadResource<MeshAnimation>(meshAnimations[i], meshAnimationFactory,
+                                                                          threadPool, callback);
                 }
+
+                // wait for workers (textures are created by workers, which load meshes)
+                meshManager_.processRequests(true);
+                meshAnimationManager_.processRequests(true);
+                textureManager_.processRequests(true);
+                packFileManager_.setThreadPool(nullptr);
         }
 
         //-----------------------------------------------------------------------------------------------------------
@@ -290,7 +327,7 @@ namespace selene
                         return false;
 
                 // initialize renderer
-                Renderer::Parameters parameters(this, &fileManager_, getWidth(), getHeight(), &std::cout, false);
+                Renderer::Parameters parameters(this, &packFileManager_, getWidth(), getHeight(), &std::cout, false);
 
                 if(!getRenderer().initialize(parameters))
                         return false;
@@ -308,6 +345,9 @@ namespace selene
         {
                 Renderer::destroyMemoryBuffer();
 
+                scene_.setTextureStreamer(nullptr);
+                textureStreamer_.clear();
+
                 meshAnimationManager_.destroyResources(true);
                 textureManager_.destroyResources(true);
                 meshManager_.destroyResources(true);
@@ -357,6 +397,9 @@ namespace selene
         {
                 // render scene
                 scene_.updateAndRender(elapsedTime, getRenderer());
+
+                // stream mip maps of the visible textures
+                textureStreamer_.update();
         }
 
         //-----------------------------------------------------------------------------------------------------------
@@ -26,6 +26,16 @@ namespace selene
                 DemoApplication& operator =(const DemoApplication&) = delete;
 
         private:
+                // Texture streaming parameters: size of the coarse mip maps, which are
+                // always resident, texture memory budget and maximum number of bytes,
+                // which are loaded on each frame.
+                enum
+                {
+                        TEXTURE_COARSE_MIP_MAP_SIZE = 64,
+                        TEXTURE_BUDGET = 16 * 1024 * 1024,
+                        TEXTURE_MAX_LOAD_SIZE = 1024 * 1024
+                };
+
                 // Resource managers are used for resource creation, deletion and
                 // sharing. One resource manager may hold resources of any type,
                 // but for convenience multiple resource managers shall be used.
@@ -35,6 +45,15 @@ namespace selene
                 // file streams in platform independent way.
                 Platform::FileManager fileManager_;
 
+                // Pack file manager provides access to the files of the mounted
+                // pack (built with Packer from the Assets folder), other files are
+                // opened with file manager.
+                PackFileManager packFileManager_;
+
+                // Texture streamer loads fine mip maps of the textures, which are
+                // visible on screen, and keeps texture memory within the budget.
+                TextureStreamer textureStreamer_;
+
                 // Scene holds scene graph, which is used for visibility determination
                 // and population of rendering lists.
                 Scene scene_;
@@ -9,7 +9,7 @@ namespace selene
 {
 
         FileManager::FileManager(bool (*fileExists)(const char*)):
-                fileName_(), folders_(), fileExists_(fileExists) {}
+                fileName_(), mutex_(), folders_(), fileExists_(fileExists) {}
         FileManager::~FileManager() {}
 
         //----------------------------------------------------------------------------
@@ -58,9 +58,32 @@ namespace selene
                 return nullptr;
         }
 
+        //----------------------------------------------------------------------------
+        bool FileManager::find(const char* fileName, std::string& fullFileName) const
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                const char* foundFileName = find(fileName);
+                if(foundFileName == nullptr)
+                        return false;
+
+                try
+                {
+                        fullFileName = foundFileName;
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return true;
+        }
+
         //----------------------------------------------------------------------------
         std::istream* FileManager::open(const char* fileName) const
         {
+                std::lock_guard<std::mutex> lock(mutex_);
+
                 const char* fullFileName = find(fileName);
                 if(fullFileName == nullptr)
                         return nullptr;
@@ -77,4 +100,10 @@ namespace selene
                 return stream.release();
         }
 
+        //----------------------------------------------------------------------------
+        std::shared_ptr<MappedFile> FileManager::map(const char*) const
+        {
+                return std::shared_ptr<MappedFile>();
+        }
+
 }
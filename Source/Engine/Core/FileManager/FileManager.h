@@ -5,9 +5,12 @@
 #define FILE_MANAGER_H
 
 #include "../Macros/Macros.h"
+#include "MappedFile.h"
 #include <fstream>
+#include <memory>
 #include <string>
 #include <deque>
+#include <mutex>
 
 namespace selene
 {
@@ -34,6 +37,12 @@ namespace selene
          * };
          * \endcode
          * Note, that in this case FileManager::find and FileManager::open methods should be re-implemented.
+         * FileManager::map may also be re-implemented, if files can be accessed without copying.
+         *
+         * FileManager::open and FileManager::map may be called from several threads at once (when resources
+         * are loaded asynchronously), so implementations must lock mutex_ while they use the path returned
+         * by FileManager::find. Threads, which need the path itself, must use the overload of
+         * FileManager::find, which copies the path.
          *
          * This class can also be used as-is for accessing files in native file system.
          */
@@ -65,6 +74,17 @@ namespace selene
                  */
                 virtual const char* find(const char* fileName) const;
 
+                /**
+                 * \brief Finds file with given name and copies its full path.
+                 *
+                 * Unlike find(const char*), this function may be called from several threads at once.
+                 * Base implementation locks mutex_ while path is found and copied.
+                 * \param[in] fileName name of the file to find
+                 * \param[out] fullFileName full path of the file
+                 * \return true if file has been found
+                 */
+                virtual bool find(const char* fileName, std::string& fullFileName) const;
+
                 /**
                  * \brief Opens file with given file name.
                  *
@@ -74,8 +94,20 @@ namespace selene
                  */
                 virtual std::istream* open(const char* fileName) const;
 
+                /**
+                 * \brief Maps file with given file name into memory.
+                 *
+                 * Looks for file in folders specified with addFolder and maps it. Base implementation
+                 * does not support mapping, in this case file should be read with open.
+                 * \param[in] fileName name of the file to map
+                 * \return shared pointer to the mapped file if file has been found and mapped, empty
+                 * pointer otherwise
+                 */
+                virtual std::shared_ptr<MappedFile> map(const char* fileName) const;
+
         protected:
                 mutable std::string fileName_;
+                mutable std::mutex mutex_;
                 std::deque<std::string> folders_;
                 bool (*fileExists_)(const char*);
 
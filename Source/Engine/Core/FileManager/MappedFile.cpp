@@ -0,0 +1,60 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "MappedFile.h"
+
+namespace selene
+{
+
+        MappedFile::StreamBuffer::StreamBuffer(const MappedFile& mappedFile)
+        {
+                char* data = reinterpret_cast<char*>(mappedFile.getData());
+                setg(data, data, data + mappedFile.getSize());
+        }
+        MappedFile::StreamBuffer::~StreamBuffer() {}
+
+        //----------------------------------------------------------------------------
+        MappedFile::StreamBuffer::pos_type MappedFile::StreamBuffer::seekoff(off_type offset,
+                                                                           std::ios_base::seekdir direction,
+                                                                           std::ios_base::openmode mode)
+        {
+                if((mode & std::ios_base::in) == 0)
+                        return pos_type(off_type(-1));
+
+                off_type position = offset;
+
+                if(direction == std::ios_base::cur)
+                        position += gptr() - eback();
+                else if(direction == std::ios_base::end)
+                        position += egptr() - eback();
+
+                if(position < 0 || position > (egptr() - eback()))
+                        return pos_type(off_type(-1));
+
+                setg(eback(), eback() + position, egptr());
+                return pos_type(position);
+        }
+
+        //----------------------------------------------------------------------------
+        MappedFile::StreamBuffer::pos_type MappedFile::StreamBuffer::seekpos(pos_type position,
+                                                                           std::ios_base::openmode mode)
+        {
+                return seekoff(off_type(position), std::ios_base::beg, mode);
+        }
+
+        MappedFile::MappedFile(uint8_t* data, uint32_t size): data_(data), size_(size) {}
+        MappedFile::~MappedFile() {}
+
+        //----------------------------------------------------------------------------
+        uint8_t* MappedFile::getData() const
+        {
+                return data_;
+        }
+
+        //----------------------------------------------------------------------------
+        uint32_t MappedFile::getSize() const
+        {
+                return size_;
+        }
+
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "../Macros/Macros.h"
+#include <streambuf>
+#include <istream>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Core
+         * @{
+         */
+
+        /**
+         * Represents mapped file. Holds contents of the file in memory (usually in memory-mapped pages),
+         * which remain valid while mapped file exists. Mapped file is created by FileManager::map, platform
+         * file managers derive from this class and release memory in destructor. Pages are mapped privately,
+         * so writes to the contents are not propagated to the file.
+         *
+         * Contents of the mapped file can be read with std::istream through MappedFile::StreamBuffer,
+         * large blocks of data can be referenced directly (see Array::reference).
+         */
+        class MappedFile
+        {
+        public:
+                /**
+                 * Represents stream buffer, which reads contents of the mapped file without copying.
+                 */
+                class StreamBuffer: public std::streambuf
+                {
+                public:
+                        /**
+                         * \brief Constructs stream buffer with given mapped file.
+                         * \param[in] mappedFile mapped file
+                         */
+                        StreamBuffer(const MappedFile& mappedFile);
+                        StreamBuffer(const StreamBuffer&) = delete;
+                        ~StreamBuffer();
+                        StreamBuffer& operator =(const StreamBuffer&) = delete;
+
+                protected:
+                        // std::streambuf interface implementation
+                        pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                                         std::ios_base::openmode mode);
+                        pos_type seekpos(pos_type position, std::ios_base::openmode mode);
+
+                };
+
+                /**
+                 * \brief Constructs mapped file with given contents.
+                 * \param[in] data pointer to the contents of the file
+                 * \param[in] size size of the file in bytes
+                 */
+                MappedFile(uint8_t* data, uint32_t size);
+                MappedFile(const MappedFile&) = delete;
+                virtual ~MappedFile();
+                MappedFile& operator =(const MappedFile&) = delete;
+
+                /**
+                 * \brief Returns contents of the file.
+                 * \return pointer to the contents of the file
+                 */
+                uint8_t* getData() const;
+
+                /**
+                 * \brief Returns size of the file.
+                 * \return size of the file in bytes
+                 */
+                uint32_t getSize() const;
+
+        protected:
+                uint8_t* data_;
+                uint32_t size_;
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
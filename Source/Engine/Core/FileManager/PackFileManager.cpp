@@ -0,0 +1,563 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "PackFileManager.h"
+#include "../Helpers/LzCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace selene
+{
+
+        PackFileManager::PackFileManager(FileManager* fileManager):
+                FileManager(nullptr), fileManager_(fileManager), threadPool_(nullptr), packs_() {}
+        PackFileManager::~PackFileManager() {}
+
+        //----------------------------------------------------------------------------
+        bool PackFileManager::mount(const char* fileName)
+        {
+                if(fileName == nullptr || fileManager_ == nullptr)
+                        return false;
+
+                // map pack file (or read its table of contents, if file manager can not map files)
+                uint64_t size = 0;
+                std::shared_ptr<MappedFile> mappedFile = fileManager_->map(fileName);
+
+                if(mappedFile)
+                        size = mappedFile->getSize();
+                else
+                        mappedFile = readTableOfContents(fileName, size);
+
+                if(!mappedFile)
+                        return false;
+
+                // validate table of contents
+                Pack pack;
+                if(!pack.initialize(mappedFile, size))
+                        return false;
+
+                try
+                {
+                        pack.fileName = fileName;
+                        packs_.push_back(pack);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return true;
+        }
+
+        //----------------------------------------------------------------------------
+        bool PackFileManager::unmount(const char* fileName)
+        {
+                if(fileName == nullptr)
+                        return false;
+
+                for(auto it = packs_.begin(); it != packs_.end(); ++it)
+                {
+                        if(it->fileName == fileName)
+                        {
+                                packs_.erase(it);
+                                return true;
+                        }
+                }
+
+                return false;
+        }
+
+        //----------------------------------------------------------------------------
+        void PackFileManager::setThreadPool(ThreadPool* threadPool)
+        {
+                threadPool_ = threadPool;
+        }
+
+        //----------------------------------------------------------------------------
+        const char* PackFileManager::find(const char* fileName) const
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                if(!find(fileName, fileName_))
+                        return nullptr;
+
+                return fileName_.c_str();
+        }
+
+        //----------------------------------------------------------------------------
+        bool PackFileManager::find(const char* fileName, std::string& fullFileName) const
+        {
+                const Pack* pack = nullptr;
+                const Entry* entry = findEntry(fileName, pack);
+
+                // another file manager locks its own mutex, while it finds the file
+                if(entry == nullptr)
+                        return (fileManager_ != nullptr && fileManager_->find(fileName, fullFileName));
+
+                try
+                {
+                        fullFileName.assign(pack->names + entry->nameOffset, entry->nameLength);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return true;
+        }
+
+        //----------------------------------------------------------------------------
+        std::istream* PackFileManager::open(const char* fileName) const
+        {
+                const Pack* pack = nullptr;
+                const Entry* entry = findEntry(fileName, pack);
+
+                if(entry == nullptr)
+                {
+                        if(fileManager_ == nullptr)
+                                return nullptr;
+
+                        return fileManager_->open(fileName);
+                }
+
+                std::shared_ptr<MappedFile> view = createView(*pack, *entry);
+                if(!view)
+                        return nullptr;
+
+                return new(std::nothrow) Stream(view);
+        }
+
+        //----------------------------------------------------------------------------
+        std::shared_ptr<MappedFile> PackFileManager::map(const char* fileName) const
+        {
+                const Pack* pack = nullptr;
+                const Entry* entry = findEntry(fileName, pack);
+
+                if(entry == nullptr)
+                {
+                        if(fileManager_ == nullptr)
+                                return std::shared_ptr<MappedFile>();
+
+                        return fileManager_->map(fileName);
+                }
+
+                return createView(*pack, *entry);
+        }
+
+        //----------------------------------------------------------------------------
+        uint32_t PackFileManager::computeHash(const char* name, uint32_t length)
+        {
+                return Name::computeId(name, length);
+        }
+
+        PackFileManager::Pack::Pack():
+                fileName(), mappedFile(), size(0), header(nullptr), slots(nullptr), entries(nullptr),
+                names(nullptr) {}
+        PackFileManager::Pack::~Pack() {}
+
+        //----------------------------------------------------------------------------
+        bool PackFileManager::Pack::initialize(const std::shared_ptr<MappedFile>& mappedFile, uint64_t size)
+        {
+                const uint8_t* data = mappedFile->getData();
+                uint64_t mappedSize = mappedFile->getSize();
+
+                // validate header
+                if(mappedSize < sizeof(Header) || mappedSize > size)
+                        return false;
+
+                const Header* header = reinterpret_cast<const Header*>(data);
+                if(std::memcmp(header->signature, "SDPF", 4) != 0 || header->version != PACK_FILE_VERSION)
+                        return false;
+
+                if(header->numSlots == 0 || (header->numSlots & (header->numSlots - 1)) != 0 ||
+                   header->numSlots < header->numEntries)
+                        return false;
+
+                // validate table of contents
+                uint64_t slotsOffset = sizeof(Header);
+                uint64_t entriesOffset = slotsOffset + static_cast<uint64_t>(header->numSlots) * sizeof(uint32_t);
+                uint64_t namesOffset = entriesOffset + static_cast<uint64_t>(header->numEntries) * sizeof(Entry);
+
+                if(namesOffset > mappedSize)
+                        return false;
+
+                const uint32_t* slots = reinterpret_cast<const uint32_t*>(data + slotsOffset);
+                const Entry* entries = reinterpret_cast<const Entry*>(data + entriesOffset);
+
+                for(uint32_t i = 0; i < header->numSlots; ++i)
+                {
+                        if(slots[i] > header->numEntries)
+                                return false;
+                }
+
+                for(uint32_t i = 0; i < header->numEntries; ++i)
+                {
+                        const Entry& entry = entries[i];
+
+                        if(namesOffset + entry.nameOffset + entry.nameLength > mappedSize ||
+                           static_cast<uint64_t>(entry.offset) + entry.size > size)
+                                return false;
+                }
+
+                this->mappedFile = mappedFile;
+                this->size = size;
+                this->header = header;
+                this->slots = slots;
+                this->entries = entries;
+                this->names = reinterpret_cast<const char*>(data + namesOffset);
+
+                return true;
+        }
+
+        //----------------------------------------------------------------------------
+        const PackFileManager::Entry* PackFileManager::Pack::findEntry(const char* name, uint32_t length) const
+        {
+                uint32_t hash = computeHash(name, length);
+                uint32_t mask = header->numSlots - 1;
+
+                // probe slots until empty slot is found
+                for(uint32_t i = 0, slot = hash & mask; i < header->numSlots; ++i, slot = (slot + 1) & mask)
+                {
+                        if(slots[slot] == 0)
+                                break;
+
+                        const Entry& entry = entries[slots[slot] - 1];
+                        if(entry.hash == hash && entry.nameLength == length &&
+                           std::memcmp(names + entry.nameOffset, name, length) == 0)
+                                return &entry;
+                }
+
+                return nullptr;
+        }
+
+        //----------------------------------------------------------------------------
+        bool PackFileManager::Pack::isMapped(const Entry& entry) const
+        {
+                return (static_cast<uint64_t>(entry.offset) + entry.size <= mappedFile->getSize());
+        }
+
+        PackFileManager::View::View(const std::shared_ptr<MappedFile>& pack, const Entry& entry):
+                MappedFile(pack->getData() + entry.offset, entry.size), pack_(pack) {}
+        PackFileManager::View::~View() {}
+
+        PackFileManager::Buffer::Buffer(uint8_t* data, uint32_t size): MappedFile(data, size) {}
+        PackFileManager::Buffer::~Buffer()
+        {
+                delete[] data_;
+        }
+
+        PackFileManager::Decoder::Decoder():
+                pack(), contents(nullptr), blockOffsets(nullptr), destination(nullptr), originalSize(0),
+                numBlocks(0), filter(FILTER_NONE), nextBlock(0), numCompletedBlocks(0), isCorrupted(false),
+                mutex(), blocksCompleted() {}
+        PackFileManager::Decoder::~Decoder() {}
+
+        //----------------------------------------------------------------------------
+        void PackFileManager::Decoder::execute()
+        {
+                // filters need temporary buffer
+                std::unique_ptr<uint8_t[]> buffer;
+                if(filter != FILTER_NONE)
+                        buffer.reset(new(std::nothrow) uint8_t[COMPRESSION_BLOCK_SIZE]);
+
+                while(true)
+                {
+                        uint32_t block = nextBlock.fetch_add(1);
+                        if(block >= numBlocks)
+                                return;
+
+                        bool result = (filter == FILTER_NONE || buffer) && decodeBlock(block, buffer.get());
+
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if(!result)
+                                isCorrupted = true;
+
+                        if(++numCompletedBlocks == numBlocks)
+                                blocksCompleted.notify_all();
+                }
+        }
+
+        //----------------------------------------------------------------------------
+        bool PackFileManager::Decoder::wait()
+        {
+                std::unique_lock<std::mutex> lock(mutex);
+                while(numCompletedBlocks != numBlocks)
+                        blocksCompleted.wait(lock);
+
+                return !isCorrupted;
+        }
+
+        //----------------------------------------------------------------------------
+        bool PackFileManager::Decoder::decodeBlock(uint32_t block, uint8_t* buffer)
+        {
+                uint32_t offset = block * COMPRESSION_BLOCK_SIZE;
+                uint32_t blockSize = std::min(originalSize - offset, static_cast<uint32_t>(COMPRESSION_BLOCK_SIZE));
+
+                const uint8_t* source = contents + blockOffsets[block];
+                uint32_t size = blockOffsets[block + 1] - blockOffsets[block];
+
+                uint8_t* output = (filter == FILTER_NONE) ? destination + offset : buffer;
+
+                // block, which could not be compressed, is stored as-is
+                if(size == blockSize)
+                        std::memcpy(output, source, size);
+                else if(!LzCodec::decompress(source, size, output, blockSize))
+                        return false;
+
+                if(filter == FILTER_SHUFFLE_DELTA)
+                {
+                        LzCodec::decodeDelta(buffer, blockSize);
+                        LzCodec::unshuffle(buffer, destination + offset, blockSize, FILTER_ELEMENT_SIZE);
+                }
+
+                return true;
+        }
+
+        PackFileManager::Stream::Stream(const std::shared_ptr<MappedFile>& mappedFile):
+                std::istream(nullptr), mappedFile_(mappedFile), streamBuffer_(*mappedFile)
+        {
+                rdbuf(&streamBuffer_);
+        }
+        PackFileManager::Stream::~Stream() {}
+
+        //----------------------------------------------------------------------------
+        const PackFileManager::Entry* PackFileManager::findEntry(const char* fileName, const Pack*& pack) const
+        {
+                if(fileName == nullptr)
+                        return nullptr;
+
+                uint32_t length = static_cast<uint32_t>(std::strlen(fileName));
+
+                // check root folder of the packs
+                for(auto it = packs_.begin(); it != packs_.end(); ++it)
+                {
+                        const Entry* entry = it->findEntry(fileName, length);
+                        if(entry != nullptr)
+                        {
+                                pack = &(*it);
+                                return entry;
+                        }
+                }
+
+                // search all folders
+                try
+                {
+                        std::string name;
+
+                        for(auto it = folders_.begin(); it != folders_.end(); ++it)
+                        {
+                                name = (*it) + fileName;
+
+                                for(auto p = packs_.begin(); p != packs_.end(); ++p)
+                                {
+                                        const Entry* entry = p->findEntry(name.c_str(),
+                                                                          static_cast<uint32_t>(name.length()));
+                                        if(entry != nullptr)
+                                        {
+                                                pack = &(*p);
+                                                return entry;
+                                        }
+                                }
+                        }
+                }
+                catch(...) {}
+
+                return nullptr;
+        }
+
+        //----------------------------------------------------------------------------
+        std::shared_ptr<MappedFile> PackFileManager::createView(const Pack& pack, const Entry& entry) const
+        {
+                if(entry.compression != COMPRESSION_NONE && entry.compression != COMPRESSION_LZ)
+                        return std::shared_ptr<MappedFile>();
+
+                // contents of the entry are either mapped, or read from the pack file
+                std::shared_ptr<MappedFile> source;
+                const uint8_t* contents = nullptr;
+
+                if(pack.isMapped(entry))
+                {
+                        if(entry.compression == COMPRESSION_NONE)
+                                return std::shared_ptr<MappedFile>(new(std::nothrow) View(pack.mappedFile, entry));
+
+                        source = pack.mappedFile;
+                        contents = source->getData() + entry.offset;
+                }
+                else
+                {
+                        source = readEntry(pack, entry);
+                        if(!source || entry.compression == COMPRESSION_NONE)
+                                return source;
+
+                        contents = source->getData();
+                }
+
+                // read and validate block table
+                uint32_t filter = 0, numBlocks = 0;
+
+                if(entry.size < 2 * sizeof(uint32_t))
+                        return std::shared_ptr<MappedFile>();
+
+                std::memcpy(&filter,    contents,                    sizeof(uint32_t));
+                std::memcpy(&numBlocks, contents + sizeof(uint32_t), sizeof(uint32_t));
+
+                uint64_t expectedNumBlocks = (static_cast<uint64_t>(entry.originalSize) +
+                                              COMPRESSION_BLOCK_SIZE - 1) / COMPRESSION_BLOCK_SIZE;
+                uint64_t tableSize = (2 + static_cast<uint64_t>(numBlocks) + 1) * sizeof(uint32_t);
+
+                if(filter > FILTER_SHUFFLE_DELTA || numBlocks != expectedNumBlocks || tableSize > entry.size)
+                        return std::shared_ptr<MappedFile>();
+
+                const uint32_t* blockOffsets = reinterpret_cast<const uint32_t*>(contents + 2 * sizeof(uint32_t));
+                if(blockOffsets[0] < tableSize || blockOffsets[numBlocks] > entry.size)
+                        return std::shared_ptr<MappedFile>();
+
+                for(uint32_t i = 0; i < numBlocks; ++i)
+                {
+                        if(blockOffsets[i] > blockOffsets[i + 1])
+                                return std::shared_ptr<MappedFile>();
+                }
+
+                // allocate buffer
+                std::unique_ptr<uint8_t[]> data(new(std::nothrow) uint8_t[entry.originalSize > 0 ?
+                                                                          entry.originalSize : 1]);
+                if(data.get() == nullptr)
+                        return std::shared_ptr<MappedFile>();
+
+                std::shared_ptr<MappedFile> buffer(new(std::nothrow) Buffer(data.get(), entry.originalSize));
+                if(!buffer)
+                        return std::shared_ptr<MappedFile>();
+
+                data.release();
+
+                // decode blocks, calling thread takes part in decoding
+                std::shared_ptr<Decoder> decoder(new(std::nothrow) Decoder);
+                if(!decoder)
+                        return std::shared_ptr<MappedFile>();
+
+                decoder->pack = source;
+                decoder->contents = contents;
+                decoder->blockOffsets = blockOffsets;
+                decoder->destination = buffer->getData();
+                decoder->originalSize = entry.originalSize;
+                decoder->numBlocks = numBlocks;
+                decoder->filter = filter;
+
+                if(threadPool_ != nullptr && numBlocks > 1)
+                {
+                        uint32_t numJobs = std::min(static_cast<uint32_t>(threadPool_->getNumWorkers()),
+                                                    numBlocks - 1);
+
+                        try
+                        {
+                                for(uint32_t i = 0; i < numJobs; ++i)
+                                        threadPool_->addJob([decoder]() { decoder->execute(); });
+                        }
+                        catch(...) {}
+                }
+
+                decoder->execute();
+                if(!decoder->wait())
+                        return std::shared_ptr<MappedFile>();
+
+                return buffer;
+        }
+
+        //----------------------------------------------------------------------------
+        std::shared_ptr<MappedFile> PackFileManager::readEntry(const Pack& pack, const Entry& entry) const
+        {
+                std::unique_ptr<std::istream> stream(fileManager_->open(pack.fileName.c_str()));
+                if(stream.get() == nullptr)
+                        return std::shared_ptr<MappedFile>();
+
+                std::unique_ptr<uint8_t[]> data(new(std::nothrow) uint8_t[entry.size > 0 ? entry.size : 1]);
+                if(data.get() == nullptr)
+                        return std::shared_ptr<MappedFile>();
+
+                stream->seekg(static_cast<std::streamoff>(entry.offset), std::ios_base::beg);
+                stream->read(reinterpret_cast<char*>(data.get()), static_cast<std::streamsize>(entry.size));
+                if(!stream->good())
+                        return std::shared_ptr<MappedFile>();
+
+                std::shared_ptr<MappedFile> buffer(new(std::nothrow) Buffer(data.get(), entry.size));
+                if(buffer)
+                        data.release();
+
+                return buffer;
+        }
+
+        //----------------------------------------------------------------------------
+        std::shared_ptr<MappedFile> PackFileManager::readTableOfContents(const char* fileName,
+                                                                         uint64_t& size) const
+        {
+                std::unique_ptr<std::istream> stream(fileManager_->open(fileName));
+                if(stream.get() == nullptr)
+                        return std::shared_ptr<MappedFile>();
+
+                stream->seekg(0, std::ios_base::end);
+                std::streamoff fileSize = stream->tellg();
+                stream->seekg(0, std::ios_base::beg);
+
+                if(fileSize < static_cast<std::streamoff>(sizeof(Header)) ||
+                   fileSize > static_cast<std::streamoff>(0xFFFFFFFFU))
+                        return std::shared_ptr<MappedFile>();
+
+                size = static_cast<uint64_t>(fileSize);
+
+                // read header, slots and entries
+                Header header;
+                stream->read(reinterpret_cast<char*>(&header), sizeof(Header));
+                if(!stream->good())
+                        return std::shared_ptr<MappedFile>();
+
+                uint64_t entriesOffset = sizeof(Header) + static_cast<uint64_t>(header.numSlots) * sizeof(uint32_t);
+                uint64_t namesOffset = entriesOffset + static_cast<uint64_t>(header.numEntries) * sizeof(Entry);
+
+                if(namesOffset > size)
+                        return std::shared_ptr<MappedFile>();
+
+                std::unique_ptr<uint8_t[]> entries(new(std::nothrow) uint8_t[static_cast<size_t>(namesOffset)]);
+                if(entries.get() == nullptr)
+                        return std::shared_ptr<MappedFile>();
+
+                std::memcpy(entries.get(), &header, sizeof(Header));
+                stream->read(reinterpret_cast<char*>(entries.get() + sizeof(Header)),
+                             static_cast<std::streamsize>(namesOffset - sizeof(Header)));
+                if(!stream->good())
+                        return std::shared_ptr<MappedFile>();
+
+                // names follow entries, their size is determined by the entries
+                uint64_t namesSize = 0;
+                for(uint32_t i = 0; i < header.numEntries; ++i)
+                {
+                        Entry entry;
+                        std::memcpy(&entry, entries.get() + entriesOffset + i * sizeof(Entry), sizeof(Entry));
+                        namesSize = std::max(namesSize, static_cast<uint64_t>(entry.nameOffset) + entry.nameLength);
+                }
+
+                uint64_t tableSize = namesOffset + namesSize;
+                if(tableSize > size)
+                        return std::shared_ptr<MappedFile>();
+
+                // read names
+                std::unique_ptr<uint8_t[]> data(new(std::nothrow) uint8_t[static_cast<size_t>(tableSize)]);
+                if(data.get() == nullptr)
+                        return std::shared_ptr<MappedFile>();
+
+                std::memcpy(data.get(), entries.get(), static_cast<size_t>(namesOffset));
+                stream->read(reinterpret_cast<char*>(data.get() + namesOffset),
+                             static_cast<std::streamsize>(namesSize));
+                if(!stream->good())
+                        return std::shared_ptr<MappedFile>();
+
+                std::shared_ptr<MappedFile> buffer(new(std::nothrow) Buffer(data.get(),
+                                                                            static_cast<uint32_t>(tableSize)));
+                if(buffer)
+                        data.release();
+
+                return buffer;
+        }
+
+}
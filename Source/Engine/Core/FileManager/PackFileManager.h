@@ -0,0 +1,412 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef PACK_FILE_MANAGER_H
+#define PACK_FILE_MANAGER_H
+
+#include "../Helpers/ThreadPool.h"
+#include "../Helpers/Name.h"
+#include "FileManager.h"
+
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Core
+         * @{
+         */
+
+        /**
+         * Represents pack file manager. Provides access to the files, which are stored in mounted pack files
+         * (SDPF). Pack file is a single file, which contains table of contents and entries (contents of
+         * the packed files). Pack file has the following layout:
+         * \code
+         * Header              (signature "SDPF", version, number of entries, number of slots)
+         * Slots               (uint32_t[number of slots], index of the entry plus one, or zero if slot is empty)
+         * Entries             (Entry[number of entries])
+         * Names               (names of the entries, not null-terminated)
+         * Contents            (contents of the entries, each entry is aligned to PACK_FILE_ALIGNMENT)
+         * \endcode
+         * Slots form open-addressing hash table with linear probing, which is indexed with hash of the name
+         * of the entry (see PackFileManager::computeHash), so files are found without touching file system.
+         * Names of the entries are relative to the root folder of the pack (for example,
+         * "Textures/brick.dds"). Folders, which are added with FileManager::addFolder, are used as prefixes
+         * of the names during search.
+         *
+         * Pack files are mapped into memory with another file manager, so PackFileManager::open and
+         * PackFileManager::map return views into the pack without copying. If another file manager can not
+         * map files, then only table of contents is kept in memory, and entries are read from the pack file
+         * (opened with another file manager) when they are accessed. Files, which can not be found in the
+         * mounted packs, are opened with another file manager.
+         *
+         * Entries may be compressed with LzCodec (COMPRESSION_LZ). Contents of the compressed entry are
+         * split into blocks of COMPRESSION_BLOCK_SIZE bytes, which are compressed independently:
+         * \code
+         * Filter              (uint32_t, FILTER_NONE or FILTER_SHUFFLE_DELTA)
+         * Number of blocks    (uint32_t)
+         * Block offsets       (uint32_t[number of blocks + 1], relative to the beginning of the entry)
+         * Blocks              (compressed blocks, block is stored as-is if it could not be compressed)
+         * \endcode
+         * Shuffle and delta filters (see LzCodec::shuffle) are applied to the blocks before compression,
+         * with element size of four bytes (floats and 32-bit integers of the vertex streams and animation
+         * keys). Compressed entries are decoded when opened, blocks are decoded in parallel if thread pool
+         * has been set, so loaders read compressed files transparently.
+         */
+        class PackFileManager: public FileManager
+        {
+        public:
+                /// Pack file constants
+                enum
+                {
+                        PACK_FILE_VERSION = 1,
+                        PACK_FILE_ALIGNMENT = 16,
+                        COMPRESSION_BLOCK_SIZE = 65536,
+                        FILTER_ELEMENT_SIZE = 4
+                };
+
+                /// Compression methods of the entries
+                enum COMPRESSION
+                {
+                        COMPRESSION_NONE = 0,
+                        COMPRESSION_LZ
+                };
+
+                /// Filters of the compressed entries
+                enum FILTER
+                {
+                        FILTER_NONE = 0,
+                        FILTER_SHUFFLE_DELTA
+                };
+
+                /**
+                 * Represents header of the pack file.
+                 */
+                class Header
+                {
+                public:
+                        char signature[4];
+                        uint32_t version;
+                        uint32_t numEntries;
+                        uint32_t numSlots;
+
+                };
+
+                /**
+                 * Represents entry of the pack file.
+                 */
+                class Entry
+                {
+                public:
+                        uint32_t hash;
+                        uint32_t nameOffset;
+                        uint32_t nameLength;
+                        uint32_t offset;
+                        uint32_t size;
+                        uint32_t originalSize;
+                        uint32_t compression;
+                        uint32_t reserved;
+
+                };
+
+                /**
+                 * \brief Constructs pack file manager with given file manager.
+                 * \param[in] fileManager file manager, which is used to map pack files and to access
+                 * files, which are not packed (can be nullptr)
+                 */
+                PackFileManager(FileManager* fileManager = nullptr);
+                PackFileManager(const PackFileManager&) = delete;
+                ~PackFileManager();
+                PackFileManager& operator =(const PackFileManager&) = delete;
+
+                /**
+                 * \brief Mounts pack file.
+                 *
+                 * Packs are searched in order, in which they have been mounted. Packs must not be mounted
+                 * or unmounted while files are accessed from other threads.
+                 * \param[in] fileName name of the pack file
+                 * \return true if pack file has been successfully mounted
+                 */
+                bool mount(const char* fileName);
+
+                /**
+                 * \brief Unmounts pack file.
+                 *
+                 * Files, which have been opened or mapped from the pack, remain valid.
+                 * \param[in] fileName name of the pack file
+                 * \return true if pack file has been unmounted
+                 */
+                bool unmount(const char* fileName);
+
+                /**
+                 * \brief Sets thread pool.
+                 * \param[in] threadPool thread pool, which is used to decode blocks of the compressed entries
+                 * in parallel (if nullptr, then blocks are decoded in the calling thread)
+                 */
+                void setThreadPool(ThreadPool* threadPool);
+
+                using FileManager::find;
+
+                /**
+                 * \brief Finds file with given name.
+                 *
+                 * Returned c-string is valid until the next call of this function, threads, which are
+                 * loading resources, must use find(const char*, std::string&) instead.
+                 * \param[in] fileName name of the file to find
+                 * \return c-string containing name of the entry (if file has been found in the mounted packs),
+                 * or full path (if file has been found by another file manager), nullptr otherwise
+                 */
+                const char* find(const char* fileName) const;
+
+                /**
+                 * \brief Finds file with given name and copies its name.
+                 *
+                 * This function does not modify shared state, so it may be called from several threads.
+                 * \param[in] fileName name of the file to find
+                 * \param[out] fullFileName name of the entry (if file has been found in the mounted packs),
+                 * or full path (if file has been found by another file manager)
+                 * \return true if file has been found
+                 */
+                bool find(const char* fileName, std::string& fullFileName) const;
+
+                /**
+                 * \brief Opens file with given file name.
+                 * \param[in] fileName name of the file to open
+                 * \return pointer to the std::istream, which reads contents of the entry without copying
+                 * (compressed entries are decoded first), or file opened by another file manager, nullptr if
+                 * file could not be found
+                 */
+                std::istream* open(const char* fileName) const;
+
+                /**
+                 * \brief Maps file with given file name into memory.
+                 * \param[in] fileName name of the file to map
+                 * \return shared pointer to the view of the entry (or decoded contents of the compressed entry,
+                 * or file mapped by another file manager), empty pointer if file could not be found or mapped
+                 */
+                std::shared_ptr<MappedFile> map(const char* fileName) const;
+
+                /**
+                 * \brief Computes hash of the name (32-bit FNV-1a, the same as identifier of the Name).
+                 * \param[in] name name
+                 * \param[in] length length of the name
+                 * \return hash of the name
+                 */
+                static uint32_t computeHash(const char* name, uint32_t length);
+
+        private:
+                /**
+                 * Represents mounted pack.
+                 */
+                class Pack
+                {
+                public:
+                        std::string fileName;
+                        std::shared_ptr<MappedFile> mappedFile;
+                        uint64_t size;
+                        const Header* header;
+                        const uint32_t* slots;
+                        const Entry* entries;
+                        const char* names;
+
+                        Pack();
+                        Pack(const Pack&) = default;
+                        ~Pack();
+                        Pack& operator =(const Pack&) = default;
+
+                        /**
+                         * \brief Initializes pack with given mapped file.
+                         *
+                         * Validates header and table of contents.
+                         * \param[in] mappedFile mapped pack file, or its table of contents (if pack file
+                         * could not be mapped)
+                         * \param[in] size size of the pack file in bytes
+                         * \return true if pack has been successfully initialized
+                         */
+                        bool initialize(const std::shared_ptr<MappedFile>& mappedFile, uint64_t size);
+
+                        /**
+                         * \brief Checks if contents of the entry are held by the mapped file.
+                         * \param[in] entry entry of the pack
+                         * \return true if contents of the entry are held by the mapped file, false if
+                         * they must be read from the pack file
+                         */
+                        bool isMapped(const Entry& entry) const;
+
+                        /**
+                         * \brief Finds entry with given name.
+                         * \param[in] name name of the entry
+                         * \param[in] length length of the name
+                         * \return pointer to the entry, or nullptr if entry could not be found
+                         */
+                        const Entry* findEntry(const char* name, uint32_t length) const;
+
+                };
+
+                /**
+                 * Represents view of the entry. Holds pack, so contents of the entry remain valid while view
+                 * exists.
+                 */
+                class View: public MappedFile
+                {
+                public:
+                        /**
+                         * \brief Constructs view with given pack and entry.
+                         * \param[in] pack mapped pack file
+                         * \param[in] entry entry of the pack
+                         */
+                        View(const std::shared_ptr<MappedFile>& pack, const Entry& entry);
+                        View(const View&) = delete;
+                        ~View();
+                        View& operator =(const View&) = delete;
+
+                private:
+                        std::shared_ptr<MappedFile> pack_;
+
+                };
+
+                /**
+                 * Represents buffer, which holds data read from the pack file, when it can not be mapped
+                 * (table of contents, or contents of the entry), or decoded contents of the entry.
+                 */
+                class Buffer: public MappedFile
+                {
+                public:
+                        /**
+                         * \brief Constructs buffer with given contents.
+                         * \param[in] data contents (allocated with new[], buffer takes ownership)
+                         * \param[in] size size of the contents in bytes
+                         */
+                        Buffer(uint8_t* data, uint32_t size);
+                        Buffer(const Buffer&) = delete;
+                        ~Buffer();
+                        Buffer& operator =(const Buffer&) = delete;
+
+                };
+
+                /**
+                 * Represents decoder of the compressed entry. Blocks are taken from the decoder by the
+                 * calling thread and by workers of the thread pool, decoder is shared between jobs (as well
+                 * as mapped pack, or compressed contents read from the pack file), so jobs, which start after
+                 * decoding has been finished, return immediately.
+                 */
+                class Decoder
+                {
+                public:
+                        std::shared_ptr<MappedFile> pack;
+                        const uint8_t* contents;
+                        const uint32_t* blockOffsets;
+                        uint8_t* destination;
+                        uint32_t originalSize;
+                        uint32_t numBlocks;
+                        uint32_t filter;
+
+                        std::atomic<uint32_t> nextBlock;
+                        uint32_t numCompletedBlocks;
+                        bool isCorrupted;
+                        std::mutex mutex;
+                        std::condition_variable blocksCompleted;
+
+                        Decoder();
+                        Decoder(const Decoder&) = delete;
+                        ~Decoder();
+                        Decoder& operator =(const Decoder&) = delete;
+
+                        /**
+                         * \brief Decodes blocks until there are no blocks left.
+                         */
+                        void execute();
+
+                        /**
+                         * \brief Waits until all blocks have been decoded.
+                         * \return true if all blocks have been successfully decoded
+                         */
+                        bool wait();
+
+                        /**
+                         * \brief Decodes block.
+                         * \param[in] block index of the block
+                         * \param[in] buffer temporary buffer, which is used by filters (can be nullptr if
+                         * entry has no filters)
+                         * \return true if block has been successfully decoded
+                         */
+                        bool decodeBlock(uint32_t block, uint8_t* buffer);
+
+                };
+
+                /**
+                 * Represents input stream, which reads contents of the mapped file.
+                 */
+                class Stream: public std::istream
+                {
+                public:
+                        /**
+                         * \brief Constructs stream with given mapped file.
+                         * \param[in] mappedFile mapped file
+                         */
+                        Stream(const std::shared_ptr<MappedFile>& mappedFile);
+                        Stream(const Stream&) = delete;
+                        ~Stream();
+                        Stream& operator =(const Stream&) = delete;
+
+                private:
+                        std::shared_ptr<MappedFile> mappedFile_;
+                        MappedFile::StreamBuffer streamBuffer_;
+
+                };
+
+                FileManager* fileManager_;
+                ThreadPool* threadPool_;
+                std::vector<Pack> packs_;
+
+                /**
+                 * \brief Finds entry with given file name in the mounted packs.
+                 *
+                 * Folders are used as prefixes of the file name.
+                 * \param[in] fileName name of the file
+                 * \param[out] pack pack, which contains entry
+                 * \return pointer to the entry, or nullptr if entry could not be found
+                 */
+                const Entry* findEntry(const char* fileName, const Pack*& pack) const;
+
+                /**
+                 * \brief Creates view of the entry.
+                 *
+                 * Compressed entries are decoded into buffer.
+                 * \param[in] pack pack, which contains entry
+                 * \param[in] entry entry
+                 * \return shared pointer to the view (or buffer), or empty pointer if entry could not
+                 * be decoded
+                 */
+                std::shared_ptr<MappedFile> createView(const Pack& pack, const Entry& entry) const;
+
+                /**
+                 * \brief Reads contents of the entry from the pack file, which can not be mapped.
+                 * \param[in] pack pack, which contains entry
+                 * \param[in] entry entry
+                 * \return shared pointer to the buffer, which holds contents of the entry (not decoded),
+                 * or empty pointer if contents could not be read
+                 */
+                std::shared_ptr<MappedFile> readEntry(const Pack& pack, const Entry& entry) const;
+
+                /**
+                 * \brief Reads table of contents of the pack file, which can not be mapped.
+                 * \param[in] fileName name of the pack file
+                 * \param[out] size size of the pack file in bytes
+                 * \return shared pointer to the buffer, which holds header, slots, entries and names of the
+                 * pack file, or empty pointer if table of contents could not be read
+                 */
+                std::shared_ptr<MappedFile> readTableOfContents(const char* fileName, uint64_t& size) const;
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
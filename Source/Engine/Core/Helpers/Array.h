@@ -5,6 +5,7 @@
 #define ARRAY_H
 
 #include "../Macros/Macros.h"
+#include <utility>
 #include <new>
 
 namespace selene
@@ -25,7 +26,7 @@ namespace selene
         public:
                 Array():
                         data_(nullptr), size_(0), sizeModifier_(0),
-                        realSize_(0), stride_(0) {}
+                        realSize_(0), stride_(0), isDataOwned_(true) {}
                 Array(const Array<D, S>& other): Array()
                 {
                         *this = other;
@@ -91,19 +92,64 @@ namespace selene
                         return true;
                 }
 
+                /**
+                 * \brief References external data.
+                 *
+                 * Array does not own referenced data (it is not deleted when array is destroyed), so data must
+                 * remain valid while array references it. This is used to access data, which is already in memory
+                 * (for example, vertices of the mapped mesh file), without copying. When referencing array is
+                 * assigned another array, own memory is allocated.
+                 * \param[in] data pointer to the external data
+                 * \param[in] size size of array
+                 * \param[in] stride data stride
+                 * \param[in] sizeModifier array size modifier
+                 * \return true if array successfully references data
+                 */
+                bool reference(D* data, S size, uint8_t stride = 1, S sizeModifier = 1)
+                {
+                        // destroy array
+                        destroy();
+
+                        // validate
+                        if(data == nullptr || size <= 0 || stride < 1 || sizeModifier < 1)
+                                return false;
+
+                        size_ = size;
+                        sizeModifier_ = sizeModifier;
+                        stride_ = stride;
+
+                        realSize_ = size_ * sizeModifier_ * stride_;
+
+                        data_ = data;
+                        isDataOwned_ = false;
+                        return true;
+                }
+
                 /**
                  * \brief Destroys array.
                  */
                 void destroy()
                 {
-                        delete[] data_;
+                        if(isDataOwned_)
+                                delete[] data_;
+
                         data_ = nullptr;
+                        isDataOwned_ = true;
 
                         size_ = sizeModifier_ = 0;
                         realSize_ = 0;
                         stride_ = 0;
                 }
 
+                /**
+                 * \brief Returns true if array references external data.
+                 * \return true if array references external data (see Array::reference)
+                 */
+                bool isReference() const
+                {
+                        return !isDataOwned_;
+                }
+
                 /**
                  * \brief Returns size.
                  * \return array size without modification and stride
@@ -149,7 +195,11 @@ namespace selene
                  */
                 Array<D, S>& operator =(const Array<D, S>& other)
                 {
-                        if(sizeModifier_ == other.sizeModifier_ &&
+                        if(this == &other)
+                                return *this;
+
+                        if(isDataOwned_ &&
+                           sizeModifier_ == other.sizeModifier_ &&
                            stride_ == other.stride_ &&
                            size_   == other.size_)
                         {
@@ -170,11 +220,29 @@ namespace selene
                         return *this;
                 }
 
+                /**
+                 * \brief Swaps contents of the arrays.
+                 *
+                 * Data is not copied, so this is used to replace contents of the array, which may be
+                 * used somewhere else, only when new contents have been successfully created.
+                 * \param[in] other array, whose contents will be swapped with contents of current array
+                 */
+                void swap(Array<D, S>& other)
+                {
+                        std::swap(data_, other.data_);
+                        std::swap(size_, other.size_);
+                        std::swap(sizeModifier_, other.sizeModifier_);
+                        std::swap(realSize_, other.realSize_);
+                        std::swap(stride_, other.stride_);
+                        std::swap(isDataOwned_, other.isDataOwned_);
+                }
+
         private:
                 D* data_;
                 S size_, sizeModifier_;
                 uint32_t realSize_;
                 uint8_t stride_;
+                bool isDataOwned_;
 
         };
 
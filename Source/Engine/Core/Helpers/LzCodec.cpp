@@ -0,0 +1,361 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "LzCodec.h"
+#include <cstring>
+
+namespace selene
+{
+
+        LzCodec::LzCodec() {}
+        LzCodec::~LzCodec() {}
+
+        //-------------------------------------------------------------------------------
+        uint32_t LzCodec::getMaxCompressedSize(uint32_t size)
+        {
+                return size + size / 255 + 16;
+        }
+
+        //-------------------------------------------------------------------------------
+        uint32_t LzCodec::compress(const uint8_t* source, uint32_t size, uint8_t* destination,
+                                   uint32_t capacity)
+        {
+                if(source == nullptr || destination == nullptr)
+                        return 0;
+
+                uint32_t hashTable[HASH_TABLE_SIZE];
+                std::memset(hashTable, 0, sizeof(hashTable));
+
+                uint8_t* output = destination;
+                const uint8_t* outputEnd = destination + capacity;
+
+                // the last bytes are always stored as literals
+                uint32_t anchor = 0;
+                uint32_t matchLimit = (size > NUM_OF_LAST_LITERALS) ? size - NUM_OF_LAST_LITERALS : 0;
+                uint32_t searchLimit = (size > MIN_INPUT_SIZE) ? size - MIN_INPUT_SIZE : 0;
+                uint32_t numMisses = 0;
+
+                for(uint32_t i = 0; i < searchLimit;)
+                {
+                        // find candidate with the same four bytes
+                        uint32_t sequence, candidateSequence;
+                        std::memcpy(&sequence, source + i, sizeof(sequence));
+
+                        uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_TABLE_SIZE_LOG2);
+                        uint32_t candidate = hashTable[hash];
+                        hashTable[hash] = i;
+
+                        std::memcpy(&candidateSequence, source + candidate, sizeof(candidateSequence));
+
+                        if(candidate >= i || (i - candidate) > MAX_OFFSET || candidateSequence != sequence)
+                        {
+                                // skip incompressible data faster
+                                i += 1 + (numMisses++ >> SKIP_STRENGTH);
+                                continue;
+                        }
+
+                        numMisses = 0;
+
+                        // extend match backwards and forwards
+                        while(i > anchor && candidate > 0 && source[i - 1] == source[candidate - 1])
+                        {
+                                --i;
+                                --candidate;
+                        }
+
+                        uint32_t matchLength = MIN_MATCH_LENGTH;
+                        while(i + matchLength < matchLimit &&
+                              source[candidate + matchLength] == source[i + matchLength])
+                                ++matchLength;
+
+                        // write sequence
+                        uint32_t numLiterals = i - anchor;
+                        uint32_t offset = i - candidate;
+
+                        if(output >= outputEnd)
+                                return 0;
+
+                        uint8_t* token = output++;
+                        *token = static_cast<uint8_t>(((numLiterals < 15) ? numLiterals : 15) << 4);
+
+                        if(numLiterals >= 15 && !writeLength(numLiterals - 15, output, outputEnd))
+                                return 0;
+
+                        if(static_cast<uint32_t>(outputEnd - output) < numLiterals + 2)
+                                return 0;
+
+                        std::memcpy(output, source + anchor, numLiterals);
+                        output += numLiterals;
+
+                        *output++ = static_cast<uint8_t>(offset & 0xFF);
+                        *output++ = static_cast<uint8_t>(offset >> 8);
+
+                        uint32_t extraLength = matchLength - MIN_MATCH_LENGTH;
+                        *token |= static_cast<uint8_t>((extraLength < 15) ? extraLength : 15);
+
+                        if(extraLength >= 15 && !writeLength(extraLength - 15, output, outputEnd))
+                                return 0;
+
+                        i += matchLength;
+                        anchor = i;
+                }
+
+                // write the last literals
+                uint32_t numLiterals = size - anchor;
+
+                if(output >= outputEnd)
+                        return 0;
+
+                uint8_t* token = output++;
+                *token = static_cast<uint8_t>(((numLiterals < 15) ? numLiterals : 15) << 4);
+
+                if(numLiterals >= 15 && !writeLength(numLiterals - 15, output, outputEnd))
+                        return 0;
+
+                if(static_cast<uint32_t>(outputEnd - output) < numLiterals)
+                        return 0;
+
+                std::memcpy(output, source + anchor, numLiterals);
+                output += numLiterals;
+
+                return static_cast<uint32_t>(output - destination);
+        }
+
+        //-------------------------------------------------------------------------------
+        bool LzCodec::decompress(const uint8_t* source, uint32_t size, uint8_t* destination,
+                                 uint32_t originalSize)
+        {
+                if(source == nullptr || destination == nullptr)
+                        return false;
+
+                const uint8_t* input = source;
+                const uint8_t* inputEnd = source + size;
+                uint8_t* output = destination;
+                uint8_t* outputEnd = destination + originalSize;
+
+                while(input < inputEnd)
+                {
+                        uint8_t token = *input++;
+
+                        // copy literals
+                        uint32_t numLiterals = token >> 4;
+                        if(numLiterals < 15 && static_cast<uint32_t>(inputEnd - input) >= SHORT_LITERALS_SIZE + 2 &&
+                           static_cast<uint32_t>(outputEnd - output) >= SHORT_LITERALS_SIZE)
+                        {
+                                // short literals (the most common case) are copied with one fixed-size copy, and
+                                // they can not be the last sequence, since input has enough bytes after them
+                                std::memcpy(output, input, SHORT_LITERALS_SIZE);
+                                output += numLiterals;
+                                input  += numLiterals;
+                        }
+                        else
+                        {
+                                if(numLiterals == 15 && !readLength(numLiterals, input, inputEnd))
+                                        return false;
+
+                                if(numLiterals > static_cast<uint32_t>(inputEnd - input) ||
+                                   numLiterals > static_cast<uint32_t>(outputEnd - output))
+                                        return false;
+
+                                // literals are copied in words when input and output have enough space after them
+                                if(static_cast<uint32_t>(inputEnd - input) >= numLiterals + WILD_COPY_SIZE &&
+                                   static_cast<uint32_t>(outputEnd - output) >= numLiterals + WILD_COPY_SIZE)
+                                        copyWords(output, input, numLiterals);
+                                else
+                                        std::memcpy(output, input, numLiterals);
+
+                                output += numLiterals;
+                                input  += numLiterals;
+
+                                // the last sequence has no match
+                                if(input == inputEnd)
+                                        break;
+                        }
+
+                        // copy match
+                        if(inputEnd - input < 2)
+                                return false;
+
+                        uint32_t offset = static_cast<uint32_t>(input[0]) | (static_cast<uint32_t>(input[1]) << 8);
+                        input += 2;
+
+                        if(offset == 0 || offset > static_cast<uint32_t>(output - destination))
+                                return false;
+
+                        uint32_t matchLength = token & 15;
+                        if(matchLength == 15 && !readLength(matchLength, input, inputEnd))
+                                return false;
+
+                        matchLength += MIN_MATCH_LENGTH;
+                        if(matchLength > static_cast<uint32_t>(outputEnd - output))
+                                return false;
+
+                        const uint8_t* match = output - offset;
+
+                        // short match, whose source is at least one word behind, is copied with two words
+                        if(offset >= WILD_COPY_SIZE && matchLength <= 2 * WILD_COPY_SIZE &&
+                           static_cast<uint32_t>(outputEnd - output) >= 2 * WILD_COPY_SIZE)
+                        {
+                                std::memcpy(output, match, WILD_COPY_SIZE);
+                                std::memcpy(output + WILD_COPY_SIZE, match + WILD_COPY_SIZE, WILD_COPY_SIZE);
+                                output += matchLength;
+                                continue;
+                        }
+
+                        if(static_cast<uint32_t>(outputEnd - output) >= matchLength + WILD_COPY_SIZE)
+                        {
+                                // match, which is closer than the word, is expanded byte by byte until its
+                                // source is at least one word behind (pattern of the match repeats with the
+                                // period, which is multiple of the offset)
+                                if(offset < WILD_COPY_SIZE)
+                                {
+                                        static const uint8_t periods[WILD_COPY_SIZE] = {0, 8, 8, 9, 8, 10, 12, 14};
+
+                                        for(uint32_t i = 0; i < WILD_COPY_SIZE; ++i)
+                                                output[i] = match[i];
+
+                                        if(matchLength <= WILD_COPY_SIZE)
+                                        {
+                                                output += matchLength;
+                                                continue;
+                                        }
+
+                                        match = output + WILD_COPY_SIZE - periods[offset];
+                                        output += WILD_COPY_SIZE;
+                                        matchLength -= WILD_COPY_SIZE;
+                                }
+
+                                copyWords(output, match, matchLength);
+                                output += matchLength;
+                                continue;
+                        }
+
+                        // near the end of the output match is copied exactly, in chunks, which do not exceed
+                        // offset (since match might overlap output)
+                        while(matchLength > 0)
+                        {
+                                uint32_t chunkSize = (matchLength < offset) ? matchLength : offset;
+                                std::memcpy(output, match, chunkSize);
+
+                                output += chunkSize;
+                                match  += chunkSize;
+                                matchLength -= chunkSize;
+                        }
+                }
+
+                return (output == outputEnd);
+        }
+
+        //-------------------------------------------------------------------------------
+        void LzCodec::shuffle(const uint8_t* source, uint8_t* destination, uint32_t size,
+                              uint32_t elementSize)
+        {
+                if(elementSize == 0)
+                        return;
+
+                uint32_t numElements = size / elementSize;
+
+                for(uint32_t i = 0; i < elementSize; ++i)
+                {
+                        const uint8_t* input = source + i;
+                        uint8_t* output = destination + i * numElements;
+
+                        for(uint32_t j = 0; j < numElements; ++j, input += elementSize)
+                                output[j] = *input;
+                }
+
+                uint32_t shuffledSize = numElements * elementSize;
+                std::memcpy(destination + shuffledSize, source + shuffledSize, size - shuffledSize);
+        }
+
+        //-------------------------------------------------------------------------------
+        void LzCodec::unshuffle(const uint8_t* source, uint8_t* destination, uint32_t size,
+                                uint32_t elementSize)
+        {
+                if(elementSize == 0)
+                        return;
+
+                uint32_t numElements = size / elementSize;
+
+                for(uint32_t i = 0; i < elementSize; ++i)
+                {
+                        const uint8_t* input = source + i * numElements;
+                        uint8_t* output = destination + i;
+
+                        for(uint32_t j = 0; j < numElements; ++j, output += elementSize)
+                                *output = input[j];
+                }
+
+                uint32_t shuffledSize = numElements * elementSize;
+                std::memcpy(destination + shuffledSize, source + shuffledSize, size - shuffledSize);
+        }
+
+        //-------------------------------------------------------------------------------
+        void LzCodec::encodeDelta(uint8_t* data, uint32_t size)
+        {
+                for(uint32_t i = size; i > 1; --i)
+                        data[i - 1] = static_cast<uint8_t>(data[i - 1] - data[i - 2]);
+        }
+
+        //-------------------------------------------------------------------------------
+        void LzCodec::decodeDelta(uint8_t* data, uint32_t size)
+        {
+                for(uint32_t i = 1; i < size; ++i)
+                        data[i] = static_cast<uint8_t>(data[i] + data[i - 1]);
+        }
+
+        //-------------------------------------------------------------------------------
+        bool LzCodec::writeLength(uint32_t length, uint8_t*& destination, const uint8_t* end)
+        {
+                while(length >= 255)
+                {
+                        if(destination >= end)
+                                return false;
+
+                        *destination++ = 255;
+                        length -= 255;
+                }
+
+                if(destination >= end)
+                        return false;
+
+                *destination++ = static_cast<uint8_t>(length);
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------
+        bool LzCodec::readLength(uint32_t& length, const uint8_t*& source, const uint8_t* end)
+        {
+                uint8_t value = 255;
+
+                while(value == 255)
+                {
+                        if(source >= end)
+                                return false;
+
+                        value = *source++;
+                        length += value;
+
+                        // corrupted data might produce lengths, which can not be valid
+                        if(length > 0x7FFFFFFFU)
+                                return false;
+                }
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------
+        void LzCodec::copyWords(uint8_t* destination, const uint8_t* source, uint32_t size)
+        {
+                uint8_t* end = destination + size;
+
+                do
+                {
+                        std::memcpy(destination, source, WILD_COPY_SIZE);
+                        destination += WILD_COPY_SIZE;
+                        source += WILD_COPY_SIZE;
+                }
+                while(destination < end);
+        }
+
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include "../Macros/Macros.h"
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Core
+         * @{
+         */
+
+        /**
+         * Represents LZ codec. Compresses blocks of data with fast LZ77-family algorithm (block format is
+         * the same as LZ4 block format: sequences of literals and matches with 16-bit offsets), which is
+         * designed for fast decompression. Each block is compressed independently, so blocks can be
+         * decompressed in parallel.
+         *
+         * Codec also provides byte shuffle and delta filters. Shuffle groups bytes of the elements by
+         * their significance (all first bytes, then all second bytes, etc.), and delta replaces each byte
+         * with its difference from the previous one. For arrays of floats (vertex streams, animation keys)
+         * these filters produce long runs of similar bytes, which compress much better.
+         */
+        class LzCodec
+        {
+        public:
+                LzCodec();
+                LzCodec(const LzCodec&) = default;
+                ~LzCodec();
+                LzCodec& operator =(const LzCodec&) = default;
+
+                /**
+                 * \brief Returns maximum size of the compressed block.
+                 * \param[in] size size of the uncompressed block
+                 * \return maximum size of the compressed block
+                 */
+                static uint32_t getMaxCompressedSize(uint32_t size);
+
+                /**
+                 * \brief Compresses block.
+                 * \param[in] source uncompressed block
+                 * \param[in] size size of the uncompressed block
+                 * \param[out] destination compressed block
+                 * \param[in] capacity capacity of the destination
+                 * \return size of the compressed block, or zero if block does not fit into destination
+                 */
+                static uint32_t compress(const uint8_t* source, uint32_t size, uint8_t* destination,
+                                         uint32_t capacity);
+
+                /**
+                 * \brief Decompresses block.
+                 * \param[in] source compressed block
+                 * \param[in] size size of the compressed block
+                 * \param[out] destination uncompressed block
+                 * \param[in] originalSize size of the uncompressed block
+                 * \return true if block has been successfully decompressed (false if block is corrupted)
+                 */
+                static bool decompress(const uint8_t* source, uint32_t size, uint8_t* destination,
+                                       uint32_t originalSize);
+
+                /**
+                 * \brief Shuffles bytes of the elements.
+                 *
+                 * Bytes, which do not form complete element, are copied as-is.
+                 * \param[in] source source data
+                 * \param[out] destination shuffled data (must not overlap with source data)
+                 * \param[in] size size of the data
+                 * \param[in] elementSize size of the element
+                 */
+                static void shuffle(const uint8_t* source, uint8_t* destination, uint32_t size,
+                                    uint32_t elementSize);
+
+                /**
+                 * \brief Restores bytes, which have been shuffled.
+                 * \see shuffle
+                 * \param[in] source shuffled data
+                 * \param[out] destination restored data (must not overlap with shuffled data)
+                 * \param[in] size size of the data
+                 * \param[in] elementSize size of the element
+                 */
+                static void unshuffle(const uint8_t* source, uint8_t* destination, uint32_t size,
+                                      uint32_t elementSize);
+
+                /**
+                 * \brief Encodes bytes with delta filter (in place).
+                 * \param[in,out] data data
+                 * \param[in] size size of the data
+                 */
+                static void encodeDelta(uint8_t* data, uint32_t size);
+
+                /**
+                 * \brief Decodes bytes, which have been encoded with delta filter (in place).
+                 * \param[in,out] data data
+                 * \param[in] size size of the data
+                 */
+                static void decodeDelta(uint8_t* data, uint32_t size);
+
+        private:
+                /// Helper constants
+                enum
+                {
+                        MIN_MATCH_LENGTH = 4,
+                        MAX_OFFSET = 65535,
+                        NUM_OF_LAST_LITERALS = 5,
+                        MIN_INPUT_SIZE = 12,
+                        HASH_TABLE_SIZE_LOG2 = 14,
+                        HASH_TABLE_SIZE = 1 << HASH_TABLE_SIZE_LOG2,
+                        SKIP_STRENGTH = 6,
+                        WILD_COPY_SIZE = 8,
+                        SHORT_LITERALS_SIZE = 16
+                };
+
+                /**
+                 * \brief Writes length, which does not fit into token.
+                 * \param[in] length remaining length (length minus 15)
+                 * \param[in,out] destination pointer to the output
+                 * \param[in] end end of the output
+                 * \return true if length has been written
+                 */
+                static bool writeLength(uint32_t length, uint8_t*& destination, const uint8_t* end);
+
+                /**
+                 * \brief Reads length, which does not fit into token.
+                 * \param[in,out] length length
+                 * \param[in,out] source pointer to the input
+                 * \param[in] end end of the input
+                 * \return true if length has been read
+                 */
+                static bool readLength(uint32_t& length, const uint8_t*& source, const uint8_t* end);
+
+                /**
+                 * \brief Copies data in words of WILD_COPY_SIZE bytes.
+                 *
+                 * Up to WILD_COPY_SIZE - 1 bytes after the end of the source are read, and after the end of
+                 * the destination are written. Source might overlap destination only if it is at least one
+                 * word behind.
+                 * \param[out] destination destination
+                 * \param[in] source source
+                 * \param[in] size size of the data
+                 */
+                static void copyWords(uint8_t* destination, const uint8_t* source, uint32_t size);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
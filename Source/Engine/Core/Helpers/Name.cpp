@@ -0,0 +1,26 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "Name.h"
+
+namespace selene
+{
+
+        //-----------------------------------------------------------------------------------------
+        Name::Id Name::computeId(const char* string, uint32_t length)
+        {
+                if(string == nullptr)
+                        return 0;
+
+                Id hash = HASH_OFFSET_BASIS;
+
+                for(uint32_t i = 0; i < length; ++i)
+                {
+                        hash ^= static_cast<uint8_t>(string[i]);
+                        hash *= HASH_PRIME;
+                }
+
+                return hash;
+        }
+
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef NAME_H
+#define NAME_H
+
+#include "../Macros/Macros.h"
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Core
+         * @{
+         */
+
+        /**
+         * Represents interned name. Name holds pointer to the null-terminated string and its identifier
+         * (32-bit FNV-1a hash of the string), so lookups in the tables of names (see NameTable) compare
+         * integers instead of strings. Identifier is computed at compile time, when name is constructed
+         * from the string literal in constant expression:
+         * \code
+         * static constexpr selene::Name bloomName("Bloom");
+         *
+         * Effect& bloom = camera.getEffect(bloomName);
+         * \endcode
+         * Names are also implicitly constructed from c-strings, in this case identifier is computed at
+         * runtime. Name does not copy the string, so string must remain valid while name is used.
+         */
+        class Name
+        {
+        public:
+                /// Identifier of the name
+                typedef uint32_t Id;
+
+                /// Constants of the FNV-1a hash
+                enum
+                {
+                        HASH_OFFSET_BASIS = 2166136261U,
+                        HASH_PRIME = 16777619U
+                };
+
+                /**
+                 * \brief Constructs name with given string.
+                 * \param[in] string null-terminated string (if nullptr, then identifier is zero)
+                 */
+                constexpr Name(const char* string = nullptr):
+                        string_(string), id_(computeId(string)) {}
+                Name(const Name&) = default;
+                ~Name() = default;
+                Name& operator =(const Name&) = default;
+
+                /**
+                 * \brief Returns string.
+                 * \return null-terminated string
+                 */
+                constexpr const char* getString() const
+                {
+                        return string_;
+                }
+
+                /**
+                 * \brief Returns identifier.
+                 * \return identifier of the name
+                 */
+                constexpr Id getId() const
+                {
+                        return id_;
+                }
+
+                /**
+                 * \brief Computes identifier of the null-terminated string.
+                 * \param[in] string null-terminated string
+                 * \return identifier (zero if string is nullptr)
+                 */
+                static constexpr Id computeId(const char* string)
+                {
+                        return (string == nullptr) ? 0 : computeHash(string, HASH_OFFSET_BASIS);
+                }
+
+                /**
+                 * \brief Computes identifier of the string with given length.
+                 * \param[in] string string (not necessarily null-terminated)
+                 * \param[in] length length of the string
+                 * \return identifier (the same as identifier of the null-terminated string)
+                 */
+                static Id computeId(const char* string, uint32_t length);
+
+        private:
+                const char* string_;
+                Id id_;
+
+                /**
+                 * \brief Computes FNV-1a hash of the null-terminated string.
+                 * \param[in] string remaining part of the string
+                 * \param[in] hash hash of the preceding part of the string
+                 * \return hash of the string
+                 */
+                static constexpr Id computeHash(const char* string, Id hash)
+                {
+                        return (*string == 0) ? hash :
+                                computeHash(string + 1, static_cast<Id>((hash ^ static_cast<uint8_t>(*string)) *
+                                                                        static_cast<Id>(HASH_PRIME)));
+                }
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
@@ -0,0 +1,397 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include "Name.h"
+
+#include <vector>
+#include <string>
+
+#ifdef SELENE_DEBUG
+#include <iostream>
+#endif
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Core
+         * @{
+         */
+
+        /**
+         * Represents table of names. Maps names to values with O(1) lookups, which compare identifiers of
+         * the names (see Name) instead of strings. Entries are stored contiguously (so iteration is fast),
+         * slots form open-addressing hash table with linear probing, which holds index of the entry plus
+         * one (or zero if slot is empty), like the table of contents of the pack file.
+         *
+         * Strings are only stored and compared in debug builds (when SELENE_DEBUG is defined): name, whose
+         * identifier collides with identifier of another name, can not be inserted and is not found. In
+         * release builds names with the same identifier are considered equal. Layout of the entry does not
+         * depend on the build, so code, which is built with and without SELENE_DEBUG, may share tables.
+         *
+         * Erasing entry moves the last entry in its place, so order of the entries is not preserved.
+         */
+        template <class T> class NameTable
+        {
+        public:
+                /**
+                 * Represents entry of the table.
+                 */
+                class Entry
+                {
+                public:
+                        Name::Id id;
+                        T value;
+                        std::string string;
+
+                };
+
+                /// Iterators of the entries
+                typedef typename std::vector<Entry>::iterator Iterator;
+                typedef typename std::vector<Entry>::const_iterator ConstIterator;
+
+                NameTable(): entries_(), slots_() {}
+                NameTable(const NameTable<T>&) = default;
+                NameTable(NameTable<T>&& other):
+                        entries_(std::move(other.entries_)), slots_(std::move(other.slots_)) {}
+                ~NameTable() {}
+                NameTable<T>& operator =(const NameTable<T>&) = default;
+
+                /**
+                 * \brief Inserts value with given name.
+                 * \param[in] name name
+                 * \param[in] value value
+                 * \return true if value has been inserted, false if name already exists (or its identifier
+                 * collides with identifier of another name), or memory could not be allocated
+                 */
+                bool insert(const Name& name, const T& value)
+                {
+                        if(name.getString() == nullptr)
+                                return false;
+
+                        size_t existingSlot = findSlot(name.getId());
+                        if(existingSlot != INVALID_SLOT)
+                        {
+#ifdef SELENE_DEBUG
+                                checkCollision(name, existingSlot);
+#endif
+                                return false;
+                        }
+
+                        try
+                        {
+                                if((entries_.size() + 1) * 2 > slots_.size() && !grow())
+                                        return false;
+
+                                Entry entry;
+                                entry.id = name.getId();
+                                entry.value = value;
+#ifdef SELENE_DEBUG
+                                entry.string = name.getString();
+#endif
+                                entries_.push_back(std::move(entry));
+                        }
+                        catch(...)
+                        {
+                                return false;
+                        }
+
+                        // place index of the entry to the first empty slot
+                        size_t mask = slots_.size() - 1;
+                        size_t slot = name.getId() & mask;
+
+                        while(slots_[slot] != 0)
+                                slot = (slot + 1) & mask;
+
+                        slots_[slot] = static_cast<uint32_t>(entries_.size());
+                        return true;
+                }
+
+                /**
+                 * \brief Finds value with given name.
+                 * \param[in] name name
+                 * \return pointer to the value, or nullptr if name has not been found
+                 */
+                T* find(const Name& name)
+                {
+                        size_t slot = findSlot(name);
+                        if(slot == INVALID_SLOT)
+                                return nullptr;
+
+                        return &entries_[slots_[slot] - 1].value;
+                }
+
+                /**
+                 * \brief Finds value with given name.
+                 * \param[in] name name
+                 * \return pointer to the value, or nullptr if name has not been found
+                 */
+                const T* find(const Name& name) const
+                {
+                        size_t slot = findSlot(name);
+                        if(slot == INVALID_SLOT)
+                                return nullptr;
+
+                        return &entries_[slots_[slot] - 1].value;
+                }
+
+                /**
+                 * \brief Erases value with given name.
+                 * \param[in] name name
+                 * \return true if value has been erased
+                 */
+                bool erase(const Name& name)
+                {
+                        size_t slot = findSlot(name);
+                        if(slot == INVALID_SLOT)
+                                return false;
+
+                        eraseSlot(slot);
+                        return true;
+                }
+
+                /**
+                 * \brief Erases entry.
+                 * \param[in] it iterator of the entry
+                 * \return iterator of the entry, which has taken place of the erased entry (or end of the
+                 * table, if the last entry has been erased)
+                 */
+                Iterator erase(Iterator it)
+                {
+                        size_t index = static_cast<size_t>(it - entries_.begin());
+                        size_t mask = slots_.size() - 1;
+                        size_t slot = it->id & mask;
+
+                        while(slots_[slot] != index + 1)
+                                slot = (slot + 1) & mask;
+
+                        eraseSlot(slot);
+                        return entries_.begin() + index;
+                }
+
+                /**
+                 * \brief Erases all entries.
+                 */
+                void clear()
+                {
+                        entries_.clear();
+                        slots_.clear();
+                }
+
+                /**
+                 * \brief Returns number of entries.
+                 * \return number of entries
+                 */
+                size_t getSize() const
+                {
+                        return entries_.size();
+                }
+
+                /**
+                 * \brief Returns iterator of the first entry.
+                 * \return iterator of the first entry
+                 */
+                Iterator begin()
+                {
+                        return entries_.begin();
+                }
+
+                /**
+                 * \brief Returns iterator of the first entry.
+                 * \return iterator of the first entry
+                 */
+                ConstIterator begin() const
+                {
+                        return entries_.begin();
+                }
+
+                /**
+                 * \brief Returns iterator, which follows the last entry.
+                 * \return iterator, which follows the last entry
+                 */
+                Iterator end()
+                {
+                        return entries_.end();
+                }
+
+                /**
+                 * \brief Returns iterator, which follows the last entry.
+                 * \return iterator, which follows the last entry
+                 */
+                ConstIterator end() const
+                {
+                        return entries_.end();
+                }
+
+                /**
+                 * \brief Swaps contents of the tables.
+                 * \param[in] other table, whose contents will be swapped with contents of current table
+                 */
+                void swap(NameTable<T>& other)
+                {
+                        entries_.swap(other.entries_);
+                        slots_.swap(other.slots_);
+                }
+
+        private:
+                /// Helper constants
+                enum
+                {
+                        MIN_NUM_SLOTS = 16
+                };
+
+                /// Index of the slot, which is returned when name has not been found
+                static const size_t INVALID_SLOT = static_cast<size_t>(-1);
+
+                std::vector<Entry> entries_;
+                std::vector<uint32_t> slots_;
+
+                /**
+                 * \brief Finds slot of the identifier.
+                 * \param[in] id identifier of the name
+                 * \return index of the slot, or INVALID_SLOT if identifier has not been found
+                 */
+                size_t findSlot(Name::Id id) const
+                {
+                        if(slots_.empty())
+                                return INVALID_SLOT;
+
+                        size_t mask = slots_.size() - 1;
+
+                        // probe slots until empty slot is found
+                        for(size_t slot = id & mask; slots_[slot] != 0; slot = (slot + 1) & mask)
+                        {
+                                if(entries_[slots_[slot] - 1].id == id)
+                                        return slot;
+                        }
+
+                        return INVALID_SLOT;
+                }
+
+                /**
+                 * \brief Finds slot of the name.
+                 * \param[in] name name
+                 * \return index of the slot, or INVALID_SLOT if name has not been found (or its identifier
+                 * collides with identifier of another name)
+                 */
+                size_t findSlot(const Name& name) const
+                {
+                        size_t slot = findSlot(name.getId());
+
+#ifdef SELENE_DEBUG
+                        if(slot != INVALID_SLOT && checkCollision(name, slot))
+                                return INVALID_SLOT;
+#endif
+
+                        return slot;
+                }
+
+#ifdef SELENE_DEBUG
+                /**
+                 * \brief Checks whether identifier of the name collides with identifier of the entry.
+                 *
+                 * Collision is reported to the standard error stream with both strings.
+                 * \param[in] name name
+                 * \param[in] slot index of the slot, which holds entry with the same identifier
+                 * \return true if identifiers collide
+                 */
+                bool checkCollision(const Name& name, size_t slot) const
+                {
+                        const std::string& string = entries_[slots_[slot] - 1].string;
+                        if(name.getString() != nullptr && string == name.getString())
+                                return false;
+
+                        std::cerr << "NameTable: identifier of the name \"" <<
+                                     ((name.getString() != nullptr) ? name.getString() : "") <<
+                                     "\" collides with identifier of the name \"" << string << "\"" << std::endl;
+                        return true;
+                }
+#endif
+
+                /**
+                 * \brief Erases entry, whose index is held by given slot.
+                 *
+                 * Following slots of the same cluster are shifted back, so probing does not stop early.
+                 * The last entry is moved in place of the erased entry.
+                 * \param[in] slot index of the slot
+                 */
+                void eraseSlot(size_t slot)
+                {
+                        size_t mask = slots_.size() - 1;
+                        size_t index = slots_[slot] - 1;
+
+                        // shift slots back
+                        slots_[slot] = 0;
+                        for(size_t next = (slot + 1) & mask; slots_[next] != 0; next = (next + 1) & mask)
+                        {
+                                size_t home = entries_[slots_[next] - 1].id & mask;
+
+                                // slot can only be moved, if its home slot is not in (slot, next]
+                                if(((next - home) & mask) < ((next - slot) & mask))
+                                        continue;
+
+                                slots_[slot] = slots_[next];
+                                slots_[next] = 0;
+                                slot = next;
+                        }
+
+                        // move the last entry in place of the erased entry
+                        size_t last = entries_.size() - 1;
+                        if(index != last)
+                        {
+                                size_t lastSlot = entries_[last].id & mask;
+                                while(slots_[lastSlot] != last + 1)
+                                        lastSlot = (lastSlot + 1) & mask;
+
+                                slots_[lastSlot] = static_cast<uint32_t>(index + 1);
+                                entries_[index] = std::move(entries_[last]);
+                        }
+
+                        entries_.pop_back();
+                }
+
+                /**
+                 * \brief Doubles number of slots and reinserts entries.
+                 * \return true if slots have been successfully reallocated
+                 */
+                bool grow()
+                {
+                        std::vector<uint32_t> slots;
+
+                        try
+                        {
+                                slots.resize(slots_.empty() ? static_cast<size_t>(MIN_NUM_SLOTS) :
+                                             slots_.size() * 2);
+                                entries_.reserve(slots.size() / 2);
+                        }
+                        catch(...)
+                        {
+                                return false;
+                        }
+
+                        size_t mask = slots.size() - 1;
+                        for(size_t i = 0; i < entries_.size(); ++i)
+                        {
+                                size_t slot = entries_[i].id & mask;
+                                while(slots[slot] != 0)
+                                        slot = (slot + 1) & mask;
+
+                                slots[slot] = static_cast<uint32_t>(i + 1);
+                        }
+
+                        slots_.swap(slots);
+                        return true;
+                }
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
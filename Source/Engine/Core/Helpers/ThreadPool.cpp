@@ -2,77 +2,540 @@
 // Licensed under the MIT License (see LICENSE.txt for details)
 
 #include "ThreadPool.h"
-#include <utility>
+#include <chrono>
 
 namespace selene
 {
 
+        ThreadPool::Counter::Counter(): value_(0), dependentTasks_(nullptr), exception_(), mutex_(), zeroReached_() {}
+        ThreadPool::Counter::~Counter() {}
+
+        //----------------------------------------------------------------------------------
+        bool ThreadPool::Counter::isZero() const
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return (value_ == 0);
+        }
+
         ThreadPool::ThreadPool(size_t numWorkers):
-                jobs_(), jobMutex_(), activator_(), workers_()
+                workers_(), numWorkers_(0), sharedTasks_(), numSharedTasks_(0), sharedTasksMutex_(), taskBlocks_(),
+                freeTasks_(nullptr), freeTasksMutex_(), exception_(), exceptionMutex_(), numSleepingWorkers_(0),
+                isActive_(true), sleepMutex_(), activator_()
         {
-                for(size_t i = 0; i < numWorkers; ++i)
+                // workers wait for this mutex before taking tasks, so list of the workers is not changed
+                // while they search it
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+
+                try
                 {
-                        std::unique_ptr<Worker> worker(new Worker(*this));
-                        workers_.emplace_front(std::move(worker));
+                        workers_.reserve(numWorkers);
+                        for(size_t i = 0; i < numWorkers; ++i)
+                        {
+                                std::unique_ptr<Worker> worker(new(std::nothrow) Worker);
+                                if(!worker)
+                                        break;
+
+                                worker->thread = std::thread(std::bind(&ThreadPool::executeTasks, this,
+                                                                       static_cast<int32_t>(i)));
+                                workers_.push_back(std::move(worker));
+                        }
+                }
+                catch(...)
+                {
+                        // thread pool works with the workers, which have been started (see getNumWorkers)
                 }
+
+                numWorkers_ = workers_.size();
         }
-        ThreadPool::~ThreadPool() {}
+        ThreadPool::~ThreadPool()
+        {
+                isActive_.store(false);
 
-        //-------------------------------------------------------------------------------
+                sleepMutex_.lock();
+                activator_.notify_all();
+                sleepMutex_.unlock();
+
+                for(auto it = workers_.begin(); it != workers_.end(); ++it)
+                {
+                        Worker& worker = **it;
+                        if(worker.thread.joinable())
+                                worker.thread.join();
+                }
+
+                // jobs, which have not been started, are dropped, and their counters are decremented, so jobs,
+                // which are parked in these counters, are dropped as well (tasks are freed with their blocks)
+                for(Task* task = takeTask(-1); task != nullptr; task = takeTask(-1))
+                        finishTask(task, std::exception_ptr(), -1);
+        }
+
+        //----------------------------------------------------------------------------------
         void ThreadPool::addJob(Job&& job)
         {
-                std::lock_guard<std::mutex> lock(jobMutex_);
-                jobs_.emplace_back(std::move(job));
-                activator_.notify_all();
+                if(!job)
+                        return;
+
+                int32_t workerIndex = findWorker();
+                Task* task = createTask(job, workerIndex);
+                if(task == nullptr)
+                {
+                        job();
+                        return;
+                }
+
+                submitTask(task, nullptr, nullptr, workerIndex);
         }
 
-        ThreadPool::Worker::Worker(ThreadPool& threadPool):
-                threadPool_(threadPool), thread_(), mutex_(), isActive_(true)
+        //----------------------------------------------------------------------------------
+        void ThreadPool::wait(Counter& counter)
         {
-                thread_ = std::thread(std::bind(&ThreadPool::Worker::executeJobs, this));
+                std::exception_ptr exception = waitForCounter(counter);
+                if(exception)
+                        std::rethrow_exception(exception);
         }
-        ThreadPool::Worker::~Worker()
+
+        //----------------------------------------------------------------------------------
+        size_t ThreadPool::getNumWorkers() const
         {
-                mutex_.lock();
-                isActive_ = false;
-                mutex_.unlock();
+                return numWorkers_;
+        }
+
+        ThreadPool::Task::Task(): storage(), execute(nullptr), destroy(nullptr), counter(nullptr), next(nullptr) {}
+        ThreadPool::Task::~Task() {}
+
+        ThreadPool::Deque::Deque(): top_(0), bottom_(0)
+        {
+                for(uint32_t i = 0; i < DEQUE_CAPACITY; ++i)
+                        tasks_[i].store(nullptr, std::memory_order_relaxed);
+        }
+        ThreadPool::Deque::~Deque() {}
+
+        //----------------------------------------------------------------------------------
+        bool ThreadPool::Deque::push(Task* task)
+        {
+                int64_t bottom = bottom_.load(std::memory_order_relaxed);
+                int64_t top = top_.load(std::memory_order_acquire);
 
-                threadPool_.jobMutex_.lock();
-                threadPool_.activator_.notify_all();
-                threadPool_.jobMutex_.unlock();
+                if(bottom - top >= static_cast<int64_t>(DEQUE_CAPACITY))
+                        return false;
 
-                thread_.join();
+                tasks_[bottom & (DEQUE_CAPACITY - 1)].store(task, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return true;
         }
 
-        //-------------------------------------------------------------------------------
-        void ThreadPool::Worker::executeJobs()
+        //----------------------------------------------------------------------------------
+        ThreadPool::Task* ThreadPool::Deque::pop()
         {
-                Job job;
-                bool isActive = true;
+                int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+                bottom_.store(bottom, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t top = top_.load(std::memory_order_relaxed);
+
+                if(top > bottom)
+                {
+                        bottom_.store(bottom + 1, std::memory_order_relaxed);
+                        return nullptr;
+                }
 
-                while(isActive)
+                Task* task = tasks_[bottom & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+                if(top == bottom)
                 {
-                        threadPool_.jobMutex_.lock();
-                        if(!threadPool_.jobs_.empty())
+                        // the last task is also available to thieves
+                        if(!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                         std::memory_order_relaxed))
+                                task = nullptr;
+
+                        bottom_.store(bottom + 1, std::memory_order_relaxed);
+                }
+
+                return task;
+        }
+
+        //----------------------------------------------------------------------------------
+        ThreadPool::Task* ThreadPool::Deque::steal()
+        {
+                int64_t top = top_.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+                if(top >= bottom)
+                        return nullptr;
+
+                Task* task = tasks_[top & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+                if(!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed))
+                        return nullptr;
+
+                return task;
+        }
+
+        //----------------------------------------------------------------------------------
+        bool ThreadPool::Deque::isEmpty() const
+        {
+                return (bottom_.load() <= top_.load());
+        }
+
+        ThreadPool::Worker::Worker(): deque(), freeTasks(nullptr), numFreeTasks(0), thread() {}
+        ThreadPool::Worker::~Worker() {}
+
+        //----------------------------------------------------------------------------------
+        ThreadPool::Task* ThreadPool::allocateTask(int32_t workerIndex)
+        {
+                Task* task = nullptr;
+
+                if(workerIndex >= 0)
+                {
+                        Worker& worker = *workers_[workerIndex];
+                        if(worker.freeTasks != nullptr)
+                        {
+                                task = worker.freeTasks;
+                                worker.freeTasks = task->next;
+                                --worker.numFreeTasks;
+                                return task;
+                        }
+                }
+
+                std::lock_guard<std::mutex> lock(freeTasksMutex_);
+
+                if(freeTasks_ == nullptr)
+                {
+                        std::unique_ptr<Task[]> taskBlock(new(std::nothrow) Task[NUM_OF_TASKS_PER_BLOCK]);
+                        if(!taskBlock)
+                                return nullptr;
+
+                        try
+                        {
+                                taskBlocks_.push_back(std::move(taskBlock));
+                        }
+                        catch(...)
+                        {
+                                return nullptr;
+                        }
+
+                        Task* tasks = taskBlocks_.back().get();
+                        for(uint32_t i = 0; i < NUM_OF_TASKS_PER_BLOCK; ++i)
+                        {
+                                tasks[i].next = freeTasks_;
+                                freeTasks_ = &tasks[i];
+                        }
+                }
+
+                task = freeTasks_;
+                freeTasks_ = task->next;
+
+                if(workerIndex >= 0)
+                {
+                        Worker& worker = *workers_[workerIndex];
+                        for(uint32_t i = 1; i < NUM_OF_TASKS_PER_BLOCK && freeTasks_ != nullptr; ++i)
                         {
-                                job = std::move(threadPool_.jobs_.front());
-                                threadPool_.jobs_.pop_front();
-                                threadPool_.jobMutex_.unlock();
+                                Task* freeTask = freeTasks_;
+                                freeTasks_ = freeTask->next;
 
-                                if(job)
-                                        job();
+                                freeTask->next = worker.freeTasks;
+                                worker.freeTasks = freeTask;
+                                ++worker.numFreeTasks;
                         }
-                        else
+                }
+
+                return task;
+        }
+
+        //----------------------------------------------------------------------------------
+        void ThreadPool::releaseTask(Task* task, int32_t workerIndex)
+        {
+                task->counter = nullptr;
+
+                if(workerIndex < 0)
+                {
+                        std::lock_guard<std::mutex> lock(freeTasksMutex_);
+                        task->next = freeTasks_;
+                        freeTasks_ = task;
+                        return;
+                }
+
+                Worker& worker = *workers_[workerIndex];
+                task->next = worker.freeTasks;
+                worker.freeTasks = task;
+
+                if(++worker.numFreeTasks <= static_cast<uint32_t>(MAX_NUM_OF_FREE_TASKS))
+                        return;
+
+                // tasks, which have been allocated by other threads, accumulate in the list of the worker,
+                // so they are returned to the shared list in batches
+                std::lock_guard<std::mutex> lock(freeTasksMutex_);
+                for(uint32_t i = 0; i < NUM_OF_TASKS_PER_BLOCK; ++i)
+                {
+                        Task* freeTask = worker.freeTasks;
+                        worker.freeTasks = freeTask->next;
+
+                        freeTask->next = freeTasks_;
+                        freeTasks_ = freeTask;
+                }
+
+                worker.numFreeTasks -= NUM_OF_TASKS_PER_BLOCK;
+        }
+
+        //----------------------------------------------------------------------------------
+        void ThreadPool::submitTask(Task* task, Counter* counter, Counter* dependency, int32_t workerIndex)
+        {
+                task->counter = counter;
+                task->next = nullptr;
+
+                if(counter != nullptr)
+                        counter->value_.fetch_add(1);
+
+                if(dependency != nullptr)
+                {
+                        std::lock_guard<std::mutex> lock(dependency->mutex_);
+                        if(dependency->value_ != 0)
                         {
-                                threadPool_.jobMutex_.unlock();
+                                task->next = static_cast<Task*>(dependency->dependentTasks_);
+                                dependency->dependentTasks_ = task;
+                                return;
+                        }
+                }
 
-                                std::unique_lock<std::mutex> lock(threadPool_.jobMutex_);
-                                threadPool_.activator_.wait(lock);
+                pushTask(task, workerIndex);
+        }
+
+        //----------------------------------------------------------------------------------
+        void ThreadPool::pushTask(Task* task, int32_t workerIndex)
+        {
+                if(workerIndex < 0 || !workers_[workerIndex]->deque.push(task))
+                {
+                        try
+                        {
+                                std::lock_guard<std::mutex> lock(sharedTasksMutex_);
+                                sharedTasks_.push_back(task);
+                                numSharedTasks_.store(sharedTasks_.size(), std::memory_order_relaxed);
+                        }
+                        catch(...)
+                        {
+                                executeTask(task, workerIndex);
+                                return;
+                        }
+                }
+
+                // worker increments number of sleeping workers before it checks queues for the last time (see
+                // executeTasks), so either worker sees the task, or the task is followed by the wake-up
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(numSleepingWorkers_.load(std::memory_order_relaxed) == 0)
+                        return;
+
+                // each wake-up claims one sleeping worker, so workers, which have already been woken, are
+                // not woken again
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+                if(numSleepingWorkers_.load() > 0)
+                {
+                        numSleepingWorkers_.fetch_sub(1);
+                        activator_.notify_one();
+                }
+        }
+
+        //----------------------------------------------------------------------------------
+        ThreadPool::Task* ThreadPool::takeTask(int32_t workerIndex)
+        {
+                Task* task = nullptr;
+
+                if(workerIndex >= 0)
+                        task = workers_[workerIndex]->deque.pop();
+
+                if(task == nullptr && numSharedTasks_.load(std::memory_order_relaxed) != 0)
+                {
+                        sharedTasksMutex_.lock();
+                        if(!sharedTasks_.empty())
+                        {
+                                task = sharedTasks_.front();
+                                sharedTasks_.pop_front();
+                                numSharedTasks_.store(sharedTasks_.size(), std::memory_order_relaxed);
+                        }
+                        sharedTasksMutex_.unlock();
+                }
+
+                for(size_t i = 1; task == nullptr && i <= numWorkers_; ++i)
+                {
+                        size_t victim = (static_cast<size_t>(workerIndex + 1) + i) % numWorkers_;
+                        if(victim != static_cast<size_t>(workerIndex))
+                                task = workers_[victim]->deque.steal();
+                }
+
+                return task;
+        }
+
+        //----------------------------------------------------------------------------------
+        bool ThreadPool::hasQueuedTasks() const
+        {
+                if(numSharedTasks_.load() != 0)
+                        return true;
+
+                for(size_t i = 0; i < numWorkers_; ++i)
+                {
+                        if(!workers_[i]->deque.isEmpty())
+                                return true;
+                }
+
+                return false;
+        }
+
+        //----------------------------------------------------------------------------------
+        void ThreadPool::executeTask(Task* task, int32_t workerIndex)
+        {
+                std::exception_ptr exception;
+
+                try
+                {
+                        task->execute(*task);
+                }
+                catch(...)
+                {
+                        exception = std::current_exception();
+                }
+
+                finishTask(task, exception, workerIndex);
+        }
+
+        //----------------------------------------------------------------------------------
+        void ThreadPool::finishTask(Task* task, const std::exception_ptr& exception, int32_t workerIndex)
+        {
+                task->destroy(*task);
+
+                Counter* counter = task->counter;
+                releaseTask(task, workerIndex);
+
+                if(counter == nullptr)
+                {
+                        if(exception)
+                        {
+                                std::lock_guard<std::mutex> lock(exceptionMutex_);
+                                if(!exception_)
+                                        exception_ = exception;
+                        }
+
+                        return;
+                }
+
+                // counter reaches zero only under its mutex, and it is not touched after the mutex has been
+                // released, because waiting thread may destroy it (exception is stored under the mutex as well)
+                uint32_t value = counter->value_.load();
+                while(!exception && value > 1)
+                {
+                        if(counter->value_.compare_exchange_weak(value, value - 1))
+                                return;
+                }
+
+                Task* dependentTasks = nullptr;
+                counter->mutex_.lock();
+                if(exception && !counter->exception_)
+                        counter->exception_ = exception;
+
+                if(counter->value_.fetch_sub(1) == 1)
+                {
+                        dependentTasks = static_cast<Task*>(counter->dependentTasks_);
+                        counter->dependentTasks_ = nullptr;
+                        counter->zeroReached_.notify_all();
+                }
+                counter->mutex_.unlock();
+
+                // thread pool, which is being destroyed, queues dependent tasks to the shared queue, where they are
+                // dropped by the destructor
+                while(dependentTasks != nullptr)
+                {
+                        Task* next = dependentTasks->next;
+                        pushTask(dependentTasks, workerIndex);
+                        dependentTasks = next;
+                }
+        }
+
+        //----------------------------------------------------------------------------------
+        std::exception_ptr ThreadPool::waitForCounter(Counter& counter)
+        {
+                int32_t workerIndex = findWorker();
+
+                while(counter.value_.load() != 0)
+                {
+                        Task* task = takeTask(workerIndex);
+                        if(task != nullptr)
+                        {
+                                executeTask(task, workerIndex);
+                                continue;
+                        }
+
+                        // jobs of the counter are executed by other threads, new tasks may be queued meanwhile,
+                        // so waiting is interrupted from time to time
+                        std::unique_lock<std::mutex> lock(counter.mutex_);
+                        if(counter.value_.load() != 0)
+                                counter.zeroReached_.wait_for(lock, std::chrono::microseconds(WAIT_INTERVAL));
+                }
+
+                // counter reaches zero under its mutex, so mutex is acquired before returning: thread, which has
+                // finished the last job, may still hold it
+                std::exception_ptr exception;
+                {
+                        std::lock_guard<std::mutex> lock(counter.mutex_);
+                        exception.swap(counter.exception_);
+                }
+
+                if(!exception)
+                {
+                        std::lock_guard<std::mutex> lock(exceptionMutex_);
+                        exception.swap(exception_);
+                }
+
+                return exception;
+        }
+
+        //----------------------------------------------------------------------------------
+        int32_t ThreadPool::findWorker() const
+        {
+                std::thread::id id = std::this_thread::get_id();
+
+                for(size_t i = 0; i < numWorkers_; ++i)
+                {
+                        if(workers_[i]->thread.get_id() == id)
+                                return static_cast<int32_t>(i);
+                }
+
+                return -1;
+        }
+
+        //----------------------------------------------------------------------------------
+        void ThreadPool::executeTasks(int32_t workerIndex)
+        {
+                sleepMutex_.lock();
+                sleepMutex_.unlock();
+
+                uint32_t numSpins = 0;
+                while(isActive_.load())
+                {
+                        Task* task = takeTask(workerIndex);
+                        if(task != nullptr)
+                        {
+                                executeTask(task, workerIndex);
+                                numSpins = 0;
+                                continue;
+                        }
+
+                        if(++numSpins < static_cast<uint32_t>(NUM_OF_SPINS))
+                        {
+                                std::this_thread::yield();
+                                continue;
+                        }
+
+                        numSpins = 0;
+
+                        std::unique_lock<std::mutex> lock(sleepMutex_);
+                        numSleepingWorkers_.fetch_add(1);
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                        if(hasQueuedTasks() || !isActive_.load())
+                        {
+                                numSleepingWorkers_.fetch_sub(1);
+                                continue;
                         }
 
-                        mutex_.lock();
-                        isActive = isActive_;
-                        mutex_.unlock();
+                        // woken worker is not counted as sleeping anymore (see pushTask)
+                        activator_.wait(lock);
                 }
         }
 
@@ -7,12 +7,18 @@
 #include "../Macros/Macros.h"
 
 #include <condition_variable>
-#include <forward_list>
+#include <type_traits>
 #include <functional>
+#include <algorithm>
+#include <utility>
+#include <exception>
 #include <memory>
+#include <atomic>
 #include <thread>
+#include <vector>
 #include <deque>
 #include <mutex>
+#include <new>
 
 namespace selene
 {
@@ -24,6 +30,34 @@ namespace selene
 
         /**
          * Represents thread pool.
+         *
+         * Each worker has its own lock-free deque of tasks (Chase-Lev deque): worker pushes and pops tasks
+         * at the bottom of its deque, idle workers steal tasks from the top of the deques of other workers.
+         * Jobs, which are added by the threads outside of the pool (or which do not fit into the deque),
+         * are placed in the shared queue. Task stores small functors (up to JOB_STORAGE_SIZE bytes) in place,
+         * so adding a job does not allocate memory, tasks are recycled.
+         *
+         * Completion of the jobs is tracked with counters: each job, which is added with a counter, increments
+         * it, and decrements it when finished. Job may also depend on a counter, then it is queued when that
+         * counter reaches zero. Thread, which waits for the counter, executes queued jobs meanwhile.
+         * Exception, which is thrown by the job, is rethrown by ThreadPool::wait (the first exception of the
+         * counter is kept, others are dropped).
+         * When thread pool is destroyed, jobs, which have not been started (including the ones, which are parked
+         * in the dependencies), are dropped, and their counters are decremented.
+         * \code
+         * selene::ThreadPool::Counter counter;
+         * threadPool.addJob(std::bind(&Loader::readTextures, &loader), &counter);
+         * threadPool.addJob(std::bind(&Loader::readMeshes, &loader), &counter);
+         *
+         * // materials are created when textures and meshes have been read
+         * selene::ThreadPool::Counter materialsCounter;
+         * threadPool.addJob(std::bind(&Loader::createMaterials, &loader), &materialsCounter, &counter);
+         * threadPool.wait(materialsCounter);
+         *
+         * // ranges of at most 256 elements are processed in parallel
+         * threadPool.parallelFor(0, numElements, 256, std::bind(&Loader::processElements, &loader,
+         *                                                       std::placeholders::_1, std::placeholders::_2));
+         * \endcode
          */
         class ThreadPool
         {
@@ -33,6 +67,37 @@ namespace selene
                  */
                 typedef std::function<void()> Job;
 
+                /**
+                 * Represents counter of the unfinished jobs. Counter must outlive its jobs (so waiting for
+                 * the counter is needed before its destruction), and its jobs must not be added to
+                 * different thread pools.
+                 */
+                class Counter
+                {
+                public:
+                        Counter();
+                        Counter(const Counter&) = delete;
+                        ~Counter();
+                        Counter& operator =(const Counter&) = delete;
+
+                        /**
+                         * \brief Returns true if all jobs of the counter have been finished.
+                         * \return true if counter is zero
+                         */
+                        bool isZero() const;
+
+                private:
+                        friend class ThreadPool;
+
+                        std::atomic<uint32_t> value_;
+                        void* dependentTasks_;
+                        std::exception_ptr exception_;
+
+                        mutable std::mutex mutex_;
+                        std::condition_variable zeroReached_;
+
+                };
+
                 /**
                  * \brief Constructs thread pool with given number of workers.
                  * \param[in] numWorkers number of workers
@@ -44,46 +109,438 @@ namespace selene
 
                 /**
                  * \brief Adds job to the queue.
+                 *
+                 * If memory for the job could not be allocated, then job is executed by the calling thread.
+                 * Job has no counter, so its exception is rethrown by the next call to ThreadPool::wait.
                  * \param[in] job job, which shall be added to the queue
                  */
                 void addJob(Job&& job);
 
+                /**
+                 * \brief Adds job to the queue.
+                 *
+                 * Functor is copied to the task, which is queued (or parked in the dependency, if
+                 * dependency is not zero).
+                 * \param[in] function functor, which is called without arguments
+                 * \param[in] counter counter, which is incremented now and decremented when job is finished
+                 * (may be nullptr)
+                 * \param[in] dependency counter, which must reach zero before job is queued (may be nullptr)
+                 * \return true if job has been successfully added, false if memory could not be allocated
+                 */
+                template <class F> bool addJob(F function, Counter* counter, Counter* dependency = nullptr)
+                {
+                        int32_t workerIndex = findWorker();
+                        Task* task = createTask(function, workerIndex);
+                        if(task == nullptr)
+                                return false;
+
+                        submitTask(task, counter, dependency, workerIndex);
+                        return true;
+                }
+
+                /**
+                 * \brief Waits until counter reaches zero.
+                 *
+                 * Calling thread executes queued jobs while waiting. If any job of the counter has thrown an
+                 * exception, then the first one is rethrown (otherwise the first exception of the jobs without
+                 * counter is rethrown, if any).
+                 * \param[in] counter counter
+                 */
+                void wait(Counter& counter);
+
+                /**
+                 * \brief Calls functor for the ranges of given interval in parallel.
+                 *
+                 * Interval is split into ranges of grainSize elements (the last range may be shorter), each
+                 * range is processed by its own job, the first range is processed by the calling thread.
+                 * Returns when all ranges have been processed (even if functor throws an exception in the calling
+                 * thread, since queued ranges refer to the counter on its stack).
+                 * \param[in] first the first element of the interval
+                 * \param[in] last element, which follows the last element of the interval
+                 * \param[in] grainSize number of elements in the range (zero is treated as one)
+                 * \param[in] function functor, which is called with the first and the last (exclusive)
+                 * elements of the range
+                 */
+                template <class F> void parallelFor(uint32_t first, uint32_t last, uint32_t grainSize, F function)
+                {
+                        if(first >= last)
+                                return;
+
+                        grainSize = std::max(grainSize, 1U);
+                        if(numWorkers_ == 0 || last - first <= grainSize)
+                        {
+                                function(first, last);
+                                return;
+                        }
+
+                        Counter counter;
+                        try
+                        {
+                                for(uint32_t i = first + grainSize; i < last;)
+                                {
+                                        uint32_t next = (last - i > grainSize) ? i + grainSize : last;
+                                        if(!addJob(Range<F>(function, i, next), &counter))
+                                                function(i, next);
+
+                                        i = next;
+                                }
+
+                                function(first, first + grainSize);
+                        }
+                        catch(...)
+                        {
+                                // exception of the calling thread is the first one, exceptions of the ranges are
+                                // dropped
+                                waitForCounter(counter);
+                                throw;
+                        }
+
+                        wait(counter);
+                }
+
+                /**
+                 * \brief Returns number of workers.
+                 * \return number of workers
+                 */
+                size_t getNumWorkers() const;
+
         private:
+                /// Helper constants
+                enum
+                {
+                        JOB_STORAGE_SIZE = 48,
+                        DEQUE_CAPACITY = 4096,
+                        NUM_OF_TASKS_PER_BLOCK = 64,
+                        MAX_NUM_OF_FREE_TASKS = 256,
+                        NUM_OF_SPINS = 64,
+                        WAIT_INTERVAL = 100
+                };
+
                 /**
-                 * Represents worker.
+                 * Represents task. Holds functor of the job (in place, or on the heap if it does not fit).
                  */
-                class Worker
+                class Task
+                {
+                public:
+                        typename std::aligned_storage<JOB_STORAGE_SIZE>::type storage;
+                        void (*execute)(Task&);
+                        void (*destroy)(Task&);
+
+                        Counter* counter;
+                        Task* next;
+
+                        Task();
+                        Task(const Task&) = delete;
+                        ~Task();
+                        Task& operator =(const Task&) = delete;
+
+                };
+
+                /**
+                 * Represents range job of the parallelFor.
+                 */
+                template <class F> class Range
                 {
                 public:
                         /**
-                         * \brief Constructs worker.
-                         * \param[in] threadPool thread pool, which owns current worker
+                         * \brief Constructs range job.
+                         * \param[in] function functor, which processes the range
+                         * \param[in] first the first element of the range
+                         * \param[in] last element, which follows the last element of the range
                          */
-                        Worker(ThreadPool& threadPool);
-                        Worker(const Worker&) = delete;
-                        ~Worker();
-                        Worker& operator =(const Worker&) = delete;
+                        Range(F& function, uint32_t first, uint32_t last):
+                                function_(&function), first_(first), last_(last) {}
+                        Range(const Range&) = default;
+                        ~Range() {}
+                        Range& operator =(const Range&) = default;
+
+                        /**
+                         * \brief Processes range.
+                         */
+                        void operator ()()
+                        {
+                                (*function_)(first_, last_);
+                        }
 
                 private:
-                        ThreadPool& threadPool_;
+                        F* function_;
+                        uint32_t first_, last_;
 
-                        std::thread thread_;
-                        std::mutex mutex_;
+                };
 
-                        volatile bool isActive_;
+                /**
+                 * Represents lock-free work-stealing deque of fixed capacity. Only owner of the deque pushes
+                 * and pops tasks, other threads steal them.
+                 */
+                class Deque
+                {
+                public:
+                        Deque();
+                        Deque(const Deque&) = delete;
+                        ~Deque();
+                        Deque& operator =(const Deque&) = delete;
+
+                        /**
+                         * \brief Pushes task to the bottom of the deque (called only by the owner).
+                         * \param[in] task task
+                         * \return true if task has been pushed, false if deque is full
+                         */
+                        bool push(Task* task);
+
+                        /**
+                         * \brief Pops task from the bottom of the deque (called only by the owner).
+                         * \return task, or nullptr if deque is empty
+                         */
+                        Task* pop();
+
+                        /**
+                         * \brief Steals task from the top of the deque.
+                         * \return task, or nullptr if deque is empty or task has been taken by another thread
+                         */
+                        Task* steal();
 
                         /**
-                         * \brief Executes jobs from the queue.
+                         * \brief Returns true if deque is empty.
+                         * \return true if deque is empty
                          */
-                        void executeJobs();
+                        bool isEmpty() const;
+
+                private:
+                        std::atomic<int64_t> top_;
+                        std::atomic<int64_t> bottom_;
+                        std::atomic<Task*> tasks_[DEQUE_CAPACITY];
 
                 };
 
-                std::deque<Job> jobs_;
-                std::mutex jobMutex_;
+                /**
+                 * Represents worker.
+                 */
+                class Worker
+                {
+                public:
+                        Deque deque;
+                        Task* freeTasks;
+                        uint32_t numFreeTasks;
+                        std::thread thread;
+
+                        Worker();
+                        Worker(const Worker&) = delete;
+                        ~Worker();
+                        Worker& operator =(const Worker&) = delete;
+
+                };
+
+                std::vector<std::unique_ptr<Worker>> workers_;
+                size_t numWorkers_;
+
+                std::deque<Task*> sharedTasks_;
+                std::atomic<size_t> numSharedTasks_;
+                std::mutex sharedTasksMutex_;
+
+                std::vector<std::unique_ptr<Task[]>> taskBlocks_;
+                Task* freeTasks_;
+                std::mutex freeTasksMutex_;
+
+                std::exception_ptr exception_;
+                std::mutex exceptionMutex_;
+
+                std::atomic<int32_t> numSleepingWorkers_;
+                std::atomic<bool> isActive_;
+                std::mutex sleepMutex_;
                 std::condition_variable activator_;
 
-                std::forward_list<std::unique_ptr<Worker>> workers_;
+                /**
+                 * \brief Creates task with given functor.
+                 * \param[in] function functor
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 * \return task, or nullptr if memory could not be allocated
+                 */
+                template <class F> Task* createTask(F& function, int32_t workerIndex)
+                {
+                        Task* task = allocateTask(workerIndex);
+                        if(task == nullptr)
+                                return nullptr;
+
+                        static const bool fits = (sizeof(F) <= sizeof(task->storage) &&
+                                                  std::alignment_of<F>::value <=
+                                                  std::alignment_of<decltype(task->storage)>::value);
+
+                        if(!constructFunction(*task, function, std::integral_constant<bool, fits>()))
+                        {
+                                releaseTask(task, workerIndex);
+                                return nullptr;
+                        }
+
+                        return task;
+                }
+
+                /**
+                 * \brief Constructs functor in place.
+                 * \param[out] task task
+                 * \param[in] function functor
+                 * \return true if functor has been successfully constructed
+                 */
+                template <class F> static bool constructFunction(Task& task, F& function, std::true_type)
+                {
+                        try
+                        {
+                                new(&task.storage) F(std::move(function));
+                        }
+                        catch(...)
+                        {
+                                return false;
+                        }
+
+                        task.execute = &executeFunction<F>;
+                        task.destroy = &destroyFunction<F>;
+                        return true;
+                }
+
+                /**
+                 * \brief Constructs functor on the heap.
+                 * \param[out] task task
+                 * \param[in] function functor
+                 * \return true if functor has been successfully constructed
+                 */
+                template <class F> static bool constructFunction(Task& task, F& function, std::false_type)
+                {
+                        F* heapFunction = nullptr;
+
+                        try
+                        {
+                                heapFunction = new(std::nothrow) F(std::move(function));
+                        }
+                        catch(...) {}
+
+                        if(heapFunction == nullptr)
+                                return false;
+
+                        *reinterpret_cast<F**>(&task.storage) = heapFunction;
+                        task.execute = &executeHeapFunction<F>;
+                        task.destroy = &destroyHeapFunction<F>;
+                        return true;
+                }
+
+                /**
+                 * \brief Calls functor, which is stored in place.
+                 * \param[in] task task
+                 */
+                template <class F> static void executeFunction(Task& task)
+                {
+                        (*reinterpret_cast<F*>(&task.storage))();
+                }
+
+                /**
+                 * \brief Destroys functor, which is stored in place.
+                 * \param[in] task task
+                 */
+                template <class F> static void destroyFunction(Task& task)
+                {
+                        reinterpret_cast<F*>(&task.storage)->~F();
+                }
+
+                /**
+                 * \brief Calls functor, which is stored on the heap.
+                 * \param[in] task task
+                 */
+                template <class F> static void executeHeapFunction(Task& task)
+                {
+                        (**reinterpret_cast<F**>(&task.storage))();
+                }
+
+                /**
+                 * \brief Destroys functor, which is stored on the heap.
+                 * \param[in] task task
+                 */
+                template <class F> static void destroyHeapFunction(Task& task)
+                {
+                        delete *reinterpret_cast<F**>(&task.storage);
+                }
+
+                /**
+                 * \brief Allocates task.
+                 *
+                 * Task is taken from the list of the free tasks of the worker, or from the shared list of the
+                 * free tasks (worker moves a batch of free tasks to its own list), new tasks are allocated in
+                 * blocks.
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 * \return task, or nullptr if memory could not be allocated
+                 */
+                Task* allocateTask(int32_t workerIndex);
+
+                /**
+                 * \brief Returns task to the list of the free tasks.
+                 * \param[in] task task
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 */
+                void releaseTask(Task* task, int32_t workerIndex);
+
+                /**
+                 * \brief Registers task in the counter and queues it (or parks it in the dependency).
+                 * \param[in] task task
+                 * \param[in] counter counter of the task (may be nullptr)
+                 * \param[in] dependency counter, which must reach zero before task is queued (may be nullptr)
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 */
+                void submitTask(Task* task, Counter* counter, Counter* dependency, int32_t workerIndex);
+
+                /**
+                 * \brief Queues task and wakes sleeping worker.
+                 * \param[in] task task
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 */
+                void pushTask(Task* task, int32_t workerIndex);
+
+                /**
+                 * \brief Takes task: from the deque of the calling worker, then from the shared queue, then
+                 * from the deques of other workers.
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 * \return task, or nullptr if there are no queued tasks
+                 */
+                Task* takeTask(int32_t workerIndex);
+
+                /**
+                 * \brief Returns true if there are queued tasks.
+                 * \return true if shared queue or deque of any worker is not empty
+                 */
+                bool hasQueuedTasks() const;
+
+                /**
+                 * \brief Executes task and finishes it.
+                 * \param[in] task task
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 */
+                void executeTask(Task* task, int32_t workerIndex);
+
+                /**
+                 * \brief Destroys functor of the task, releases task and decrements its counter.
+                 *
+                 * When counter reaches zero, tasks, which are parked in it, are queued (or finished without
+                 * execution, if thread pool is being destroyed).
+                 * \param[in] task task
+                 * \param[in] exception exception, which has been thrown by the functor (may be null)
+                 * \param[in] workerIndex index of the calling worker (or -1)
+                 */
+                void finishTask(Task* task, const std::exception_ptr& exception, int32_t workerIndex);
+
+                /**
+                 * \brief Waits until counter reaches zero, executing queued jobs meanwhile.
+                 * \param[in] counter counter
+                 * \return the first exception of the counter (or of the jobs without counter), or null
+                 */
+                std::exception_ptr waitForCounter(Counter& counter);
+
+                /**
+                 * \brief Returns index of the calling worker.
+                 * \return index of the worker, or -1 if calling thread is not a worker of this thread pool
+                 */
+                int32_t findWorker() const;
+
+                /**
+                 * \brief Executes tasks (loop of the worker).
+                 * \param[in] workerIndex index of the worker
+                 */
+                void executeTasks(int32_t workerIndex);
 
         };
 
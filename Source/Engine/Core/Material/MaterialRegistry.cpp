@@ -0,0 +1,175 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "MaterialRegistry.h"
+#include "../Helpers/Name.h"
+
+namespace selene
+{
+
+        MaterialRegistry::MaterialRegistry(): materials_(), numInternedMaterials_(0), maxNumEntries_(MIN_NUM_ENTRIES_TO_CLEAN), mutex_() {}
+        MaterialRegistry::~MaterialRegistry() {}
+
+        //---------------------------------------------------------------------------------------
+        std::shared_ptr<Material> MaterialRegistry::intern(const std::shared_ptr<Material>& material)
+        {
+                if(!material)
+                        return material;
+
+                uint32_t hash = computeHash(*material);
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                ++numInternedMaterials_;
+
+                auto range = materials_.equal_range(hash);
+                for(auto it = range.first; it != range.second;)
+                {
+                        std::shared_ptr<Material> registeredMaterial = it->second.lock();
+                        if(!registeredMaterial)
+                        {
+                                it = materials_.erase(it);
+                                continue;
+                        }
+
+                        if(areEqual(*registeredMaterial, *material))
+                                return registeredMaterial;
+
+                        ++it;
+                }
+
+                try
+                {
+                        if(materials_.size() >= maxNumEntries_)
+                        {
+                                removeExpiredEntries();
+                                maxNumEntries_ = std::max(maxNumEntries_, 2 * materials_.size());
+                        }
+
+                        materials_.insert(std::make_pair(hash, std::weak_ptr<Material>(material)));
+                }
+                catch(...) {}
+
+                return material;
+        }
+
+        //---------------------------------------------------------------------------------------
+        size_t MaterialRegistry::getNumMaterials() const
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                size_t numMaterials = 0;
+                for(auto it = materials_.begin(); it != materials_.end(); ++it)
+                {
+                        if(!it->second.expired())
+                                ++numMaterials;
+                }
+
+                return numMaterials;
+        }
+
+        //---------------------------------------------------------------------------------------
+        size_t MaterialRegistry::getNumInternedMaterials() const
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return numInternedMaterials_;
+        }
+
+        //---------------------------------------------------------------------------------------
+        void MaterialRegistry::clear()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                materials_.clear();
+                numInternedMaterials_ = 0;
+        }
+
+        //---------------------------------------------------------------------------------------
+        void MaterialRegistry::removeExpiredEntries()
+        {
+                for(auto it = materials_.begin(); it != materials_.end();)
+                {
+                        if(it->second.expired())
+                                it = materials_.erase(it);
+                        else
+                                ++it;
+                }
+        }
+
+        //---------------------------------------------------------------------------------------
+        uint32_t MaterialRegistry::computeHash(const Material& material)
+        {
+                uint32_t hash = Name::HASH_OFFSET_BASIS;
+
+                uint8_t header[] = {material.getShadingType(), material.getFlags()};
+                hash = computeHash(header, sizeof(header), hash);
+
+                // negative zero is replaced by positive zero, because they are equal
+                for(uint8_t i = 0; i < NUM_OF_MATERIAL_COLOR_TYPES; ++i)
+                {
+                        const Vector3d& color = material.getColor(i);
+                        float components[] = {color.x + 0.0f, color.y + 0.0f, color.z + 0.0f};
+                        hash = computeHash(components, sizeof(components), hash);
+                }
+
+                float parameters[] =
+                {
+                        material.getSpecularLevel() + 0.0f,
+                        material.getGlossiness() + 0.0f,
+                        material.getOpacity() + 0.0f
+                };
+                hash = computeHash(parameters, sizeof(parameters), hash);
+
+                for(uint8_t i = 0; i < NUM_OF_TEXTURE_MAP_TYPES; ++i)
+                {
+                        const Texture* textureMap = *material.getTextureMap(i);
+                        hash = computeHash(&textureMap, sizeof(textureMap), hash);
+                }
+
+                return hash;
+        }
+
+        //---------------------------------------------------------------------------------------
+        uint32_t MaterialRegistry::computeHash(const void* data, size_t size, uint32_t hash)
+        {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+
+                for(size_t i = 0; i < size; ++i)
+                {
+                        hash ^= bytes[i];
+                        hash *= Name::HASH_PRIME;
+                }
+
+                return hash;
+        }
+
+        //---------------------------------------------------------------------------------------
+        bool MaterialRegistry::areEqual(const Material& first, const Material& second)
+        {
+                if(first.getShadingType() != second.getShadingType() || first.getFlags() != second.getFlags())
+                        return false;
+
+                for(uint8_t i = 0; i < NUM_OF_MATERIAL_COLOR_TYPES; ++i)
+                {
+                        const Vector3d& firstColor = first.getColor(i);
+                        const Vector3d& secondColor = second.getColor(i);
+
+                        if(firstColor.x != secondColor.x || firstColor.y != secondColor.y ||
+                           firstColor.z != secondColor.z)
+                                return false;
+                }
+
+                if(first.getSpecularLevel() != second.getSpecularLevel() ||
+                   first.getGlossiness() != second.getGlossiness() ||
+                   first.getOpacity() != second.getOpacity())
+                        return false;
+
+                for(uint8_t i = 0; i < NUM_OF_TEXTURE_MAP_TYPES; ++i)
+                {
+                        if(*first.getTextureMap(i) != *second.getTextureMap(i))
+                                return false;
+                }
+
+                return true;
+        }
+
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef MATERIAL_REGISTRY_H
+#define MATERIAL_REGISTRY_H
+
+#include "Material.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Core
+         * @{
+         */
+
+        /**
+         * Represents material registry. Interns materials: materials with the same parameters (shading type,
+         * flags, colors, specular level, glossiness, opacity and texture maps) are replaced by one shared
+         * material, so renderer (which groups meshes by pointers to the materials, see Renderer::Data) sets
+         * state of each material only once.
+         *
+         * Registry does not own materials, it holds weak pointers, which are removed when materials are
+         * destroyed. Registry is thread-safe, so it can be used by mesh factories in the workers of the thread
+         * pool (see MeshFactory::setMaterialRegistry). Interned materials are shared between meshes, so they
+         * should not be modified after loading.
+         */
+        class MaterialRegistry
+        {
+        public:
+                MaterialRegistry();
+                MaterialRegistry(const MaterialRegistry&) = delete;
+                ~MaterialRegistry();
+                MaterialRegistry& operator =(const MaterialRegistry&) = delete;
+
+                /**
+                 * \brief Interns material.
+                 * \param[in] material material
+                 * \return registered material with the same parameters, or given material if there is no such
+                 * material (then given material is registered), or given material if memory could not be
+                 * allocated
+                 */
+                std::shared_ptr<Material> intern(const std::shared_ptr<Material>& material);
+
+                /**
+                 * \brief Returns number of materials.
+                 * \return number of registered materials, which have not been destroyed
+                 */
+                size_t getNumMaterials() const;
+
+                /**
+                 * \brief Returns number of interned materials.
+                 * \return number of materials, which have been passed to the intern function (the difference
+                 * between this number and number of created materials is number of removed duplicates)
+                 */
+                size_t getNumInternedMaterials() const;
+
+                /**
+                 * \brief Clears registry.
+                 */
+                void clear();
+
+        private:
+                /// Helper constants
+                enum
+                {
+                        // number of entries, after which entries of the destroyed materials are removed
+                        // for the first time (then this number grows with the number of materials)
+                        MIN_NUM_ENTRIES_TO_CLEAN = 64
+                };
+
+                /// Map of the materials (with hashes of the parameters as the keys)
+                typedef std::unordered_multimap<uint32_t, std::weak_ptr<Material>> MaterialsMap;
+
+                MaterialsMap materials_;
+                size_t numInternedMaterials_;
+                size_t maxNumEntries_;
+                mutable std::mutex mutex_;
+
+                /**
+                 * \brief Removes entries of the destroyed materials.
+                 */
+                void removeExpiredEntries();
+
+                /**
+                 * \brief Computes hash of the parameters of the material.
+                 * \param[in] material material
+                 * \return hash of the parameters
+                 */
+                static uint32_t computeHash(const Material& material);
+
+                /**
+                 * \brief Computes 32-bit FNV-1a hash.
+                 * \param[in] data data
+                 * \param[in] size size of the data
+                 * \param[in] hash hash of the preceding data
+                 * \return hash of the data
+                 */
+                static uint32_t computeHash(const void* data, size_t size, uint32_t hash);
+
+                /**
+                 * \brief Checks equality of the parameters of the materials.
+                 * \param[in] first the first material
+                 * \param[in] second the second material
+                 * \return true if materials have the same parameters
+                 */
+                static bool areEqual(const Material& first, const Material& second);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 // Licensed under the MIT License (see LICENSE.txt for details)
 
 #include "Box.h"
+#include "Matrix.h"
 
 namespace selene
 {
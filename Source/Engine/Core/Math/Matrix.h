@@ -41,12 +41,13 @@ namespace selene
                  * \param[in] a43 element of the matrix
                  * \param[in] a44 element of the matrix
                  */
-                explicit Matrix(float a11 = 0.0f, float a12 = 0.0f, float a13 = 0.0f, float a14 = 0.0f,
-                                float a21 = 0.0f, float a22 = 0.0f, float a23 = 0.0f, float a24 = 0.0f,
-                                float a31 = 0.0f, float a32 = 0.0f, float a33 = 0.0f, float a34 = 0.0f,
-                                float a41 = 0.0f, float a42 = 0.0f, float a43 = 0.0f, float a44 = 0.0f);
+                constexpr explicit Matrix(float a11 = 0.0f, float a12 = 0.0f, float a13 = 0.0f, float a14 = 0.0f,
+                                          float a21 = 0.0f, float a22 = 0.0f, float a23 = 0.0f, float a24 = 0.0f,
+                                          float a31 = 0.0f, float a32 = 0.0f, float a33 = 0.0f, float a34 = 0.0f,
+                                          float a41 = 0.0f, float a42 = 0.0f, float a43 = 0.0f, float a44 = 0.0f):
+                        a{{a11, a12, a13, a14}, {a21, a22, a23, a24},
+                          {a31, a32, a33, a34}, {a41, a42, a43, a44}} {}
                 Matrix(const Matrix&) = default;
-                ~Matrix();
                 Matrix& operator =(const Matrix&) = default;
 
                 /**
@@ -71,24 +72,55 @@ namespace selene
                 void define(float a11, float a12, float a13, float a14,
                             float a21, float a22, float a23, float a24,
                             float a31, float a32, float a33, float a34,
-                            float a41, float a42, float a43, float a44);
+                            float a41, float a42, float a43, float a44)
+                {
+                        a[0][0] = a11; a[0][1] = a12; a[0][2] = a13; a[0][3] = a14;
+                        a[1][0] = a21; a[1][1] = a22; a[1][2] = a23; a[1][3] = a24;
+                        a[2][0] = a31; a[2][1] = a32; a[2][2] = a33; a[2][3] = a34;
+                        a[3][0] = a41; a[3][1] = a42; a[3][2] = a43; a[3][3] = a44;
+                }
 
                 /**
                  * \brief Creates identity matrix.
                  */
-                void identity();
+                void identity()
+                {
+                        a[0][0] = 1.0f; a[0][1] = 0.0f; a[0][2] = 0.0f; a[0][3] = 0.0f;
+                        a[1][0] = 0.0f; a[1][1] = 1.0f; a[1][2] = 0.0f; a[1][3] = 0.0f;
+                        a[2][0] = 0.0f; a[2][1] = 0.0f; a[2][2] = 1.0f; a[2][3] = 0.0f;
+                        a[3][0] = 0.0f; a[3][1] = 0.0f; a[3][2] = 0.0f; a[3][3] = 1.0f;
+                }
 
                 /**
                  * \brief Creates translation matrix.
                  * \param[in] vector translation vector
                  */
-                void translation(const Vector3d& vector);
+                void translation(const Vector3d& vector)
+                {
+                        a[0][0] = 1.0f; a[0][1] = 0.0f; a[0][2] = 0.0f; a[0][3] = 0.0f;
+                        a[1][0] = 0.0f; a[1][1] = 1.0f; a[1][2] = 0.0f; a[1][3] = 0.0f;
+                        a[2][0] = 0.0f; a[2][1] = 0.0f; a[2][2] = 1.0f; a[2][3] = 0.0f;
+                        a[3][0] = vector.x;
+                        a[3][1] = vector.y;
+                        a[3][2] = vector.z;
+                        a[3][3] = 1.0f;
+                }
 
                 /**
                  * \brief Creates scale matrix.
                  * \param[in] amount amount of scale for each axis
                  */
-                void scale(const Vector3d& amount);
+                void scale(const Vector3d& amount)
+                {
+                        a[0][0] = amount.x;
+                        a[1][1] = amount.y;
+                        a[2][2] = amount.z;
+                        a[0][1] = 0.0f; a[0][2] = 0.0f; a[0][3] = 0.0f;
+                        a[1][0] = 0.0f; a[1][2] = 0.0f; a[1][3] = 0.0f;
+                        a[2][0] = 0.0f; a[2][1] = 0.0f; a[2][3] = 0.0f;
+                        a[3][0] = 0.0f; a[3][1] = 0.0f; a[3][2] = 0.0f;
+                        a[3][3] = 1.0f;
+                }
 
                 /**
                  * \brief Creates rotation matrix around X CCW.
@@ -134,41 +166,301 @@ namespace selene
                 /**
                  * \brief Transposes matrix.
                  */
-                void transpose();
+                void transpose()
+                {
+                        std::swap(a[0][1], a[1][0]);
+                        std::swap(a[0][2], a[2][0]);
+                        std::swap(a[0][3], a[3][0]);
+                        std::swap(a[1][2], a[2][1]);
+                        std::swap(a[1][3], a[3][1]);
+                        std::swap(a[2][3], a[3][2]);
+                }
 
                 // Operators
-                operator float*();
-                operator const float*() const;
+                operator float*()
+                {
+                        return &a[0][0];
+                }
 
-                Matrix& operator +=(float scalar);
-                Matrix& operator +=(const Matrix& matrix);
+                operator const float*() const
+                {
+                        return &a[0][0];
+                }
 
-                Matrix& operator -=(float scalar);
-                Matrix& operator -=(const Matrix& matrix);
+                Matrix& operator +=(float scalar)
+                {
+                        a[0][0] += scalar; a[0][1] += scalar;
+                        a[0][2] += scalar; a[0][3] += scalar;
+                        a[1][0] += scalar; a[1][1] += scalar;
+                        a[1][2] += scalar; a[1][3] += scalar;
+                        a[2][0] += scalar; a[2][1] += scalar;
+                        a[2][2] += scalar; a[2][3] += scalar;
+                        a[3][0] += scalar; a[3][1] += scalar;
+                        a[3][2] += scalar; a[3][3] += scalar;
 
-                Matrix& operator *=(float scalar);
-                Matrix& operator *=(Matrix matrix);
+                        return *this;
+                }
 
-                Matrix& operator /=(float scalar);
-                Matrix& operator /=(const Matrix& matrix);
+                Matrix& operator +=(const Matrix& matrix)
+                {
+                        a[0][0] += matrix.a[0][0]; a[0][1] += matrix.a[0][1];
+                        a[0][2] += matrix.a[0][2]; a[0][3] += matrix.a[0][3];
+                        a[1][0] += matrix.a[1][0]; a[1][1] += matrix.a[1][1];
+                        a[1][2] += matrix.a[1][2]; a[1][3] += matrix.a[1][3];
+                        a[2][0] += matrix.a[2][0]; a[2][1] += matrix.a[2][1];
+                        a[2][2] += matrix.a[2][2]; a[2][3] += matrix.a[2][3];
+                        a[3][0] += matrix.a[3][0]; a[3][1] += matrix.a[3][1];
+                        a[3][2] += matrix.a[3][2]; a[3][3] += matrix.a[3][3];
+
+                        return *this;
+                }
+
+                Matrix& operator -=(float scalar)
+                {
+                        a[0][0] -= scalar; a[0][1] -= scalar;
+                        a[0][2] -= scalar; a[0][3] -= scalar;
+                        a[1][0] -= scalar; a[1][1] -= scalar;
+                        a[1][2] -= scalar; a[1][3] -= scalar;
+                        a[2][0] -= scalar; a[2][1] -= scalar;
+                        a[2][2] -= scalar; a[2][3] -= scalar;
+                        a[3][0] -= scalar; a[3][1] -= scalar;
+                        a[3][2] -= scalar; a[3][3] -= scalar;
+
+                        return *this;
+                }
+
+                Matrix& operator -=(const Matrix& matrix)
+                {
+                        a[0][0] -= matrix.a[0][0]; a[0][1] -= matrix.a[0][1];
+                        a[0][2] -= matrix.a[0][2]; a[0][3] -= matrix.a[0][3];
+                        a[1][0] -= matrix.a[1][0]; a[1][1] -= matrix.a[1][1];
+                        a[1][2] -= matrix.a[1][2]; a[1][3] -= matrix.a[1][3];
+                        a[2][0] -= matrix.a[2][0]; a[2][1] -= matrix.a[2][1];
+                        a[2][2] -= matrix.a[2][2]; a[2][3] -= matrix.a[2][3];
+                        a[3][0] -= matrix.a[3][0]; a[3][1] -= matrix.a[3][1];
+                        a[3][2] -= matrix.a[3][2]; a[3][3] -= matrix.a[3][3];
+
+                        return *this;
+                }
+
+                Matrix& operator *=(float scalar)
+                {
+                        a[0][0] *= scalar; a[0][1] *= scalar;
+                        a[0][2] *= scalar; a[0][3] *= scalar;
+                        a[1][0] *= scalar; a[1][1] *= scalar;
+                        a[1][2] *= scalar; a[1][3] *= scalar;
+                        a[2][0] *= scalar; a[2][1] *= scalar;
+                        a[2][2] *= scalar; a[2][3] *= scalar;
+                        a[3][0] *= scalar; a[3][1] *= scalar;
+                        a[3][2] *= scalar; a[3][3] *= scalar;
+
+                        return *this;
+                }
+
+                Matrix& operator *=(Matrix matrix)
+                {
+                        Matrix result;
+                        matrix.transpose();
+
+                        for(uint32_t i = 0; i < 4; ++i)
+                        {
+                                result.a[i][0] = a[i][0] * matrix.a[0][0] + a[i][1] * matrix.a[0][1] +
+                                                 a[i][2] * matrix.a[0][2] + a[i][3] * matrix.a[0][3];
+                                result.a[i][1] = a[i][0] * matrix.a[1][0] + a[i][1] * matrix.a[1][1] +
+                                                 a[i][2] * matrix.a[1][2] + a[i][3] * matrix.a[1][3];
+                                result.a[i][2] = a[i][0] * matrix.a[2][0] + a[i][1] * matrix.a[2][1] +
+                                                 a[i][2] * matrix.a[2][2] + a[i][3] * matrix.a[2][3];
+                                result.a[i][3] = a[i][0] * matrix.a[3][0] + a[i][1] * matrix.a[3][1] +
+                                                 a[i][2] * matrix.a[3][2] + a[i][3] * matrix.a[3][3];
+                        }
+
+                        *this = result;
+                        return *this;
+                }
+
+                Matrix& operator /=(float scalar)
+                {
+                        a[0][0] /= scalar; a[0][1] /= scalar;
+                        a[0][2] /= scalar; a[0][3] /= scalar;
+                        a[1][0] /= scalar; a[1][1] /= scalar;
+                        a[1][2] /= scalar; a[1][3] /= scalar;
+                        a[2][0] /= scalar; a[2][1] /= scalar;
+                        a[2][2] /= scalar; a[2][3] /= scalar;
+                        a[3][0] /= scalar; a[3][1] /= scalar;
+                        a[3][2] /= scalar; a[3][3] /= scalar;
+
+                        return *this;
+                }
+
+                Matrix& operator /=(const Matrix& matrix)
+                {
+                        a[0][0] /= matrix.a[0][0]; a[0][1] /= matrix.a[0][1];
+                        a[0][2] /= matrix.a[0][2]; a[0][3] /= matrix.a[0][3];
+                        a[1][0] /= matrix.a[1][0]; a[1][1] /= matrix.a[1][1];
+                        a[1][2] /= matrix.a[1][2]; a[1][3] /= matrix.a[1][3];
+                        a[2][0] /= matrix.a[2][0]; a[2][1] /= matrix.a[2][1];
+                        a[2][2] /= matrix.a[2][2]; a[2][3] /= matrix.a[2][3];
+                        a[3][0] /= matrix.a[3][0]; a[3][1] /= matrix.a[3][1];
+                        a[3][2] /= matrix.a[3][2]; a[3][3] /= matrix.a[3][3];
+
+                        return *this;
+                }
 
         };
 
         // Matrix operators
-        Matrix operator +(const Matrix& matrix);
-        Matrix operator +(const Matrix& matrix, float scalar);
-        Matrix operator +(const Matrix& matrix0, const Matrix& matrix1);
+        constexpr Matrix operator +(const Matrix& matrix)
+        {
+                return matrix;
+        }
+
+        inline Matrix operator +(const Matrix& matrix, float scalar)
+        {
+                Matrix result = matrix;
+                result += scalar;
+                return result;
+        }
 
-        Matrix operator -(const Matrix& matrix);
-        Matrix operator -(const Matrix& matrix, float scalar);
-        Matrix operator -(const Matrix& matrix0, const Matrix& matrix1);
+        inline Matrix operator +(const Matrix& matrix0, const Matrix& matrix1)
+        {
+                Matrix result = matrix0;
+                result += matrix1;
+                return result;
+        }
 
-        Matrix operator *(const Matrix& matrix, float scalar);
-        Matrix operator *(float scalar, const Matrix& matrix);
-        Matrix operator *(const Matrix& matrix0, const Matrix& matrix1);
+        constexpr Matrix operator -(const Matrix& matrix)
+        {
+                return Matrix(-matrix.a[0][0], -matrix.a[0][1], -matrix.a[0][2], -matrix.a[0][3],
+                              -matrix.a[1][0], -matrix.a[1][1], -matrix.a[1][2], -matrix.a[1][3],
+                              -matrix.a[2][0], -matrix.a[2][1], -matrix.a[2][2], -matrix.a[2][3],
+                              -matrix.a[3][0], -matrix.a[3][1], -matrix.a[3][2], -matrix.a[3][3]);
+        }
+
+        inline Matrix operator -(const Matrix& matrix, float scalar)
+        {
+                Matrix result = matrix;
+                result -= scalar;
+                return result;
+        }
+
+        inline Matrix operator -(const Matrix& matrix0, const Matrix& matrix1)
+        {
+                Matrix result = matrix0;
+                result -= matrix1;
+                return result;
+        }
+
+        inline Matrix operator *(const Matrix& matrix, float scalar)
+        {
+                Matrix result = matrix;
+                result *= scalar;
+                return result;
+        }
+
+        inline Matrix operator *(float scalar, const Matrix& matrix)
+        {
+                Matrix result = matrix;
+                result *= scalar;
+                return result;
+        }
 
-        Matrix operator /(const Matrix& matrix, float scalar);
-        Matrix operator /(const Matrix& matrix0, const Matrix& matrix1);
+        inline Matrix operator *(const Matrix& matrix0, const Matrix& matrix1)
+        {
+                Matrix result = matrix0;
+                result *= matrix1;
+                return result;
+        }
+
+        inline Matrix operator /(const Matrix& matrix, float scalar)
+        {
+                Matrix result = matrix;
+                result /= scalar;
+                return result;
+        }
+
+        inline Matrix operator /(const Matrix& matrix0, const Matrix& matrix1)
+        {
+                Matrix result = matrix0;
+                result /= matrix1;
+                return result;
+        }
+
+        // Vector3d, Vector4d and Quaternion operations with matrices (declared in Vector.h)
+        inline void Vector3d::transform(const Matrix& matrix)
+        {
+                *this = (*this) * matrix;
+        }
+
+        inline Vector3d& Vector3d::operator *=(const Matrix& matrix)
+        {
+                *this = (*this) * matrix;
+                return *this;
+        }
+
+        inline Matrix Quaternion::convert() const
+        {
+                Matrix matrix;
+
+                float x2 = x * x;
+                float y2 = y * y;
+                float z2 = z * z;
+                float w2 = w * w;
+                float l2 = 1.0f / (x2 + y2 + z2 + w2);
+
+                matrix.a[0][0] = ( x2 - y2 - z2 + w2) * l2;
+                matrix.a[1][1] = (-x2 + y2 - z2 + w2) * l2;
+                matrix.a[2][2] = (-x2 - y2 + z2 + w2) * l2;
+
+                float t1 = x * y;
+                float t2 = z * w;
+
+                matrix.a[1][0] = 2.0f * (t1 + t2) * l2;
+                matrix.a[0][1] = 2.0f * (t1 - t2) * l2;
+
+                t1 = x * z;
+                t2 = y * w;
+
+                matrix.a[2][0] = 2.0f * (t1 - t2) * l2;
+                matrix.a[0][2] = 2.0f * (t1 + t2) * l2;
+
+                t1 = y * z;
+                t2 = x * w;
+
+                matrix.a[2][1] = 2.0f * (t1 + t2) * l2;
+                matrix.a[1][2] = 2.0f * (t1 - t2) * l2;
+
+                matrix.a[3][3] = 1.0f;
+
+                return matrix;
+        }
+
+        inline Vector3d operator *(const Vector3d& vector, const Matrix& matrix)
+        {
+                Vector3d result(vector.x * matrix.a[0][0] + vector.y * matrix.a[1][0] +
+                                vector.z * matrix.a[2][0] + matrix.a[3][0],
+                                vector.x * matrix.a[0][1] + vector.y * matrix.a[1][1] +
+                                vector.z * matrix.a[2][1] + matrix.a[3][1],
+                                vector.x * matrix.a[0][2] + vector.y * matrix.a[1][2] +
+                                vector.z * matrix.a[2][2] + matrix.a[3][2]);
+                float w = vector.x * matrix.a[0][3] + vector.y * matrix.a[1][3] +
+                          vector.z * matrix.a[2][3] + matrix.a[3][3];
+                w = 1.0f / w;
+                result *= w;
+
+                return result;
+        }
+
+        inline Vector4d operator *(const Vector4d& vector, const Matrix& matrix)
+        {
+                return Vector4d(vector.x * matrix.a[0][0] + vector.y * matrix.a[1][0] +
+                                vector.z * matrix.a[2][0] + vector.w * matrix.a[3][0],
+                                vector.x * matrix.a[0][1] + vector.y * matrix.a[1][1] +
+                                vector.z * matrix.a[2][1] + vector.w * matrix.a[3][1],
+                                vector.x * matrix.a[0][2] + vector.y * matrix.a[1][2] +
+                                vector.z * matrix.a[2][2] + vector.w * matrix.a[3][2],
+                                vector.x * matrix.a[0][3] + vector.y * matrix.a[1][3] +
+                                vector.z * matrix.a[2][3] + vector.w * matrix.a[3][3]);
+        }
 
         /**
          * @}
@@ -6,6 +6,9 @@
 
 #include "../Macros/Macros.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace selene
 {
 
@@ -15,8 +18,75 @@ namespace selene
          */
 
         // Forward declaration of classes
+        class Vector2d;
+        class Vector3d;
+        class Vector4d;
+        class Quaternion;
         class Matrix;
 
+        // Vector2d operators
+        constexpr Vector2d operator +(const Vector2d& vector);
+        constexpr Vector2d operator +(const Vector2d& vector, float scalar);
+        constexpr Vector2d operator +(const Vector2d& vector0, const Vector2d& vector1);
+
+        constexpr Vector2d operator -(const Vector2d& vector);
+        constexpr Vector2d operator -(const Vector2d& vector, float scalar);
+        constexpr Vector2d operator -(const Vector2d& vector0, const Vector2d& vector1);
+
+        constexpr Vector2d operator *(const Vector2d& vector, float scalar);
+        constexpr Vector2d operator *(float scalar, const Vector2d& vector);
+
+        constexpr Vector2d operator /(const Vector2d& vector, float scalar);
+        constexpr Vector2d operator /(const Vector2d& vector0, const Vector2d& vector1);
+
+        // Vector3d operators
+        constexpr Vector3d operator +(const Vector3d& vector);
+        constexpr Vector3d operator +(const Vector3d& vector, float scalar);
+        constexpr Vector3d operator +(const Vector3d& vector0, const Vector3d& vector1);
+
+        constexpr Vector3d operator -(const Vector3d& vector);
+        constexpr Vector3d operator -(const Vector3d& vector, float scalar);
+        constexpr Vector3d operator -(const Vector3d& vector0, const Vector3d& vector1);
+
+        constexpr Vector3d operator *(const Vector3d& vector, float scalar);
+        constexpr Vector3d operator *(float scalar, const Vector3d& vector);
+        inline Vector3d operator *(const Vector3d& vector, const Matrix& matrix);
+
+        constexpr Vector3d operator /(const Vector3d& vector, float scalar);
+        constexpr Vector3d operator /(const Vector3d& vector0, const Vector3d& vector1);
+
+        // Vector4d operators
+        constexpr Vector4d operator +(const Vector4d& vector);
+        constexpr Vector4d operator +(const Vector4d& vector, float scalar);
+        constexpr Vector4d operator +(const Vector4d& vector0, const Vector4d& vector1);
+
+        constexpr Vector4d operator -(const Vector4d& vector);
+        constexpr Vector4d operator -(const Vector4d& vector, float scalar);
+        constexpr Vector4d operator -(const Vector4d& vector0, const Vector4d& vector1);
+
+        constexpr Vector4d operator *(const Vector4d& vector, float scalar);
+        constexpr Vector4d operator *(float scalar, const Vector4d& vector);
+        inline Vector4d operator *(const Vector4d& vector, const Matrix& matrix);
+
+        constexpr Vector4d operator /(const Vector4d& vector, float scalar);
+        constexpr Vector4d operator /(const Vector4d& vector0, const Vector4d& vector1);
+
+        // Quaternion operators
+        constexpr Quaternion operator +(const Quaternion& quaternion);
+        constexpr Quaternion operator +(const Quaternion& quaternion, float scalar);
+        constexpr Quaternion operator +(const Quaternion& quaternion0, const Quaternion& quaternion1);
+
+        constexpr Quaternion operator -(const Quaternion& quaternion);
+        constexpr Quaternion operator -(const Quaternion& quaternion, float scalar);
+        constexpr Quaternion operator -(const Quaternion& quaternion0, const Quaternion& quaternion1);
+
+        constexpr Quaternion operator *(const Quaternion& quaternion, float scalar);
+        constexpr Quaternion operator *(float scalar, const Quaternion& quaternion);
+        inline Quaternion operator *(const Quaternion& quaternion0, const Quaternion& quaternion1);
+
+        constexpr Quaternion operator /(const Quaternion& quaternion, float scalar);
+        constexpr Quaternion operator /(const Quaternion& quaternion0, const Quaternion& quaternion1);
+
         /**
          * Represents vector in 2D space.
          */
@@ -30,9 +100,9 @@ namespace selene
                  * \param[in] x_ x coordinate of vector
                  * \param[in] y_ y coordinate of vector
                  */
-                explicit Vector2d(float x_ = 0.0f, float y_ = 0.0f);
+                constexpr explicit Vector2d(float x_ = 0.0f, float y_ = 0.0f):
+                        x(x_), y(y_) {}
                 Vector2d(const Vector2d&) = default;
-                ~Vector2d();
                 Vector2d& operator =(const Vector2d&) = default;
 
                 /**
@@ -40,49 +110,122 @@ namespace selene
                  * \param[in] x_ x coordinate of vector
                  * \param[in] y_ y coordinate of vector
                  */
-                void define(float x_, float y_);
+                void define(float x_, float y_)
+                {
+                        x = x_;
+                        y = y_;
+                }
 
                 /**
                  * \brief Defines vector with given scalar (makes both x and y coordinates equal to scalar).
                  * \param[in] scalar x and y coordinates
                  */
-                void define(float scalar);
+                void define(float scalar)
+                {
+                        x = y = scalar;
+                }
 
                 /**
                  * \brief Computes length.
                  * \return length of the vector
                  */
-                float length() const;
+                float length() const
+                {
+                        return std::sqrt((x * x) + (y * y));
+                }
 
                 /**
                  * \brief Computes dot product.
                  * \param[in] vector another vector
                  * \return dot product of two vectors
                  */
-                float dot(const Vector2d& vector) const;
+                constexpr float dot(const Vector2d& vector) const
+                {
+                        return ((x * vector.x) + (y * vector.y));
+                }
 
                 /**
                  * \brief Normalizes vector.
                  */
-                void normalize();
+                void normalize()
+                {
+                        float l = 1.0f / length();
+                        *this *= l;
+                }
 
                 // Operators
-                operator float*();
-                operator const float*() const;
-
-                Vector2d& operator +=(float scalar);
-                Vector2d& operator +=(const Vector2d& vector);
-
-                Vector2d& operator -=(float scalar);
-                Vector2d& operator -=(const Vector2d& vector);
-
-                Vector2d& operator *=(float scalar);
-                Vector2d& operator *=(const Vector2d& vector);
-
-                Vector2d& operator /=(float scalar);
-                Vector2d& operator /=(const Vector2d& vector);
-
-                bool operator ==(const Vector2d& vector);
+                operator float*()
+                {
+                        return &x;
+                }
+
+                operator const float*() const
+                {
+                        return &x;
+                }
+
+                Vector2d& operator +=(float scalar)
+                {
+                        x += scalar;
+                        y += scalar;
+                        return *this;
+                }
+
+                Vector2d& operator +=(const Vector2d& vector)
+                {
+                        x += vector.x;
+                        y += vector.y;
+                        return *this;
+                }
+
+                Vector2d& operator -=(float scalar)
+                {
+                        x -= scalar;
+                        y -= scalar;
+                        return *this;
+                }
+
+                Vector2d& operator -=(const Vector2d& vector)
+                {
+                        x -= vector.x;
+                        y -= vector.y;
+                        return *this;
+                }
+
+                Vector2d& operator *=(float scalar)
+                {
+                        x *= scalar;
+                        y *= scalar;
+                        return *this;
+                }
+
+                Vector2d& operator *=(const Vector2d& vector)
+                {
+                        x *= vector.x;
+                        y *= vector.y;
+                        return *this;
+                }
+
+                Vector2d& operator /=(float scalar)
+                {
+                        x /= scalar;
+                        y /= scalar;
+                        return *this;
+                }
+
+                Vector2d& operator /=(const Vector2d& vector)
+                {
+                        x /= vector.x;
+                        y /= vector.y;
+                        return *this;
+                }
+
+                bool operator ==(const Vector2d& vector) const
+                {
+                        const float epsilon = std::numeric_limits<float>::epsilon() * 10.0f;
+                        return (std::fabs(x - vector.x) <= epsilon * std::max(std::fabs(x), std::fabs(vector.x)) &&
+                                std::fabs(y - vector.y) <= epsilon * std::max(std::fabs(y), std::fabs(vector.y)));
+                }
 
         };
 
@@ -100,15 +243,16 @@ namespace selene
                  * \param[in] y_ y coordinate of vector
                  * \param[in] z_ z coordinate of vector
                  */
-                explicit Vector3d(float x_ = 0.0f, float y_ = 0.0f, float z_ = 0.0f);
+                constexpr explicit Vector3d(float x_ = 0.0f, float y_ = 0.0f, float z_ = 0.0f):
+                        x(x_), y(y_), z(z_) {}
                 /**
                  * \brief Constructs vector with given coordinates.
                  * \param[in] vector holds x and y coordinates
                  * \param[in] z_ z coordinate of vector
                  */
-                explicit Vector3d(const Vector2d& vector, float z_ = 0.0f);
+                constexpr explicit Vector3d(const Vector2d& vector, float z_ = 0.0f):
+                        x(vector.x), y(vector.y), z(z_) {}
                 Vector3d(const Vector3d&) = default;
-                ~Vector3d();
                 Vector3d& operator =(const Vector3d&) = default;
 
                 /**
@@ -117,45 +261,73 @@ namespace selene
                  * \param[in] y_ y coordinate of vector
                  * \param[in] z_ z coordinate of vector
                  */
-                void define(float x_, float y_, float z_);
+                void define(float x_, float y_, float z_)
+                {
+                        x = x_;
+                        y = y_;
+                        z = z_;
+                }
 
                 /**
                  * \brief Defines vector with given coordinates.
                  * \param[in] vector holds x and y coordinates
                  * \param[in] z_ z coordinate of vector
                  */
-                void define(const Vector2d& vector, float z_);
+                void define(const Vector2d& vector, float z_)
+                {
+                        x = vector.x;
+                        y = vector.y;
+                        z = z_;
+                }
 
                 /**
                  * \brief Defines vector with given scalar (makes x, y and z coordinates equal to scalar).
                  * \param[in] scalar x, y and z coordinates
                  */
-                void define(float scalar);
+                void define(float scalar)
+                {
+                        x = y = z = scalar;
+                }
 
                 /**
                  * \brief Computes length.
                  * \return length of vector
                  */
-                float length() const;
+                float length() const
+                {
+                        return std::sqrt((x * x) + (y * y) + (z * z));
+                }
 
                 /**
                  * \brief Computes dot product.
                  * \param[in] vector another vector
                  * \return dot product of two vectors
                  */
-                float dot(const Vector3d& vector) const;
+                constexpr float dot(const Vector3d& vector) const
+                {
+                        return ((x * vector.x) + (y * vector.y) + (z * vector.z));
+                }
 
                 /**
                  * \brief Computes cross product.
                  * \param[in] vector another vector
                  * \return cross product of two vectors
                  */
-                Vector3d cross(const Vector3d& vector) const;
+                constexpr Vector3d cross(const Vector3d& vector) const
+                {
+                        return Vector3d(y * vector.z - z * vector.y,
+                                        z * vector.x - x * vector.z,
+                                        x * vector.y - y * vector.x);
+                }
 
                 /**
                  * \brief Normalizes vector.
                  */
-                void normalize();
+                void normalize()
+                {
+                        float l = 1.0f / length();
+                        *this *= l;
+                }
 
                 /**
                  * \brief Interpolates vector.
@@ -166,38 +338,104 @@ namespace selene
                  * \param[in] scalar interpolation amount (float in [0; 1] range)
                  * \return result of interpolation
                  */
-                Vector3d lerp(const Vector3d& vector, float scalar) const;
+                Vector3d lerp(const Vector3d& vector, float scalar) const
+                {
+                        scalar = std::max(0.0f, std::min(1.0f, scalar));
+                        return (*this - scalar * (*this - vector));
+                }
 
                 /**
                  * \brief Scales vector.
                  * \param[in] vector specifies amount of scale for each component of initial vector
                  * \return scaled vector
                  */
-                Vector3d scale(const Vector3d& vector) const;
+                constexpr Vector3d scale(const Vector3d& vector) const
+                {
+                        return Vector3d(x * vector.x, y * vector.y, z * vector.z);
+                }
 
                 /**
                  * \brief Applies transformation.
                  * \param[in] matrix transformation matrix
                  */
-                void transform(const Matrix& matrix);
+                inline void transform(const Matrix& matrix);
 
                 // Operators
-                operator float*();
-                operator const float*() const;
-
-                Vector3d& operator +=(float scalar);
-                Vector3d& operator +=(const Vector3d& vector);
-
-                Vector3d& operator -=(float scalar);
-                Vector3d& operator -=(const Vector3d& vector);
-
-                Vector3d& operator *=(float scalar);
-                Vector3d& operator *=(const Matrix& matrix);
-
-                Vector3d& operator /=(float scalar);
-                Vector3d& operator /=(const Vector3d& vector);
-
-                bool operator ==(const Vector3d& vector);
+                operator float*()
+                {
+                        return &x;
+                }
+
+                operator const float*() const
+                {
+                        return &x;
+                }
+
+                Vector3d& operator +=(float scalar)
+                {
+                        x += scalar;
+                        y += scalar;
+                        z += scalar;
+                        return *this;
+                }
+
+                Vector3d& operator +=(const Vector3d& vector)
+                {
+                        x += vector.x;
+                        y += vector.y;
+                        z += vector.z;
+                        return *this;
+                }
+
+                Vector3d& operator -=(float scalar)
+                {
+                        x -= scalar;
+                        y -= scalar;
+                        z -= scalar;
+                        return *this;
+                }
+
+                Vector3d& operator -=(const Vector3d& vector)
+                {
+                        x -= vector.x;
+                        y -= vector.y;
+                        z -= vector.z;
+                        return *this;
+                }
+
+                Vector3d& operator *=(float scalar)
+                {
+                        x *= scalar;
+                        y *= scalar;
+                        z *= scalar;
+                        return *this;
+                }
+
+                inline Vector3d& operator *=(const Matrix& matrix);
+
+                Vector3d& operator /=(float scalar)
+                {
+                        x /= scalar;
+                        y /= scalar;
+                        z /= scalar;
+                        return *this;
+                }
+
+                Vector3d& operator /=(const Vector3d& vector)
+                {
+                        x /= vector.x;
+                        y /= vector.y;
+                        z /= vector.z;
+                        return *this;
+                }
+
+                bool operator ==(const Vector3d& vector) const
+                {
+                        const float epsilon = std::numeric_limits<float>::epsilon() * 10.0f;
+                        return (std::fabs(x - vector.x) <= epsilon * std::max(std::fabs(x), std::fabs(vector.x)) &&
+                                std::fabs(y - vector.y) <= epsilon * std::max(std::fabs(y), std::fabs(vector.y)) &&
+                                std::fabs(z - vector.z) <= epsilon * std::max(std::fabs(z), std::fabs(vector.z)));
+                }
 
         };
 
@@ -216,28 +454,31 @@ namespace selene
                  * \param[in] z_ z coordinate of vector
                  * \param[in] w_ w coordinate of vector
                  */
-                explicit Vector4d(float x_ = 0.0f, float y_ = 0.0f, float z_ = 0.0f, float w_ = 0.0f);
+                constexpr explicit Vector4d(float x_ = 0.0f, float y_ = 0.0f, float z_ = 0.0f, float w_ = 0.0f):
+                        x(x_), y(y_), z(z_), w(w_) {}
                 /**
                  * \brief Constructs vector with given coordinates.
                  * \param[in] vector holds x and y coordinates
                  * \param[in] z_ z coordinate of vector
                  * \param[in] w_ w coordinate of vector
                  */
-                explicit Vector4d(const Vector2d& vector, float z_ = 0.0f, float w_ = 0.0f);
+                constexpr explicit Vector4d(const Vector2d& vector, float z_ = 0.0f, float w_ = 0.0f):
+                        x(vector.x), y(vector.y), z(z_), w(w_) {}
                 /**
                  * \brief Constructs vector with given coordinates.
                  * \param[in] vector0 holds x and y coordinates
                  * \param[in] vector1 holds z and w coordinates
                  */
-                explicit Vector4d(const Vector2d& vector0, const Vector2d& vector1);
+                constexpr explicit Vector4d(const Vector2d& vector0, const Vector2d& vector1):
+                        x(vector0.x), y(vector0.y), z(vector1.x), w(vector1.y) {}
                 /**
                  * \brief Constructs vector with given coordinates.
                  * \param[in] vector holds x, y and z coordinates
                  * \param[in] w_ w coordinate of vector
                  */
-                explicit Vector4d(const Vector3d& vector, float w_ = 0.0f);
+                constexpr explicit Vector4d(const Vector3d& vector, float w_ = 0.0f):
+                        x(vector.x), y(vector.y), z(vector.z), w(w_) {}
                 Vector4d(const Vector4d&) = default;
-                ~Vector4d();
                 Vector4d& operator =(const Vector4d&) = default;
 
                 /**
@@ -247,7 +488,13 @@ namespace selene
                  * \param[in] z_ z coordinate of vector
                  * \param[in] w_ w coordinate of vector
                  */
-                void define(float x_, float y_, float z_, float w_);
+                void define(float x_, float y_, float z_, float w_)
+                {
+                        x = x_;
+                        y = y_;
+                        z = z_;
+                        w = w_;
+                }
 
                 /**
                  * \brief Defines vector with given coordinates.
@@ -255,45 +502,140 @@ namespace selene
                  * \param[in] z_ z coordinate of vector
                  * \param[in] w_ w coordinate of vector
                  */
-                void define(const Vector2d& vector, float z_, float w_);
+                void define(const Vector2d& vector, float z_, float w_)
+                {
+                        x = vector.x;
+                        y = vector.y;
+                        z = z_;
+                        w = w_;
+                }
 
                 /**
                  * \brief Defines vector with given coordinates.
                  * \param[in] vector0 holds x and y coordinates
                  * \param[in] vector1 holds z and w coordinates
                  */
-                void define(const Vector2d& vector0, const Vector2d& vector1);
+                void define(const Vector2d& vector0, const Vector2d& vector1)
+                {
+                        x = vector0.x;
+                        y = vector0.y;
+                        z = vector1.x;
+                        w = vector1.y;
+                }
 
                 /**
                  * \brief Defines vector with given coordinates.
                  * \param[in] vector holds x, y and z coordinates
                  * \param[in] w_ w coordinate of vector
                  */
-                void define(const Vector3d& vector, float w_);
+                void define(const Vector3d& vector, float w_)
+                {
+                        x = vector.x;
+                        y = vector.y;
+                        z = vector.z;
+                        w = w_;
+                }
 
                 /**
                  * \brief Defines vector with given scalar (makes x, y, z and w coordinates equal to scalar).
                  * \param[in] scalar x, y, z and w coordinates
                  */
-                void define(float scalar);
+                void define(float scalar)
+                {
+                        x = y = z = w = scalar;
+                }
 
                 // Operators
-                operator float*();
-                operator const float*() const;
-
-                Vector4d& operator +=(float scalar);
-                Vector4d& operator +=(const Vector4d& vector);
-
-                Vector4d& operator -=(float scalar);
-                Vector4d& operator -=(const Vector4d& vector);
-
-                Vector4d& operator *=(float scalar);
-                Vector4d& operator *=(const Vector4d& vector);
-
-                Vector4d& operator /=(float scalar);
-                Vector4d& operator /=(const Vector4d& vector);
-
-                bool operator ==(const Vector4d& vector);
+                operator float*()
+                {
+                        return &x;
+                }
+
+                operator const float*() const
+                {
+                        return &x;
+                }
+
+                Vector4d& operator +=(float scalar)
+                {
+                        x += scalar;
+                        y += scalar;
+                        z += scalar;
+                        w += scalar;
+                        return *this;
+                }
+
+                Vector4d& operator +=(const Vector4d& vector)
+                {
+                        x += vector.x;
+                        y += vector.y;
+                        z += vector.z;
+                        w += vector.w;
+                        return *this;
+                }
+
+                Vector4d& operator -=(float scalar)
+                {
+                        x -= scalar;
+                        y -= scalar;
+                        z -= scalar;
+                        w -= scalar;
+                        return *this;
+                }
+
+                Vector4d& operator -=(const Vector4d& vector)
+                {
+                        x -= vector.x;
+                        y -= vector.y;
+                        z -= vector.z;
+                        w -= vector.w;
+                        return *this;
+                }
+
+                Vector4d& operator *=(float scalar)
+                {
+                        x *= scalar;
+                        y *= scalar;
+                        z *= scalar;
+                        w *= scalar;
+                        return *this;
+                }
+
+                Vector4d& operator *=(const Vector4d& vector)
+                {
+                        x *= vector.x;
+                        y *= vector.y;
+                        z *= vector.z;
+                        w *= vector.w;
+                        return *this;
+                }
+
+                Vector4d& operator /=(float scalar)
+                {
+                        x /= scalar;
+                        y /= scalar;
+                        z /= scalar;
+                        w /= scalar;
+                        return *this;
+                }
+
+                Vector4d& operator /=(const Vector4d& vector)
+                {
+                        x /= vector.x;
+                        y /= vector.y;
+                        z /= vector.z;
+                        w /= vector.w;
+                        return *this;
+                }
+
+                bool operator ==(const Vector4d& vector) const
+                {
+                        const float epsilon = std::numeric_limits<float>::epsilon() * 10.0f;
+                        return (std::fabs(x - vector.x) <= epsilon * std::max(std::fabs(x), std::fabs(vector.x)) &&
+                                std::fabs(y - vector.y) <= epsilon * std::max(std::fabs(y), std::fabs(vector.y)) &&
+                                std::fabs(z - vector.z) <= epsilon * std::max(std::fabs(z), std::fabs(vector.z)) &&
+                                std::fabs(w - vector.w) <= epsilon * std::max(std::fabs(w), std::fabs(vector.w)));
+                }
 
         };
 
@@ -312,28 +654,31 @@ namespace selene
                  * \param[in] z_ z coordinate of quaternion
                  * \param[in] w_ w coordinate of quaternion
                  */
-                explicit Quaternion(float x_ = 0.0f, float y_ = 0.0f, float z_ = 0.0f, float w_ = 1.0f);
+                constexpr explicit Quaternion(float x_ = 0.0f, float y_ = 0.0f, float z_ = 0.0f, float w_ = 1.0f):
+                        x(x_), y(y_), z(z_), w(w_) {}
                 /**
                  * \brief Constructs quaternion with given coordinates.
                  * \param[in] vector holds x and y coordinates
                  * \param[in] z_ z coordinate of quaternion
                  * \param[in] w_ w coordinate of quaternion
                  */
-                explicit Quaternion(const Vector2d& vector, float z_ = 0.0f, float w_ = 0.0f);
+                constexpr explicit Quaternion(const Vector2d& vector, float z_ = 0.0f, float w_ = 0.0f):
+                        x(vector.x), y(vector.y), z(z_), w(w_) {}
                 /**
                  * \brief Constructs quaternion with given coordinates.
                  * \param[in] vector0 holds x and y coordinates
                  * \param[in] vector1 holds z and w coordinates
                  */
-                explicit Quaternion(const Vector2d& vector0, const Vector2d& vector1);
+                constexpr explicit Quaternion(const Vector2d& vector0, const Vector2d& vector1):
+                        x(vector0.x), y(vector0.y), z(vector1.x), w(vector1.y) {}
                 /**
                  * \brief Constructs quaternion with given coordinates.
                  * \param[in] vector holds x, y and z coordinates
                  * \param[in] w_ w coordinate of quaternion
                  */
-                explicit Quaternion(const Vector3d& vector, float w_ = 0.0f);
+                constexpr explicit Quaternion(const Vector3d& vector, float w_ = 0.0f):
+                        x(vector.x), y(vector.y), z(vector.z), w(w_) {}
                 Quaternion(const Quaternion&) = default;
-                ~Quaternion();
                 Quaternion& operator =(const Quaternion&) = default;
 
                 /**
@@ -343,7 +688,13 @@ namespace selene
                  * \param[in] z_ z coordinate of quaternion
                  * \param[in] w_ w coordinate of quaternion
                  */
-                void define(float x_, float y_, float z_, float w_);
+                void define(float x_, float y_, float z_, float w_)
+                {
+                        x = x_;
+                        y = y_;
+                        z = z_;
+                        w = w_;
+                }
 
                 /**
                  * \brief Defines quaternion with given coordinates.
@@ -351,58 +702,98 @@ namespace selene
                  * \param[in] z_ z coordinate of quaternion
                  * \param[in] w_ w coordinate of quaternion
                  */
-                void define(const Vector2d& vector, float z_, float w_);
+                void define(const Vector2d& vector, float z_, float w_)
+                {
+                        x = vector.x;
+                        y = vector.y;
+                        z = z_;
+                        w = w_;
+                }
 
                 /**
                  * \brief Defines quaternion with given coordinates.
                  * \param[in] vector0 holds x and y coordinates
                  * \param[in] vector1 holds z and w coordinates
                  */
-                void define(const Vector2d& vector0, const Vector2d& vector1);
+                void define(const Vector2d& vector0, const Vector2d& vector1)
+                {
+                        x = vector0.x;
+                        y = vector0.y;
+                        z = vector1.x;
+                        w = vector1.y;
+                }
 
                 /**
                  * \brief Defines quaternion with given coordinates.
                  * \param[in] vector holds x, y and z coordinates
                  * \param[in] w_ w coordinate of quaternion
                  */
-                void define(const Vector3d& vector, float w_);
+                void define(const Vector3d& vector, float w_)
+                {
+                        x = vector.x;
+                        y = vector.y;
+                        z = vector.z;
+                        w = w_;
+                }
 
                 /**
                  * \brief Defines quaternion with given scalar (makes x, y, z and w coordinates equal to scalar).
                  * \param[in] scalar x, y, z and w coordinates
                  */
-                void define(float scalar);
+                void define(float scalar)
+                {
+                        x = y = z = w = scalar;
+                }
 
                 /**
                  * \brief Computes inner product.
                  * \param[in] quaternion another quaternion
                  * \return inner product of two quaternions
                  */
-                float inner(const Quaternion& quaternion) const;
+                constexpr float inner(const Quaternion& quaternion) const
+                {
+                        return ((x * quaternion.x) + (y * quaternion.y) +
+                                (z * quaternion.z) + (w * quaternion.w));
+                }
 
                 /**
                  * \brief Returns norm of the quaternion.
                  * \return norm of the quaternion
                  */
-                float norm() const;
+                constexpr float norm() const
+                {
+                        return (x * x + y * y + z * z + w * w);
+                }
 
                 /**
                  * \brief Normalizes quaternion.
                  */
-                void normalize();
+                void normalize()
+                {
+                        float l = 1.0f / std::sqrt(norm());
+                        *this *= l;
+                }
 
                 /**
                  * \brief Returns conjugated quaternion.
                  * \return conjugated quaternion
                  */
-                Quaternion conjugate() const;
+                constexpr Quaternion conjugate() const
+                {
+                        return Quaternion(-x, -y, -z, w);
+                }
 
                 /**
                  * \brief Rotates given vector (quaternion must be normalized).
                  * \param[in] vector vector, which will be rotated
                  * \return result of rotation
                  */
-                Vector3d rotate(const Vector3d& vector) const;
+                Vector3d rotate(const Vector3d& vector) const
+                {
+                        Quaternion v = (*this) * Quaternion(vector, 0.0f);
+                        Quaternion p = v * conjugate();
+                        return Vector3d(p.x, p.y, p.z);
+                }
 
                 /**
                  * \brief Interpolates quaternion.
@@ -413,94 +804,349 @@ namespace selene
                  * \param[in] scalar interpolation amount (float in [0; 1] range)
                  * \return result of interpolation
                  */
-                Quaternion lerp(const Quaternion& quaternion, float scalar) const;
+                Quaternion lerp(const Quaternion& quaternion, float scalar) const
+                {
+                        scalar = std::max(0.0f, std::min(1.0f, scalar));
+                        Quaternion q = quaternion;
+                        float c = inner(q);
+
+                        if(c < 0.0f)
+                                q = -q;
+
+                        q = q - *this;
+                        q = *this + q * scalar;
+                        q.normalize();
+                        return q;
+                }
 
                 /**
                  * \brief Converts quaternion to matrix.
                  * \return corresponding rotation matrix
                  */
-                Matrix convert() const;
+                inline Matrix convert() const;
 
                 // Operators
-                operator float*();
-                operator const float*() const;
+                operator float*()
+                {
+                        return &x;
+                }
+
+                operator const float*() const
+                {
+                        return &x;
+                }
+
+                Quaternion& operator +=(float scalar)
+                {
+                        x += scalar;
+                        y += scalar;
+                        z += scalar;
+                        w += scalar;
+                        return *this;
+                }
+
+                Quaternion& operator +=(const Quaternion& quaternion)
+                {
+                        x += quaternion.x;
+                        y += quaternion.y;
+                        z += quaternion.z;
+                        w += quaternion.w;
+                        return *this;
+                }
+
+                Quaternion& operator -=(float scalar)
+                {
+                        x -= scalar;
+                        y -= scalar;
+                        z -= scalar;
+                        w -= scalar;
+                        return *this;
+                }
+
+                Quaternion& operator -=(const Quaternion& quaternion)
+                {
+                        x -= quaternion.x;
+                        y -= quaternion.y;
+                        z -= quaternion.z;
+                        w -= quaternion.w;
+                        return *this;
+                }
+
+                Quaternion& operator *=(float scalar)
+                {
+                        x *= scalar;
+                        y *= scalar;
+                        z *= scalar;
+                        w *= scalar;
+                        return *this;
+                }
+
+                Quaternion& operator *=(const Quaternion& quaternion)
+                {
+                        *this = (*this) * quaternion;
+                        return *this;
+                }
+
+                Quaternion& operator /=(float scalar)
+                {
+                        x /= scalar;
+                        y /= scalar;
+                        z /= scalar;
+                        w /= scalar;
+                        return *this;
+                }
+
+                Quaternion& operator /=(const Quaternion& quaternion)
+                {
+                        x /= quaternion.x;
+                        y /= quaternion.y;
+                        z /= quaternion.z;
+                        w /= quaternion.w;
+                        return *this;
+                }
+
+        };
 
-                Quaternion& operator +=(float scalar);
-                Quaternion& operator +=(const Quaternion& quaternion);
+        // Vector2d operators
+        constexpr Vector2d operator +(const Vector2d& vector)
+        {
+                return vector;
+        }
 
-                Quaternion& operator -=(float scalar);
-                Quaternion& operator -=(const Quaternion& quaternion);
+        constexpr Vector2d operator +(const Vector2d& vector, float scalar)
+        {
+                return Vector2d(vector.x + scalar, vector.y + scalar);
+        }
 
-                Quaternion& operator *=(float scalar);
-                Quaternion& operator *=(const Quaternion& quaternion);
+        constexpr Vector2d operator +(const Vector2d& vector0, const Vector2d& vector1)
+        {
+                return Vector2d(vector0.x + vector1.x, vector0.y + vector1.y);
+        }
 
-                Quaternion& operator /=(float scalar);
-                Quaternion& operator /=(const Quaternion& quaternion);
+        constexpr Vector2d operator -(const Vector2d& vector)
+        {
+                return Vector2d(-vector.x, -vector.y);
+        }
 
-        };
+        constexpr Vector2d operator -(const Vector2d& vector, float scalar)
+        {
+                return Vector2d(vector.x - scalar, vector.y - scalar);
+        }
 
-        // Vector2d operators
-        Vector2d operator +(const Vector2d& vector);
-        Vector2d operator +(const Vector2d& vector, float scalar);
-        Vector2d operator +(const Vector2d& vector0, const Vector2d& vector1);
+        constexpr Vector2d operator -(const Vector2d& vector0, const Vector2d& vector1)
+        {
+                return Vector2d(vector0.x - vector1.x, vector0.y - vector1.y);
+        }
 
-        Vector2d operator -(const Vector2d& vector);
-        Vector2d operator -(const Vector2d& vector, float scalar);
-        Vector2d operator -(const Vector2d& vector0, const Vector2d& vector1);
+        constexpr Vector2d operator *(const Vector2d& vector, float scalar)
+        {
+                return Vector2d(vector.x * scalar, vector.y * scalar);
+        }
+
+        constexpr Vector2d operator *(float scalar, const Vector2d& vector)
+        {
+                return Vector2d(vector.x * scalar, vector.y * scalar);
+        }
 
-        Vector2d operator *(const Vector2d& vector, float scalar);
-        Vector2d operator *(float scalar, const Vector2d& vector);
+        constexpr Vector2d operator /(const Vector2d& vector, float scalar)
+        {
+                return Vector2d(vector.x / scalar, vector.y / scalar);
+        }
 
-        Vector2d operator /(const Vector2d& vector, float scalar);
-        Vector2d operator /(const Vector2d& vector0, const Vector2d& vector1);
+        constexpr Vector2d operator /(const Vector2d& vector0, const Vector2d& vector1)
+        {
+                return Vector2d(vector0.x / vector1.x, vector0.y / vector1.y);
+        }
 
         // Vector3d operators
-        Vector3d operator +(const Vector3d& vector);
-        Vector3d operator +(const Vector3d& vector, float scalar);
-        Vector3d operator +(const Vector3d& vector0, const Vector3d& vector1);
+        constexpr Vector3d operator +(const Vector3d& vector)
+        {
+                return vector;
+        }
+
+        constexpr Vector3d operator +(const Vector3d& vector, float scalar)
+        {
+                return Vector3d(vector.x + scalar, vector.y + scalar, vector.z + scalar);
+        }
+
+        constexpr Vector3d operator +(const Vector3d& vector0, const Vector3d& vector1)
+        {
+                return Vector3d(vector0.x + vector1.x,
+                                vector0.y + vector1.y,
+                                vector0.z + vector1.z);
+        }
+
+        constexpr Vector3d operator -(const Vector3d& vector)
+        {
+                return Vector3d(-vector.x, -vector.y, -vector.z);
+        }
+
+        constexpr Vector3d operator -(const Vector3d& vector, float scalar)
+        {
+                return Vector3d(vector.x - scalar, vector.y - scalar, vector.z - scalar);
+        }
+
+        constexpr Vector3d operator -(const Vector3d& vector0, const Vector3d& vector1)
+        {
+                return Vector3d(vector0.x - vector1.x,
+                                vector0.y - vector1.y,
+                                vector0.z - vector1.z);
+        }
 
-        Vector3d operator -(const Vector3d& vector);
-        Vector3d operator -(const Vector3d& vector, float scalar);
-        Vector3d operator -(const Vector3d& vector0, const Vector3d& vector1);
+        constexpr Vector3d operator *(const Vector3d& vector, float scalar)
+        {
+                return Vector3d(vector.x * scalar, vector.y * scalar, vector.z * scalar);
+        }
 
-        Vector3d operator *(const Vector3d& vector, float scalar);
-        Vector3d operator *(float scalar, const Vector3d& vector);
-        Vector3d operator *(const Vector3d& vector, const Matrix& matrix);
+        constexpr Vector3d operator *(float scalar, const Vector3d& vector)
+        {
+                return Vector3d(vector.x * scalar, vector.y * scalar, vector.z * scalar);
+        }
 
-        Vector3d operator /(const Vector3d& vector, float scalar);
-        Vector3d operator /(const Vector3d& vector0, const Vector3d& vector1);
+        constexpr Vector3d operator /(const Vector3d& vector, float scalar)
+        {
+                return Vector3d(vector.x / scalar, vector.y / scalar, vector.z / scalar);
+        }
+
+        constexpr Vector3d operator /(const Vector3d& vector0, const Vector3d& vector1)
+        {
+                return Vector3d(vector0.x / vector1.x,
+                                vector0.y / vector1.y,
+                                vector0.z / vector1.z);
+        }
 
         // Vector4d operators
-        Vector4d operator +(const Vector4d& vector);
-        Vector4d operator +(const Vector4d& vector, float scalar);
-        Vector4d operator +(const Vector4d& vector0, const Vector4d& vector1);
+        constexpr Vector4d operator +(const Vector4d& vector)
+        {
+                return vector;
+        }
+
+        constexpr Vector4d operator +(const Vector4d& vector, float scalar)
+        {
+                return Vector4d(vector.x + scalar, vector.y + scalar,
+                                vector.z + scalar, vector.w + scalar);
+        }
+
+        constexpr Vector4d operator +(const Vector4d& vector0, const Vector4d& vector1)
+        {
+                return Vector4d(vector0.x + vector1.x, vector0.y + vector1.y,
+                                vector0.z + vector1.z, vector0.w + vector1.w);
+        }
+
+        constexpr Vector4d operator -(const Vector4d& vector)
+        {
+                return Vector4d(-vector.x, -vector.y, -vector.z, -vector.w);
+        }
+
+        constexpr Vector4d operator -(const Vector4d& vector, float scalar)
+        {
+                return Vector4d(vector.x - scalar, vector.y - scalar,
+                                vector.z - scalar, vector.w - scalar);
+        }
 
-        Vector4d operator -(const Vector4d& vector);
-        Vector4d operator -(const Vector4d& vector, float scalar);
-        Vector4d operator -(const Vector4d& vector0, const Vector4d& vector1);
+        constexpr Vector4d operator -(const Vector4d& vector0, const Vector4d& vector1)
+        {
+                return Vector4d(vector0.x - vector1.x, vector0.y - vector1.y,
+                                vector0.z - vector1.z, vector0.w - vector1.w);
+        }
 
-        Vector4d operator *(const Vector4d& vector, float scalar);
-        Vector4d operator *(float scalar, const Vector4d& vector);
-        Vector4d operator *(const Vector4d& vector, const Matrix& matrix);
+        constexpr Vector4d operator *(const Vector4d& vector, float scalar)
+        {
+                return Vector4d(vector.x * scalar, vector.y * scalar,
+                                vector.z * scalar, vector.w * scalar);
+        }
 
-        Vector4d operator /(const Vector4d& vector, float scalar);
-        Vector4d operator /(const Vector4d& vector0, const Vector4d& vector1);
+        constexpr Vector4d operator *(float scalar, const Vector4d& vector)
+        {
+                return Vector4d(vector.x * scalar, vector.y * scalar,
+                                vector.z * scalar, vector.w * scalar);
+        }
+
+        constexpr Vector4d operator /(const Vector4d& vector, float scalar)
+        {
+                return Vector4d(vector.x / scalar, vector.y / scalar,
+                                vector.z / scalar, vector.w / scalar);
+        }
+
+        constexpr Vector4d operator /(const Vector4d& vector0, const Vector4d& vector1)
+        {
+                return Vector4d(vector0.x / vector1.x, vector0.y / vector1.y,
+                                vector0.z / vector1.z, vector0.w / vector1.w);
+        }
 
         // Quaternion operators
-        Quaternion operator +(const Quaternion& quaternion);
-        Quaternion operator +(const Quaternion& quaternion, float scalar);
-        Quaternion operator +(const Quaternion& quaternion0, const Quaternion& quaternion1);
+        constexpr Quaternion operator +(const Quaternion& quaternion)
+        {
+                return quaternion;
+        }
+
+        constexpr Quaternion operator +(const Quaternion& quaternion, float scalar)
+        {
+                return Quaternion(quaternion.x + scalar, quaternion.y + scalar,
+                                  quaternion.z + scalar, quaternion.w + scalar);
+        }
+
+        constexpr Quaternion operator +(const Quaternion& quaternion0, const Quaternion& quaternion1)
+        {
+                return Quaternion(quaternion0.x + quaternion1.x,
+                                  quaternion0.y + quaternion1.y,
+                                  quaternion0.z + quaternion1.z,
+                                  quaternion0.w + quaternion1.w);
+        }
 
-        Quaternion operator -(const Quaternion& quaternion);
-        Quaternion operator -(const Quaternion& quaternion, float scalar);
-        Quaternion operator -(const Quaternion& quaternion0, const Quaternion& quaternion1);
+        constexpr Quaternion operator -(const Quaternion& quaternion)
+        {
+                return Quaternion(-quaternion.x, -quaternion.y,
+                                  -quaternion.z, -quaternion.w);
+        }
+
+        constexpr Quaternion operator -(const Quaternion& quaternion, float scalar)
+        {
+                return Quaternion(quaternion.x - scalar, quaternion.y - scalar,
+                                  quaternion.z - scalar, quaternion.w - scalar);
+        }
 
-        Quaternion operator *(const Quaternion& quaternion, float scalar);
-        Quaternion operator *(float scalar, const Quaternion& quaternion);
-        Quaternion operator *(const Quaternion& quaternion0, const Quaternion& quaternion1);
+        constexpr Quaternion operator -(const Quaternion& quaternion0, const Quaternion& quaternion1)
+        {
+                return Quaternion(quaternion0.x - quaternion1.x,
+                                  quaternion0.y - quaternion1.y,
+                                  quaternion0.z - quaternion1.z,
+                                  quaternion0.w - quaternion1.w);
+        }
 
-        Quaternion operator /(const Quaternion& quaternion, float scalar);
-        Quaternion operator /(const Quaternion& quaternion0, const Quaternion& quaternion1);
+        constexpr Quaternion operator *(const Quaternion& quaternion, float scalar)
+        {
+                return Quaternion(quaternion.x * scalar, quaternion.y * scalar,
+                                  quaternion.z * scalar, quaternion.w * scalar);
+        }
+
+        constexpr Quaternion operator *(float scalar, const Quaternion& quaternion)
+        {
+                return Quaternion(quaternion.x * scalar, quaternion.y * scalar,
+                                  quaternion.z * scalar, quaternion.w * scalar);
+        }
+
+        inline Quaternion operator *(const Quaternion& quaternion0, const Quaternion& quaternion1)
+        {
+                Vector3d v0(quaternion0.x, quaternion0.y, quaternion0.z);
+                Vector3d v1(quaternion1.x, quaternion1.y, quaternion1.z);
+                Vector3d p = quaternion0.w * v1 + quaternion1.w * v0 + v0.cross(v1);
+                return Quaternion(p, quaternion0.w * quaternion1.w - v0.dot(v1));
+        }
+
+        constexpr Quaternion operator /(const Quaternion& quaternion, float scalar)
+        {
+                return Quaternion(quaternion.x / scalar, quaternion.y / scalar,
+                                  quaternion.z / scalar, quaternion.w / scalar);
+        }
+
+        constexpr Quaternion operator /(const Quaternion& quaternion0, const Quaternion& quaternion1)
+        {
+                return Quaternion(quaternion0.x / quaternion1.x,
+                                  quaternion0.y / quaternion1.y,
+                                  quaternion0.z / quaternion1.z,
+                                  quaternion0.w / quaternion1.w);
+        }
 
         /**
          * @}
@@ -8,10 +8,28 @@ namespace selene
 
         Mesh::Subset::Subset():
                 vertexIndex(0), numVertices(0), faceIndex(0),
-                numFaces(0), material() {}
+                numFaces(0), material(), clusterIndex(0), numClusters(0) {}
         Mesh::Subset::~Subset() {}
 
-        Mesh::Data::Data(): faces(), subsets(), boundingBox(), skeleton() {}
+        Mesh::Cluster::Cluster():
+                center(), radius(0.0f), coneAxis(), coneCutoff(1.0f),
+                faceIndex(0), numFaces(0) {}
+        Mesh::Cluster::~Cluster() {}
+
+        //------------------------------------------------------------------
+        bool Mesh::Cluster::isBackFacing(const Vector3d& viewer) const
+        {
+                if(coneCutoff >= 1.0f)
+                        return false;
+
+                Vector3d direction = center - viewer;
+                return (direction.dot(coneAxis) >= coneCutoff * direction.length() + radius);
+        }
+
+        Mesh::FaceRange::FaceRange(): faceIndex(0), numFaces(0) {}
+        Mesh::FaceRange::~FaceRange() {}
+
+        Mesh::Data::Data(): faces(), subsets(), clusters(), boundingBox(), skeleton(), mappedFile() {}
         Mesh::Data::~Data() {}
 
         Mesh::Mesh(const char* name): Resource(name), data_() {}
@@ -4,6 +4,7 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include "../../FileManager/MappedFile.h"
 #include "../../Material/Material.h"
 #include "../ResourceManager.h"
 #include "../../Math/Box.h"
@@ -35,7 +36,8 @@ namespace selene
                 };
 
                 /**
-                 * Represents mesh subset.
+                 * Represents mesh subset. Faces of the subset may be split into clusters (see Mesh::Cluster),
+                 * in this case clusters of the subset are stored contiguously, starting from the given index.
                  */
                 class Subset
                 {
@@ -45,6 +47,8 @@ namespace selene
                         uint32_t faceIndex;
                         uint32_t numFaces;
                         std::shared_ptr<Material> material;
+                        uint32_t clusterIndex;
+                        uint32_t numClusters;
 
                         Subset();
                         Subset(const Subset&) = delete;
@@ -53,20 +57,79 @@ namespace selene
 
                 };
 
+                /**
+                 * Represents cluster of faces. Cluster is a contiguous range of faces of the subset, which is
+                 * bounded by sphere, normals of its faces are bounded by cone (with given axis and sine of the
+                 * angle, by which normals deviate from the axis). Cluster is outside the view, if its sphere is
+                 * outside the frustum, and it is back-facing, if for each point of the sphere direction from
+                 * the viewer to this point forms angle with the axis, which is less than the complement of the
+                 * angle of the cone:
+                 * \code
+                 * dot(center - viewer, coneAxis) >= coneCutoff * length(center - viewer) + radius
+                 * \endcode
+                 * Cone cutoff of one means that faces of the cluster can not be back-facing at the same time.
+                 */
+                class Cluster
+                {
+                public:
+                        Vector3d center;
+                        float radius;
+                        Vector3d coneAxis;
+                        float coneCutoff;
+                        uint32_t faceIndex;
+                        uint32_t numFaces;
+
+                        Cluster();
+                        Cluster(const Cluster&) = default;
+                        ~Cluster();
+                        Cluster& operator =(const Cluster&) = default;
+
+                        /**
+                         * \brief Returns true if cluster is back-facing.
+                         * \param[in] viewer position of the viewer (in the space of the mesh)
+                         * \return true if all faces of the cluster are back-facing
+                         */
+                        bool isBackFacing(const Vector3d& viewer) const;
+
+                };
+
+                /**
+                 * Represents range of faces.
+                 */
+                class FaceRange
+                {
+                public:
+                        uint32_t faceIndex;
+                        uint32_t numFaces;
+
+                        FaceRange();
+                        FaceRange(const FaceRange&) = default;
+                        ~FaceRange();
+                        FaceRange& operator =(const FaceRange&) = default;
+
+                };
+
                 /**
                  * Represents mesh data container. Mesh data consists of vertices, faces, subsets,
-                 * bounding box and skeleton. Vertices consist of streams, which hold specific data,
+                 * clusters, bounding box and skeleton. Vertices consist of streams, which hold specific data,
                  * such as, positions, tangent-bitangent-normal bases, texture coordinates, bone
                  * indices and weights. Subsets split mesh into submeshes with different materials.
+                 * Clusters split subsets of static meshes into small ranges of faces, which are culled
+                 * separately (clusters are optional).
+                 *
+                 * If mesh has been loaded from the mapped file, then vertices and faces may reference
+                 * contents of this file, which is held by the mesh data.
                  */
                 class Data
                 {
                 public:
                         Array<uint8_t, uint32_t> vertices[NUM_OF_VERTEX_STREAMS], faces;
                         Array<Subset, uint16_t> subsets;
+                        Array<Cluster, uint32_t> clusters;
 
                         Box boundingBox;
                         std::shared_ptr<Skeleton> skeleton;
+                        std::shared_ptr<MappedFile> mappedFile;
 
                         Data();
                         Data(const Data&) = delete;
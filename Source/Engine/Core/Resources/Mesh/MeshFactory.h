@@ -25,13 +25,27 @@ namespace selene
                  * \brief Constructs mesh factory with given file manager.
                  * \param[in] fileManager file manager
                  */
-                MeshFactory(FileManager* fileManager = nullptr): ResourceFactory(fileManager) {}
+                MeshFactory(FileManager* fileManager = nullptr):
+                        ResourceFactory(fileManager), materialRegistry_(nullptr) {}
                 ~MeshFactory() {}
 
+                /**
+                 * \brief Sets material registry.
+                 *
+                 * If material registry is set, then materials of the loaded meshes are interned in it, so
+                 * meshes with identical materials share them.
+                 * \param[in] materialRegistry material registry (can be nullptr)
+                 */
+                void setMaterialRegistry(MaterialRegistry* materialRegistry)
+                {
+                        materialRegistry_ = materialRegistry;
+                }
+
                 /**
                  * \brief Creates mesh.
                  *
-                 * Mesh data is loaded from file.
+                 * Mesh data is loaded from file. If file manager can map files into memory, then vertices
+                 * and faces of the mesh reference mapped file.
                  * \param[in] name name of the mesh (and name of the file from which mesh is loaded)
                  * \return pointer to the created mesh, or nullptr if mesh could not be created
                  */
@@ -41,11 +55,6 @@ namespace selene
                         if(name == nullptr || fileManager_ == nullptr)
                                 return nullptr;
 
-                        // open file
-                        std::unique_ptr<std::istream> stream(fileManager_->open(name));
-                        if(stream.get() == nullptr)
-                                return nullptr;
-
                         // create mesh
                         std::unique_ptr<T> resource(new(std::nothrow) T(name));
 
@@ -53,15 +62,36 @@ namespace selene
                         if(resource.get() == nullptr)
                                 return nullptr;
 
-                        // read mesh
                         MeshManager meshManager;
+
+                        // map file (if file manager supports mapping) and read mesh without copying
+                        std::shared_ptr<MappedFile> mappedFile = fileManager_->map(name);
+                        if(mappedFile)
+                        {
+                                if(meshManager.readMesh(mappedFile, resource->getData(),
+                                                        resourceManager_, resourceFactory_,
+                                                        materialRegistry_))
+                                        return resource.release();
+
+                                return nullptr;
+                        }
+
+                        // open file
+                        std::unique_ptr<std::istream> stream(fileManager_->open(name));
+                        if(stream.get() == nullptr)
+                                return nullptr;
+
+                        // read mesh
                         if(meshManager.readMesh(*stream, resource->getData(),
-                                                resourceManager_, resourceFactory_))
+                                                resourceManager_, resourceFactory_, materialRegistry_))
                                 return resource.release();
 
                         return nullptr;
                 }
 
+        private:
+                MaterialRegistry* materialRegistry_;
+
         };
 
         /**
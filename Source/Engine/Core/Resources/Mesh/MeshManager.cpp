@@ -4,10 +4,53 @@
 #include "MeshManager.h"
 #include "../../Helpers/Utility.h"
 
+#include <algorithm>
+
 namespace selene
 {
 
-        MeshManager::MeshManager(): textureManager_(nullptr), textureFactory_(nullptr)
+        MeshManager::VertexFormat::VertexFormat(uint8_t positions,
+                                                uint8_t tbnBases,
+                                                uint8_t textureCoordinates,
+                                                uint8_t boneIndicesAndWeights):
+                positions(positions), tbnBases(tbnBases), textureCoordinates(textureCoordinates),
+                boneIndicesAndWeights(boneIndicesAndWeights) {}
+        MeshManager::VertexFormat::~VertexFormat() {}
+
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::VertexFormat::isValid() const
+        {
+                if(positions != ENCODING_FLOAT32 && positions != ENCODING_FLOAT16 && positions != ENCODING_SNORM16)
+                        return false;
+
+                if(tbnBases != ENCODING_FLOAT32 && tbnBases != ENCODING_OCTAHEDRAL)
+                        return false;
+
+                if(textureCoordinates != ENCODING_FLOAT32 && textureCoordinates != ENCODING_FLOAT16 &&
+                   textureCoordinates != ENCODING_UNORM16)
+                        return false;
+
+                return (boneIndicesAndWeights == ENCODING_FLOAT32 || boneIndicesAndWeights == ENCODING_UINT8);
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        uint8_t MeshManager::VertexFormat::computeSize(bool hasBones) const
+        {
+                // position has four components, since the fourth one holds handedness of the TBN basis
+                uint8_t size = (positions == ENCODING_FLOAT32) ? 4 * sizeof(float) : 4 * sizeof(uint16_t);
+                size += (tbnBases == ENCODING_FLOAT32) ? 6 * sizeof(float) : 4 * sizeof(int16_t);
+                size += (textureCoordinates == ENCODING_FLOAT32) ? 2 * sizeof(float) : 2 * sizeof(uint16_t);
+
+                if(hasBones)
+                        size += (boneIndicesAndWeights == ENCODING_FLOAT32) ? 8 * sizeof(float) : 8 * sizeof(uint8_t);
+
+                return size;
+        }
+
+        MeshManager::MeshManager():
+                textureManager_(nullptr), textureFactory_(nullptr), materialRegistry_(nullptr), mappedFile_(nullptr),
+                numVertices_(0), numFaces_(0), numBones_(0), faceStride_(0),
+                version_(VERSION_1), flags_(0), vertexFormat_(), ranges_()
         {
                 const uint8_t vertexStreamStrides[Mesh::NUM_OF_VERTEX_STREAMS] =
                 {
@@ -28,10 +71,12 @@ namespace selene
         bool MeshManager::readMesh(std::istream& stream,
                                    Mesh::Data& meshData,
                                    ResourceManager* textureManager,
-                                   ResourceFactory* textureFactory)
+                                   ResourceFactory* textureFactory,
+                                   MaterialRegistry* materialRegistry)
         {
                 textureManager_ = textureManager;
                 textureFactory_ = textureFactory;
+                materialRegistry_ = materialRegistry;
 
                 if(!readHeader(stream, meshData))
                         return false;
@@ -49,16 +94,62 @@ namespace selene
                 {
                         if(!readBones(stream, meshData.skeleton->getBones()))
                                 return false;
+                }
 
-                        return meshData.skeleton->initialize();
+                meshData.clusters.destroy();
+                if((flags_ & FLAG_CLUSTERS) != 0 && !readClusters(stream, meshData))
+                        return false;
+
+                if(static_cast<bool>(meshData.skeleton))
+                {
+                        if(!meshData.skeleton->initialize())
+                                return false;
+
+                        // bounds of the bones are optional: without them actors use bounding box of the mesh
+                        const auto& positions = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                        const auto& bones = meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+                        meshData.skeleton->computeBoneBounds(positions, bones);
                 }
 
                 return true;
         }
 
         //--------------------------------------------------------------------------------------------------------
-        bool MeshManager::writeMesh(std::ostream& stream, const Mesh::Data& meshData)
+        bool MeshManager::readMesh(const std::shared_ptr<MappedFile>& mappedFile,
+                                   Mesh::Data& meshData,
+                                   ResourceManager* textureManager,
+                                   ResourceFactory* textureFactory,
+                                   MaterialRegistry* materialRegistry)
+        {
+                if(!mappedFile || mappedFile->getData() == nullptr)
+                        return false;
+
+                MappedFile::StreamBuffer streamBuffer(*mappedFile);
+                std::istream stream(&streamBuffer);
+
+                mappedFile_ = mappedFile.get();
+                bool result = readMesh(stream, meshData, textureManager, textureFactory, materialRegistry);
+                mappedFile_ = nullptr;
+
+                if(!result)
+                        return false;
+
+                meshData.mappedFile = mappedFile;
+                return true;
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::writeMesh(std::ostream& stream, const Mesh::Data& meshData,
+                                    const VertexFormat* vertexFormat)
         {
+                version_ = (vertexFormat != nullptr) ? VERSION_2 : VERSION_1;
+                vertexFormat_ = (vertexFormat != nullptr) ? *vertexFormat : VertexFormat();
+
+                // clusters can only be stored in version 2
+                flags_ = 0;
+                if(version_ == VERSION_2 && !meshData.clusters.isEmpty())
+                        flags_ |= FLAG_CLUSTERS;
+
                 if(!writeHeader(stream, meshData))
                         return false;
 
@@ -72,7 +163,13 @@ namespace selene
                         return false;
 
                 if(static_cast<bool>(meshData.skeleton))
-                        return writeBones(stream, meshData.skeleton->getBones());
+                {
+                        if(!writeBones(stream, meshData.skeleton->getBones()))
+                                return false;
+                }
+
+                if((flags_ & FLAG_CLUSTERS) != 0)
+                        return writeClusters(stream, meshData);
 
                 return true;
         }
@@ -80,6 +177,11 @@ namespace selene
         MeshManager::VertexStream::VertexStream(): stride(0), isPresent(false) {}
         MeshManager::VertexStream::~VertexStream() {}
 
+        MeshManager::Ranges::Ranges():
+                positionsOffset(), positionsScale(1.0f, 1.0f, 1.0f),
+                textureCoordinatesOffset(), textureCoordinatesScale(1.0f, 1.0f) {}
+        MeshManager::Ranges::~Ranges() {}
+
         //--------------------------------------------------------------------------------------------------------
         bool MeshManager::readMaterial(std::istream& stream, Material& material)
         {
@@ -118,7 +220,9 @@ namespace selene
 
                                 if(*material.getTextureMap(j) == nullptr && textureFactory_ != nullptr)
                                 {
-                                        if(textureManager_->createResource(fileName, *textureFactory_) == SUCCESS)
+                                        // texture might be created by another worker at the same time
+                                        RESULT result = textureManager_->createResource(fileName, *textureFactory_);
+                                        if(result == SUCCESS || result == RESOURCE_ALREADY_EXISTS)
                                         {
                                                 auto textureMap =
                                                         textureManager_->requestResource<Texture>(fileName);
@@ -150,29 +254,66 @@ namespace selene
                 uint8_t  faceStride  = 0;
 
                 stream.read(reinterpret_cast<char*>(&numVertices), sizeof(uint32_t));
-                stream.read(reinterpret_cast<char*>(&numFaces),    sizeof(uint32_t));
+
+                // zero number of vertices marks version 2 (so readers of version 1 reject such files)
+                version_ = VERSION_1;
+                flags_ = 0;
+                if(numVertices == 0)
+                {
+                        uint32_t version = 0;
+                        stream.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+
+                        if(version != VERSION_2)
+                                return false;
+
+                        version_ = VERSION_2;
+                        stream.read(reinterpret_cast<char*>(&numVertices), sizeof(uint32_t));
+                }
+
+                stream.read(reinterpret_cast<char*>(&numFaces), sizeof(uint32_t));
 
                 stream.read(reinterpret_cast<char*>(&numSubsets), sizeof(uint16_t));
                 stream.read(reinterpret_cast<char*>(&numBones),   sizeof(uint16_t));
 
                 stream.read(reinterpret_cast<char*>(&faceStride), sizeof(uint8_t));
 
-                if(faceStride != 2 && faceStride != 4)
-                        return false;
-
-                vertexStreams_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS].isPresent = (numBones > 0);
-                for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
+                if(version_ == VERSION_2)
                 {
-                        if(!vertexStreams_[i].isPresent)
-                                continue;
+                        uint8_t reserved[2];
 
-                        if(!meshData.vertices[i].create(numVertices, vertexStreams_[i].stride))
+                        stream.read(reinterpret_cast<char*>(&vertexFormat_.positions),             sizeof(uint8_t));
+                        stream.read(reinterpret_cast<char*>(&vertexFormat_.tbnBases),              sizeof(uint8_t));
+                        stream.read(reinterpret_cast<char*>(&vertexFormat_.textureCoordinates),    sizeof(uint8_t));
+                        stream.read(reinterpret_cast<char*>(&vertexFormat_.boneIndicesAndWeights), sizeof(uint8_t));
+                        stream.read(reinterpret_cast<char*>(&flags_), sizeof(uint8_t));
+                        stream.read(reinterpret_cast<char*>(reserved), sizeof(reserved));
+
+                        if(!vertexFormat_.isValid() || (flags_ & ~FLAG_CLUSTERS) != 0)
+                                return false;
+
+                        stream.read(reinterpret_cast<char*>(&ranges_.positionsOffset), sizeof(Vector3d));
+                        stream.read(reinterpret_cast<char*>(&ranges_.positionsScale),  sizeof(Vector3d));
+
+                        stream.read(reinterpret_cast<char*>(&ranges_.textureCoordinatesOffset), sizeof(Vector2d));
+                        stream.read(reinterpret_cast<char*>(&ranges_.textureCoordinatesScale),  sizeof(Vector2d));
+
+                        if(!stream.good())
                                 return false;
                 }
 
-                if(!meshData.faces.create(numFaces, faceStride, 3))
+                if(faceStride != 2 && faceStride != 4)
+                        return false;
+
+                if(numVertices == 0 || numFaces == 0)
                         return false;
 
+                // vertices and faces are created when they are read
+                vertexStreams_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS].isPresent = (numBones > 0);
+                numVertices_ = numVertices;
+                numFaces_ = numFaces;
+                numBones_ = numBones;
+                faceStride_ = faceStride;
+
                 if(!meshData.subsets.create(numSubsets))
                         return false;
 
@@ -211,18 +352,28 @@ namespace selene
                 if(!stream.good())
                         return false;
 
-                for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
+                if(version_ == VERSION_2)
                 {
-                        if(!vertexStreams_[i].isPresent)
-                                continue;
+                        if(!readInterleavedVertices(stream, meshData))
+                                return false;
+                }
+                else
+                {
+                        for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
+                        {
+                                if(!vertexStreams_[i].isPresent)
+                                {
+                                        meshData.vertices[i].destroy();
+                                        continue;
+                                }
 
-                        auto& vertexStream = meshData.vertices[i];
-                        stream.read(reinterpret_cast<char*>(&vertexStream[0]),
-                                    vertexStream.getSize() * vertexStream.getStride());
+                                if(!readArray(stream, meshData.vertices[i], numVertices_, vertexStreams_[i].stride))
+                                        return false;
+                        }
                 }
 
-                stream.read(reinterpret_cast<char*>(&meshData.faces[0]),
-                            3 * meshData.faces.getSize() * meshData.faces.getStride());
+                if(!readArray(stream, meshData.faces, numFaces_, faceStride_, 3))
+                        return false;
 
                 auto numVertices = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS].getSize();
                 if(meshData.faces.getStride() == 2)
@@ -247,6 +398,71 @@ namespace selene
                 return true;
         }
 
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::readInterleavedVertices(std::istream& stream, Mesh::Data& meshData)
+        {
+                bool hasBones = vertexStreams_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS].isPresent;
+                uint8_t vertexSize = vertexFormat_.computeSize(hasBones);
+
+                if(hasBones && vertexFormat_.boneIndicesAndWeights == ENCODING_UINT8 && numBones_ > 256)
+                        return false;
+
+                // encoded vertices reference contents of the mapped file, if possible
+                Array<uint8_t, uint32_t> vertices;
+                if(!readArray(stream, vertices, numVertices_, vertexSize))
+                        return false;
+
+                for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
+                {
+                        if(!vertexStreams_[i].isPresent)
+                        {
+                                meshData.vertices[i].destroy();
+                                continue;
+                        }
+
+                        if(!meshData.vertices[i].create(numVertices_, vertexStreams_[i].stride))
+                                return false;
+                }
+
+                for(uint32_t i = 0; i < numVertices_; ++i)
+                {
+                        if(!decodeVertex(&vertices[static_cast<size_t>(i) * vertexSize], meshData, i))
+                                return false;
+                }
+
+                return true;
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::readArray(std::istream& stream, Array<uint8_t, uint32_t>& array,
+                                    uint32_t size, uint8_t stride, uint32_t sizeModifier)
+        {
+                uint64_t numBytes = static_cast<uint64_t>(size) * stride * sizeModifier;
+
+                if(mappedFile_ != nullptr)
+                {
+                        std::streamoff offset = stream.tellg();
+                        if(offset < 0 || static_cast<uint64_t>(offset) + numBytes > mappedFile_->getSize())
+                                return false;
+
+                        // elements of the vertex streams are floats, so only four-byte alignment matters
+                        uint8_t* data = mappedFile_->getData() + offset;
+                        uint8_t alignment = (stride % 4 == 0) ? 4 : stride;
+
+                        if((reinterpret_cast<uintptr_t>(data) % alignment) == 0)
+                        {
+                                stream.seekg(static_cast<std::streamoff>(numBytes), std::ios_base::cur);
+                                return array.reference(data, size, stride, sizeModifier);
+                        }
+                }
+
+                if(numBytes > 0xFFFFFFFFU || !array.create(size, stride, sizeModifier))
+                        return false;
+
+                stream.read(reinterpret_cast<char*>(&array[0]), static_cast<std::streamsize>(numBytes));
+                return stream.good();
+        }
+
         //--------------------------------------------------------------------------------------------------------
         bool MeshManager::readSubsets(std::istream& stream, Mesh::Data& meshData)
         {
@@ -265,6 +481,10 @@ namespace selene
                         if(!readMaterial(stream, *meshData.subsets[i].material))
                                 return false;
 
+                        // identical materials are shared, so renderer groups their subsets together
+                        if(materialRegistry_ != nullptr)
+                                meshData.subsets[i].material = materialRegistry_->intern(meshData.subsets[i].material);
+
                         stream.read(reinterpret_cast<char*>(&meshData.subsets[i].vertexIndex),
                                     4 * sizeof(uint32_t));
 
@@ -281,6 +501,62 @@ namespace selene
                 return true;
         }
 
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::readClusters(std::istream& stream, Mesh::Data& meshData)
+        {
+                if(!stream.good())
+                        return false;
+
+                uint32_t numClusters = 0;
+                stream.read(reinterpret_cast<char*>(&numClusters), sizeof(uint32_t));
+
+                if(numClusters == 0 || !meshData.clusters.create(numClusters))
+                        return false;
+
+                for(uint16_t i = 0; i < meshData.subsets.getSize(); ++i)
+                {
+                        Mesh::Subset& subset = meshData.subsets[i];
+
+                        stream.read(reinterpret_cast<char*>(&subset.clusterIndex), sizeof(uint32_t));
+                        stream.read(reinterpret_cast<char*>(&subset.numClusters),  sizeof(uint32_t));
+
+                        if(subset.clusterIndex > numClusters || subset.numClusters > numClusters - subset.clusterIndex)
+                                return false;
+                }
+
+                for(uint32_t i = 0; i < numClusters; ++i)
+                {
+                        Mesh::Cluster& cluster = meshData.clusters[i];
+
+                        stream.read(reinterpret_cast<char*>(&cluster.center),     sizeof(Vector3d));
+                        stream.read(reinterpret_cast<char*>(&cluster.radius),     sizeof(float));
+                        stream.read(reinterpret_cast<char*>(&cluster.coneAxis),   sizeof(Vector3d));
+                        stream.read(reinterpret_cast<char*>(&cluster.coneCutoff), sizeof(float));
+                        stream.read(reinterpret_cast<char*>(&cluster.faceIndex),  sizeof(uint32_t));
+                        stream.read(reinterpret_cast<char*>(&cluster.numFaces),   sizeof(uint32_t));
+                }
+
+                if(!stream.good())
+                        return false;
+
+                // faces of the clusters must belong to their subsets
+                for(uint16_t i = 0; i < meshData.subsets.getSize(); ++i)
+                {
+                        const Mesh::Subset& subset = meshData.subsets[i];
+
+                        for(uint32_t j = subset.clusterIndex; j < subset.clusterIndex + subset.numClusters; ++j)
+                        {
+                                const Mesh::Cluster& cluster = meshData.clusters[j];
+
+                                if(cluster.numFaces == 0 || cluster.faceIndex < subset.faceIndex ||
+                                   cluster.faceIndex + cluster.numFaces > subset.faceIndex + subset.numFaces)
+                                        return false;
+                        }
+                }
+
+                return true;
+        }
+
         //--------------------------------------------------------------------------------------------------------
         bool MeshManager::readBones(std::istream& stream, Array<Skeleton::Bone, uint16_t>& bones)
         {
@@ -364,6 +640,9 @@ namespace selene
 
                 stream.write("SDMF", 4);
 
+                if(version_ == VERSION_2 && !vertexFormat_.isValid())
+                        return false;
+
                 vertexStreams_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS].isPresent =
                         static_cast<bool>(meshData.skeleton);
                 for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
@@ -396,6 +675,16 @@ namespace selene
                         numBones = bones.getSize();
                 }
 
+                if(version_ == VERSION_2)
+                {
+                        if(vertexFormat_.boneIndicesAndWeights == ENCODING_UINT8 && numBones > 256)
+                                return false;
+
+                        uint32_t marker = 0, version = VERSION_2;
+                        stream.write(reinterpret_cast<char*>(&marker),  sizeof(uint32_t));
+                        stream.write(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+                }
+
                 stream.write(reinterpret_cast<char*>(&numVertices), sizeof(uint32_t));
                 stream.write(reinterpret_cast<char*>(&numFaces),    sizeof(uint32_t));
 
@@ -404,7 +693,28 @@ namespace selene
 
                 stream.write(reinterpret_cast<char*>(&faceStride), sizeof(uint8_t));
 
-                return true;
+                if(version_ == VERSION_2)
+                {
+                        uint8_t reserved[2] = {0, 0};
+
+                        stream.write(reinterpret_cast<char*>(&vertexFormat_.positions),             sizeof(uint8_t));
+                        stream.write(reinterpret_cast<char*>(&vertexFormat_.tbnBases),              sizeof(uint8_t));
+                        stream.write(reinterpret_cast<char*>(&vertexFormat_.textureCoordinates),    sizeof(uint8_t));
+                        stream.write(reinterpret_cast<char*>(&vertexFormat_.boneIndicesAndWeights), sizeof(uint8_t));
+                        stream.write(reinterpret_cast<char*>(&flags_), sizeof(uint8_t));
+                        stream.write(reinterpret_cast<char*>(reserved), sizeof(reserved));
+
+                        numBones_ = numBones;
+                        computeRanges(meshData);
+
+                        stream.write(reinterpret_cast<char*>(&ranges_.positionsOffset), sizeof(Vector3d));
+                        stream.write(reinterpret_cast<char*>(&ranges_.positionsScale),  sizeof(Vector3d));
+
+                        stream.write(reinterpret_cast<char*>(&ranges_.textureCoordinatesOffset), sizeof(Vector2d));
+                        stream.write(reinterpret_cast<char*>(&ranges_.textureCoordinatesScale),  sizeof(Vector2d));
+                }
+
+                return stream.good();
         }
 
         //--------------------------------------------------------------------------------------------------------
@@ -424,18 +734,391 @@ namespace selene
                 if(!stream.good())
                         return false;
 
+                if(version_ == VERSION_2)
+                {
+                        if(!writeInterleavedVertices(stream, meshData))
+                                return false;
+                }
+                else
+                {
+                        for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
+                        {
+                                if(!vertexStreams_[i].isPresent)
+                                        continue;
+
+                                auto& vertexStream = meshData.vertices[i];
+                                stream.write(reinterpret_cast<const char*>(&vertexStream[0]),
+                                             vertexStream.getSize() * vertexStream.getStride());
+                        }
+                }
+
+                stream.write(reinterpret_cast<const char*>(&meshData.faces[0]),
+                             3 * meshData.faces.getSize() * meshData.faces.getStride());
+
+                return true;
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::writeInterleavedVertices(std::ostream& stream, const Mesh::Data& meshData)
+        {
+                bool hasBones = vertexStreams_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS].isPresent;
+                uint32_t numVertices = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS].getSize();
+
+                // vertex streams must have the same layout, as streams of the mesh, which has been read
                 for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
                 {
                         if(!vertexStreams_[i].isPresent)
                                 continue;
 
-                        auto& vertexStream = meshData.vertices[i];
-                        stream.write(reinterpret_cast<const char*>(&vertexStream[0]),
-                                     vertexStream.getSize() * vertexStream.getStride());
+                        if(meshData.vertices[i].getStride() != vertexStreams_[i].stride ||
+                           meshData.vertices[i].getSize() != numVertices)
+                                return false;
                 }
 
-                stream.write(reinterpret_cast<const char*>(&meshData.faces[0]),
-                             3 * meshData.faces.getSize() * meshData.faces.getStride());
+                // vertices are encoded in blocks, so whole encoded mesh is not held in memory
+                const uint32_t maxNumVerticesInBlock = 4096;
+                uint8_t vertexSize = vertexFormat_.computeSize(hasBones);
+
+                Array<uint8_t, uint32_t> block;
+                if(!block.create(std::min(numVertices, maxNumVerticesInBlock), vertexSize))
+                        return false;
+
+                for(uint32_t first = 0; first < numVertices; first += maxNumVerticesInBlock)
+                {
+                        uint32_t numVerticesInBlock = std::min(numVertices - first, maxNumVerticesInBlock);
+
+                        for(uint32_t i = 0; i < numVerticesInBlock; ++i)
+                        {
+                                if(!encodeVertex(meshData, first + i, &block[static_cast<size_t>(i) * vertexSize]))
+                                        return false;
+                        }
+
+                        stream.write(reinterpret_cast<const char*>(&block[0]),
+                                     static_cast<std::streamsize>(numVerticesInBlock) * vertexSize);
+                }
+
+                return stream.good();
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        void MeshManager::computeRanges(const Mesh::Data& meshData)
+        {
+                ranges_ = Ranges();
+
+                const auto& positions          = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                const auto& textureCoordinates = meshData.vertices[Mesh::VERTEX_STREAM_TEXTURE_COORDINATES];
+
+                // quantized positions are relative to the bounding box of the vertices
+                if(vertexFormat_.positions != ENCODING_FLOAT32 && !positions.isEmpty())
+                {
+                        Vector3d minimum = *reinterpret_cast<const Vector3d*>(&positions[0]);
+                        Vector3d maximum = minimum;
+
+                        for(uint32_t i = 1; i < positions.getSize(); ++i)
+                        {
+                                const Vector3d& position =
+                                        *reinterpret_cast<const Vector3d*>(&positions[i * positions.getStride()]);
+
+                                minimum.define(std::min(minimum.x, position.x), std::min(minimum.y, position.y),
+                                               std::min(minimum.z, position.z));
+                                maximum.define(std::max(maximum.x, position.x), std::max(maximum.y, position.y),
+                                               std::max(maximum.z, position.z));
+                        }
+
+                        ranges_.positionsOffset = 0.5f * (minimum + maximum);
+                        ranges_.positionsScale  = 0.5f * (maximum - minimum);
+
+                        float* scale = &ranges_.positionsScale.x;
+                        for(uint8_t i = 0; i < 3; ++i)
+                        {
+                                if(scale[i] <= 0.0f)
+                                        scale[i] = 1.0f;
+                        }
+                }
+
+                // unorm16 texture coordinates are relative to the rectangle, which contains them
+                if(vertexFormat_.textureCoordinates == ENCODING_UNORM16 && !textureCoordinates.isEmpty())
+                {
+                        Vector2d minimum = *reinterpret_cast<const Vector2d*>(&textureCoordinates[0]);
+                        Vector2d maximum = minimum;
+
+                        for(uint32_t i = 1; i < textureCoordinates.getSize(); ++i)
+                        {
+                                const Vector2d& textureCoordinate = *reinterpret_cast<const Vector2d*>(
+                                        &textureCoordinates[i * textureCoordinates.getStride()]);
+
+                                minimum.define(std::min(minimum.x, textureCoordinate.x),
+                                               std::min(minimum.y, textureCoordinate.y));
+                                maximum.define(std::max(maximum.x, textureCoordinate.x),
+                                               std::max(maximum.y, textureCoordinate.y));
+                        }
+
+                        ranges_.textureCoordinatesOffset = minimum;
+                        ranges_.textureCoordinatesScale  = maximum - minimum;
+
+                        float* scale = &ranges_.textureCoordinatesScale.x;
+                        for(uint8_t i = 0; i < 2; ++i)
+                        {
+                                if(scale[i] <= 0.0f)
+                                        scale[i] = 1.0f;
+                        }
+                }
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::decodeVertex(const uint8_t* source, Mesh::Data& meshData, uint32_t vertexIndex) const
+        {
+                auto& positions          = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                auto& tbnBases           = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                auto& textureCoordinates = meshData.vertices[Mesh::VERTEX_STREAM_TEXTURE_COORDINATES];
+
+                Vector3d& position = *reinterpret_cast<Vector3d*>(&positions[vertexIndex * positions.getStride()]);
+                uint8_t* tbnBasis = &tbnBases[vertexIndex * tbnBases.getStride()];
+
+                Vector3d& normal  = *reinterpret_cast<Vector3d*>(tbnBasis);
+                Vector4d& tangent = *reinterpret_cast<Vector4d*>(tbnBasis + sizeof(Vector3d));
+
+                Vector2d& textureCoordinate = *reinterpret_cast<Vector2d*>(
+                        &textureCoordinates[vertexIndex * textureCoordinates.getStride()]);
+
+                // decode position
+                float components[4];
+                if(vertexFormat_.positions == ENCODING_FLOAT32)
+                {
+                        std::memcpy(components, source, sizeof(components));
+                        source += 4 * sizeof(float);
+                }
+                else
+                {
+                        const uint16_t* encodedPosition = reinterpret_cast<const uint16_t*>(source);
+                        for(uint8_t i = 0; i < 4; ++i)
+                        {
+                                if(vertexFormat_.positions == ENCODING_FLOAT16)
+                                        components[i] = decodeHalf(encodedPosition[i]);
+                                else
+                                        components[i] = decodeSnorm16(static_cast<int16_t>(encodedPosition[i]));
+                        }
+
+                        source += 4 * sizeof(uint16_t);
+                }
+
+                const Vector3d& positionsOffset = ranges_.positionsOffset;
+                const Vector3d& positionsScale  = ranges_.positionsScale;
+
+                position.define(positionsOffset.x + positionsScale.x * components[0],
+                                positionsOffset.y + positionsScale.y * components[1],
+                                positionsOffset.z + positionsScale.z * components[2]);
+                float handedness = (components[3] < 0.0f) ? -1.0f : 1.0f;
+
+                // decode TBN basis
+                if(vertexFormat_.tbnBases == ENCODING_FLOAT32)
+                {
+                        float vectors[6];
+                        std::memcpy(vectors, source, sizeof(vectors));
+                        source += 6 * sizeof(float);
+
+                        normal.define(vectors[0], vectors[1], vectors[2]);
+                        tangent.define(Vector3d(vectors[3], vectors[4], vectors[5]), handedness);
+                }
+                else
+                {
+                        const int16_t* encodedVectors = reinterpret_cast<const int16_t*>(source);
+                        source += 4 * sizeof(int16_t);
+
+                        normal = decodeOctahedral(encodedVectors);
+                        tangent.define(decodeOctahedral(encodedVectors + 2), handedness);
+                }
+
+                // decode texture coordinates
+                if(vertexFormat_.textureCoordinates == ENCODING_FLOAT32)
+                {
+                        std::memcpy(components, source, 2 * sizeof(float));
+                        source += 2 * sizeof(float);
+                }
+                else
+                {
+                        const uint16_t* encodedTextureCoordinate = reinterpret_cast<const uint16_t*>(source);
+                        for(uint8_t i = 0; i < 2; ++i)
+                        {
+                                if(vertexFormat_.textureCoordinates == ENCODING_FLOAT16)
+                                        components[i] = decodeHalf(encodedTextureCoordinate[i]);
+                                else
+                                        components[i] = static_cast<float>(encodedTextureCoordinate[i]) / 65535.0f;
+                        }
+
+                        source += 2 * sizeof(uint16_t);
+                }
+
+                const Vector2d& textureCoordinatesOffset = ranges_.textureCoordinatesOffset;
+                const Vector2d& textureCoordinatesScale  = ranges_.textureCoordinatesScale;
+
+                textureCoordinate.define(textureCoordinatesOffset.x + textureCoordinatesScale.x * components[0],
+                                         textureCoordinatesOffset.y + textureCoordinatesScale.y * components[1]);
+
+                // decode bone indices and weights
+                if(!vertexStreams_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS].isPresent)
+                        return true;
+
+                auto& bones = meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+                float* boneIndicesAndWeights = reinterpret_cast<float*>(&bones[vertexIndex * bones.getStride()]);
+
+                if(vertexFormat_.boneIndicesAndWeights == ENCODING_FLOAT32)
+                        std::memcpy(boneIndicesAndWeights, source, 8 * sizeof(float));
+                else
+                {
+                        for(uint8_t i = 0; i < 4; ++i)
+                        {
+                                boneIndicesAndWeights[i]     = static_cast<float>(source[i]);
+                                boneIndicesAndWeights[i + 4] = static_cast<float>(source[i + 4]) / 255.0f;
+                        }
+                }
+
+                for(uint8_t i = 0; i < 4; ++i)
+                {
+                        if(boneIndicesAndWeights[i] < 0.0f || boneIndicesAndWeights[i] >= numBones_)
+                                return false;
+                }
+
+                return true;
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::encodeVertex(const Mesh::Data& meshData, uint32_t vertexIndex, uint8_t* destination) const
+        {
+                const auto& positions          = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                const auto& tbnBases           = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                const auto& textureCoordinates = meshData.vertices[Mesh::VERTEX_STREAM_TEXTURE_COORDINATES];
+
+                const Vector3d& position =
+                        *reinterpret_cast<const Vector3d*>(&positions[vertexIndex * positions.getStride()]);
+                const uint8_t* tbnBasis = &tbnBases[vertexIndex * tbnBases.getStride()];
+
+                const Vector3d& normal  = *reinterpret_cast<const Vector3d*>(tbnBasis);
+                const Vector4d& tangent = *reinterpret_cast<const Vector4d*>(tbnBasis + sizeof(Vector3d));
+
+                const Vector2d& textureCoordinate = *reinterpret_cast<const Vector2d*>(
+                        &textureCoordinates[vertexIndex * textureCoordinates.getStride()]);
+
+                // encode position (the fourth component holds handedness of the TBN basis)
+                const Vector3d& positionsOffset = ranges_.positionsOffset;
+                const Vector3d& positionsScale  = ranges_.positionsScale;
+
+                float components[4] =
+                {
+                        (position.x - positionsOffset.x) / positionsScale.x,
+                        (position.y - positionsOffset.y) / positionsScale.y,
+                        (position.z - positionsOffset.z) / positionsScale.z,
+                        (tangent.w < 0.0f) ? -1.0f : 1.0f
+                };
+
+                if(vertexFormat_.positions == ENCODING_FLOAT32)
+                {
+                        std::memcpy(destination, components, sizeof(components));
+                        destination += 4 * sizeof(float);
+                }
+                else
+                {
+                        uint16_t* encodedPosition = reinterpret_cast<uint16_t*>(destination);
+                        for(uint8_t i = 0; i < 4; ++i)
+                        {
+                                if(vertexFormat_.positions == ENCODING_FLOAT16)
+                                        encodedPosition[i] = encodeHalf(components[i]);
+                                else
+                                        encodedPosition[i] = static_cast<uint16_t>(encodeSnorm16(components[i]));
+                        }
+
+                        destination += 4 * sizeof(uint16_t);
+                }
+
+                // encode TBN basis
+                if(vertexFormat_.tbnBases == ENCODING_FLOAT32)
+                {
+                        float vectors[6] = {normal.x, normal.y, normal.z, tangent.x, tangent.y, tangent.z};
+                        std::memcpy(destination, vectors, sizeof(vectors));
+                        destination += 6 * sizeof(float);
+                }
+                else
+                {
+                        int16_t* encodedVectors = reinterpret_cast<int16_t*>(destination);
+                        encodeOctahedral(normal, encodedVectors);
+                        encodeOctahedral(Vector3d(tangent.x, tangent.y, tangent.z), encodedVectors + 2);
+                        destination += 4 * sizeof(int16_t);
+                }
+
+                // encode texture coordinates
+                const Vector2d& textureCoordinatesOffset = ranges_.textureCoordinatesOffset;
+                const Vector2d& textureCoordinatesScale  = ranges_.textureCoordinatesScale;
+
+                components[0] = (textureCoordinate.x - textureCoordinatesOffset.x) / textureCoordinatesScale.x;
+                components[1] = (textureCoordinate.y - textureCoordinatesOffset.y) / textureCoordinatesScale.y;
+
+                if(vertexFormat_.textureCoordinates == ENCODING_FLOAT32)
+                {
+                        std::memcpy(destination, components, 2 * sizeof(float));
+                        destination += 2 * sizeof(float);
+                }
+                else
+                {
+                        uint16_t* encodedTextureCoordinate = reinterpret_cast<uint16_t*>(destination);
+                        for(uint8_t i = 0; i < 2; ++i)
+                        {
+                                if(vertexFormat_.textureCoordinates == ENCODING_FLOAT16)
+                                        encodedTextureCoordinate[i] = encodeHalf(components[i]);
+                                else
+                                {
+                                        float value = std::max(std::min(components[i], 1.0f), 0.0f);
+                                        encodedTextureCoordinate[i] = static_cast<uint16_t>(value * 65535.0f + 0.5f);
+                                }
+                        }
+
+                        destination += 2 * sizeof(uint16_t);
+                }
+
+                // encode bone indices and weights
+                if(!vertexStreams_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS].isPresent)
+                        return true;
+
+                const auto& bones = meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+                const float* boneIndicesAndWeights =
+                        reinterpret_cast<const float*>(&bones[vertexIndex * bones.getStride()]);
+
+                for(uint8_t i = 0; i < 4; ++i)
+                {
+                        if(boneIndicesAndWeights[i] < 0.0f || boneIndicesAndWeights[i] >= numBones_)
+                                return false;
+                }
+
+                if(vertexFormat_.boneIndicesAndWeights == ENCODING_FLOAT32)
+                {
+                        std::memcpy(destination, boneIndicesAndWeights, 8 * sizeof(float));
+                        return true;
+                }
+
+                // quantized weights are corrected, so that their sum is preserved
+                int32_t weights[4], sum = 0;
+                float weightsSum = 0.0f;
+                uint8_t largestWeight = 0;
+
+                for(uint8_t i = 0; i < 4; ++i)
+                {
+                        float weight = std::max(std::min(boneIndicesAndWeights[i + 4], 1.0f), 0.0f);
+
+                        weights[i] = static_cast<int32_t>(weight * 255.0f + 0.5f);
+                        sum += weights[i];
+                        weightsSum += weight;
+
+                        if(weight > boneIndicesAndWeights[largestWeight + 4])
+                                largestWeight = i;
+                }
+
+                int32_t expectedSum = static_cast<int32_t>(std::min(weightsSum, 1.0f) * 255.0f + 0.5f);
+                weights[largestWeight] = std::max(std::min(weights[largestWeight] + expectedSum - sum, 255), 0);
+
+                for(uint8_t i = 0; i < 4; ++i)
+                {
+                        destination[i]     = static_cast<uint8_t>(boneIndicesAndWeights[i] + 0.5f);
+                        destination[i + 4] = static_cast<uint8_t>(weights[i]);
+                }
 
                 return true;
         }
@@ -461,6 +1144,41 @@ namespace selene
                 return true;
         }
 
+        //--------------------------------------------------------------------------------------------------------
+        bool MeshManager::writeClusters(std::ostream& stream, const Mesh::Data& meshData)
+        {
+                if(!stream.good())
+                        return false;
+
+                uint32_t numClusters = meshData.clusters.getSize();
+                stream.write(reinterpret_cast<const char*>(&numClusters), sizeof(uint32_t));
+
+                for(uint16_t i = 0; i < meshData.subsets.getSize(); ++i)
+                {
+                        const Mesh::Subset& subset = meshData.subsets[i];
+
+                        if(subset.clusterIndex > numClusters || subset.numClusters > numClusters - subset.clusterIndex)
+                                return false;
+
+                        stream.write(reinterpret_cast<const char*>(&subset.clusterIndex), sizeof(uint32_t));
+                        stream.write(reinterpret_cast<const char*>(&subset.numClusters),  sizeof(uint32_t));
+                }
+
+                for(uint32_t i = 0; i < numClusters; ++i)
+                {
+                        const Mesh::Cluster& cluster = meshData.clusters[i];
+
+                        stream.write(reinterpret_cast<const char*>(&cluster.center),     sizeof(Vector3d));
+                        stream.write(reinterpret_cast<const char*>(&cluster.radius),     sizeof(float));
+                        stream.write(reinterpret_cast<const char*>(&cluster.coneAxis),   sizeof(Vector3d));
+                        stream.write(reinterpret_cast<const char*>(&cluster.coneCutoff), sizeof(float));
+                        stream.write(reinterpret_cast<const char*>(&cluster.faceIndex),  sizeof(uint32_t));
+                        stream.write(reinterpret_cast<const char*>(&cluster.numFaces),   sizeof(uint32_t));
+                }
+
+                return stream.good();
+        }
+
         //--------------------------------------------------------------------------------------------------------
         bool MeshManager::writeBones(std::ostream& stream, const Array<Skeleton::Bone, uint16_t>& bones)
         {
@@ -484,4 +1202,130 @@ namespace selene
                 return true;
         }
 
+        //--------------------------------------------------------------------------------------------------------
+        uint16_t MeshManager::encodeHalf(float value)
+        {
+                uint32_t bits = 0;
+                std::memcpy(&bits, &value, sizeof(float));
+
+                uint32_t sign = (bits >> 16) & 0x8000;
+                uint32_t mantissa = bits & 0x7FFFFF;
+                int32_t floatExponent = static_cast<int32_t>((bits >> 23) & 0xFF);
+                int32_t exponent = floatExponent - 127 + 15;
+
+                // infinity and NaN
+                if(floatExponent == 0xFF)
+                        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+
+                // overflow
+                if(exponent >= 31)
+                        return static_cast<uint16_t>(sign | 0x7C00);
+
+                // denormalized half float (or zero)
+                if(exponent <= 0)
+                {
+                        if(exponent < -10)
+                                return static_cast<uint16_t>(sign);
+
+                        mantissa |= 0x800000;
+
+                        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+                        uint32_t result = mantissa >> shift;
+                        uint32_t remainder = mantissa & ((1U << shift) - 1);
+                        uint32_t halfway = 1U << (shift - 1);
+
+                        if(remainder > halfway || (remainder == halfway && (result & 1) != 0))
+                                ++result;
+
+                        return static_cast<uint16_t>(sign | result);
+                }
+
+                // round to nearest even (carry into exponent is correct)
+                uint32_t result = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+                uint32_t remainder = mantissa & 0x1FFF;
+
+                if(remainder > 0x1000 || (remainder == 0x1000 && (result & 1) != 0))
+                        ++result;
+
+                return static_cast<uint16_t>(sign | result);
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        float MeshManager::decodeHalf(uint16_t value)
+        {
+                uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+                uint32_t exponent = (value >> 10) & 0x1F;
+                uint32_t mantissa = value & 0x3FF;
+                uint32_t bits = 0;
+
+                if(exponent == 0)
+                {
+                        // zero or denormalized half float
+                        float result = std::ldexp(static_cast<float>(mantissa), -24);
+                        return (sign != 0) ? -result : result;
+                }
+                else if(exponent == 31)
+                        bits = sign | 0x7F800000 | (mantissa << 13);
+                else
+                        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+                float result = 0.0f;
+                std::memcpy(&result, &bits, sizeof(float));
+                return result;
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        int16_t MeshManager::encodeSnorm16(float value)
+        {
+                value = std::max(std::min(value, 1.0f), -1.0f);
+                return static_cast<int16_t>(std::floor(value * 32767.0f + 0.5f));
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        float MeshManager::decodeSnorm16(int16_t value)
+        {
+                return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        void MeshManager::encodeOctahedral(const Vector3d& vector, int16_t* result)
+        {
+                float sum = std::fabs(vector.x) + std::fabs(vector.y) + std::fabs(vector.z);
+                if(sum == 0.0f)
+                {
+                        result[0] = result[1] = 0;
+                        return;
+                }
+
+                // project onto octahedron, lower hemisphere is folded over the diagonals
+                float u = vector.x / sum, v = vector.y / sum;
+                if(vector.z < 0.0f)
+                {
+                        float foldedU = (1.0f - std::fabs(v)) * ((u >= 0.0f) ? 1.0f : -1.0f);
+                        float foldedV = (1.0f - std::fabs(u)) * ((v >= 0.0f) ? 1.0f : -1.0f);
+
+                        u = foldedU;
+                        v = foldedV;
+                }
+
+                result[0] = encodeSnorm16(u);
+                result[1] = encodeSnorm16(v);
+        }
+
+        //--------------------------------------------------------------------------------------------------------
+        Vector3d MeshManager::decodeOctahedral(const int16_t* source)
+        {
+                float u = decodeSnorm16(source[0]), v = decodeSnorm16(source[1]);
+                Vector3d result(u, v, 1.0f - std::fabs(u) - std::fabs(v));
+
+                if(result.z < 0.0f)
+                {
+                        result.x = (1.0f - std::fabs(v)) * ((u >= 0.0f) ? 1.0f : -1.0f);
+                        result.y = (1.0f - std::fabs(u)) * ((v >= 0.0f) ? 1.0f : -1.0f);
+                }
+
+                result.normalize();
+                return result;
+        }
+
 }
@@ -6,6 +6,8 @@
 
 #include "Mesh.h"
 
+#include "../../Material/MaterialRegistry.h"
+
 namespace selene
 {
 
@@ -16,10 +18,108 @@ namespace selene
 
         /**
          * Represents mesh manager. Reads/writes meshes from/to istream/ostream.
+         *
+         * Meshes are stored in SDMF. Version 1 holds vertex streams of the mesh as-is (32-bit floats), so they
+         * are referenced without copying, when mesh is read from the mapped file. Version 2 holds quantized
+         * vertices in the single interleaved stream:
+         * \code
+         * Header              ("SDMF", zero (number of vertices in version 1), version, number of vertices,
+         *                     number of faces, number of subsets, number of bones, face stride, vertex format,
+         *                     flags, two reserved bytes)
+         * Ranges              (offset and scale of the positions, offset and scale of the texture coordinates)
+         * Bounding box        (Vector3d[8])
+         * Vertices            (interleaved vertices, attributes are encoded as specified by the vertex format)
+         * Faces, subsets, bones (the same as in version 1)
+         * Clusters            (if FLAG_CLUSTERS is set: number of clusters, index of the first cluster and
+         *                     number of clusters of each subset, clusters, see Mesh::Cluster)
+         * \endcode
+         * Clusters are placed at the end of the file, so readers, which do not know about them, still read
+         * the rest of the mesh.
+         * Each interleaved vertex consists of position (fourth component holds handedness of the TBN basis),
+         * normal and tangent, texture coordinates, bone indices and weights (if mesh has skeleton). Positions
+         * and texture coordinates, which are encoded as normalized integers (or half floats, in case of
+         * positions), are relative to the ranges, which are computed when mesh is written. Size of the vertex
+         * is a multiple of four bytes, so faces are aligned and referenced from the mapped file as in
+         * version 1.
+         *
+         * Vertices of version 2 are decoded into the same vertex streams (see Mesh::VERTEX_STREAM_POSITIONS),
+         * so renderers and skinning do not depend on the version of the file. Default vertex format takes
+         * 28 bytes per skinned vertex (80 bytes in version 1) and 20 bytes per static vertex (48 bytes).
          */
         class MeshManager
         {
         public:
+                /// Versions of the mesh format
+                enum
+                {
+                        VERSION_1 = 1,
+                        VERSION_2
+                };
+
+                /// Flags of the mesh format (version 2)
+                enum
+                {
+                        FLAG_CLUSTERS = 0x01
+                };
+
+                /// Encodings of the vertex attributes (version 2)
+                enum ENCODING
+                {
+                        ENCODING_FLOAT32 = 0,
+                        ENCODING_FLOAT16,
+                        ENCODING_SNORM16,
+                        ENCODING_UNORM16,
+                        ENCODING_OCTAHEDRAL,
+                        ENCODING_UINT8
+                };
+
+                /**
+                 * Represents vertex format of the mesh (version 2). Positions may be encoded as
+                 * ENCODING_FLOAT32, ENCODING_FLOAT16 or ENCODING_SNORM16, TBN bases as ENCODING_FLOAT32 or
+                 * ENCODING_OCTAHEDRAL (normal and tangent are mapped onto octahedron and stored as two
+                 * snorm16 values each), texture coordinates as ENCODING_FLOAT32, ENCODING_FLOAT16 or
+                 * ENCODING_UNORM16, bone indices and weights as ENCODING_FLOAT32 or ENCODING_UINT8 (uint8
+                 * indices and unorm8 weights, mesh must not have more than 256 bones).
+                 */
+                class VertexFormat
+                {
+                public:
+                        uint8_t positions;
+                        uint8_t tbnBases;
+                        uint8_t textureCoordinates;
+                        uint8_t boneIndicesAndWeights;
+
+                        /**
+                         * \brief Constructs vertex format with given encodings.
+                         * \param[in] positions encoding of the positions
+                         * \param[in] tbnBases encoding of the TBN bases
+                         * \param[in] textureCoordinates encoding of the texture coordinates
+                         * \param[in] boneIndicesAndWeights encoding of the bone indices and weights
+                         */
+                        VertexFormat(uint8_t positions = ENCODING_SNORM16,
+                                     uint8_t tbnBases = ENCODING_OCTAHEDRAL,
+                                     uint8_t textureCoordinates = ENCODING_UNORM16,
+                                     uint8_t boneIndicesAndWeights = ENCODING_UINT8);
+                        VertexFormat(const VertexFormat&) = default;
+                        ~VertexFormat();
+                        VertexFormat& operator =(const VertexFormat&) = default;
+
+                        /**
+                         * \brief Returns true if vertex format is valid.
+                         * \return true if encodings are supported by corresponding attributes
+                         */
+                        bool isValid() const;
+
+                        /**
+                         * \brief Computes size of the vertex.
+                         * \param[in] hasBones flag, which shows whether or not vertex has bone indices
+                         * and weights
+                         * \return size of the vertex in bytes
+                         */
+                        uint8_t computeSize(bool hasBones) const;
+
+                };
+
                 MeshManager();
                 MeshManager(const MeshManager&) = default;
                 ~MeshManager();
@@ -31,20 +131,46 @@ namespace selene
                  * \param[out] meshData mesh data
                  * \param[in] textureManager texture manager
                  * \param[in] textureFactory texture factory
+                 * \param[in] materialRegistry registry, in which materials of the subsets are interned (if
+                 * nullptr, then each subset has its own material)
                  * \return true on success
                  */
                 bool readMesh(std::istream& stream,
                               Mesh::Data& meshData,
                               ResourceManager* textureManager,
-                              ResourceFactory* textureFactory);
+                              ResourceFactory* textureFactory,
+                              MaterialRegistry* materialRegistry = nullptr);
+
+                /**
+                 * \brief Reads mesh from mapped file.
+                 *
+                 * Vertices and faces reference contents of the mapped file (if they are suitably aligned),
+                 * so they are not copied; mapped file is held by the mesh data.
+                 * \param[in] mappedFile mapped file from which mesh data is read
+                 * \param[out] meshData mesh data
+                 * \param[in] textureManager texture manager
+                 * \param[in] textureFactory texture factory
+                 * \param[in] materialRegistry registry, in which materials of the subsets are interned (if
+                 * nullptr, then each subset has its own material)
+                 * \return true on success
+                 */
+                bool readMesh(const std::shared_ptr<MappedFile>& mappedFile,
+                              Mesh::Data& meshData,
+                              ResourceManager* textureManager,
+                              ResourceFactory* textureFactory,
+                              MaterialRegistry* materialRegistry = nullptr);
 
                 /**
                  * \brief Writes mesh.
                  * \param[in] stream std::ostream to which mesh data is written
-                 * \param[in] meshData mesh data
+                 * \param[in] meshData mesh data (vertex streams must have the same layout, as streams of
+                 * the mesh, which has been read)
+                 * \param[in] vertexFormat vertex format (if nullptr, then mesh is written in version 1,
+                 * otherwise mesh is written in version 2 with given vertex format)
                  * \return true on success
                  */
-                bool writeMesh(std::ostream& stream, const Mesh::Data& meshData);
+                bool writeMesh(std::ostream& stream, const Mesh::Data& meshData,
+                               const VertexFormat* vertexFormat = nullptr);
 
         private:
                 /**
@@ -64,9 +190,35 @@ namespace selene
 
                 };
 
+                /**
+                 * Represents ranges of the quantized attributes (version 2).
+                 */
+                class Ranges
+                {
+                public:
+                        Vector3d positionsOffset, positionsScale;
+                        Vector2d textureCoordinatesOffset, textureCoordinatesScale;
+
+                        Ranges();
+                        Ranges(const Ranges&) = default;
+                        ~Ranges();
+                        Ranges& operator =(const Ranges&) = default;
+
+                };
+
                 VertexStream vertexStreams_[Mesh::NUM_OF_VERTEX_STREAMS];
                 ResourceManager* textureManager_;
                 ResourceFactory* textureFactory_;
+                MaterialRegistry* materialRegistry_;
+                MappedFile* mappedFile_;
+
+                uint32_t numVertices_, numFaces_;
+                uint16_t numBones_;
+                uint8_t faceStride_;
+
+                uint8_t version_, flags_;
+                VertexFormat vertexFormat_;
+                Ranges ranges_;
 
                 /**
                  * \brief Reads material.
@@ -100,6 +252,29 @@ namespace selene
                  */
                 bool readVerticesAndFaces(std::istream& stream, Mesh::Data& meshData);
 
+                /**
+                 * \brief Reads interleaved vertices (version 2) and decodes them into vertex streams.
+                 * \param[in] stream std::istream from which vertices are read
+                 * \param[out] meshData mesh data
+                 * \return true on success
+                 */
+                bool readInterleavedVertices(std::istream& stream, Mesh::Data& meshData);
+
+                /**
+                 * \brief Reads array.
+                 *
+                 * If mesh is read from the mapped file, then array references contents of the file (when
+                 * they are aligned by the stride of the array elements), otherwise data are copied.
+                 * \param[in] stream std::istream from which array is read
+                 * \param[out] array array
+                 * \param[in] size size of array
+                 * \param[in] stride data stride
+                 * \param[in] sizeModifier array size modifier
+                 * \return true on success
+                 */
+                bool readArray(std::istream& stream, Array<uint8_t, uint32_t>& array,
+                               uint32_t size, uint8_t stride, uint32_t sizeModifier = 1);
+
                 /**
                  * \brief Reads subsets.
                  * \param[in] stream std::istream from which subsets are read
@@ -108,6 +283,14 @@ namespace selene
                  */
                 bool readSubsets(std::istream& stream, Mesh::Data& meshData);
 
+                /**
+                 * \brief Reads clusters.
+                 * \param[in] stream std::istream from which clusters are read
+                 * \param[out] meshData mesh data (subsets must be read)
+                 * \return true on success
+                 */
+                bool readClusters(std::istream& stream, Mesh::Data& meshData);
+
                 /**
                  * \brief Reads bones.
                  * \param[in] stream std::istream from which bones are read
@@ -148,6 +331,38 @@ namespace selene
                  */
                 bool writeVerticesAndFaces(std::ostream& stream, const Mesh::Data& meshData);
 
+                /**
+                 * \brief Encodes vertex streams and writes interleaved vertices (version 2).
+                 * \param[in] stream std::ostream to which vertices are written
+                 * \param[in] meshData mesh data
+                 * \return true on success
+                 */
+                bool writeInterleavedVertices(std::ostream& stream, const Mesh::Data& meshData);
+
+                /**
+                 * \brief Computes ranges of the quantized attributes.
+                 * \param[in] meshData mesh data
+                 */
+                void computeRanges(const Mesh::Data& meshData);
+
+                /**
+                 * \brief Decodes vertex.
+                 * \param[in] source encoded vertex
+                 * \param[out] meshData mesh data, which holds vertex streams
+                 * \param[in] vertexIndex index of the vertex
+                 * \return true if vertex has been successfully decoded
+                 */
+                bool decodeVertex(const uint8_t* source, Mesh::Data& meshData, uint32_t vertexIndex) const;
+
+                /**
+                 * \brief Encodes vertex.
+                 * \param[in] meshData mesh data, which holds vertex streams
+                 * \param[in] vertexIndex index of the vertex
+                 * \param[out] destination encoded vertex
+                 * \return true if vertex has been successfully encoded
+                 */
+                bool encodeVertex(const Mesh::Data& meshData, uint32_t vertexIndex, uint8_t* destination) const;
+
                 /**
                  * \brief Writes subsets.
                  * \param[in] stream std::ostream to which subsets are written
@@ -156,6 +371,14 @@ namespace selene
                  */
                 bool writeSubsets(std::ostream& stream, const Mesh::Data& meshData);
 
+                /**
+                 * \brief Writes clusters.
+                 * \param[in] stream std::ostream to which clusters are written
+                 * \param[in] meshData mesh data
+                 * \return true on success
+                 */
+                bool writeClusters(std::ostream& stream, const Mesh::Data& meshData);
+
                 /**
                  * \brief Writes bones.
                  * \param[in] stream std::ostream to which bones are written
@@ -164,6 +387,48 @@ namespace selene
                  */
                 bool writeBones(std::ostream& stream, const Array<Skeleton::Bone, uint16_t>& bones);
 
+                /**
+                 * \brief Encodes float as half float.
+                 * \param[in] value float
+                 * \return half float (rounded to nearest)
+                 */
+                static uint16_t encodeHalf(float value);
+
+                /**
+                 * \brief Decodes half float.
+                 * \param[in] value half float
+                 * \return float
+                 */
+                static float decodeHalf(uint16_t value);
+
+                /**
+                 * \brief Encodes value in range [-1; 1] as snorm16.
+                 * \param[in] value value
+                 * \return snorm16 value
+                 */
+                static int16_t encodeSnorm16(float value);
+
+                /**
+                 * \brief Decodes snorm16 value.
+                 * \param[in] value snorm16 value
+                 * \return value in range [-1; 1]
+                 */
+                static float decodeSnorm16(int16_t value);
+
+                /**
+                 * \brief Encodes unit vector with octahedral mapping.
+                 * \param[in] vector unit vector
+                 * \param[out] result two snorm16 values
+                 */
+                static void encodeOctahedral(const Vector3d& vector, int16_t* result);
+
+                /**
+                 * \brief Decodes unit vector from octahedral mapping.
+                 * \param[in] source two snorm16 values
+                 * \return unit vector
+                 */
+                static Vector3d decodeOctahedral(const int16_t* source);
+
         };
 
         /**
@@ -0,0 +1,372 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "MeshSkinner.h"
+
+#include <algorithm>
+#include <memory>
+#include <cmath>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace selene
+{
+
+        MeshSkinner::MeshSkinner(): emptyVertices_(), boneMatrices_() {}
+        MeshSkinner::~MeshSkinner() {}
+
+        //------------------------------------------------------------------
+        bool MeshSkinner::initialize(const Mesh::Data& meshData)
+        {
+                destroy();
+
+                const auto& positions = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                const auto& tbnBases  = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+
+                if(positions.isEmpty() || tbnBases.isEmpty())
+                        return false;
+
+                if(!vertices_[SKINNED_STREAM_POSITIONS].create(positions.getSize(), positions.getStride()) ||
+                   !vertices_[SKINNED_STREAM_TBN_BASES].create(tbnBases.getSize(), tbnBases.getStride()))
+                {
+                        destroy();
+                        return false;
+                }
+
+                vertices_[SKINNED_STREAM_POSITIONS] = positions;
+                vertices_[SKINNED_STREAM_TBN_BASES] = tbnBases;
+                return true;
+        }
+
+        //------------------------------------------------------------------
+        void MeshSkinner::destroy()
+        {
+                for(uint8_t i = 0; i < NUM_OF_SKINNED_STREAMS; ++i)
+                        vertices_[i].destroy();
+
+                boneMatrices_.destroy();
+        }
+
+        //------------------------------------------------------------------
+        bool MeshSkinner::skin(const Mesh::Data& meshData, const Array<Skeleton::Transform, uint16_t>& boneTransforms,
+                               ThreadPool* threadPool)
+        {
+                if(!validate(meshData, boneTransforms) || !computeBoneMatrices(boneTransforms))
+                        return false;
+
+                uint32_t numVertices = vertices_[SKINNED_STREAM_POSITIONS].getSize();
+                size_t numWorkers = (threadPool != nullptr) ? threadPool->getNumWorkers() : 0;
+
+                if(numWorkers == 0 || numVertices < 2 * static_cast<uint32_t>(MIN_NUM_OF_VERTICES_PER_RANGE))
+                {
+                        skinVertices(meshData, 0, numVertices);
+                        return true;
+                }
+
+                // split vertices into ranges, calling thread takes part in skinning
+                uint32_t numRanges = static_cast<uint32_t>(numWorkers) + 1;
+                uint32_t numVerticesPerRange = std::max((numVertices + numRanges - 1) / numRanges,
+                                                        static_cast<uint32_t>(MIN_NUM_OF_VERTICES_PER_RANGE));
+
+                threadPool->parallelFor(0, numVertices, numVerticesPerRange,
+                                        std::bind(&MeshSkinner::skinVertices, this, std::cref(meshData),
+                                                  std::placeholders::_1, std::placeholders::_2));
+                return true;
+        }
+
+        //------------------------------------------------------------------
+        bool MeshSkinner::skinReference(const Mesh::Data& meshData,
+                                        const Array<Skeleton::Transform, uint16_t>& boneTransforms)
+        {
+                if(!validate(meshData, boneTransforms))
+                        return false;
+
+                const auto& positions = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                const auto& tbnBases  = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                const auto& bones     = meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+
+                auto& skinnedPositions = vertices_[SKINNED_STREAM_POSITIONS];
+                auto& skinnedTbnBases  = vertices_[SKINNED_STREAM_TBN_BASES];
+
+                uint32_t numVertices = skinnedPositions.getSize();
+                uint16_t numBones = boneTransforms.getSize();
+
+                for(uint32_t i = 0; i < numVertices; ++i)
+                {
+                        const uint8_t* vertexPosition = &positions[i * positions.getStride()];
+                        const Vector3d& position = *reinterpret_cast<const Vector3d*>(vertexPosition);
+                        const uint8_t* tbnBasis = &tbnBases[i * tbnBases.getStride()];
+                        const Vector3d& normal  = *reinterpret_cast<const Vector3d*>(tbnBasis);
+                        const Vector4d& tangent = *reinterpret_cast<const Vector4d*>(tbnBasis + sizeof(Vector3d));
+
+                        const uint8_t* vertexBones = &bones[i * bones.getStride()];
+                        const Vector4d& boneIndices = *reinterpret_cast<const Vector4d*>(vertexBones);
+                        const Vector4d& boneWeights = *reinterpret_cast<const Vector4d*>(vertexBones +
+                                                                                         sizeof(Vector4d));
+
+                        const float indices[] = {boneIndices.x, boneIndices.y, boneIndices.z, boneIndices.w};
+                        const float weights[] = {boneWeights.x, boneWeights.y, boneWeights.z, boneWeights.w};
+
+                        Vector3d skinnedPosition, skinnedNormal, skinnedTangent;
+
+                        for(uint8_t j = 0; j < NUM_OF_BONES_PER_VERTEX; ++j)
+                        {
+                                uint32_t boneIndex = static_cast<uint32_t>(indices[j]);
+                                if(boneIndex >= numBones)
+                                        continue;
+
+                                const Skeleton::Transform& boneTransform = boneTransforms[boneIndex];
+
+                                skinnedPosition += weights[j] * (boneTransform.position +
+                                                                 boneTransform.rotation.rotate(position));
+                                skinnedNormal  += weights[j] * boneTransform.rotation.rotate(normal);
+                                skinnedTangent += weights[j] * boneTransform.rotation.rotate(Vector3d(tangent.x,
+                                                                                                      tangent.y,
+                                                                                                      tangent.z));
+                        }
+
+                        uint8_t* skinnedTbnBasis = &skinnedTbnBases[i * skinnedTbnBases.getStride()];
+
+                        *reinterpret_cast<Vector3d*>(&skinnedPositions[i * skinnedPositions.getStride()]) =
+                                skinnedPosition;
+                        *reinterpret_cast<Vector3d*>(skinnedTbnBasis) = skinnedNormal;
+                        *reinterpret_cast<Vector4d*>(skinnedTbnBasis + sizeof(Vector3d)) =
+                                Vector4d(skinnedTangent, tangent.w);
+                }
+
+                return true;
+        }
+
+        //------------------------------------------------------------------
+        bool MeshSkinner::check(const Mesh::Data& meshData, const Array<Skeleton::Transform, uint16_t>& boneTransforms,
+                                ThreadPool* threadPool, float tolerance)
+        {
+                MeshSkinner referenceMeshSkinner;
+
+                if(!referenceMeshSkinner.initialize(meshData) ||
+                   !referenceMeshSkinner.skinReference(meshData, boneTransforms))
+                        return false;
+
+                if(!skin(meshData, boneTransforms, threadPool))
+                        return false;
+
+                float maxDifference = computeMaxDifference(referenceMeshSkinner);
+                if(maxDifference < 0.0f)
+                        return false;
+
+                // tolerance is relative to the size of the mesh
+                const auto& vertices = referenceMeshSkinner.vertices_[SKINNED_STREAM_POSITIONS];
+                float maxComponent = 1.0f;
+
+                for(uint32_t i = 0; i < vertices.getSize(); ++i)
+                {
+                        const float* position = reinterpret_cast<const float*>(&vertices[i * vertices.getStride()]);
+
+                        for(uint8_t j = 0; j < 3; ++j)
+                                maxComponent = std::max(maxComponent, std::fabs(position[j]));
+                }
+
+                return maxDifference <= tolerance * maxComponent;
+        }
+
+        //------------------------------------------------------------------
+        const Array<uint8_t, uint32_t>& MeshSkinner::getVertices(uint8_t stream) const
+        {
+                if(stream >= NUM_OF_SKINNED_STREAMS)
+                        return emptyVertices_;
+
+                return vertices_[stream];
+        }
+
+        //------------------------------------------------------------------
+        float MeshSkinner::computeMaxDifference(const MeshSkinner& meshSkinner) const
+        {
+                float maxDifference = 0.0f;
+
+                for(uint8_t i = 0; i < NUM_OF_SKINNED_STREAMS; ++i)
+                {
+                        const auto& vertices0 = vertices_[i];
+                        const auto& vertices1 = meshSkinner.vertices_[i];
+
+                        if(vertices0.getSize() != vertices1.getSize() ||
+                           vertices0.getStride() != vertices1.getStride())
+                                return -1.0f;
+
+                        uint32_t numComponents = vertices0.getStride() / sizeof(float);
+
+                        for(uint32_t j = 0; j < vertices0.getSize(); ++j)
+                        {
+                                uint32_t offset = j * vertices0.getStride();
+                                const float* components0 = reinterpret_cast<const float*>(&vertices0[offset]);
+                                const float* components1 = reinterpret_cast<const float*>(&vertices1[offset]);
+
+                                for(uint32_t k = 0; k < numComponents; ++k)
+                                        maxDifference = std::max(maxDifference,
+                                                                 std::fabs(components0[k] - components1[k]));
+                        }
+                }
+
+                return maxDifference;
+        }
+
+        //------------------------------------------------------------------
+        bool MeshSkinner::validate(const Mesh::Data& meshData,
+                                   const Array<Skeleton::Transform, uint16_t>& boneTransforms) const
+        {
+                if(boneTransforms.isEmpty())
+                        return false;
+
+                const auto& positions = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                const auto& tbnBases  = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                const auto& bones     = meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+
+                const auto& skinnedPositions = vertices_[SKINNED_STREAM_POSITIONS];
+                const auto& skinnedTbnBases  = vertices_[SKINNED_STREAM_TBN_BASES];
+
+                if(positions.isEmpty() || tbnBases.isEmpty() || bones.isEmpty())
+                        return false;
+
+                if(positions.getSize() != skinnedPositions.getSize() ||
+                   positions.getStride() != skinnedPositions.getStride() ||
+                   tbnBases.getSize() != skinnedTbnBases.getSize() ||
+                   tbnBases.getStride() != skinnedTbnBases.getStride())
+                        return false;
+
+                if(positions.getStride() < sizeof(Vector3d) ||
+                   tbnBases.getStride() < (sizeof(Vector3d) + sizeof(Vector4d)) ||
+                   bones.getStride() < 2 * sizeof(Vector4d))
+                        return false;
+
+                if(positions.getSize() != tbnBases.getSize() || positions.getSize() != bones.getSize())
+                        return false;
+
+                return true;
+        }
+
+        //------------------------------------------------------------------
+        bool MeshSkinner::computeBoneMatrices(const Array<Skeleton::Transform, uint16_t>& boneTransforms)
+        {
+                uint32_t size = boneTransforms.getSize() * static_cast<uint32_t>(NUM_OF_BONE_MATRIX_ELEMENTS);
+
+                if(boneMatrices_.getSize() != size)
+                {
+                        if(!boneMatrices_.create(size))
+                                return false;
+                }
+
+                // each matrix is stored by rows, fourth column holds translation
+                for(uint16_t i = 0; i < boneTransforms.getSize(); ++i)
+                {
+                        const Skeleton::Transform& boneTransform = boneTransforms[i];
+                        float* matrix = &boneMatrices_[i * static_cast<uint32_t>(NUM_OF_BONE_MATRIX_ELEMENTS)];
+
+                        Vector3d axes[] =
+                        {
+                                boneTransform.rotation.rotate(Vector3d(1.0f, 0.0f, 0.0f)),
+                                boneTransform.rotation.rotate(Vector3d(0.0f, 1.0f, 0.0f)),
+                                boneTransform.rotation.rotate(Vector3d(0.0f, 0.0f, 1.0f))
+                        };
+
+                        const float translation[] =
+                        {
+                                boneTransform.position.x, boneTransform.position.y, boneTransform.position.z
+                        };
+
+                        for(uint8_t row = 0; row < 3; ++row)
+                        {
+                                matrix[4 * row + 0] = static_cast<const float*>(axes[0])[row];
+                                matrix[4 * row + 1] = static_cast<const float*>(axes[1])[row];
+                                matrix[4 * row + 2] = static_cast<const float*>(axes[2])[row];
+                                matrix[4 * row + 3] = translation[row];
+                        }
+                }
+
+                return true;
+        }
+
+        //------------------------------------------------------------------
+        void MeshSkinner::skinVertices(const Mesh::Data& meshData, uint32_t firstVertex, uint32_t lastVertex)
+        {
+                const auto& positions = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                const auto& tbnBases  = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                const auto& bones     = meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+
+                auto& skinnedPositions = vertices_[SKINNED_STREAM_POSITIONS];
+                auto& skinnedTbnBases  = vertices_[SKINNED_STREAM_TBN_BASES];
+
+                const float* boneMatrices = &boneMatrices_[0];
+                uint32_t numBones = boneMatrices_.getSize() / static_cast<uint32_t>(NUM_OF_BONE_MATRIX_ELEMENTS);
+
+                for(uint32_t i = firstVertex; i < lastVertex; ++i)
+                {
+                        const float* vertexBones = reinterpret_cast<const float*>(&bones[i * bones.getStride()]);
+                        const float* boneWeights = vertexBones + NUM_OF_BONES_PER_VERTEX;
+
+                        // blend bone matrices
+                        float m[NUM_OF_BONE_MATRIX_ELEMENTS];
+
+#if defined(__SSE__)
+                        __m128 row0 = _mm_setzero_ps();
+                        __m128 row1 = _mm_setzero_ps();
+                        __m128 row2 = _mm_setzero_ps();
+
+                        for(uint8_t j = 0; j < NUM_OF_BONES_PER_VERTEX; ++j)
+                        {
+                                uint32_t boneIndex = static_cast<uint32_t>(vertexBones[j]);
+                                if(boneIndex >= numBones || boneWeights[j] == 0.0f)
+                                        continue;
+
+                                const float* boneMatrix = boneMatrices + boneIndex * NUM_OF_BONE_MATRIX_ELEMENTS;
+                                __m128 weight = _mm_set1_ps(boneWeights[j]);
+
+                                row0 = _mm_add_ps(row0, _mm_mul_ps(weight, _mm_loadu_ps(boneMatrix + 0)));
+                                row1 = _mm_add_ps(row1, _mm_mul_ps(weight, _mm_loadu_ps(boneMatrix + 4)));
+                                row2 = _mm_add_ps(row2, _mm_mul_ps(weight, _mm_loadu_ps(boneMatrix + 8)));
+                        }
+
+                        _mm_storeu_ps(m + 0, row0);
+                        _mm_storeu_ps(m + 4, row1);
+                        _mm_storeu_ps(m + 8, row2);
+#else
+                        for(uint8_t k = 0; k < NUM_OF_BONE_MATRIX_ELEMENTS; ++k)
+                                m[k] = 0.0f;
+
+                        for(uint8_t j = 0; j < NUM_OF_BONES_PER_VERTEX; ++j)
+                        {
+                                uint32_t boneIndex = static_cast<uint32_t>(vertexBones[j]);
+                                if(boneIndex >= numBones || boneWeights[j] == 0.0f)
+                                        continue;
+
+                                const float* boneMatrix = boneMatrices + boneIndex * NUM_OF_BONE_MATRIX_ELEMENTS;
+                                float weight = boneWeights[j];
+
+                                for(uint8_t k = 0; k < NUM_OF_BONE_MATRIX_ELEMENTS; ++k)
+                                        m[k] += weight * boneMatrix[k];
+                        }
+#endif
+
+                        // transform vertex
+                        const float* p = reinterpret_cast<const float*>(&positions[i * positions.getStride()]);
+                        const float* n = reinterpret_cast<const float*>(&tbnBases[i * tbnBases.getStride()]);
+                        const float* t = n + 3;
+
+                        float* skinnedP = reinterpret_cast<float*>(&skinnedPositions[i * skinnedPositions.getStride()]);
+                        float* skinnedN = reinterpret_cast<float*>(&skinnedTbnBases[i * skinnedTbnBases.getStride()]);
+                        float* skinnedT = skinnedN + 3;
+
+                        for(uint8_t row = 0; row < 3; ++row)
+                        {
+                                const float* r = m + 4 * row;
+
+                                skinnedP[row] = r[0] * p[0] + r[1] * p[1] + r[2] * p[2] + r[3];
+                                skinnedN[row] = r[0] * n[0] + r[1] * n[1] + r[2] * n[2];
+                                skinnedT[row] = r[0] * t[0] + r[1] * t[1] + r[2] * t[2];
+                        }
+
+                        skinnedT[3] = t[3];
+                }
+        }
+
+}
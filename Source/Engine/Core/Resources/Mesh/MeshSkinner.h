@@ -0,0 +1,164 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef MESH_SKINNER_H
+#define MESH_SKINNER_H
+
+#include "../../Helpers/ThreadPool.h"
+#include "Mesh.h"
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Resources
+         * @{
+         */
+
+        /**
+         * Represents mesh skinner. It deforms positions and TBN bases of the skin mesh on the CPU with given
+         * bone transforms (usually final bone transforms of the skeleton instance). This is used when skeleton
+         * has more bones, than skinning shaders of the renderer can hold, and also when deformed vertices are
+         * needed on the CPU side (for picking, for example).
+         *
+         * Resulting vertex streams have the same layout, as Mesh::VERTEX_STREAM_POSITIONS and
+         * Mesh::VERTEX_STREAM_TBN_BASES streams of the mesh, so they can be used in place of them.
+         *
+         * Each bone transform is converted to the 3x4 matrix once, then matrices of the vertex bones are
+         * blended with weights of the vertex, so each vertex is transformed only once. Vertex ranges can
+         * be processed in parallel with ThreadPool. There is also a reference implementation, which
+         * transforms vertices exactly as skinning shaders do; it is used for validation (see check).
+         */
+        class MeshSkinner
+        {
+        public:
+                /// Skinned vertex streams
+                enum
+                {
+                        SKINNED_STREAM_POSITIONS = 0,
+                        SKINNED_STREAM_TBN_BASES,
+                        NUM_OF_SKINNED_STREAMS
+                };
+
+                MeshSkinner();
+                MeshSkinner(const MeshSkinner&) = delete;
+                ~MeshSkinner();
+                MeshSkinner& operator =(const MeshSkinner&) = delete;
+
+                /**
+                 * \brief Initializes mesh skinner.
+                 *
+                 * Allocates skinned vertex streams for given mesh.
+                 * \param[in] meshData data of the mesh, which will be skinned
+                 * \return true if mesh skinner has been successfully initialized
+                 */
+                bool initialize(const Mesh::Data& meshData);
+
+                /**
+                 * \brief Destroys mesh skinner.
+                 */
+                void destroy();
+
+                /**
+                 * \brief Skins mesh.
+                 * \param[in] meshData data of the mesh (must be the same mesh, which has been used in
+                 * initialization)
+                 * \param[in] boneTransforms final bone transforms
+                 * \param[in] threadPool thread pool, which is used to skin vertex ranges in parallel (if
+                 * nullptr, then all vertices are skinned in the calling thread)
+                 * \return true if mesh has been successfully skinned
+                 */
+                bool skin(const Mesh::Data& meshData, const Array<Skeleton::Transform, uint16_t>& boneTransforms,
+                          ThreadPool* threadPool = nullptr);
+
+                /**
+                 * \brief Skins mesh with reference implementation.
+                 *
+                 * Each vertex is transformed by each of its bones, then results are blended, as skinning
+                 * shaders do. This function is slow, it should only be used for validation.
+                 * \param[in] meshData data of the mesh (must be the same mesh, which has been used in
+                 * initialization)
+                 * \param[in] boneTransforms final bone transforms
+                 * \return true if mesh has been successfully skinned
+                 */
+                bool skinReference(const Mesh::Data& meshData,
+                                   const Array<Skeleton::Transform, uint16_t>& boneTransforms);
+
+                /**
+                 * \brief Checks skinning against reference implementation.
+                 *
+                 * Mesh is skinned with skin() and with reference implementation (by temporary mesh skinner),
+                 * then results are compared. After this operation mesh skinner holds vertices, which have been
+                 * skinned with skin().
+                 * \param[in] meshData data of the mesh (must be the same mesh, which has been used in
+                 * initialization)
+                 * \param[in] boneTransforms final bone transforms
+                 * \param[in] threadPool thread pool, which is used in skinning (can be nullptr)
+                 * \param[in] tolerance maximum difference between components of the skinned vertices, relative
+                 * to the greatest component of the reference vertices (or to one, if it is less than one)
+                 * \return true if mesh has been skinned and results of both implementations match
+                 */
+                bool check(const Mesh::Data& meshData, const Array<Skeleton::Transform, uint16_t>& boneTransforms,
+                           ThreadPool* threadPool = nullptr, float tolerance = 1.0e-4f);
+
+                /**
+                 * \brief Returns skinned vertices.
+                 * \param[in] stream skinned vertex stream
+                 * \return const reference to the skinned vertex stream
+                 */
+                const Array<uint8_t, uint32_t>& getVertices(uint8_t stream) const;
+
+                /**
+                 * \brief Computes maximum difference between skinned vertices of two mesh skinners.
+                 * \param[in] meshSkinner another mesh skinner
+                 * \return maximum absolute difference between components of the skinned vertices
+                 * (or -1 if mesh skinners have different number of vertices)
+                 */
+                float computeMaxDifference(const MeshSkinner& meshSkinner) const;
+
+        private:
+                /// Helper constants
+                enum
+                {
+                        NUM_OF_BONES_PER_VERTEX = 4,
+                        NUM_OF_BONE_MATRIX_ELEMENTS = 12,
+                        MIN_NUM_OF_VERTICES_PER_RANGE = 1024
+                };
+
+                Array<uint8_t, uint32_t> vertices_[NUM_OF_SKINNED_STREAMS];
+                Array<uint8_t, uint32_t> emptyVertices_;
+                Array<float, uint32_t> boneMatrices_;
+
+                /**
+                 * \brief Checks if given mesh and bone transforms can be used in skinning.
+                 * \param[in] meshData data of the mesh
+                 * \param[in] boneTransforms final bone transforms
+                 * \return true if mesh can be skinned
+                 */
+                bool validate(const Mesh::Data& meshData,
+                              const Array<Skeleton::Transform, uint16_t>& boneTransforms) const;
+
+                /**
+                 * \brief Computes bone matrices.
+                 * \param[in] boneTransforms final bone transforms
+                 * \return true if bone matrices have been successfully computed
+                 */
+                bool computeBoneMatrices(const Array<Skeleton::Transform, uint16_t>& boneTransforms);
+
+                /**
+                 * \brief Skins vertices in given range.
+                 * \param[in] meshData data of the mesh
+                 * \param[in] firstVertex index of the first vertex in range
+                 * \param[in] lastVertex index of the vertex, which follows the last vertex in range
+                 */
+                void skinVertices(const Mesh::Data& meshData, uint32_t firstVertex, uint32_t lastVertex);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
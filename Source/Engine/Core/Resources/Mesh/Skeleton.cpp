@@ -3,6 +3,9 @@
 
 #include "Skeleton.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace selene
 {
 
@@ -25,6 +28,32 @@ namespace selene
                 return combinedTransform;
         }
 
+        //-------------------------------------------------------------------------------------------------------------
+        void Skeleton::Transform::combine(const Skeleton::Transform& first, const Skeleton::Transform& second)
+        {
+                const Quaternion& q = first.rotation;
+                const Quaternion& r = second.rotation;
+                const Vector3d& v = second.position;
+
+                // rotate position: v' = v + w * t + q x t, where t = 2 * (q x v)
+                float tx = 2.0f * (q.y * v.z - q.z * v.y);
+                float ty = 2.0f * (q.z * v.x - q.x * v.z);
+                float tz = 2.0f * (q.x * v.y - q.y * v.x);
+
+                float px = first.position.x + v.x + q.w * tx + (q.y * tz - q.z * ty);
+                float py = first.position.y + v.y + q.w * ty + (q.z * tx - q.x * tz);
+                float pz = first.position.z + v.z + q.w * tz + (q.x * ty - q.y * tx);
+
+                // multiply rotations
+                float rx = q.w * r.x + r.w * q.x + (q.y * r.z - q.z * r.y);
+                float ry = q.w * r.y + r.w * q.y + (q.z * r.x - q.x * r.z);
+                float rz = q.w * r.z + r.w * q.z + (q.x * r.y - q.y * r.x);
+                float rw = q.w * r.w - (q.x * r.x + q.y * r.y + q.z * r.z);
+
+                position.define(px, py, pz);
+                rotation.define(rx, ry, rz, rw);
+        }
+
         //-------------------------------------------------------------------------------------------------------------
         Skeleton::Transform operator -(const Skeleton::Transform& transform)
         {
@@ -50,9 +79,18 @@ namespace selene
         Skeleton::BoneTransform::BoneTransform(): transform(), boneName() {}
         Skeleton::BoneTransform::~BoneTransform() {}
 
+        Skeleton::BoneBounds::BoneBounds(): center(), extents(), isPresent(false) {}
+        Skeleton::BoneBounds::~BoneBounds() {}
+
+        Skeleton::Layer::Layer():
+                key0(nullptr), key1(nullptr), keyIndices(nullptr), boneWeights(nullptr),
+                keyScalar(0.0f), blendFactor(0.0f) {}
+        Skeleton::Layer::~Layer() {}
+
         Skeleton::Instance::Instance():
-                localBoneTransforms_(), combinedBoneTransforms_(),
-                finalBoneTransforms_(), skeleton_(), isUpdated_(false) {}
+                localBoneTransforms_(), storedBoneTransforms_(), combinedBoneTransforms_(),
+                finalBoneTransforms_(), outdatedBoneFlags_(), palette_(), skeleton_(),
+                poseInterpolationScalar_(1.0f), paletteFormat_(PALETTE_NONE), isUpdated_(false) {}
         Skeleton::Instance::~Instance() {}
 
         //-------------------------------------------------------------------------------------------------------------
@@ -68,13 +106,17 @@ namespace selene
 
                 if(!combinedBoneTransforms_.create(numBones) ||
                    !localBoneTransforms_.create(numBones) ||
-                   !finalBoneTransforms_.create(numBones))
+                   !storedBoneTransforms_.create(numBones) ||
+                   !finalBoneTransforms_.create(numBones) ||
+                   !outdatedBoneFlags_.create(numBones))
                 {
                         destroy();
                         return false;
                 }
 
                 localBoneTransforms_ = skeleton->initialLocalBoneTransforms_;
+                storedBoneTransforms_ = localBoneTransforms_;
+                invalidateAllBones();
                 return true;
         }
 
@@ -82,9 +124,14 @@ namespace selene
         void Skeleton::Instance::destroy()
         {
                 localBoneTransforms_.destroy();
+                storedBoneTransforms_.destroy();
                 combinedBoneTransforms_.destroy();
                 finalBoneTransforms_.destroy();
+                outdatedBoneFlags_.destroy();
+                palette_.destroy();
                 skeleton_.reset();
+                poseInterpolationScalar_ = 1.0f;
+                paletteFormat_ = PALETTE_NONE;
                 isUpdated_ = false;
         }
 
@@ -112,6 +159,59 @@ namespace selene
                 return combinedBoneTransforms_;
         }
 
+        //-------------------------------------------------------------------------------------------------------------
+        bool Skeleton::Instance::setPaletteFormat(uint8_t format)
+        {
+                if(format == paletteFormat_)
+                        return true;
+
+                uint32_t numBones = finalBoneTransforms_.getSize();
+
+                switch(format)
+                {
+                        case PALETTE_NONE:
+                                palette_.destroy();
+                                break;
+
+                        case PALETTE_MATRICES:
+                                if(numBones == 0 || !palette_.create(12 * numBones))
+                                        return false;
+
+                                break;
+
+                        case PALETTE_DUAL_QUATERNIONS:
+                                if(numBones == 0 || !palette_.create(8 * numBones))
+                                        return false;
+
+                                break;
+
+                        default:
+                                return false;
+                }
+
+                paletteFormat_ = format;
+                invalidateAllBones();
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        uint8_t Skeleton::Instance::getPaletteFormat() const
+        {
+                return paletteFormat_;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        const Array<float, uint32_t>& Skeleton::Instance::getPalette() const
+        {
+                if(!isUpdated_)
+                {
+                        computeFinalBoneTransforms();
+                        isUpdated_ = true;
+                }
+
+                return palette_;
+        }
+
         //-------------------------------------------------------------------------------------------------------------
         void Skeleton::Instance::setInitialPose()
         {
@@ -125,7 +225,8 @@ namespace selene
                         return;
 
                 localBoneTransforms_ = initialLocalBoneTransforms;
-                isUpdated_ = false;
+                poseInterpolationScalar_ = 1.0f;
+                invalidateAllBones();
         }
 
         //-------------------------------------------------------------------------------------------------------------
@@ -149,6 +250,7 @@ namespace selene
                                         continue;
 
                                 localBoneTransforms_[boneIndex] = boneTransform.transform;
+                                outdatedBoneFlags_[boneIndex] = true;
                         }
                 }
                 else
@@ -168,12 +270,202 @@ namespace selene
                                 localBoneTransform.position =
                                         localBoneTransform.position.lerp(boneTransform.transform.position,
                                                                          blendFactor);
+                                outdatedBoneFlags_[boneIndex] = true;
                         }
                 }
 
                 isUpdated_ = false;
         }
 
+        //-------------------------------------------------------------------------------------------------------------
+        void Skeleton::Instance::blendLayers(const std::vector<Layer>& layers)
+        {
+                uint16_t numBones = localBoneTransforms_.getSize();
+
+                if(layers.empty() || outdatedBoneFlags_.getSize() != numBones)
+                        return;
+
+                for(auto it = layers.begin(); it != layers.end(); ++it)
+                {
+                        const Layer& layer = *it;
+
+                        if(layer.key0 == nullptr || layer.key1 == nullptr || layer.keyIndices == nullptr)
+                                return;
+
+                        if(layer.key0->getSize() != layer.key1->getSize() ||
+                           layer.keyIndices->getSize() != numBones)
+                                return;
+
+                        if(layer.boneWeights != nullptr && layer.boneWeights->getSize() != numBones)
+                                return;
+                }
+
+                for(uint16_t i = 0; i < numBones; ++i)
+                {
+                        Transform& localBoneTransform = localBoneTransforms_[i];
+                        bool isBoneAffected = false;
+
+                        for(auto it = layers.begin(); it != layers.end(); ++it)
+                        {
+                                const Layer& layer = *it;
+
+                                int32_t keyIndex = (*layer.keyIndices)[i];
+                                if(keyIndex < 0 || keyIndex >= layer.key0->getSize())
+                                        continue;
+
+                                float blendFactor = layer.blendFactor;
+                                if(layer.boneWeights != nullptr)
+                                        blendFactor *= (*layer.boneWeights)[i];
+
+                                if(blendFactor <= 0.0f)
+                                        continue;
+
+                                // sample key
+                                const Transform& transform0 = (*layer.key0)[keyIndex].transform;
+                                const Transform& transform1 = (*layer.key1)[keyIndex].transform;
+
+                                Transform transform = transform0;
+                                if(layer.key0 != layer.key1)
+                                {
+                                        transform.rotation = transform0.rotation.lerp(transform1.rotation,
+                                                                                      layer.keyScalar);
+                                        transform.position = transform0.position.lerp(transform1.position,
+                                                                                      layer.keyScalar);
+                                }
+
+                                // blend it
+                                if(blendFactor >= 1.0f)
+                                        localBoneTransform = transform;
+                                else
+                                {
+                                        localBoneTransform.rotation =
+                                                localBoneTransform.rotation.lerp(transform.rotation, blendFactor);
+                                        localBoneTransform.position =
+                                                localBoneTransform.position.lerp(transform.position, blendFactor);
+                                }
+
+                                isBoneAffected = true;
+                        }
+
+                        if(isBoneAffected)
+                        {
+                                outdatedBoneFlags_[i] = true;
+                                isUpdated_ = false;
+                        }
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void Skeleton::Instance::storePose()
+        {
+                if(storedBoneTransforms_.getSize() != localBoneTransforms_.getSize())
+                        return;
+
+                if(poseInterpolationScalar_ < 1.0f)
+                {
+                        for(uint16_t i = 0; i < storedBoneTransforms_.getSize(); ++i)
+                                storedBoneTransforms_[i] = getInterpolatedLocalBoneTransform(i);
+
+                        // visible pose depends on the stored pose
+                        invalidateAllBones();
+                }
+                else
+                        storedBoneTransforms_ = localBoneTransforms_;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void Skeleton::Instance::interpolatePose(float scalar)
+        {
+                if(storedBoneTransforms_.getSize() != localBoneTransforms_.getSize())
+                        return;
+
+                scalar = scalar < 1.0f ? scalar : 1.0f;
+                scalar = scalar > 0.0f ? scalar : 0.0f;
+
+                if(scalar == poseInterpolationScalar_)
+                        return;
+
+                poseInterpolationScalar_ = scalar;
+                invalidateAllBones();
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void Skeleton::Instance::copyPose(const Instance& instance)
+        {
+                if(this == &instance || instance.localBoneTransforms_.getSize() != localBoneTransforms_.getSize())
+                        return;
+
+                localBoneTransforms_ = instance.localBoneTransforms_;
+                storedBoneTransforms_ = instance.storedBoneTransforms_;
+                poseInterpolationScalar_ = instance.poseInterpolationScalar_;
+                invalidateAllBones();
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        bool Skeleton::Instance::computeBoundingBox(Box& boundingBox) const
+        {
+                auto skeleton = skeleton_.lock();
+                if(!skeleton)
+                        return false;
+
+                const auto& boneBounds = skeleton->boneBounds_;
+                const auto& combinedBoneTransforms = getCombinedBoneTransforms();
+
+                if(boneBounds.getSize() != combinedBoneTransforms.getSize())
+                        return false;
+
+                Vector3d minimum, maximum;
+                bool isEmpty = true;
+
+                for(uint16_t i = 0; i < boneBounds.getSize(); ++i)
+                {
+                        if(!boneBounds[i].isPresent)
+                                continue;
+
+                        const Transform& transform = combinedBoneTransforms[i];
+                        const Vector3d& extents = boneBounds[i].extents;
+
+                        // transform box to model space and compute its axis-aligned extents
+                        Vector3d axes[] =
+                        {
+                                transform.rotation.rotate(Vector3d(1.0f, 0.0f, 0.0f)),
+                                transform.rotation.rotate(Vector3d(0.0f, 1.0f, 0.0f)),
+                                transform.rotation.rotate(Vector3d(0.0f, 0.0f, 1.0f))
+                        };
+
+                        Vector3d center = transform.position + transform.rotation.rotate(boneBounds[i].center);
+                        Vector3d halfSize(std::fabs(axes[0].x) * extents.x + std::fabs(axes[1].x) * extents.y +
+                                          std::fabs(axes[2].x) * extents.z,
+                                          std::fabs(axes[0].y) * extents.x + std::fabs(axes[1].y) * extents.y +
+                                          std::fabs(axes[2].y) * extents.z,
+                                          std::fabs(axes[0].z) * extents.x + std::fabs(axes[1].z) * extents.y +
+                                          std::fabs(axes[2].z) * extents.z);
+
+                        Vector3d boxMinimum = center - halfSize;
+                        Vector3d boxMaximum = center + halfSize;
+
+                        if(isEmpty)
+                        {
+                                minimum = boxMinimum;
+                                maximum = boxMaximum;
+                                isEmpty = false;
+                                continue;
+                        }
+
+                        minimum.define(std::min(minimum.x, boxMinimum.x), std::min(minimum.y, boxMinimum.y),
+                                       std::min(minimum.z, boxMinimum.z));
+                        maximum.define(std::max(maximum.x, boxMaximum.x), std::max(maximum.y, boxMaximum.y),
+                                       std::max(maximum.z, boxMaximum.z));
+                }
+
+                if(isEmpty)
+                        return false;
+
+                boundingBox.define(0.5f * (minimum + maximum), maximum.x - minimum.x,
+                                   maximum.y - minimum.y, maximum.z - minimum.z);
+                return true;
+        }
+
         //-------------------------------------------------------------------------------------------------------------
         int32_t Skeleton::Instance::getBoneIndex(const std::string& boneName) const
         {
@@ -184,6 +476,12 @@ namespace selene
                 return skeleton->getBoneIndex(boneName);
         }
 
+        //-------------------------------------------------------------------------------------------------------------
+        std::shared_ptr<Skeleton> Skeleton::Instance::getSkeleton() const
+        {
+                return skeleton_.lock();
+        }
+
         //-------------------------------------------------------------------------------------------------------------
         void Skeleton::Instance::computeFinalBoneTransforms() const
         {
@@ -192,23 +490,122 @@ namespace selene
                         return;
 
                 const auto& bones = skeleton->bones_;
+                uint16_t numBones = localBoneTransforms_.getSize();
 
-                if(bones.getSize() != localBoneTransforms_.getSize())
+                if(bones.getSize() != numBones || outdatedBoneFlags_.getSize() != numBones)
                         return;
 
-                for(uint16_t i = 0; i < localBoneTransforms_.getSize(); ++i)
+                bool shouldInterpolatePose = (poseInterpolationScalar_ < 1.0f &&
+                                              storedBoneTransforms_.getSize() == numBones);
+
+                // combine outdated subtrees, children of the outdated bones are outdated too
+                for(uint16_t i = 0; i < numBones; ++i)
                 {
                         int32_t parent = bones[i].parent;
-                        if(parent >= 0 && parent < localBoneTransforms_.getSize())
-                                combinedBoneTransforms_[i] = combinedBoneTransforms_[parent] + localBoneTransforms_[i];
+                        bool hasParent = (parent >= 0 && parent < numBones);
+
+                        if(hasParent && outdatedBoneFlags_[parent])
+                                outdatedBoneFlags_[i] = true;
+
+                        if(!outdatedBoneFlags_[i])
+                                continue;
+
+                        if(shouldInterpolatePose)
+                        {
+                                Transform localBoneTransform = getInterpolatedLocalBoneTransform(i);
+
+                                if(hasParent)
+                                        combinedBoneTransforms_[i].combine(combinedBoneTransforms_[parent],
+                                                                           localBoneTransform);
+                                else
+                                        combinedBoneTransforms_[i] = localBoneTransform;
+                        }
                         else
-                                combinedBoneTransforms_[i] = localBoneTransforms_[i];
+                        {
+                                if(hasParent)
+                                        combinedBoneTransforms_[i].combine(combinedBoneTransforms_[parent],
+                                                                           localBoneTransforms_[i]);
+                                else
+                                        combinedBoneTransforms_[i] = localBoneTransforms_[i];
+                        }
+                }
+
+                // apply bind pose transformation and fill palette
+                for(uint16_t i = 0; i < numBones; ++i)
+                {
+                        if(!outdatedBoneFlags_[i])
+                                continue;
+
+                        finalBoneTransforms_[i].combine(combinedBoneTransforms_[i], bones[i].offsetTransform);
+                        writePaletteEntry(i);
+                        outdatedBoneFlags_[i] = false;
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void Skeleton::Instance::invalidateAllBones()
+        {
+                for(uint16_t i = 0; i < outdatedBoneFlags_.getSize(); ++i)
+                        outdatedBoneFlags_[i] = true;
+
+                isUpdated_ = false;
+        }
 
-                        finalBoneTransforms_[i] = combinedBoneTransforms_[i] + bones[i].offsetTransform;
+        //-------------------------------------------------------------------------------------------------------------
+        void Skeleton::Instance::writePaletteEntry(uint16_t index) const
+        {
+                const Transform& transform = finalBoneTransforms_[index];
+                const Quaternion& q = transform.rotation;
+                const Vector3d& t = transform.position;
+
+                if(paletteFormat_ == PALETTE_MATRICES)
+                {
+                        float* matrix = &palette_[12 * static_cast<uint32_t>(index)];
+
+                        matrix[0]  = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+                        matrix[1]  = 2.0f * (q.x * q.y - q.w * q.z);
+                        matrix[2]  = 2.0f * (q.x * q.z + q.w * q.y);
+                        matrix[3]  = t.x;
+
+                        matrix[4]  = 2.0f * (q.x * q.y + q.w * q.z);
+                        matrix[5]  = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+                        matrix[6]  = 2.0f * (q.y * q.z - q.w * q.x);
+                        matrix[7]  = t.y;
+
+                        matrix[8]  = 2.0f * (q.x * q.z - q.w * q.y);
+                        matrix[9]  = 2.0f * (q.y * q.z + q.w * q.x);
+                        matrix[10] = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+                        matrix[11] = t.z;
+                }
+                else if(paletteFormat_ == PALETTE_DUAL_QUATERNIONS)
+                {
+                        float* dualQuaternion = &palette_[8 * static_cast<uint32_t>(index)];
+
+                        // real part is rotation, dual part is 0.5 * (t, 0) * q
+                        dualQuaternion[0] = q.x;
+                        dualQuaternion[1] = q.y;
+                        dualQuaternion[2] = q.z;
+                        dualQuaternion[3] = q.w;
+
+                        dualQuaternion[4] =  0.5f * ( t.x * q.w + t.y * q.z - t.z * q.y);
+                        dualQuaternion[5] =  0.5f * (-t.x * q.z + t.y * q.w + t.z * q.x);
+                        dualQuaternion[6] =  0.5f * ( t.x * q.y - t.y * q.x + t.z * q.w);
+                        dualQuaternion[7] = -0.5f * ( t.x * q.x + t.y * q.y + t.z * q.z);
                 }
         }
 
-        Skeleton::Skeleton(): bones_(), initialLocalBoneTransforms_(), bonesMap_() {}
+        //-------------------------------------------------------------------------------------------------------------
+        Skeleton::Transform Skeleton::Instance::getInterpolatedLocalBoneTransform(uint16_t index) const
+        {
+                Transform transform;
+                transform.rotation = storedBoneTransforms_[index].rotation.lerp(localBoneTransforms_[index].rotation,
+                                                                                 poseInterpolationScalar_);
+                transform.position = storedBoneTransforms_[index].position.lerp(localBoneTransforms_[index].position,
+                                                                                 poseInterpolationScalar_);
+                return transform;
+        }
+
+        Skeleton::Skeleton(): bones_(), initialLocalBoneTransforms_(), boneBounds_(), bonesMap_() {}
         Skeleton::~Skeleton() {}
 
         //-------------------------------------------------------------------------------------------------------------
@@ -261,6 +658,7 @@ namespace selene
                 bonesMap_.clear();
                 bones_.destroy();
                 initialLocalBoneTransforms_.destroy();
+                boneBounds_.destroy();
         }
 
         //-------------------------------------------------------------------------------------------------------------
@@ -288,4 +686,85 @@ namespace selene
                 return static_cast<int32_t>(it->second);
         }
 
+        //-------------------------------------------------------------------------------------------------------------
+        bool Skeleton::computeBoneBounds(const Array<uint8_t, uint32_t>& positions,
+                                         const Array<uint8_t, uint32_t>& boneIndicesAndWeights)
+        {
+                boneBounds_.destroy();
+
+                uint16_t numBones = bones_.getSize();
+
+                if(positions.isEmpty() || boneIndicesAndWeights.isEmpty() || numBones == 0)
+                        return false;
+
+                if(positions.getSize() != boneIndicesAndWeights.getSize() ||
+                   positions.getStride() < sizeof(Vector3d) ||
+                   boneIndicesAndWeights.getStride() < 2 * sizeof(Vector4d))
+                        return false;
+
+                Array<Vector3d, uint16_t> minimums, maximums;
+                if(!boneBounds_.create(numBones) || !minimums.create(numBones) || !maximums.create(numBones))
+                {
+                        boneBounds_.destroy();
+                        return false;
+                }
+
+                for(uint16_t i = 0; i < numBones; ++i)
+                        boneBounds_[i].isPresent = false;
+
+                // transform each vertex to the space of its bones
+                for(uint32_t i = 0; i < positions.getSize(); ++i)
+                {
+                        const Vector3d& position =
+                                *reinterpret_cast<const Vector3d*>(&positions[i * positions.getStride()]);
+                        uint32_t offset = i * boneIndicesAndWeights.getStride();
+                        const float* vertexBones = reinterpret_cast<const float*>(&boneIndicesAndWeights[offset]);
+
+                        for(uint8_t j = 0; j < 4; ++j)
+                        {
+                                uint32_t boneIndex = static_cast<uint32_t>(vertexBones[j]);
+                                if(boneIndex >= numBones || vertexBones[j + 4] <= 0.0f)
+                                        continue;
+
+                                const Transform& offsetTransform = bones_[boneIndex].offsetTransform;
+                                Vector3d bonePosition = offsetTransform.position +
+                                                        offsetTransform.rotation.rotate(position);
+
+                                Vector3d& minimum = minimums[boneIndex];
+                                Vector3d& maximum = maximums[boneIndex];
+
+                                if(!boneBounds_[boneIndex].isPresent)
+                                {
+                                        minimum = maximum = bonePosition;
+                                        boneBounds_[boneIndex].isPresent = true;
+                                        continue;
+                                }
+
+                                minimum.define(std::min(minimum.x, bonePosition.x),
+                                               std::min(minimum.y, bonePosition.y),
+                                               std::min(minimum.z, bonePosition.z));
+                                maximum.define(std::max(maximum.x, bonePosition.x),
+                                               std::max(maximum.y, bonePosition.y),
+                                               std::max(maximum.z, bonePosition.z));
+                        }
+                }
+
+                for(uint16_t i = 0; i < numBones; ++i)
+                {
+                        if(!boneBounds_[i].isPresent)
+                                continue;
+
+                        boneBounds_[i].center  = 0.5f * (minimums[i] + maximums[i]);
+                        boneBounds_[i].extents = 0.5f * (maximums[i] - minimums[i]);
+                }
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        const Array<Skeleton::BoneBounds, uint16_t>& Skeleton::getBoneBounds() const
+        {
+                return boneBounds_;
+        }
+
 }
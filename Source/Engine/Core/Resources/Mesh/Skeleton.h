@@ -6,10 +6,12 @@
 
 #include "../../Helpers/Array.h"
 #include "../../Math/Vector.h"
+#include "../../Math/Box.h"
 
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace selene
 {
@@ -54,6 +56,17 @@ namespace selene
                          */
                         Transform operator +(const Transform& transform);
 
+                        /**
+                         * \brief Combines two transforms.
+                         *
+                         * Result is the same as first + second, but it is written in place and no temporary
+                         * quaternions are created (rotation quaternions must be normalized). Current transform
+                         * can be one of the arguments.
+                         * \param[in] first first transform
+                         * \param[in] second second transform, which is applied in space of the first
+                         */
+                        void combine(const Transform& first, const Transform& second);
+
                         /**
                          * \brief Computes inverted transform.
                          * \param[in] transform initial transform
@@ -103,6 +116,47 @@ namespace selene
 
                 };
 
+                /**
+                 * Represents bounds of the bone. This is axis-aligned box in the space of the bone, which
+                 * contains all vertices influenced by the bone.
+                 */
+                class BoneBounds
+                {
+                public:
+                        Vector3d center;
+                        Vector3d extents;
+                        bool isPresent;
+
+                        BoneBounds();
+                        BoneBounds(const BoneBounds&) = default;
+                        ~BoneBounds();
+                        BoneBounds& operator =(const BoneBounds&) = default;
+
+                };
+
+                /**
+                 * Represents animation layer. Layer references two keys of the animation (arrays of bone
+                 * transforms), interpolation scalar between them, blend factor of the layer and optional
+                 * weights of the bones (mask). Key indices map each bone of the skeleton to the index of its
+                 * transform in the keys (negative index means that bone is not animated by the layer).
+                 */
+                class Layer
+                {
+                public:
+                        const Array<BoneTransform, uint16_t>* key0;
+                        const Array<BoneTransform, uint16_t>* key1;
+                        const Array<int32_t, uint16_t>* keyIndices;
+                        const Array<float, uint16_t>* boneWeights;
+                        float keyScalar;
+                        float blendFactor;
+
+                        Layer();
+                        Layer(const Layer&) = default;
+                        ~Layer();
+                        Layer& operator =(const Layer&) = default;
+
+                };
+
                 /**
                  * Represents skeleton instance. This instance can be animated. It also holds reference to the
                  * original skeleton.
@@ -110,6 +164,14 @@ namespace selene
                 class Instance
                 {
                 public:
+                        /// Palette formats
+                        enum
+                        {
+                                PALETTE_NONE = 0,
+                                PALETTE_MATRICES,
+                                PALETTE_DUAL_QUATERNIONS
+                        };
+
                         Instance();
                         Instance(const Instance&) = delete;
                         ~Instance();
@@ -143,6 +205,30 @@ namespace selene
                          */
                         const Array<Transform, uint16_t>& getCombinedBoneTransforms() const;
 
+                        /**
+                         * \brief Sets palette format.
+                         *
+                         * Palette holds final bone transforms in the form, which can be directly uploaded
+                         * to the GPU. Matrices are stored as 3x4 matrices (rows of the rotation matrix with
+                         * translation in the fourth column), dual quaternions are stored as rotation quaternion
+                         * followed by dual part. Palette is updated together with final bone transforms.
+                         * \param[in] format palette format (PALETTE_NONE disables palette)
+                         * \return true if palette format has been successfully set
+                         */
+                        bool setPaletteFormat(uint8_t format);
+
+                        /**
+                         * \brief Returns palette format.
+                         * \return palette format
+                         */
+                        uint8_t getPaletteFormat() const;
+
+                        /**
+                         * \brief Returns palette.
+                         * \return const reference to the palette (empty if palette format is PALETTE_NONE)
+                         */
+                        const Array<float, uint32_t>& getPalette() const;
+
                         /**
                          * \brief Sets initial skeleton pose.
                          */
@@ -156,6 +242,60 @@ namespace selene
                         void blendPose(const Array<BoneTransform, uint16_t>& boneTransforms,
                                        float blendFactor);
 
+                        /**
+                         * \brief Blends skeleton pose with animation layers.
+                         *
+                         * Result is the same as sequential blending of each layer with blendPose(), but all
+                         * layers are accumulated in one pass over the bones: keys are interpolated only for
+                         * affected bones and each bone is written once. Blend factor of the bone is the blend
+                         * factor of the layer multiplied by the weight of the bone. Bones, which are not affected
+                         * by any layer, are left untouched (and are not recomputed later).
+                         * \param[in] layers animation layers (from the first to the last); each layer must have
+                         * key indices for all bones of the skeleton
+                         */
+                        void blendLayers(const std::vector<Layer>& layers);
+
+                        /**
+                         * \brief Stores current pose.
+                         *
+                         * Stored pose is the pose, which is currently seen by the renderer (it takes pose
+                         * interpolation into account). After this operation interpolatePose() can be used to
+                         * smoothly move from the stored pose to the pose, which is computed with blendPose().
+                         */
+                        void storePose();
+
+                        /**
+                         * \brief Interpolates between stored and current pose.
+                         *
+                         * This is used when skeleton is animated with reduced update rate. Resulting pose is
+                         * seen through getFinalBoneTransforms() and getCombinedBoneTransforms() functions,
+                         * blendPose() is not affected.
+                         * \param[in] scalar interpolation scalar (zero for the stored pose, one and greater
+                         * for the current pose)
+                         */
+                        void interpolatePose(float scalar);
+
+                        /**
+                         * \brief Copies pose from another skeleton instance.
+                         *
+                         * Pose is copied only if both instances have the same number of bones.
+                         * \param[in] instance skeleton instance, whose pose will be copied
+                         */
+                        void copyPose(const Instance& instance);
+
+                        /**
+                         * \brief Computes bounding box of the current pose.
+                         *
+                         * Bounds of the bones are transformed with combined bone transforms and merged, so
+                         * the cost of this operation depends only on the number of bones.
+                         * \see Skeleton::computeBoneBounds
+                         * \param[out] boundingBox bounding box, which contains all vertices of the skin mesh
+                         * in current pose
+                         * \return true if bounding box has been successfully computed (false if skeleton has
+                         * no bone bounds)
+                         */
+                        bool computeBoundingBox(Box& boundingBox) const;
+
                         /**
                          * \brief Returns bone index.
                          * \param[in] boneName name of the bone
@@ -163,18 +303,50 @@ namespace selene
                          */
                         int32_t getBoneIndex(const std::string& boneName) const;
 
+                        /**
+                         * \brief Returns skeleton.
+                         * \return shared pointer to the skeleton (empty if instance is not initialized)
+                         */
+                        std::shared_ptr<Skeleton> getSkeleton() const;
+
                 private:
                         Array<Transform, uint16_t> localBoneTransforms_;
+                        Array<Transform, uint16_t> storedBoneTransforms_;
                         mutable Array<Transform, uint16_t> combinedBoneTransforms_;
                         mutable Array<Transform, uint16_t> finalBoneTransforms_;
+                        mutable Array<bool, uint16_t> outdatedBoneFlags_;
+                        mutable Array<float, uint32_t> palette_;
                         std::weak_ptr<Skeleton> skeleton_;
+                        float poseInterpolationScalar_;
+                        uint8_t paletteFormat_;
                         mutable bool isUpdated_;
 
                         /**
                          * \brief Computes final bone transforms.
+                         *
+                         * Bones are processed in order of the bones array (parent bones precede their
+                         * children), only outdated bones and their subtrees are recomputed.
                          */
                         void computeFinalBoneTransforms() const;
 
+                        /**
+                         * \brief Marks all bones as outdated.
+                         */
+                        void invalidateAllBones();
+
+                        /**
+                         * \brief Writes final transform of the bone to the palette.
+                         * \param[in] index index of the bone
+                         */
+                        void writePaletteEntry(uint16_t index) const;
+
+                        /**
+                         * \brief Returns local bone transform, which is seen by the renderer.
+                         * \param[in] index index of the bone
+                         * \return local bone transform with pose interpolation applied
+                         */
+                        Transform getInterpolatedLocalBoneTransform(uint16_t index) const;
+
                 };
 
                 Skeleton();
@@ -212,9 +384,28 @@ namespace selene
                  */
                 int32_t getBoneIndex(const std::string& boneName) const;
 
+                /**
+                 * \brief Computes bounds of the bones.
+                 *
+                 * Each vertex is transformed to the space of each bone, which influences it, so the bounds
+                 * are computed only once (when mesh is loaded). Skeleton must be initialized.
+                 * \param[in] positions vertex positions of the skin mesh in bind pose
+                 * \param[in] boneIndicesAndWeights bone indices and weights of the vertices
+                 * \return true if bounds have been successfully computed
+                 */
+                bool computeBoneBounds(const Array<uint8_t, uint32_t>& positions,
+                                       const Array<uint8_t, uint32_t>& boneIndicesAndWeights);
+
+                /**
+                 * \brief Returns bounds of the bones.
+                 * \return const reference to the array of bone bounds (empty if bounds have not been computed)
+                 */
+                const Array<BoneBounds, uint16_t>& getBoneBounds() const;
+
         private:
                 Array<Bone, uint16_t> bones_;
                 Array<Transform, uint16_t> initialLocalBoneTransforms_;
+                Array<BoneBounds, uint16_t> boneBounds_;
                 std::unordered_map<std::string, uint16_t> bonesMap_;
 
         };
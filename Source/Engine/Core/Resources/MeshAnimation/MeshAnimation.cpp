@@ -21,11 +21,44 @@ namespace selene
         //--------------------------------------------------------------------------------------------------
         const MeshAnimation::Key& MeshAnimation::getInterpolatedKey(float scalar)
         {
-                if(getNumKeys() == 0)
+                const Key* key0 = nullptr;
+                const Key* key1 = nullptr;
+
+                if(!findInterpolationKeys(scalar, key0, key1, scalar))
                         return data_.emptyKey;
 
+                if(key0 == key1)
+                        return *key0;
+
+                Key& key = data_.helperKey;
+
+                if(key0->getSize() == key1->getSize() && key.getSize() == key0->getSize())
+                {
+                        for(uint32_t i = 0; i < key.getSize(); ++i)
+                        {
+                                key[i].transform.rotation =
+                                        (*key0)[i].transform.rotation.lerp((*key1)[i].transform.rotation, scalar);
+                                key[i].transform.position =
+                                        (*key0)[i].transform.position.lerp((*key1)[i].transform.position, scalar);
+                        }
+                }
+
+                return data_.helperKey;
+        }
+
+        //--------------------------------------------------------------------------------------------------
+        bool MeshAnimation::findInterpolationKeys(float scalar, const Key*& key0, const Key*& key1,
+                                                  float& keyScalar)
+        {
+                if(getNumKeys() == 0)
+                        return false;
+
                 if(getNumKeys() == 1)
-                        return data_.keys[0];
+                {
+                        key0 = key1 = &data_.keys[0];
+                        keyScalar = 0.0f;
+                        return true;
+                }
 
                 if(scalar < 0.0f)
                         scalar = 0.0f;
@@ -43,24 +76,11 @@ namespace selene
                         frame1 = 0;
 
                 float start = static_cast<float>(frame0) * data_.lengthInv;
-                scalar = (scalar - start) * data_.length;
 
-                const Key& key0 = getKey(frame0);
-                const Key& key1 = getKey(frame1);
-                Key& key = data_.helperKey;
-
-                if(key0.getSize() == key1.getSize() && key.getSize() == key0.getSize())
-                {
-                        for(uint32_t i = 0; i < key.getSize(); ++i)
-                        {
-                                key[i].transform.rotation =
-                                        key0[i].transform.rotation.lerp(key1[i].transform.rotation, scalar);
-                                key[i].transform.position =
-                                        key0[i].transform.position.lerp(key1[i].transform.position, scalar);
-                        }
-                }
-
-                return data_.helperKey;
+                key0 = &data_.keys[frame0];
+                key1 = &data_.keys[frame1];
+                keyScalar = (scalar - start) * data_.length;
+                return true;
         }
 
         //--------------------------------------------------------------------------------------------------
@@ -73,6 +73,20 @@ namespace selene
                  */
                 const Key& getInterpolatedKey(float scalar);
 
+                /**
+                 * \brief Finds mesh animation keys, between which interpolation is performed.
+                 *
+                 * This function does not change helper key, so resulting keys can be interpolated directly
+                 * (for example, only for some bones).
+                 * \param[in] scalar interpolation amount (float in [0; 1] range, where
+                 * zero stands for the first animation key and one - for the last)
+                 * \param[out] key0 pointer to the first mesh animation key
+                 * \param[out] key1 pointer to the second mesh animation key
+                 * \param[out] keyScalar interpolation scalar between first and second keys
+                 * \return true if keys have been found (false if mesh animation has no keys)
+                 */
+                bool findInterpolationKeys(float scalar, const Key*& key0, const Key*& key1, float& keyScalar);
+
                 /**
                  * \brief Returns mesh animation key.
                  * \param[in] index index of the mesh animation key
@@ -2,6 +2,8 @@
 // Licensed under the MIT License (see LICENSE.txt for details)
 
 #include "MeshAnimationProcessor.h"
+#include "../../Helpers/Name.h"
+#include <algorithm>
 #include <utility>
 
 namespace selene
@@ -18,8 +20,9 @@ namespace selene
                 numTimesPlayed_(0), blendFactorTransitionTime_(0.0f), startingTransitionTime_(0.0f),
                 stoppingTransitionTime_(0.0f), animationTime_(0.0f), elapsedTime_(0.0f),
                 animationInterpolationScalar_(0.0f), blendFactor_(),
-                blendFactorInterpolationScalar_(1.0f),
-                state_(STOPPED)
+                blendFactorInterpolationScalar_(1.0f), currentScalar_(0.0f), currentBlendFactor_(0.0f),
+                keyIndices_(), boneWeights_(), boneWeightsHash_(0), areAllBonesAnimated_(false),
+                isMaskPartial_(false), state_(STOPPED)
         {
                 blendFactorTransitionTime_ =
                         blendFactorTransitionTime > SELENE_EPSILON ? blendFactorTransitionTime : 0.0f;
@@ -111,8 +114,79 @@ namespace selene
         }
 
         //------------------------------------------------------------------------------------------------------------
-        void MeshAnimationProcessor::MixableMeshAnimation::process(float elapsedTime)
+        bool MeshAnimationProcessor::MixableMeshAnimation::setBoneWeight(const std::string& boneName, float weight,
+                                                                          bool shouldApplyToChildren)
         {
+                if(skeletonInstance_ == nullptr)
+                        return false;
+
+                auto skeleton = skeletonInstance_->getSkeleton();
+                if(!skeleton)
+                        return false;
+
+                const auto& bones = skeleton->getBones();
+                int32_t boneIndex = skeleton->getBoneIndex(boneName);
+
+                if(boneIndex < 0)
+                        return false;
+
+                if(boneWeights_.getSize() != bones.getSize())
+                {
+                        if(!boneWeights_.create(bones.getSize()))
+                                return false;
+
+                        for(uint16_t i = 0; i < boneWeights_.getSize(); ++i)
+                                boneWeights_[i] = 1.0f;
+                }
+
+                Array<bool, uint16_t> subtree;
+                if(!subtree.create(bones.getSize()))
+                        return false;
+
+                weight = std::max(0.0f, std::min(1.0f, weight));
+
+                // parent bones precede their children, so subtree is marked in one pass
+                for(uint16_t i = 0; i < bones.getSize(); ++i)
+                {
+                        int32_t parent = bones[i].parent;
+
+                        subtree[i] = (i == boneIndex);
+                        if(shouldApplyToChildren && parent >= 0 && parent < bones.getSize())
+                                subtree[i] = subtree[i] || subtree[parent];
+
+                        if(subtree[i])
+                                boneWeights_[i] = weight;
+                }
+
+                isMaskPartial_ = false;
+                for(uint16_t i = 0; i < boneWeights_.getSize(); ++i)
+                        isMaskPartial_ = isMaskPartial_ || (boneWeights_[i] < 1.0f);
+
+                // hash of the weights identifies the mask in the pose cache
+                boneWeightsHash_ = Name::HASH_OFFSET_BASIS;
+
+                for(uint16_t i = 0; i < boneWeights_.getSize(); ++i)
+                {
+                        boneWeightsHash_ ^= static_cast<uint32_t>(boneWeights_[i] * 65535.0f);
+                        boneWeightsHash_ *= Name::HASH_PRIME;
+                }
+
+                return true;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::MixableMeshAnimation::clearBoneWeights()
+        {
+                boneWeights_.destroy();
+                boneWeightsHash_ = 0;
+                isMaskPartial_ = false;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::MixableMeshAnimation::advance(float elapsedTime)
+        {
+                currentBlendFactor_ = 0.0f;
+
                 if(state_ == STOPPED || skeletonInstance_ == nullptr)
                         return;
 
@@ -141,10 +215,8 @@ namespace selene
 
                         if(elapsedTime_ > 0.0f)
                         {
-                                const MeshAnimation::Key& key =
-                                        meshAnimation->getInterpolatedKey(animationInterpolationScalar_);
-                                skeletonInstance_->blendPose(key,
-                                                             blendFactor * elapsedTime_ / stoppingTransitionTime_);
+                                currentScalar_ = animationInterpolationScalar_;
+                                currentBlendFactor_ = blendFactor * elapsedTime_ / stoppingTransitionTime_;
                         }
                         else
                                 state_ = STOPPED;
@@ -159,10 +231,8 @@ namespace selene
                 {
                         if(elapsedTime_ <= startingTransitionTime_)
                         {
-                                const MeshAnimation::Key& key =
-                                        meshAnimation->getInterpolatedKey(animationInterpolationScalar_);
-                                skeletonInstance_->blendPose(key,
-                                                             blendFactor * elapsedTime_ / startingTransitionTime_);
+                                currentScalar_ = animationInterpolationScalar_;
+                                currentBlendFactor_ = blendFactor * elapsedTime_ / startingTransitionTime_;
                         }
                         else
                         {
@@ -184,17 +254,161 @@ namespace selene
                                         numTimesPlayed_ += static_cast<uint32_t>(intPart);
                         }
 
-                        const MeshAnimation::Key& key =
-                                meshAnimation->getInterpolatedKey(elapsedTime_ / animationTime_);
-                        skeletonInstance_->blendPose(key, blendFactor);
+                        currentScalar_ = elapsedTime_ / animationTime_;
+                        currentBlendFactor_ = blendFactor;
 
                         if(numTimesToPlay_ != 0 && numTimesPlayed_ >= numTimesToPlay_)
                                 stop();
                 }
         }
 
+        //------------------------------------------------------------------------------------------------------------
+        bool MeshAnimationProcessor::MixableMeshAnimation::computeLayer(float minBlendFactor,
+                                                                         Skeleton::Layer& layer)
+        {
+                if(!affectsPose(minBlendFactor))
+                        return false;
+
+                MeshAnimation* meshAnimation = *meshAnimation_;
+                if(meshAnimation == nullptr)
+                        return false;
+
+                if(!meshAnimation->findInterpolationKeys(currentScalar_, layer.key0, layer.key1, layer.keyScalar))
+                        return false;
+
+                if(keyIndices_.isEmpty() && !computeKeyIndices())
+                        return false;
+
+                layer.keyIndices  = &keyIndices_;
+                layer.boneWeights = boneWeights_.isEmpty() ? nullptr : &boneWeights_;
+                layer.blendFactor = currentBlendFactor_;
+                return true;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        bool MeshAnimationProcessor::MixableMeshAnimation::computeKeyIndices()
+        {
+                MeshAnimation* meshAnimation = *meshAnimation_;
+                if(meshAnimation == nullptr || meshAnimation->getNumKeys() == 0)
+                        return false;
+
+                auto skeleton = skeletonInstance_->getSkeleton();
+                if(!skeleton || skeleton->getBones().isEmpty())
+                        return false;
+
+                if(!keyIndices_.create(skeleton->getBones().getSize()))
+                        return false;
+
+                for(uint16_t i = 0; i < keyIndices_.getSize(); ++i)
+                        keyIndices_[i] = -1;
+
+                // all keys of the animation have the same order of bone transforms
+                const MeshAnimation::Key& key = meshAnimation->getKey(0);
+
+                for(uint16_t i = 0; i < key.getSize(); ++i)
+                {
+                        int32_t boneIndex = skeleton->getBoneIndex(key[i].boneName);
+                        if(boneIndex >= 0)
+                                keyIndices_[boneIndex] = i;
+                }
+
+                areAllBonesAnimated_ = true;
+                for(uint16_t i = 0; i < keyIndices_.getSize(); ++i)
+                        areAllBonesAnimated_ = areAllBonesAnimated_ && (keyIndices_[i] >= 0);
+
+                return true;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        bool MeshAnimationProcessor::MixableMeshAnimation::affectsPose(float minBlendFactor) const
+        {
+                return (skeletonInstance_ != nullptr && currentBlendFactor_ > 0.0f &&
+                        currentBlendFactor_ >= minBlendFactor);
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        bool MeshAnimationProcessor::MixableMeshAnimation::overwritesPose(float minBlendFactor)
+        {
+                if(!affectsPose(minBlendFactor) || currentBlendFactor_ < 1.0f || isMaskPartial_)
+                        return false;
+
+                if(keyIndices_.isEmpty() && !computeKeyIndices())
+                        return false;
+
+                return areAllBonesAnimated_;
+        }
+
+        MeshAnimationProcessor::PoseCache::PoseCache(float timeQuantum, float blendFactorQuantum):
+                poses_(), timeQuantumInv_(0.0f), blendFactorQuantumInv_(0.0f),
+                numEvaluatedPoses_(0), numSharedPoses_(0)
+        {
+                timeQuantumInv_ = 1.0f / (timeQuantum > SELENE_EPSILON ? timeQuantum : SELENE_EPSILON);
+                blendFactorQuantumInv_ =
+                        1.0f / (blendFactorQuantum > SELENE_EPSILON ? blendFactorQuantum : SELENE_EPSILON);
+        }
+        MeshAnimationProcessor::PoseCache::~PoseCache() {}
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::PoseCache::clear()
+        {
+                poses_.clear();
+                numEvaluatedPoses_ = numSharedPoses_ = 0;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        uint32_t MeshAnimationProcessor::PoseCache::getNumEvaluatedPoses() const
+        {
+                return numEvaluatedPoses_;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        uint32_t MeshAnimationProcessor::PoseCache::getNumSharedPoses() const
+        {
+                return numSharedPoses_;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        std::size_t MeshAnimationProcessor::PoseCache::KeyHasher::operator()(const Key& key) const
+        {
+                // FNV-1a
+                uint32_t hash = Name::HASH_OFFSET_BASIS;
+
+                for(auto it = key.begin(); it != key.end(); ++it)
+                {
+                        hash ^= *it;
+                        hash *= Name::HASH_PRIME;
+                }
+
+                return static_cast<std::size_t>(hash);
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        std::shared_ptr<const Skeleton::Instance> MeshAnimationProcessor::PoseCache::findPose(const Key& key)
+        {
+                auto it = poses_.find(key);
+                if(it == poses_.end())
+                        return std::shared_ptr<const Skeleton::Instance>();
+
+                ++numSharedPoses_;
+                return it->second;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::PoseCache::addPose(const Key& key, const std::shared_ptr<const Skeleton::Instance>&
+                                                        skeletonInstance)
+        {
+                try
+                {
+                        if(poses_.insert(std::make_pair(key, skeletonInstance)).second)
+                                ++numEvaluatedPoses_;
+                }
+                catch(...) {}
+        }
+
         MeshAnimationProcessor::MeshAnimationProcessor():
-                mixableMeshAnimations_(), emptyMixableMeshAnimation_(), skeletonInstance_() {}
+                mixableMeshAnimations_(), emptyMixableMeshAnimation_(), skeletonInstance_(),
+                sharedSkeletonInstance_(), emptySkeletonInstance_(), skeleton_(nullptr), poseKey_(), layers_(),
+                updateInterval_(0.0f), minBlendFactor_(0.0f), accumulatedTime_(0.0f), isPoseOutdated_(false) {}
         MeshAnimationProcessor::~MeshAnimationProcessor()
         {
                 destroy();
@@ -204,20 +418,43 @@ namespace selene
         bool MeshAnimationProcessor::initialize(const std::shared_ptr<Skeleton>& skeleton)
         {
                 destroy();
-                return skeletonInstance_.initialize(skeleton);
+
+                skeletonInstance_.reset(new(std::nothrow) Skeleton::Instance);
+                if(!skeletonInstance_)
+                        return false;
+
+                if(!skeletonInstance_->initialize(skeleton))
+                {
+                        destroy();
+                        return false;
+                }
+
+                skeleton_ = skeleton.get();
+                return true;
         }
 
         //------------------------------------------------------------------------------------------------------------
         void MeshAnimationProcessor::destroy()
         {
                 mixableMeshAnimations_.clear();
-                skeletonInstance_.destroy();
+                skeletonInstance_.reset();
+                sharedSkeletonInstance_.reset();
+                skeleton_ = nullptr;
+
+                accumulatedTime_ = 0.0f;
+                isPoseOutdated_ = false;
         }
 
         //------------------------------------------------------------------------------------------------------------
         const Skeleton::Instance& MeshAnimationProcessor::getSkeletonInstance() const
         {
-                return skeletonInstance_;
+                if(sharedSkeletonInstance_)
+                        return *sharedSkeletonInstance_;
+
+                if(skeletonInstance_)
+                        return *skeletonInstance_;
+
+                return emptySkeletonInstance_;
         }
 
         //------------------------------------------------------------------------------------------------------------
@@ -228,7 +465,7 @@ namespace selene
                                                       float animationTime,
                                                       float blendFactor)
         {
-                if(*meshAnimation == nullptr)
+                if(*meshAnimation == nullptr || !skeletonInstance_)
                         return false;
 
                 auto mixableMeshAnimation = new(std::nothrow) MixableMeshAnimation(meshAnimation,
@@ -237,7 +474,7 @@ namespace selene
                                                                                    stoppingTransitionTime,
                                                                                    animationTime,
                                                                                    blendFactor,
-                                                                                   &skeletonInstance_);
+                                                                                   skeletonInstance_.get());
 
                 if(mixableMeshAnimation == nullptr)
                         return false;
@@ -277,12 +514,191 @@ namespace selene
         }
 
         //------------------------------------------------------------------------------------------------------------
-        void MeshAnimationProcessor::processMeshAnimations(float elapsedTime)
+        void MeshAnimationProcessor::setUpdateInterval(float updateInterval)
+        {
+                updateInterval_ = updateInterval > SELENE_EPSILON ? updateInterval : 0.0f;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        float MeshAnimationProcessor::getUpdateInterval() const
+        {
+                return updateInterval_;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::setMinBlendFactor(float minBlendFactor)
+        {
+                minBlendFactor_ = minBlendFactor > 0.0f ? minBlendFactor : 0.0f;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        float MeshAnimationProcessor::getMinBlendFactor() const
+        {
+                return minBlendFactor_;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::processMeshAnimations(float elapsedTime, PoseCache* poseCache)
+        {
+                if(!skeletonInstance_)
+                        return;
+
+                accumulatedTime_ += elapsedTime;
+
+                // compute pose on each call if update rate is not reduced
+                if(updateInterval_ < SELENE_EPSILON || isPoseOutdated_)
+                {
+                        advanceAll(accumulatedTime_);
+                        accumulatedTime_ = 0.0f;
+                        isPoseOutdated_ = false;
+
+                        computePose(poseCache);
+                        return;
+                }
+
+                // compute pose once per update interval, then interpolate from previous pose
+                releaseSharedPose();
+
+                if(accumulatedTime_ >= updateInterval_)
+                {
+                        skeletonInstance_->storePose();
+
+                        advanceAll(accumulatedTime_);
+                        blendAll();
+
+                        accumulatedTime_ = 0.0f;
+                }
+
+                skeletonInstance_->interpolatePose(accumulatedTime_ / updateInterval_);
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::advanceMeshAnimations(float elapsedTime)
+        {
+                if(!skeletonInstance_)
+                        return;
+
+                advanceAll(accumulatedTime_ + elapsedTime);
+
+                accumulatedTime_ = 0.0f;
+                isPoseOutdated_ = true;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::advanceAll(float elapsedTime)
         {
                 for(auto it  = mixableMeshAnimations_.begin();
                          it != mixableMeshAnimations_.end();
                          ++it)
-                        (*it)->process(elapsedTime);
+                        (*it)->advance(elapsedTime);
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::blendAll()
+        {
+                layers_.clear();
+
+                try
+                {
+                        Skeleton::Layer layer;
+
+                        for(auto it  = mixableMeshAnimations_.begin();
+                                 it != mixableMeshAnimations_.end();
+                                 ++it)
+                        {
+                                if((*it)->computeLayer(minBlendFactor_, layer))
+                                        layers_.push_back(layer);
+                        }
+                }
+                catch(...)
+                {
+                        return;
+                }
+
+                skeletonInstance_->blendLayers(layers_);
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::computePose(PoseCache* poseCache)
+        {
+                bool shouldUsePoseCache = (poseCache != nullptr);
+
+                if(shouldUsePoseCache)
+                {
+                        // build key of the current animation state
+                        poseKey_.clear();
+
+                        // pose can be shared only if it does not depend on the previous pose of the skeleton
+                        // (some animation must overwrite all bones), otherwise equal keys can mean different poses
+                        bool isPoseOverwritten = false;
+
+                        try
+                        {
+                                uint64_t skeleton = reinterpret_cast<uintptr_t>(skeleton_);
+                                poseKey_.push_back(static_cast<uint32_t>(skeleton));
+                                poseKey_.push_back(static_cast<uint32_t>(skeleton >> 32));
+
+                                for(auto it  = mixableMeshAnimations_.begin();
+                                         it != mixableMeshAnimations_.end();
+                                         ++it)
+                                {
+                                        MixableMeshAnimation& animation = *(*it);
+                                        if(!animation.affectsPose(minBlendFactor_))
+                                                continue;
+
+                                        uint64_t meshAnimation = reinterpret_cast<uintptr_t>(*animation.meshAnimation_);
+                                        float time = animation.currentScalar_ * animation.animationTime_;
+                                        bool overwritesPose = animation.overwritesPose(minBlendFactor_);
+
+                                        poseKey_.push_back(static_cast<uint32_t>(meshAnimation));
+                                        poseKey_.push_back(static_cast<uint32_t>(meshAnimation >> 32));
+                                        poseKey_.push_back(static_cast<uint32_t>(time * poseCache->timeQuantumInv_ +
+                                                                                 0.5f));
+                                        poseKey_.push_back(static_cast<uint32_t>(animation.currentBlendFactor_ *
+                                                                                 poseCache->blendFactorQuantumInv_ +
+                                                                                 0.5f));
+                                        poseKey_.push_back(animation.boneWeightsHash_);
+                                        poseKey_.push_back(overwritesPose ? 1 : 0);
+
+                                        isPoseOverwritten = isPoseOverwritten || overwritesPose;
+                                }
+                        }
+                        catch(...)
+                        {
+                                shouldUsePoseCache = false;
+                        }
+
+                        if(!isPoseOverwritten)
+                                shouldUsePoseCache = false;
+                }
+
+                if(shouldUsePoseCache)
+                {
+                        auto sharedSkeletonInstance = poseCache->findPose(poseKey_);
+                        if(sharedSkeletonInstance)
+                        {
+                                // own pose is copied now, since owner of the shared pose might change it before
+                                // this processor evaluates its pose again (final transforms are still shared)
+                                skeletonInstance_->copyPose(*sharedSkeletonInstance);
+                                sharedSkeletonInstance_ = sharedSkeletonInstance;
+                                return;
+                        }
+                }
+
+                // evaluate own pose
+                releaseSharedPose();
+
+                skeletonInstance_->interpolatePose(1.0f);
+                blendAll();
+
+                if(shouldUsePoseCache)
+                        poseCache->addPose(poseKey_, skeletonInstance_);
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void MeshAnimationProcessor::releaseSharedPose()
+        {
+                sharedSkeletonInstance_.reset();
         }
 
 }
@@ -6,6 +6,8 @@
 
 #include "../../Math/LinearInterpolator.h"
 #include "MeshAnimation.h"
+#include <unordered_map>
+#include <memory>
 #include <vector>
 
 namespace selene
@@ -111,6 +113,11 @@ namespace selene
                  *
                  * If the second animation has blend factor equal to one, then the first animation's influence is
                  * completely discarded (rewrited by the second animation).
+                 *
+                 * Each animation is a layer, which can be restricted to the part of the skeleton with bone weights
+                 * (for example, upper body animation can be played over full body animation). All layers are
+                 * accumulated in one pass over the bones (see Skeleton::Instance::blendLayers), so bones, which
+                 * are not animated by any layer, cost nothing.
                  */
                 class MixableMeshAnimation
                 {
@@ -165,6 +172,26 @@ namespace selene
                          */
                         void setBlendFactor(float blendFactor);
 
+                        /**
+                         * \brief Sets weight of the bone.
+                         *
+                         * Bone weights form the mask of the animation: blend factor of each bone is multiplied by
+                         * its weight. Initially all bones have weight one.
+                         * \param[in] boneName name of the bone
+                         * \param[in] weight weight of the bone (float in [0; 1] range, zero excludes the bone from
+                         * the animation)
+                         * \param[in] shouldApplyToChildren if true, then weight is also set to all descendants of
+                         * the bone
+                         * \return true if weight has been successfully set
+                         */
+                        bool setBoneWeight(const std::string& boneName, float weight,
+                                           bool shouldApplyToChildren = true);
+
+                        /**
+                         * \brief Clears bone weights (all bones get weight one).
+                         */
+                        void clearBoneWeights();
+
                 private:
                         friend class MeshAnimationProcessor;
 
@@ -192,13 +219,146 @@ namespace selene
                         LinearInterpolator<float> blendFactor_;
                         float blendFactorInterpolationScalar_;
 
+                        float currentScalar_;
+                        float currentBlendFactor_;
+
+                        Array<int32_t, uint16_t> keyIndices_;
+                        Array<float, uint16_t> boneWeights_;
+                        uint32_t boneWeightsHash_;
+                        bool areAllBonesAnimated_;
+                        bool isMaskPartial_;
+
                         STATE state_;
 
                         /**
-                         * \brief Processes mesh animation.
+                         * \brief Advances mesh animation.
+                         *
+                         * Changes state and time of the animation, computes current interpolation scalar and
+                         * blend factor. Pose of the skeleton is not changed.
                          * \param[in] elapsedTime elapsed time since last processing
                          */
-                        void process(float elapsedTime);
+                        void advance(float elapsedTime);
+
+                        /**
+                         * \brief Computes animation layer.
+                         * \param[in] minBlendFactor minimum blend factor (if current blend factor of the animation
+                         * is less than this value, then animation has no effect on skeleton)
+                         * \param[out] layer animation layer, which holds current keys of the mesh animation
+                         * \return true if layer has been computed (false if animation has no effect on skeleton)
+                         */
+                        bool computeLayer(float minBlendFactor, Skeleton::Layer& layer);
+
+                        /**
+                         * \brief Maps bones of the skeleton to the bone transforms of the mesh animation keys.
+                         * \return true if key indices have been successfully computed
+                         */
+                        bool computeKeyIndices();
+
+                        /**
+                         * \brief Returns true if animation affects pose of the skeleton.
+                         * \param[in] minBlendFactor minimum blend factor
+                         * \return true if animation affects pose of the skeleton
+                         */
+                        bool affectsPose(float minBlendFactor) const;
+
+                        /**
+                         * \brief Returns true if animation overwrites pose of the skeleton.
+                         *
+                         * Animation overwrites pose if it affects all bones of the skeleton with full blend factor,
+                         * so resulting pose does not depend on the pose, which skeleton had before blending.
+                         * \param[in] minBlendFactor minimum blend factor
+                         * \return true if animation overwrites pose of the skeleton
+                         */
+                        bool overwritesPose(float minBlendFactor);
+
+                };
+
+                /**
+                 * Represents pose cache. It is used to share evaluated poses between mesh animation processors,
+                 * which play identical animation states on the same skeleton. State is identified by the skeleton,
+                 * list of the affecting animations, their quantized times and blend factors. The first processor,
+                 * which evaluates given state, adds its skeleton instance to the cache; other processors with
+                 * the same state use this instance by reference (so its final bone transforms are computed once)
+                 * and do not sample or blend animations, they only copy local bone transforms of the pose.
+                 *
+                 * Since animations are blended with the current pose, only poses, in which at least one animation
+                 * overwrites all bones (full blend factor, no mask), are shared: other poses depend on the previous
+                 * frames of the processor and are always evaluated.
+                 *
+                 * Pose cache is valid for one frame only, it must be cleared before processing of the next frame.
+                 * Note, that processors, whose update rate is reduced (see setUpdateInterval), do not use the cache.
+                 */
+                class PoseCache
+                {
+                public:
+                        /**
+                         * \brief Constructs pose cache with given quantization parameters.
+                         * \param[in] timeQuantum animation time quantum in seconds
+                         * \param[in] blendFactorQuantum blend factor quantum
+                         */
+                        PoseCache(float timeQuantum = 1.0f / 60.0f, float blendFactorQuantum = 1.0f / 64.0f);
+                        PoseCache(const PoseCache&) = delete;
+                        ~PoseCache();
+                        PoseCache& operator =(const PoseCache&) = delete;
+
+                        /**
+                         * \brief Clears pose cache.
+                         */
+                        void clear();
+
+                        /**
+                         * \brief Returns number of evaluated poses since last clear.
+                         * \return number of poses, which have been added to the cache
+                         */
+                        uint32_t getNumEvaluatedPoses() const;
+
+                        /**
+                         * \brief Returns number of shared poses since last clear.
+                         * \return number of times, when pose has been found in the cache
+                         */
+                        uint32_t getNumSharedPoses() const;
+
+                private:
+                        friend class MeshAnimationProcessor;
+
+                        /**
+                         * Represents key of the pose.
+                         */
+                        typedef std::vector<uint32_t> Key;
+
+                        /**
+                         * Represents hasher of the key.
+                         */
+                        class KeyHasher
+                        {
+                        public:
+                                /**
+                                 * \brief Computes hash of the key.
+                                 * \param[in] key key of the pose
+                                 * \return hash of the key
+                                 */
+                                std::size_t operator()(const Key& key) const;
+
+                        };
+
+                        std::unordered_map<Key, std::shared_ptr<const Skeleton::Instance>, KeyHasher> poses_;
+                        float timeQuantumInv_, blendFactorQuantumInv_;
+                        uint32_t numEvaluatedPoses_, numSharedPoses_;
+
+                        /**
+                         * \brief Finds pose.
+                         * \param[in] key key of the pose
+                         * \return shared pointer to the skeleton instance, which holds the pose (or empty
+                         * pointer if pose could not be found)
+                         */
+                        std::shared_ptr<const Skeleton::Instance> findPose(const Key& key);
+
+                        /**
+                         * \brief Adds pose.
+                         * \param[in] key key of the pose
+                         * \param[in] skeletonInstance skeleton instance, which holds the pose
+                         */
+                        void addPose(const Key& key, const std::shared_ptr<const Skeleton::Instance>& skeletonInstance);
 
                 };
 
@@ -221,6 +381,8 @@ namespace selene
 
                 /**
                  * \brief Returns skeleton instance.
+                 *
+                 * If pose has been found in the pose cache, then shared skeleton instance is returned.
                  * \return const reference to the skeleton instance
                  */
                 const Skeleton::Instance& getSkeletonInstance() const;
@@ -257,16 +419,92 @@ namespace selene
                  */
                 MixableMeshAnimation& getMeshAnimation(uint32_t index);
 
+                /**
+                 * \brief Sets update interval.
+                 *
+                 * If update interval is greater than zero, then pose of the skeleton is computed only once
+                 * per given interval, between updates pose is interpolated.
+                 * \param[in] updateInterval update interval (zero means that pose is computed on each call
+                 * to processMeshAnimations() function)
+                 */
+                void setUpdateInterval(float updateInterval);
+
+                /**
+                 * \brief Returns update interval.
+                 * \return update interval
+                 */
+                float getUpdateInterval() const;
+
+                /**
+                 * \brief Sets minimum blend factor.
+                 *
+                 * Animations, whose current blend factor is less than given value, do not affect the skeleton,
+                 * which makes blending cheaper.
+                 * \param[in] minBlendFactor minimum blend factor (zero means that all animations are blended)
+                 */
+                void setMinBlendFactor(float minBlendFactor);
+
+                /**
+                 * \brief Returns minimum blend factor.
+                 * \return minimum blend factor
+                 */
+                float getMinBlendFactor() const;
+
                 /**
                  * \brief Processes mesh animations.
                  * \param[in] elapsedTime elapsed time since last processing
+                 * \param[in] poseCache pose cache, which is used to share evaluated poses (can be nullptr)
+                 */
+                void processMeshAnimations(float elapsedTime, PoseCache* poseCache = nullptr);
+
+                /**
+                 * \brief Advances mesh animations.
+                 *
+                 * Only state and time of the animations are advanced, pose of the skeleton is not changed.
+                 * Next call to processMeshAnimations() function computes pose without interpolation.
+                 * \param[in] elapsedTime elapsed time since last processing
                  */
-                void processMeshAnimations(float elapsedTime);
+                void advanceMeshAnimations(float elapsedTime);
 
         private:
                 std::vector<std::unique_ptr<MixableMeshAnimation>> mixableMeshAnimations_;
                 MixableMeshAnimation emptyMixableMeshAnimation_;
-                Skeleton::Instance skeletonInstance_;
+                std::shared_ptr<Skeleton::Instance> skeletonInstance_;
+                std::shared_ptr<const Skeleton::Instance> sharedSkeletonInstance_;
+                Skeleton::Instance emptySkeletonInstance_;
+                const Skeleton* skeleton_;
+                PoseCache::Key poseKey_;
+                std::vector<Skeleton::Layer> layers_;
+
+                float updateInterval_;
+                float minBlendFactor_;
+                float accumulatedTime_;
+                bool isPoseOutdated_;
+
+                /**
+                 * \brief Advances all mesh animations.
+                 * \param[in] elapsedTime elapsed time since last processing
+                 */
+                void advanceAll(float elapsedTime);
+
+                /**
+                 * \brief Blends pose of the skeleton with all mesh animations in one pass.
+                 */
+                void blendAll();
+
+                /**
+                 * \brief Computes pose of the skeleton (uses pose cache, if it is present).
+                 * \param[in] poseCache pose cache
+                 */
+                void computePose(PoseCache* poseCache);
+
+                /**
+                 * \brief Stops using shared skeleton instance.
+                 *
+                 * Own skeleton instance already holds the shared pose, since it is copied when shared skeleton
+                 * instance is found in the cache.
+                 */
+                void releaseSharedPose();
 
         };
 
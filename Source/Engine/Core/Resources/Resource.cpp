@@ -2,35 +2,79 @@
 // Licensed under the MIT License (see LICENSE.txt for details)
 
 #include "Resource.h"
-#include <limits>
+#include <new>
 
 namespace selene
 {
 
-        Resource::Resource(const char* name): Entity(name), numRequests_(0) {}
-        Resource::~Resource() {}
+        Resource::Link Resource::nullLink_(nullptr);
+
+        Resource::Link::Link(Resource* linkedResource): resource(linkedResource), numReferences(1) {}
+        Resource::Link::~Link() {}
 
         //--------------------------------------------------------------------
-        bool Resource::isUsed() const
+        void Resource::Link::release()
+        {
+                if(numReferences.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        delete this;
+        }
+
+        Resource::Reference::Reference(): link_(&nullLink_), object_(nullptr) {}
+        Resource::Reference::~Reference() {}
+
+        //--------------------------------------------------------------------
+        void Resource::Reference::attach(Resource* resource, void* object)
+        {
+                if(resource == nullptr || object == nullptr || resource->link_ == &nullLink_)
+                        return;
+
+                resource->link_->numReferences.fetch_add(1, std::memory_order_relaxed);
+                link_ = resource->link_;
+                object_ = object;
+        }
+
+        //--------------------------------------------------------------------
+        void Resource::Reference::attach(const Reference& reference)
         {
-                return (numRequests_ > 0);
+                // references to the destroyed resources are not copied
+                if(reference.getObject() == nullptr)
+                        return;
+
+                reference.link_->numReferences.fetch_add(1, std::memory_order_relaxed);
+                link_ = reference.link_;
+                object_ = reference.object_;
         }
 
         //--------------------------------------------------------------------
-        bool Resource::request()
+        void Resource::Reference::detach()
+        {
+                if(link_ == &nullLink_)
+                        return;
+
+                link_->release();
+                link_ = &nullLink_;
+                object_ = nullptr;
+        }
+
+        Resource::Resource(const char* name): Entity(name), link_(new(std::nothrow) Link(this))
         {
-                if(numRequests_ == std::numeric_limits<uint32_t>::max())
-                        return false;
+                if(link_ == nullptr)
+                        link_ = &nullLink_;
+        }
+        Resource::~Resource()
+        {
+                if(link_ == &nullLink_)
+                        return;
 
-                ++numRequests_;
-                return true;
+                // references know that resource no longer exists, link is freed by the last of them
+                link_->resource.store(nullptr, std::memory_order_release);
+                link_->release();
         }
 
         //--------------------------------------------------------------------
-        void Resource::release()
+        bool Resource::isUsed() const
         {
-                if(numRequests_ > 0)
-                        --numRequests_;
+                return (link_->numReferences.load() > 1);
         }
 
 }
@@ -5,7 +5,9 @@
 #define RESOURCE_H
 
 #include "../Entity/Entity.h"
+
 #include <memory>
+#include <atomic>
 
 namespace selene
 {
@@ -30,11 +32,107 @@ namespace selene
         class Resource: public Entity
         {
         public:
+                /**
+                 * Represents link between the resource and its references. Resource resets the link when it is
+                 * destroyed, and link is freed by the last of the resource and its references, so references
+                 * check existence of the resource without locking.
+                 */
+                class Link
+                {
+                public:
+                        std::atomic<Resource*> resource;
+                        std::atomic<uint32_t> numReferences;
+
+                        /**
+                         * \brief Constructs link with given resource.
+                         * \param[in] linkedResource pointer to the resource
+                         */
+                        Link(Resource* linkedResource);
+                        Link(const Link&) = delete;
+                        ~Link();
+                        Link& operator =(const Link&) = delete;
+
+                        /**
+                         * \brief Releases link (link is destroyed when it is not referenced anymore).
+                         */
+                        void release();
+
+                };
+
+                /**
+                 * Represents reference to the resource. This is base class for resource instances. Reference
+                 * holds pointer to the link of the resource (which is never null: empty reference points to
+                 * the static null link) and the pointer to the resource, which is casted to the type of the
+                 * instance.
+                 */
+                class Reference
+                {
+                protected:
+                        Reference();
+                        Reference(const Reference&) = delete;
+                        ~Reference();
+                        Reference& operator =(const Reference&) = delete;
+
+                        /**
+                         * \brief Attaches reference to the resource.
+                         *
+                         * Resource becomes used.
+                         * \param[in] resource pointer to the resource
+                         * \param[in] object pointer to the resource, which is casted to the type of the
+                         * instance (if nullptr, then reference is not attached)
+                         */
+                        void attach(Resource* resource, void* object);
+
+                        /**
+                         * \brief Attaches reference to the resource of another reference.
+                         * \param[in] reference another reference
+                         */
+                        void attach(const Reference& reference);
+
+                        /**
+                         * \brief Detaches reference from the resource.
+                         */
+                        void detach();
+
+                        /**
+                         * \brief Returns resource.
+                         * \return pointer to the resource, which is casted to the type of the instance,
+                         * or nullptr if resource has been destroyed
+                         */
+                        void* getObject() const
+                        {
+                                if(link_->resource.load(std::memory_order_acquire) == nullptr)
+                                        return nullptr;
+
+                                return object_;
+                        }
+
+                        /**
+                         * \brief Checks whether reference points to the same resource as another reference.
+                         * \param[in] reference another reference
+                         * \return true if both references point to the same resource
+                         */
+                        bool isSameAs(const Reference& reference) const
+                        {
+                                return (link_ == reference.link_ && object_ == reference.object_);
+                        }
+
+                private:
+                        Link* link_;
+                        void* object_;
+
+                };
+
                 /**
                  * Represents resource instance. When resource is destroyed somewhere else, instance
                  * is automatically notified that resource no longer exists.
+                 *
+                 * Instances do not lock the resource: copying and destroying the instance change reference
+                 * counter of the link, dereferencing loads pointer of the link. Instances may be copied and
+                 * destroyed while resource is destroyed in another thread, but pointer, which has been
+                 * returned by the instance, must not be used after resource has been destroyed.
                  */
-                template <class T> class Instance
+                template <class T> class Instance: public Reference
                 {
                 public:
                         /**
@@ -44,24 +142,18 @@ namespace selene
                          * to the resource of derived class (T).
                          * \param[in] sharedPointer std::shared_ptr to the resource
                          */
-                        Instance(const std::shared_ptr<Resource>& sharedPointer): Instance()
+                        Instance(const std::shared_ptr<Resource>& sharedPointer): Reference()
                         {
-                                initialize(dynamic_cast<T*>(sharedPointer.get()));
-
-                                if(resource_ != nullptr)
-                                        weakPointer_ = sharedPointer;
+                                attach(sharedPointer.get(), dynamic_cast<T*>(sharedPointer.get()));
                         }
-                        Instance(const Instance<T>& instance): Instance()
+                        Instance(const Instance<T>& instance): Reference()
                         {
-                                *this = instance;
+                                attach(instance);
                         }
-                        Instance(): weakPointer_(), resource_(nullptr) {}
+                        Instance(): Reference() {}
                         ~Instance()
                         {
-                                if(weakPointer_.expired())
-                                        return;
-
-                                resource_->release();
+                                detach();
                         }
 
                         /**
@@ -73,54 +165,22 @@ namespace selene
                          */
                         Instance<T>& operator =(const Instance<T>& instance)
                         {
-                                if(!weakPointer_.expired())
-                                {
-                                        weakPointer_.reset();
-                                        resource_->release();
-                                }
-
-                                resource_ = nullptr;
-
-                                if(!instance.weakPointer_.expired())
-                                {
-                                        initialize(instance.resource_);
+                                if(isSameAs(instance))
+                                        return *this;
 
-                                        if(resource_ != nullptr)
-                                                weakPointer_ = instance.weakPointer_;
-                                }
+                                detach();
+                                attach(instance);
 
                                 return *this;
                         }
 
                         /**
                          * \brief Returns resource.
-                         * \return pointer to the resource
+                         * \return pointer to the resource, or nullptr if resource has been destroyed
                          */
                         T* operator *() const
                         {
-                                if(!weakPointer_.expired())
-                                        return resource_;
-
-                                return nullptr;
-                        }
-
-                private:
-                        std::weak_ptr<Resource> weakPointer_;
-                        T* resource_;
-
-                        /**
-                         * \brief Initializes resource instance.
-                         * \param[in] resource pointer to the resource
-                         */
-                        void initialize(T* resource)
-                        {
-                                if(resource == nullptr)
-                                        return;
-
-                                if(!resource->request())
-                                        return;
-
-                                resource_ = resource;
+                                return static_cast<T*>(getObject());
                         }
 
                 };
@@ -154,18 +214,11 @@ namespace selene
                 virtual void discard() = 0;
 
         private:
-                uint32_t numRequests_;
-
-                /**
-                 * \brief Requests resource.
-                 * \return true if request has been granted
-                 */
-                bool request();
+                // link of the empty references (and of the resources, whose links could not be allocated)
+                static Link nullLink_;
 
-                /**
-                 * \brief Releases resource.
-                 */
-                void release();
+                // link is shared with the references, so it is released (not freed) by the resource
+                Link* link_;
 
         };
 
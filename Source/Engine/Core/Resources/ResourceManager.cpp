@@ -2,16 +2,38 @@
 // Licensed under the MIT License (see LICENSE.txt for details)
 
 #include "ResourceManager.h"
+#include <utility>
 
 namespace selene
 {
 
         std::set<ResourceManager*> ResourceManager::resourceManagers_;
+        std::mutex ResourceManager::resourceManagersMutex_;
 
-        ResourceManager::ResourceManager(): resources_(), nullSharedPointer_(), isInitialized_(true)
+        ResourceManager::Request::Request(const char* name):
+                name(name), resource(), callbacks(), result(FAIL), isParsed(false), isCompleted(false) {}
+        ResourceManager::Request::~Request() {}
+
+        //----------------------------------------------------------------------------------------------
+        void ResourceManager::Request::complete(RESULT result)
+        {
+                this->result = result;
+                isCompleted = true;
+                resource.reset();
+
+                for(auto it = callbacks.begin(); it != callbacks.end(); ++it)
+                        (*it)(name.c_str(), result);
+
+                callbacks.clear();
+        }
+
+        ResourceManager::ResourceManager():
+                resources_(), nullSharedPointer_(), isInitialized_(true), requests_(), unretainedResources_(),
+                numUnparsedRequests_(0), threadId_(std::this_thread::get_id()), mutex_(), requestParsed_()
         {
                 try
                 {
+                        std::lock_guard<std::mutex> lock(resourceManagersMutex_);
                         resourceManagers_.insert(this);
                 }
                 catch(...)
@@ -21,14 +43,26 @@ namespace selene
         }
         ResourceManager::~ResourceManager()
         {
-                resourceManagers_.erase(this);
+                {
+                        std::lock_guard<std::mutex> lock(resourceManagersMutex_);
+                        resourceManagers_.erase(this);
+                }
+
+                // wait for workers
+                {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        while(numUnparsedRequests_ != 0)
+                                requestParsed_.wait(lock);
+                }
+
                 destroyResources(true);
         }
 
         //----------------------------------------------------------------------------------------------
         size_t ResourceManager::getNumResources()
         {
-                return resources_.size();
+                std::lock_guard<std::mutex> lock(mutex_);
+                return resources_.getSize();
         }
 
         //----------------------------------------------------------------------------------------------
@@ -38,68 +72,141 @@ namespace selene
                 if(!isInitialized_ || name == nullptr)
                         return FAIL;
 
-                if(getResource(name))
-                        return RESOURCE_ALREADY_EXISTS;
+                {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if(getResource(name))
+                                return RESOURCE_ALREADY_EXISTS;
+                }
 
                 // create resource
                 std::unique_ptr<Resource> resource(resourceFactory.createResource(name));
                 if(resource.get() == nullptr)
                         return FAIL;
 
-                // retain resource
-                if(!resource->retain())
-                        return RESOURCE_COULD_NOT_BE_RETAINED;
+                // retain and store resource
+                return storeResource(name, resource);
+        }
 
-                // store resource
-                try
+        //----------------------------------------------------------------------------------------------
+        void ResourceManager::processRequests(bool shouldWait)
+        {
+                std::vector<std::shared_ptr<Request>> parsedRequests;
+                std::vector<std::shared_ptr<Resource>> unretainedResources;
+
+                // take parsed requests
                 {
-                        auto result = resources_.insert(std::make_pair(std::string(name),
-                                                        std::shared_ptr<Resource>(resource.release())));
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        while(shouldWait && numUnparsedRequests_ != 0)
+                                requestParsed_.wait(lock);
 
-                        if(!result.second)
-                                return FAIL;
+                        try
+                        {
+                                parsedRequests.reserve(requests_.size());
+
+                                // unretained resources stay visible to workers while they are retained
+                                unretainedResources.reserve(unretainedResources_.getSize());
+                                for(auto it = unretainedResources_.begin(); it != unretainedResources_.end(); ++it)
+                                        unretainedResources.push_back(it->value);
+                        }
+                        catch(...)
+                        {
+                                return;
+                        }
+
+                        auto it = requests_.begin();
+                        while(it != requests_.end())
+                        {
+                                if(it->second->isParsed)
+                                {
+                                        parsedRequests.push_back(it->second);
+                                        it = requests_.erase(it);
+                                }
+                                else
+                                        ++it;
+                        }
                 }
-                catch(...)
+
+                // retain resources, which have been created by workers without requests, then store them
+                for(auto it = unretainedResources.begin(); it != unretainedResources.end(); ++it)
                 {
-                        return FAIL;
+                        bool isRetained = (*it)->retain();
+                        Name name((*it)->getName());
+
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        unretainedResources_.erase(name);
+
+                        if(isRetained)
+                                resources_.insert(name, *it);
                 }
 
-                return SUCCESS;
+                // resources, which could not be retained or stored, are destroyed outside of the lock
+                unretainedResources.clear();
+
+                // complete requests
+                for(auto it = parsedRequests.begin(); it != parsedRequests.end(); ++it)
+                {
+                        Request& request = **it;
+
+                        if(request.result == SUCCESS)
+                                request.complete(storeResource(request.name.c_str(), request.resource));
+                        else
+                                request.complete(request.result);
+                }
+        }
+
+        //----------------------------------------------------------------------------------------------
+        size_t ResourceManager::getNumPendingRequests()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return requests_.size();
         }
 
         //----------------------------------------------------------------------------------------------
-        RESULT ResourceManager::destroyResource(const char* name, bool forced)
+        RESULT ResourceManager::destroyResource(const Name& name, bool forced)
         {
                 // validate
-                if(name == nullptr)
+                if(name.getString() == nullptr)
                         return FAIL;
 
-                // find
-                auto it = resources_.find(std::string(name));
+                std::shared_ptr<Resource> resource;
 
-                if(it == resources_.end())
-                        return FAIL;
+                {
+                        std::lock_guard<std::mutex> lock(mutex_);
 
-                // destroy
-                if(!it->second->isUsed() || forced)
-                        resources_.erase(it);
-                else
-                        return RESOURCE_IS_USED;
+                        // find
+                        std::shared_ptr<Resource>* storedResource = resources_.find(name);
+
+                        if(storedResource == nullptr)
+                                return FAIL;
+
+                        if((*storedResource)->isUsed() && !forced)
+                                return RESOURCE_IS_USED;
 
+                        resource.swap(*storedResource);
+                        resources_.erase(name);
+                }
+
+                // destroy (outside of the lock, since resource might release other resources)
+                resource.reset();
                 return SUCCESS;
         }
 
         //----------------------------------------------------------------------------------------------
         void ResourceManager::destroyResources(bool forced)
         {
+                std::lock_guard<std::mutex> lock(mutex_);
+
                 if(forced)
+                {
                         resources_.clear();
+                        unretainedResources_.clear();
+                }
                 else
                 {
                         auto it = resources_.begin();
                         while(it != resources_.end())
                         {
-                                if(!it->second->isUsed())
+                                if(!it->value->isUsed())
                                         it = resources_.erase(it);
                                 else
                                         ++it;
@@ -110,13 +217,17 @@ namespace selene
         //----------------------------------------------------------------------------------------------
         bool ResourceManager::retainResources()
         {
+                std::lock_guard<std::mutex> registryLock(resourceManagersMutex_);
+
                 bool result = true;
                 for(auto m = resourceManagers_.begin(); m != resourceManagers_.end(); ++m)
                 {
+                        std::lock_guard<std::mutex> lock((*m)->mutex_);
+
                         auto& resources = (*m)->resources_;
                         for(auto it = resources.begin(); it != resources.end(); ++it)
                         {
-                                if(!it->second->retain())
+                                if(!it->value->retain())
                                         result = false;
                         }
                 }
@@ -127,29 +238,190 @@ namespace selene
         //----------------------------------------------------------------------------------------------
         void ResourceManager::discardResources()
         {
+                std::lock_guard<std::mutex> registryLock(resourceManagersMutex_);
+
                 for(auto m = resourceManagers_.begin(); m != resourceManagers_.end(); ++m)
                 {
+                        std::lock_guard<std::mutex> lock((*m)->mutex_);
+
                         auto& resources = (*m)->resources_;
                         for(auto it = resources.begin(); it != resources.end(); ++it)
-                                it->second->discard();
+                                it->value->discard();
                 }
         }
 
         //----------------------------------------------------------------------------------------------
-        const std::shared_ptr<Resource>& ResourceManager::getResource(const char* name)
+        std::shared_ptr<ResourceManager::Request> ResourceManager::addRequest(const char* name,
+                                                                            ResourceFactory& resourceFactory,
+                                                                            ThreadPool& threadPool,
+                                                                            const Callback& callback)
         {
+                std::shared_ptr<Request> request;
+
                 // validate
-                if(name == nullptr)
+                if(!isInitialized_ || name == nullptr)
+                {
+                        if(callback)
+                                callback(name, FAIL);
+
+                        return request;
+                }
+
+                {
+                        std::lock_guard<std::mutex> lock(mutex_);
+
+                        try
+                        {
+                                // share request, which is already pending
+                                auto it = requests_.find(std::string(name));
+                                if(it != requests_.end())
+                                {
+                                        if(callback)
+                                                it->second->callbacks.push_back(callback);
+
+                                        return it->second;
+                                }
+
+                                request.reset(new(std::nothrow) Request(name));
+                                if(!request)
+                                        return request;
+
+                                if(callback)
+                                        request->callbacks.push_back(callback);
+
+                                if(!getResource(name))
+                                {
+                                        requests_.insert(std::make_pair(request->name, request));
+                                        ++numUnparsedRequests_;
+                                }
+                                else
+                                        request->result = RESOURCE_ALREADY_EXISTS;
+                        }
+                        catch(...)
+                        {
+                                request.reset();
+                        }
+                }
+
+                if(!request)
+                {
+                        if(callback)
+                                callback(name, FAIL);
+
+                        return request;
+                }
+
+                // resource already exists, so request is completed at once
+                if(request->result == RESOURCE_ALREADY_EXISTS)
+                {
+                        request->complete(RESOURCE_ALREADY_EXISTS);
+                        return request;
+                }
+
+                // add job
+                bool isJobAdded = true;
+
+                try
+                {
+                        threadPool.addJob(std::bind(&ResourceManager::parseRequest, this, request,
+                                                    &resourceFactory));
+                }
+                catch(...)
+                {
+                        isJobAdded = false;
+                }
+
+                if(!isJobAdded)
+                {
+                        {
+                                std::lock_guard<std::mutex> lock(mutex_);
+                                --numUnparsedRequests_;
+                                requests_.erase(request->name);
+                        }
+
+                        request->complete(FAIL);
+                }
+
+                return request;
+        }
+
+        //----------------------------------------------------------------------------------------------
+        void ResourceManager::parseRequest(const std::shared_ptr<Request>& request,
+                                           ResourceFactory* resourceFactory)
+        {
+                std::unique_ptr<Resource> resource(resourceFactory->createResource(request->name.c_str()));
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                request->result = (resource.get() != nullptr) ? SUCCESS : FAIL;
+                request->resource = std::move(resource);
+                request->isParsed = true;
+
+                --numUnparsedRequests_;
+                requestParsed_.notify_all();
+        }
+
+        //----------------------------------------------------------------------------------------------
+        RESULT ResourceManager::storeResource(const char* name, std::unique_ptr<Resource>& resource)
+        {
+                // resources with duplicate names are never retained
+                if(hasResource(name))
+                        return RESOURCE_ALREADY_EXISTS;
+
+                // resources can only be retained in the thread, which has created resource manager
+                bool shouldRetain = (std::this_thread::get_id() == threadId_);
+                if(shouldRetain && !resource->retain())
+                        return RESOURCE_COULD_NOT_BE_RETAINED;
+
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                // resource with the same name might have been stored by another thread while retaining
+                if(resources_.find(name) != nullptr || unretainedResources_.find(name) != nullptr)
+                        return RESOURCE_ALREADY_EXISTS;
+
+                try
+                {
+                        std::shared_ptr<Resource> sharedPointer(resource.release());
+
+                        // resources, which have been created by workers, are not visible to the main thread
+                        // until they are retained
+                        auto& resources = shouldRetain ? resources_ : unretainedResources_;
+                        if(!resources.insert(name, sharedPointer))
+                                return FAIL;
+                }
+                catch(...)
+                {
+                        return FAIL;
+                }
+
+                return SUCCESS;
+        }
+
+        //----------------------------------------------------------------------------------------------
+        bool ResourceManager::hasResource(const char* name)
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return (resources_.find(name) != nullptr || unretainedResources_.find(name) != nullptr);
+        }
+
+        //----------------------------------------------------------------------------------------------
+        const std::shared_ptr<Resource>& ResourceManager::getResource(const Name& name)
+        {
+                // validate
+                if(name.getString() == nullptr)
                         return nullSharedPointer_;
 
                 // find
-                auto it = resources_.find(std::string(name));
+                const std::shared_ptr<Resource>* resource = resources_.find(name);
+
+                // resources, which have not been retained yet, can only be used by workers
+                if(resource == nullptr && std::this_thread::get_id() != threadId_)
+                        resource = unretainedResources_.find(name);
 
-                if(it == resources_.end())
+                if(resource == nullptr)
                         return nullSharedPointer_;
 
                 // return resource
-                return it->second;
+                return *resource;
         }
 
 }
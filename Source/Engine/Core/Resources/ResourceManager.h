@@ -4,10 +4,16 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
+#include "../Helpers/ThreadPool.h"
+#include "../Helpers/NameTable.h"
 #include "ResourceFactory.h"
 #include "Resource.h"
 
+#include <condition_variable>
 #include <unordered_map>
+#include <functional>
+#include <vector>
+#include <mutex>
 #include <set>
 
 namespace selene
@@ -59,10 +65,106 @@ namespace selene
          * // if you want to destroy resource, even if it is used somewhere, force its destruction:
          * resourceManager.destroyResource("brick.dds", true);
          * \endcode
+         *
+         * Resources are stored in the table of names (see NameTable), so resources are found by identifiers
+         * of their names. Names, which are requested on each frame, may be defined as constant expressions,
+         * so their identifiers are computed at compile time:
+         * \code
+         * static constexpr selene::Name brickName("brick.dds");
+         * auto textureInstance = resourceManager.requestResource<selene::Texture>(brickName);
+         * \endcode
+         *
+         * Resources may also be loaded asynchronously with ThreadPool. In this case resource is created
+         * by the factory on the worker thread, but it is retained (and stored) only when
+         * ResourceManager::processRequests is called, so subsystems, which can only be used from the main
+         * thread (Direct3D or OpenGL library), are not accessed from workers:
+         * \code
+         * auto handle = resourceManager.loadResource<selene::Texture>("brick.dds", textureFactory, threadPool);
+         *
+         * ...
+         *
+         * // on each frame (or in loading loop)
+         * resourceManager.processRequests();
+         *
+         * if(handle.isCompleted())
+         *         auto textureInstance = handle.getInstance();
+         * \endcode
+         * Requests for resource, which is already being loaded, share the same handle state, so resource
+         * is created only once. Note, that resource factory must not be destroyed before all its requests
+         * have been processed (ResourceManager::processRequests with wait flag can be used to ensure that).
          */
         class ResourceManager
         {
+                class Request;
+
         public:
+                /**
+                 * Represents completion callback of the asynchronous request. Callback receives name of the
+                 * resource and result of the request.
+                 */
+                typedef std::function<void(const char*, RESULT)> Callback;
+
+                /**
+                 * Represents handle of the asynchronous request. Handle is resolved to the resource instance
+                 * when request is completed. Handle must only be used in the thread, which processes requests.
+                 */
+                template <class T> class Handle
+                {
+                public:
+                        /**
+                         * \brief Constructs handle with given resource manager and request.
+                         * \param[in] resourceManager resource manager, which processes request
+                         * \param[in] request request
+                         */
+                        Handle(ResourceManager* resourceManager, const std::shared_ptr<Request>& request):
+                                resourceManager_(resourceManager), request_(request) {}
+                        Handle(): resourceManager_(nullptr), request_() {}
+                        Handle(const Handle<T>&) = default;
+                        ~Handle() {}
+                        Handle<T>& operator =(const Handle<T>&) = default;
+
+                        /**
+                         * \brief Returns true if request is completed.
+                         * \return true if request is completed (successfully or not)
+                         */
+                        bool isCompleted() const
+                        {
+                                return (!request_ || request_->isCompleted);
+                        }
+
+                        /**
+                         * \brief Returns result of the request.
+                         * \see ResourceManager::createResource
+                         * \return result of the request (FAIL if request is not completed)
+                         */
+                        RESULT getResult() const
+                        {
+                                if(!isCompleted() || !request_)
+                                        return FAIL;
+
+                                return request_->result;
+                        }
+
+                        /**
+                         * \brief Returns resource instance.
+                         * \return resource instance (resource is nullptr if request is not completed or
+                         * resource could not be created)
+                         */
+                        Resource::Instance<T> getInstance() const
+                        {
+                                RESULT result = getResult();
+                                if(result != SUCCESS && result != RESOURCE_ALREADY_EXISTS)
+                                        return Resource::Instance<T>();
+
+                                return resourceManager_->requestResource<T>(request_->name.c_str());
+                        }
+
+                private:
+                        ResourceManager* resourceManager_;
+                        std::shared_ptr<Request> request_;
+
+                };
+
                 ResourceManager();
                 ResourceManager(const ResourceManager&) = delete;
                 ~ResourceManager();
@@ -82,9 +184,51 @@ namespace selene
                  * created, RESOURCE_ALREADY_EXISTS if resource with given name already exists,
                  * RESOURCE_COULD_NOT_BE_RETAINED if resource could not be retained for use in
                  * corresponding subsystem.
+                 *
+                 * If this function is called not from the thread, which has created resource manager (for
+                 * example, when mesh factory creates textures on the worker thread), then resource is
+                 * retained in ResourceManager::processRequests. Until then resource can only be requested
+                 * by workers, so the thread, which has created resource manager, never gets resource, which
+                 * has not been retained.
                  */
                 RESULT createResource(const char* name, ResourceFactory& resourceFactory);
 
+                /**
+                 * \brief Loads resource asynchronously.
+                 *
+                 * Resource is created on the worker thread of given thread pool, then it is retained and
+                 * stored in ResourceManager::processRequests. If resource with given name is already being
+                 * loaded, then handle of the existing request is returned.
+                 * \param[in] name name of the resource
+                 * \param[in] resourceFactory resource factory (must be thread-safe and must exist until
+                 * request is processed)
+                 * \param[in] threadPool thread pool (must exist until request is processed)
+                 * \param[in] callback callback, which is called when request is completed
+                 * \return handle of the request
+                 */
+                template <class T> Handle<T> loadResource(const char* name, ResourceFactory& resourceFactory,
+                                                          ThreadPool& threadPool,
+                                                          const Callback& callback = Callback())
+                {
+                        return Handle<T>(this, addRequest(name, resourceFactory, threadPool, callback));
+                }
+
+                /**
+                 * \brief Processes asynchronous requests.
+                 *
+                 * Retains and stores resources, which have been created by workers, and calls completion
+                 * callbacks. This function must be called from the thread, which has created resource manager.
+                 * \param[in] shouldWait flag, which forces function to wait until all pending requests are
+                 * completed
+                 */
+                void processRequests(bool shouldWait = false);
+
+                /**
+                 * \brief Returns number of pending requests.
+                 * \return number of asynchronous requests, which have not been completed yet
+                 */
+                size_t getNumPendingRequests();
+
                 /**
                  * \brief Destroys resource.
                  * \param[in] name name of the resource
@@ -93,7 +237,7 @@ namespace selene
                  * name does not exist, RESOURCE_IS_USED if resource with given name is used and
                  * destruction is not forced
                  */
-                RESULT destroyResource(const char* name, bool forced = false);
+                RESULT destroyResource(const Name& name, bool forced = false);
 
                 /**
                  * \brief Destroys resources.
@@ -106,8 +250,9 @@ namespace selene
                  * \param[in] name name of the resource
                  * \return resource instance
                  */
-                template <class T> Resource::Instance<T> requestResource(const char* name)
+                template <class T> Resource::Instance<T> requestResource(const Name& name)
                 {
+                        std::lock_guard<std::mutex> lock(mutex_);
                         return Resource::Instance<T>(getResource(name));
                 }
 
@@ -125,18 +270,100 @@ namespace selene
                 static void discardResources();
 
         private:
-                std::unordered_map<std::string, std::shared_ptr<Resource>> resources_;
+                /**
+                 * Represents asynchronous request.
+                 */
+                class Request
+                {
+                public:
+                        std::string name;
+                        std::unique_ptr<Resource> resource;
+                        std::vector<Callback> callbacks;
+                        RESULT result;
+                        bool isParsed, isCompleted;
+
+                        /**
+                         * \brief Constructs request with given name of the resource.
+                         * \param[in] name name of the resource
+                         */
+                        Request(const char* name);
+                        Request(const Request&) = delete;
+                        ~Request();
+                        Request& operator =(const Request&) = delete;
+
+                        /**
+                         * \brief Completes request with given result.
+                         *
+                         * Calls completion callbacks.
+                         * \param[in] result result of the request
+                         */
+                        void complete(RESULT result);
+
+                };
+
+                NameTable<std::shared_ptr<Resource>> resources_;
                 std::shared_ptr<Resource> nullSharedPointer_;
                 bool isInitialized_;
 
+                std::unordered_map<std::string, std::shared_ptr<Request>> requests_;
+                NameTable<std::shared_ptr<Resource>> unretainedResources_;
+                size_t numUnparsedRequests_;
+                std::thread::id threadId_;
+
+                std::mutex mutex_;
+                std::condition_variable requestParsed_;
+
+                // resource managers may be created and destroyed by different threads
                 static std::set<ResourceManager*> resourceManagers_;
+                static std::mutex resourceManagersMutex_;
+
+                /**
+                 * \brief Adds asynchronous request.
+                 * \param[in] name name of the resource
+                 * \param[in] resourceFactory resource factory
+                 * \param[in] threadPool thread pool
+                 * \param[in] callback completion callback
+                 * \return std::shared_ptr to the request, or empty pointer if request could not be added
+                 */
+                std::shared_ptr<Request> addRequest(const char* name, ResourceFactory& resourceFactory,
+                                                    ThreadPool& threadPool, const Callback& callback);
+
+                /**
+                 * \brief Creates resource of the request (this function is executed by the worker).
+                 * \param[in] request request
+                 * \param[in] resourceFactory resource factory
+                 */
+                void parseRequest(const std::shared_ptr<Request>& request, ResourceFactory* resourceFactory);
+
+                /**
+                 * \brief Retains and stores resource.
+                 *
+                 * If current thread is not the thread, which has created resource manager, then resource
+                 * is stored without retaining in the table of unretained resources, and it is retained and
+                 * moved to the table of resources in ResourceManager::processRequests.
+                 * \param[in] name name of the resource
+                 * \param[in] resource resource
+                 * \return SUCCESS if resource has been stored, RESOURCE_ALREADY_EXISTS if resource with
+                 * given name already exists, RESOURCE_COULD_NOT_BE_RETAINED if resource could not be
+                 * retained, FAIL otherwise
+                 */
+                RESULT storeResource(const char* name, std::unique_ptr<Resource>& resource);
+
+                /**
+                 * \brief Checks whether resource with given name is stored (retained or not).
+                 * \param[in] name name of the resource
+                 * \return true if resource with given name is stored, false otherwise
+                 */
+                bool hasResource(const char* name);
 
                 /**
-                 * \brief Returns resource.
+                 * \brief Returns resource (mutex must be locked).
+                 *
+                 * Unretained resources are only returned to workers (see ResourceManager::createResource).
                  * \param[in] name name of the resource
                  * \return reference to the std::shared_ptr to the resource
                  */
-                const std::shared_ptr<Resource>& getResource(const char* name);
+                const std::shared_ptr<Resource>& getResource(const Name& name);
 
         };
 
@@ -8,7 +8,7 @@ namespace selene
 
         Texture::Data::Data():
                 pixels(), width(0), height(0),
-                numMipMaps(0), format(0), bpp(0) {}
+                numMipMaps(0), mipMapLevel(0), format(0), bpp(0) {}
         Texture::Data::~Data() {}
 
         Texture::Texture(const char* name): Resource(name), data_() {}
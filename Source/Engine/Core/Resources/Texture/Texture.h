@@ -37,8 +37,13 @@ namespace selene
                  * - array of bytes, which contains pixels,
                  * - width and height of the texture,
                  * - number of mip maps,
+                 * - level of the first mip map,
                  * - format of texture (one of the selene::TEXTURE_FORMAT),
                  * - bytes per pixel (bpp) for not compressed texture.
+                 *
+                 * Texture may hold only coarse mip maps of the texture file (see TextureStreamer). In this case
+                 * width, height and number of mip maps describe mip maps, which are held in pixels, and level
+                 * of the first mip map is the number of finer mip maps, which have not been loaded.
                  */
                 class Data
                 {
@@ -46,6 +51,7 @@ namespace selene
                         Array<uint8_t, uint32_t> pixels;
                         uint32_t width, height;
                         uint32_t numMipMaps;
+                        uint32_t mipMapLevel;
                         uint8_t format, bpp;
 
                         Data();
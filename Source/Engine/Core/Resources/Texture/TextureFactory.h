@@ -25,9 +25,23 @@ namespace selene
                  * \brief Constructs texture factory with given file manager.
                  * \param[in] fileManager file manager
                  */
-                TextureFactory(FileManager* fileManager = nullptr): ResourceFactory(fileManager) {}
+                TextureFactory(FileManager* fileManager = nullptr): ResourceFactory(fileManager), maxSize_(0) {}
                 ~TextureFactory() {}
 
+                /**
+                 * \brief Sets maximum size of the mip maps.
+                 *
+                 * Only mip maps, whose width and height are not greater than maximum size, are loaded, so
+                 * textures are created with their coarse mip maps, and finer mip maps are streamed in with
+                 * TextureStreamer.
+                 * \param[in] maxSize maximum width and height of the loaded mip maps (if zero, then all mip
+                 * maps are loaded)
+                 */
+                void setMaxSize(uint32_t maxSize)
+                {
+                        maxSize_ = maxSize;
+                }
+
                 /**
                  * \brief Creates texture.
                  *
@@ -57,12 +71,15 @@ namespace selene
 
                         // read texture
                         TextureManager textureManager;
-                        if(textureManager.readTexture(*stream, resource->getData()))
+                        if(textureManager.readTexture(*stream, resource->getData(), maxSize_))
                                 return resource.release();
 
                         return nullptr;
                 }
 
+        private:
+                uint32_t maxSize_;
+
         };
 
         /**
@@ -7,18 +7,19 @@ namespace selene
 {
 
         TextureManager::TextureManager():
-                totalSize_(0), compressionFactor_(0), ddsHeader_(), isDxt_(false) {}
+                totalSize_(0), ddsHeader_(), isDxt_(false) {}
         TextureManager::~TextureManager() {}
 
         //-----------------------------------------------------------------------------------------------------
-        bool TextureManager::readTexture(std::istream& stream, Texture::Data& textureData)
+        bool TextureManager::readTexture(std::istream& stream, Texture::Data& textureData,
+                                         uint32_t maxSize, uint32_t mipMapLevel)
         {
                 // read header
                 if(!readHeader(stream, textureData))
                         return false;
 
                 // get texture properties
-                if(!getProperties(textureData))
+                if(!getProperties(textureData, maxSize, mipMapLevel))
                         return false;
 
                 // compute texture total size
@@ -29,6 +30,17 @@ namespace selene
                 return readPixels(stream, textureData);
         }
 
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureManager::computeMipMapSize(uint32_t width, uint32_t height, uint8_t format, uint8_t bpp)
+        {
+                if(format == TEXTURE_FORMAT_NOT_COMPRESSED)
+                        return width * height * bpp;
+
+                // DXT textures consist of 4x4 blocks
+                uint32_t blockSize = (format == TEXTURE_FORMAT_DXT1) ? 8 : 16;
+                return ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+        }
+
         //-----------------------------------------------------------------------------------------------------
         bool TextureManager::readHeader(std::istream& stream, Texture::Data& textureData)
         {
@@ -72,11 +84,6 @@ namespace selene
                                         return false;
                         }
 
-                        // determine compression factor
-                        compressionFactor_ = 4;
-                        if(textureData.format == TEXTURE_FORMAT_DXT1)
-                                compressionFactor_ = 2;
-
                         isDxt_ = true;
                 }
                 else
@@ -91,7 +98,7 @@ namespace selene
         }
 
         //-----------------------------------------------------------------------------------------------------
-        bool TextureManager::getProperties(Texture::Data& textureData)
+        bool TextureManager::getProperties(Texture::Data& textureData, uint32_t maxSize, uint32_t mipMapLevel)
         {
                 // get number of mip maps
                 textureData.numMipMaps = ddsHeader_.mipMapCount == 0 ? 1 : ddsHeader_.mipMapCount;
@@ -117,41 +124,42 @@ namespace selene
                    (!isDxt_ && (textureData.bpp < 3)))
                         return false;
 
+                // skip large mip maps
+                textureData.mipMapLevel = 0;
+                while(textureData.numMipMaps > 1 &&
+                      (textureData.mipMapLevel < mipMapLevel ||
+                       (maxSize != 0 && (textureData.width > maxSize || textureData.height > maxSize))))
+                {
+                        textureData.width  = textureData.width  > 1 ? (textureData.width  >> 1) : 1;
+                        textureData.height = textureData.height > 1 ? (textureData.height >> 1) : 1;
+
+                        --textureData.numMipMaps;
+                        ++textureData.mipMapLevel;
+                }
+
                 return true;
         }
 
         //-----------------------------------------------------------------------------------------------------
         bool TextureManager::computeTotalSize(Texture::Data& textureData)
         {
-                if(isDxt_)
-                {
-                        // compute DXT texture total size
-                        if(textureData.numMipMaps > 1)
-                                totalSize_ = ddsHeader_.pitchOrLinearSize * compressionFactor_;
-                        else
-                                totalSize_ = ddsHeader_.pitchOrLinearSize;
-                }
-                else
-                {
-                        // compute regular texture total size
-                        uint32_t mipWidth  = textureData.width;
-                        uint32_t mipHeight = textureData.height;
+                uint32_t mipWidth  = textureData.width;
+                uint32_t mipHeight = textureData.height;
 
-                        totalSize_ = 0;
+                totalSize_ = 0;
 
-                        for(uint32_t i = 0; i < textureData.numMipMaps; ++i)
-                        {
-                                totalSize_ += mipWidth * mipHeight * textureData.bpp;
+                for(uint32_t i = 0; i < textureData.numMipMaps; ++i)
+                {
+                        totalSize_ += computeMipMapSize(mipWidth, mipHeight, textureData.format, textureData.bpp);
 
-                                mipWidth  = mipWidth  >> 1;
-                                mipHeight = mipHeight >> 1;
+                        mipWidth  = mipWidth  >> 1;
+                        mipHeight = mipHeight >> 1;
 
-                                if(mipWidth == 0)
-                                        mipWidth = 1;
+                        if(mipWidth == 0)
+                                mipWidth = 1;
 
-                                if(mipHeight == 0)
-                                        mipHeight = 1;
-                        }
+                        if(mipHeight == 0)
+                                mipHeight = 1;
                 }
 
                 // allocate memory for texture
@@ -164,8 +172,20 @@ namespace selene
         //-----------------------------------------------------------------------------------------------------
         bool TextureManager::readPixels(std::istream& stream, Texture::Data& textureData)
         {
+                uint32_t mipWidth  = ddsHeader_.width;
+                uint32_t mipHeight = ddsHeader_.height;
+
                 if(isDxt_)
                 {
+                        // skip large mip maps
+                        for(uint32_t i = 0; i < textureData.mipMapLevel; ++i)
+                        {
+                                stream.ignore(computeMipMapSize(mipWidth, mipHeight, textureData.format, 0));
+
+                                mipWidth  = mipWidth  > 1 ? (mipWidth  >> 1) : 1;
+                                mipHeight = mipHeight > 1 ? (mipHeight >> 1) : 1;
+                        }
+
                         // read DXT texture data
                         stream.read(reinterpret_cast<char*>(&textureData.pixels[0]),
                                     textureData.pixels.getSize());
@@ -173,7 +193,7 @@ namespace selene
                 else
                 {
                         // compute pitch
-                        uint32_t pitch = textureData.width * textureData.bpp;
+                        uint32_t pitch = mipWidth * textureData.bpp;
                         if((pitch & 0x03) != 0)
                                 pitch += 4 - (pitch & 0x03);
 
@@ -182,12 +202,10 @@ namespace selene
                                 return false;
 
                         // read regular texture data
-                        uint32_t mipWidth  = textureData.width;
-                        uint32_t mipHeight = textureData.height;
-
                         uint8_t* pixels = &textureData.pixels[0];
+                        uint32_t numMipMaps = textureData.mipMapLevel + textureData.numMipMaps;
 
-                        for(uint32_t i = 0; i < textureData.numMipMaps; ++i)
+                        for(uint32_t i = 0; i < numMipMaps; ++i)
                         {
                                 uint32_t lineSize = mipWidth * textureData.bpp;
 
@@ -195,18 +213,26 @@ namespace selene
                                 if(lineSize > pitch)
                                         return false;
 
-                                // read mip map data
-                                for(uint32_t j = 0; j < mipHeight; ++j)
+                                if(i < textureData.mipMapLevel)
                                 {
-                                        stream.read(reinterpret_cast<char*>(&line[0]), pitch);
-                                        memcpy(pixels, &line[0], lineSize);
-
-                                        pixels += lineSize;
+                                        // skip large mip map
+                                        stream.ignore(static_cast<std::streamsize>(pitch) * mipHeight);
+                                }
+                                else
+                                {
+                                        // read mip map data
+                                        for(uint32_t j = 0; j < mipHeight; ++j)
+                                        {
+                                                stream.read(reinterpret_cast<char*>(&line[0]), pitch);
+                                                memcpy(pixels, &line[0], lineSize);
+
+                                                pixels += lineSize;
+                                        }
                                 }
 
                                 // compute new width and height
-                                mipWidth  = mipWidth  >> 1;
-                                mipHeight = mipHeight >> 1;
+                                mipWidth  = mipWidth  > 1 ? (mipWidth  >> 1) : 1;
+                                mipHeight = mipHeight > 1 ? (mipHeight >> 1) : 1;
 
                                 // compute new pitch
                                 pitch = pitch >> 1;
@@ -27,14 +27,32 @@ namespace selene
 
                 /**
                  * \brief Reads texture.
+                 *
+                 * Mip maps, whose width or height is greater than maximum size (if it is specified), and mip
+                 * maps, whose level is less than given level, are skipped (the last mip map is always read).
+                 * Texture::Data::mipMapLevel holds the number of skipped mip maps.
                  * \param[in] stream std::istream from which texture data is read
                  * \param[out] textureData texture data
+                 * \param[in] maxSize maximum width and height of the mip maps (if zero, then size of the mip
+                 * maps is not limited)
+                 * \param[in] mipMapLevel level of the first mip map, which is read
                  * \return true if texture has been successfully read
                  */
-                bool readTexture(std::istream& stream, Texture::Data& textureData);
+                bool readTexture(std::istream& stream, Texture::Data& textureData,
+                                 uint32_t maxSize = 0, uint32_t mipMapLevel = 0);
+
+                /**
+                 * \brief Computes size of the mip map.
+                 * \param[in] width width of the mip map
+                 * \param[in] height height of the mip map
+                 * \param[in] format format of the texture (one of the selene::TEXTURE_FORMAT)
+                 * \param[in] bpp bytes per pixel of the not compressed texture
+                 * \return size of the mip map in bytes
+                 */
+                static uint32_t computeMipMapSize(uint32_t width, uint32_t height, uint8_t format, uint8_t bpp);
 
         private:
-                uint32_t totalSize_, compressionFactor_;
+                uint32_t totalSize_;
                 DdsHeader ddsHeader_;
                 bool isDxt_;
 
@@ -49,11 +67,14 @@ namespace selene
                 /**
                  * \brief Gets texture properties.
                  *
-                 * Properties are retrieved from header and checked.
+                 * Properties are retrieved from header and checked. Mip maps, which are larger than
+                 * maximum size or finer than given level, are skipped.
                  * \param[out] textureData texture data
+                 * \param[in] maxSize maximum width and height of the mip maps (zero if there is no limit)
+                 * \param[in] mipMapLevel level of the first mip map, which is read
                  * \return true if texture properties have been successfully retrieved
                  */
-                bool getProperties(Texture::Data& textureData);
+                bool getProperties(Texture::Data& textureData, uint32_t maxSize, uint32_t mipMapLevel);
 
                 /**
                  * \brief Computes total size of texture.
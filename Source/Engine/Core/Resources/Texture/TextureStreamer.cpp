@@ -0,0 +1,476 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace selene
+{
+
+        TextureStreamer::Record::Record():
+                texture(), width(0), height(0), numMipMaps(0), minMipMapLevel(0), mipMapLevel(0),
+                targetMipMapLevel(0), numBytes(0), lastUseFrame(0), importance(0.0f), isLoadable(true) {}
+        TextureStreamer::Record::~Record() {}
+
+        TextureStreamer::Comparator::Comparator(const std::vector<Record>& records): records_(records) {}
+        TextureStreamer::Comparator::~Comparator() {}
+
+        //-----------------------------------------------------------------------------------------------------
+        bool TextureStreamer::Comparator::operator ()(uint32_t first, uint32_t second) const
+        {
+                const Record& firstRecord  = records_[first];
+                const Record& secondRecord = records_[second];
+
+                if(firstRecord.lastUseFrame != secondRecord.lastUseFrame)
+                        return firstRecord.lastUseFrame > secondRecord.lastUseFrame;
+
+                return firstRecord.importance > secondRecord.importance;
+        }
+
+        TextureStreamer::TextureStreamer(FileManager* fileManager):
+                fileManager_(fileManager), records_(), indices_(), order_(),
+                budget_(0), minSize_(64), referenceSize_(0), maxLoadSize_(0),
+                numResidentBytes_(0), numLoadedBytes_(0), numEvictedBytes_(0), frame_(0) {}
+        TextureStreamer::~TextureStreamer() {}
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::setBudget(uint32_t budget)
+        {
+                budget_ = budget;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureStreamer::getBudget() const
+        {
+                return budget_;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::setMinSize(uint32_t minSize)
+        {
+                minSize_ = minSize > 0 ? minSize : 1;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::setReferenceSize(uint32_t referenceSize)
+        {
+                referenceSize_ = referenceSize;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::setMaxLoadSize(uint32_t maxLoadSize)
+        {
+                maxLoadSize_ = maxLoadSize;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        bool TextureStreamer::addTexture(const Resource::Instance<Texture>& texture)
+        {
+                return (findRecord(texture) != nullptr);
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::addImportance(const Resource::Instance<Texture>& texture, float importance)
+        {
+                Record* record = findRecord(texture);
+                if(record == nullptr)
+                        return;
+
+                if(record->lastUseFrame != frame_)
+                {
+                        record->lastUseFrame = frame_;
+                        record->importance = importance;
+                }
+                else if(importance > record->importance)
+                        record->importance = importance;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::addImportance(const Material& material, float importance)
+        {
+                for(uint8_t i = 0; i < NUM_OF_TEXTURE_MAP_TYPES; ++i)
+                {
+                        const Resource::Instance<Texture>& texture = material.getTextureMap(i);
+
+                        if(*texture != nullptr)
+                                addImportance(texture, importance);
+                }
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::update()
+        {
+                numLoadedBytes_ = numEvictedBytes_ = 0;
+                removeDestroyedTextures();
+
+                // sort textures by priority
+                try
+                {
+                        order_.resize(records_.size());
+                }
+                catch(...)
+                {
+                        return;
+                }
+
+                for(uint32_t i = 0; i < static_cast<uint32_t>(order_.size()); ++i)
+                        order_[i] = i;
+
+                std::sort(order_.begin(), order_.end(), Comparator(records_));
+
+                // coarse mip maps are always resident
+                uint64_t numReservedBytes = 0;
+                for(auto it = records_.begin(); it != records_.end(); ++it)
+                        numReservedBytes += computeSize(*it, it->minMipMapLevel);
+
+                // give budget to the textures in order of their priority
+                for(auto it = order_.begin(); it != order_.end(); ++it)
+                {
+                        Record& record = records_[*it];
+
+                        // textures, which have not been used on current frame, keep their mip maps
+                        uint32_t mipMapLevel = std::min(record.mipMapLevel, record.minMipMapLevel);
+                        if(record.lastUseFrame == frame_)
+                                mipMapLevel = computeMipMapLevel(record);
+
+                        if(budget_ != 0)
+                        {
+                                uint64_t numBaseBytes = computeSize(record, record.minMipMapLevel);
+                                numReservedBytes -= numBaseBytes;
+
+                                while(mipMapLevel < record.minMipMapLevel &&
+                                      numReservedBytes + computeSize(record, mipMapLevel) > budget_)
+                                        ++mipMapLevel;
+
+                                numReservedBytes += computeSize(record, mipMapLevel);
+                        }
+
+                        record.targetMipMapLevel = mipMapLevel;
+                }
+
+                // evict mip maps, starting from the textures with the lowest priority
+                for(auto it = order_.rbegin(); it != order_.rend(); ++it)
+                {
+                        Record& record = records_[*it];
+
+                        if(record.targetMipMapLevel > record.mipMapLevel)
+                                evictMipMaps(record, record.targetMipMapLevel);
+                }
+
+                // load mip maps, starting from the textures with the highest priority
+                for(auto it = order_.begin(); it != order_.end(); ++it)
+                {
+                        Record& record = records_[*it];
+
+                        if(record.targetMipMapLevel >= record.mipMapLevel || !record.isLoadable)
+                                continue;
+
+                        if(maxLoadSize_ != 0 && numLoadedBytes_ != 0 &&
+                           numLoadedBytes_ + computeSize(record, record.targetMipMapLevel) > maxLoadSize_)
+                                continue;
+
+                        // file of the texture is not opened again, if mip maps could not be loaded
+                        record.isLoadable = loadMipMaps(record, record.targetMipMapLevel);
+                }
+
+                ++frame_;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::clear()
+        {
+                records_.clear();
+                indices_.clear();
+                order_.clear();
+
+                numResidentBytes_ = numLoadedBytes_ = numEvictedBytes_ = 0;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureStreamer::getNumTextures() const
+        {
+                return static_cast<uint32_t>(records_.size());
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureStreamer::getNumResidentBytes() const
+        {
+                return numResidentBytes_;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureStreamer::getNumLoadedBytes() const
+        {
+                return numLoadedBytes_;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureStreamer::getNumEvictedBytes() const
+        {
+                return numEvictedBytes_;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        TextureStreamer::Record* TextureStreamer::findRecord(const Resource::Instance<Texture>& texture)
+        {
+                Texture* resource = *texture;
+                if(resource == nullptr)
+                        return nullptr;
+
+                auto it = indices_.find(resource);
+                if(it != indices_.end())
+                        return &records_[it->second];
+
+                // validate
+                const Texture::Data& textureData = resource->getData();
+                if(textureData.pixels.isEmpty() || textureData.numMipMaps == 0 || textureData.mipMapLevel >= 32)
+                        return nullptr;
+
+                Record record;
+                record.texture = texture;
+                record.width  = textureData.width  << textureData.mipMapLevel;
+                record.height = textureData.height << textureData.mipMapLevel;
+                record.numMipMaps = textureData.numMipMaps + textureData.mipMapLevel;
+                record.mipMapLevel = textureData.mipMapLevel;
+                record.numBytes = textureData.pixels.getSize();
+                record.lastUseFrame = frame_;
+
+                // compute level of the coarse mip maps
+                uint32_t width = record.width, height = record.height;
+                while(record.minMipMapLevel + 1 < record.numMipMaps && (width > minSize_ || height > minSize_))
+                {
+                        width  = width  > 1 ? (width  >> 1) : 1;
+                        height = height > 1 ? (height >> 1) : 1;
+                        ++record.minMipMapLevel;
+                }
+
+                record.targetMipMapLevel = record.mipMapLevel;
+
+                // add record
+                uint32_t index = static_cast<uint32_t>(records_.size());
+
+                try
+                {
+                        records_.push_back(record);
+                        indices_.insert(std::make_pair(resource, index));
+                }
+                catch(...)
+                {
+                        if(records_.size() > index)
+                                records_.pop_back();
+
+                        return nullptr;
+                }
+
+                numResidentBytes_ += record.numBytes;
+                return &records_[index];
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::removeDestroyedTextures()
+        {
+                bool shouldRebuildIndices = false;
+
+                for(uint32_t i = 0; i < static_cast<uint32_t>(records_.size());)
+                {
+                        if(*records_[i].texture != nullptr)
+                        {
+                                ++i;
+                                continue;
+                        }
+
+                        numResidentBytes_ -= records_[i].numBytes;
+                        records_[i] = records_.back();
+                        records_.pop_back();
+
+                        shouldRebuildIndices = true;
+                }
+
+                if(!shouldRebuildIndices)
+                        return;
+
+                indices_.clear();
+
+                try
+                {
+                        for(uint32_t i = 0; i < static_cast<uint32_t>(records_.size()); ++i)
+                                indices_.insert(std::make_pair(*records_[i].texture, i));
+                }
+                catch(...)
+                {
+                        clear();
+                }
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureStreamer::computeMipMapLevel(const Record& record) const
+        {
+                if(referenceSize_ == 0)
+                        return 0;
+
+                float size = record.importance * static_cast<float>(referenceSize_);
+
+                // select the coarsest mip map, which is not smaller than needed size
+                uint32_t mipMapLevel = 0;
+                uint32_t width = record.width, height = record.height;
+
+                while(mipMapLevel < record.minMipMapLevel &&
+                      static_cast<float>(std::max(width, height) >> 1) >= size)
+                {
+                        width  = width  > 1 ? (width  >> 1) : 1;
+                        height = height > 1 ? (height >> 1) : 1;
+                        ++mipMapLevel;
+                }
+
+                return mipMapLevel;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        uint32_t TextureStreamer::computeSize(const Record& record, uint32_t mipMapLevel) const
+        {
+                const Texture::Data& textureData = (*record.texture)->getData();
+
+                uint32_t width = record.width, height = record.height;
+                uint32_t size = 0;
+
+                for(uint32_t i = 0; i < record.numMipMaps; ++i)
+                {
+                        if(i >= mipMapLevel)
+                                size += TextureManager::computeMipMapSize(width, height,
+                                                                          textureData.format, textureData.bpp);
+
+                        width  = width  > 1 ? (width  >> 1) : 1;
+                        height = height > 1 ? (height >> 1) : 1;
+                }
+
+                return size;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        bool TextureStreamer::loadMipMaps(Record& record, uint32_t mipMapLevel)
+        {
+                if(fileManager_ == nullptr)
+                        return false;
+
+                Texture* texture = *record.texture;
+
+                // open file
+                std::unique_ptr<std::istream> stream(fileManager_->open(texture->getName()));
+                if(stream.get() == nullptr)
+                        return false;
+
+                // read mip maps
+                Texture::Data textureData;
+                TextureManager textureManager;
+                if(!textureManager.readTexture(*stream, textureData, 0, mipMapLevel))
+                        return false;
+
+                // validate (file of the texture might have been changed)
+                const Texture::Data& currentTextureData = texture->getData();
+                if(textureData.format != currentTextureData.format ||
+                   textureData.bpp != currentTextureData.bpp ||
+                   textureData.mipMapLevel + textureData.numMipMaps != record.numMipMaps ||
+                   textureData.mipMapLevel >= record.mipMapLevel)
+                        return false;
+
+                uint32_t numBytes = textureData.pixels.getSize();
+                if(!replaceData(record, textureData))
+                        return false;
+
+                numLoadedBytes_ += numBytes;
+                numResidentBytes_ = numResidentBytes_ - record.numBytes + numBytes;
+                record.numBytes = numBytes;
+
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        bool TextureStreamer::evictMipMaps(Record& record, uint32_t mipMapLevel)
+        {
+                const Texture::Data& currentTextureData = (*record.texture)->getData();
+
+                if(mipMapLevel <= currentTextureData.mipMapLevel)
+                        return true;
+
+                uint32_t numEvictedMipMaps = mipMapLevel - currentTextureData.mipMapLevel;
+                if(numEvictedMipMaps >= currentTextureData.numMipMaps)
+                        numEvictedMipMaps = currentTextureData.numMipMaps - 1;
+
+                // compute offset of the first resident mip map
+                uint32_t width = currentTextureData.width, height = currentTextureData.height;
+                uint32_t offset = 0;
+
+                for(uint32_t i = 0; i < numEvictedMipMaps; ++i)
+                {
+                        offset += TextureManager::computeMipMapSize(width, height,
+                                                                    currentTextureData.format,
+                                                                    currentTextureData.bpp);
+
+                        width  = width  > 1 ? (width  >> 1) : 1;
+                        height = height > 1 ? (height >> 1) : 1;
+                }
+
+                uint32_t size = currentTextureData.pixels.getSize();
+                if(offset == 0 || offset >= size)
+                        return false;
+
+                // copy coarse mip maps
+                Texture::Data textureData;
+                if(!textureData.pixels.create(size - offset))
+                        return false;
+
+                memcpy(&textureData.pixels[0], &currentTextureData.pixels[offset], size - offset);
+
+                textureData.width  = width;
+                textureData.height = height;
+                textureData.numMipMaps  = currentTextureData.numMipMaps  - numEvictedMipMaps;
+                textureData.mipMapLevel = currentTextureData.mipMapLevel + numEvictedMipMaps;
+                textureData.format = currentTextureData.format;
+                textureData.bpp = currentTextureData.bpp;
+
+                if(!replaceData(record, textureData))
+                        return false;
+
+                numEvictedBytes_ += offset;
+                numResidentBytes_ -= offset;
+                record.numBytes = size - offset;
+
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        bool TextureStreamer::replaceData(Record& record, Texture::Data& textureData)
+        {
+                Texture* texture = *record.texture;
+
+                texture->discard();
+                swapData(texture->getData(), textureData);
+
+                if(!texture->retain())
+                {
+                        swapData(texture->getData(), textureData);
+                        texture->retain();
+
+                        return false;
+                }
+
+                record.mipMapLevel = texture->getData().mipMapLevel;
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------
+        void TextureStreamer::swapData(Texture::Data& first, Texture::Data& second)
+        {
+                first.pixels.swap(second.pixels);
+
+                std::swap(first.width, second.width);
+                std::swap(first.height, second.height);
+                std::swap(first.numMipMaps, second.numMipMaps);
+                std::swap(first.mipMapLevel, second.mipMapLevel);
+                std::swap(first.format, second.format);
+                std::swap(first.bpp, second.bpp);
+        }
+
+}
@@ -0,0 +1,297 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include "../../Material/Material.h"
+#include "TextureManager.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Resources
+         * @{
+         */
+
+        /**
+         * Represents texture streamer. Keeps the memory, which is held by mip maps of the textures, within
+         * the budget. Textures should be created with their coarse mip maps only (see
+         * TextureFactory::setMaxSize), finer mip maps are streamed in, when textures become important.
+         *
+         * Importance of the texture is fed from rendering: it is the screen size of the largest actor, which
+         * uses material with this texture on the current frame (see Actor::computeScreenSize). Importance
+         * determines the level of the mip map, which is needed (for example, texture of the actor, which
+         * covers half of the screen, needs mip map, whose size is half of the reference size).
+         *
+         * On each update textures are sorted by priority: textures, which have been used recently, come
+         * first, textures with the same time of the last use are sorted by importance. Budget is given to
+         * the textures in this order, so least recently used and least important textures lose their fine
+         * mip maps first. Coarse mip maps (whose size is not greater than minimum size) are never evicted.
+         *
+         * Mip maps are loaded from the file of the texture (name of the texture is the name of the file),
+         * and evicted by copying coarser mip maps. When mip maps of the texture change, it is discarded and
+         * retained again (see Resource::retain and Resource::discard), so renderer receives new data.
+         *
+         * Texture streamer holds instances of the registered textures, so they are used until streamer is
+         * cleared. Textures, which have been destroyed by force, are removed on update.
+         * \code
+         * selene::TextureFactory<Platform::Texture> textureFactory(&fileManager);
+         * textureFactory.setMaxSize(64);
+         * ...
+         * selene::TextureStreamer textureStreamer(&fileManager);
+         * textureStreamer.setBudget(32 * 1024 * 1024);
+         * textureStreamer.setReferenceSize(screenHeight);
+         * textureStreamer.setMaxLoadSize(1024 * 1024);
+         * scene.setTextureStreamer(&textureStreamer);
+         *
+         * // on each frame
+         * scene.updateAndRender(elapsedTime, renderer);
+         * textureStreamer.update();
+         * \endcode
+         */
+        class TextureStreamer
+        {
+        public:
+                /**
+                 * \brief Constructs texture streamer with given file manager.
+                 * \param[in] fileManager file manager, which is used to load mip maps
+                 */
+                TextureStreamer(FileManager* fileManager = nullptr);
+                TextureStreamer(const TextureStreamer&) = delete;
+                ~TextureStreamer();
+                TextureStreamer& operator =(const TextureStreamer&) = delete;
+
+                /**
+                 * \brief Sets budget.
+                 * \param[in] budget maximum number of bytes, which are held by mip maps of the textures
+                 * (if zero, then there is no limit)
+                 */
+                void setBudget(uint32_t budget);
+
+                /**
+                 * \brief Returns budget.
+                 * \return maximum number of bytes, which are held by mip maps of the textures
+                 */
+                uint32_t getBudget() const;
+
+                /**
+                 * \brief Sets minimum size.
+                 * \param[in] minSize width and height of the mip maps, which are always resident (should be
+                 * the same as maximum size of the texture factory)
+                 */
+                void setMinSize(uint32_t minSize);
+
+                /**
+                 * \brief Sets reference size.
+                 * \param[in] referenceSize size of the mip map, which is needed for texture with importance
+                 * of one (usually height of the screen in pixels)
+                 */
+                void setReferenceSize(uint32_t referenceSize);
+
+                /**
+                 * \brief Sets maximum number of bytes, which are loaded on each update.
+                 *
+                 * At least one texture is loaded on each update, even if its mip maps are larger.
+                 * \param[in] maxLoadSize maximum number of bytes (if zero, then there is no limit)
+                 */
+                void setMaxLoadSize(uint32_t maxLoadSize);
+
+                /**
+                 * \brief Adds texture.
+                 * \param[in] texture instance of the texture
+                 * \return true if texture has been added (or it has been added before)
+                 */
+                bool addTexture(const Resource::Instance<Texture>& texture);
+
+                /**
+                 * \brief Adds importance of the texture.
+                 *
+                 * Texture is added, if it has not been added before. Importance of the texture on the current
+                 * frame is the largest of the added importances.
+                 * \param[in] texture instance of the texture
+                 * \param[in] importance importance (screen size of the actor, which uses texture)
+                 */
+                void addImportance(const Resource::Instance<Texture>& texture, float importance);
+
+                /**
+                 * \brief Adds importance of the textures of the material.
+                 * \see addImportance
+                 * \param[in] material material
+                 * \param[in] importance importance (screen size of the actor, which uses material)
+                 */
+                void addImportance(const Material& material, float importance);
+
+                /**
+                 * \brief Updates textures.
+                 *
+                 * Determines mip maps of the textures, which fit into budget, evicts mip maps, which do not
+                 * fit, and loads needed mip maps. Importances of the current frame are then reset.
+                 */
+                void update();
+
+                /**
+                 * \brief Removes all textures.
+                 */
+                void clear();
+
+                /**
+                 * \brief Returns number of textures.
+                 * \return number of textures
+                 */
+                uint32_t getNumTextures() const;
+
+                /**
+                 * \brief Returns number of resident bytes.
+                 * \return number of bytes, which are held by mip maps of the textures
+                 */
+                uint32_t getNumResidentBytes() const;
+
+                /**
+                 * \brief Returns number of loaded bytes.
+                 * \return number of bytes, which have been loaded on the last update
+                 */
+                uint32_t getNumLoadedBytes() const;
+
+                /**
+                 * \brief Returns number of evicted bytes.
+                 * \return number of bytes, which have been evicted on the last update
+                 */
+                uint32_t getNumEvictedBytes() const;
+
+        private:
+                /**
+                 * Represents streamed texture.
+                 */
+                class Record
+                {
+                public:
+                        Resource::Instance<Texture> texture;
+                        uint32_t width, height;
+                        uint32_t numMipMaps;
+                        uint32_t minMipMapLevel;
+                        uint32_t mipMapLevel;
+                        uint32_t targetMipMapLevel;
+                        uint32_t numBytes;
+                        uint32_t lastUseFrame;
+                        float importance;
+                        bool isLoadable;
+
+                        Record();
+                        Record(const Record&) = default;
+                        ~Record();
+                        Record& operator =(const Record&) = default;
+
+                };
+
+                /**
+                 * Represents comparator, which sorts records by priority.
+                 */
+                class Comparator
+                {
+                public:
+                        /**
+                         * \brief Constructs comparator with given records.
+                         * \param[in] records records of the textures
+                         */
+                        Comparator(const std::vector<Record>& records);
+                        Comparator(const Comparator&) = default;
+                        ~Comparator();
+                        Comparator& operator =(const Comparator&) = delete;
+
+                        /**
+                         * \brief Compares priorities of the records.
+                         * \param[in] first index of the first record
+                         * \param[in] second index of the second record
+                         * \return true if first record has higher priority
+                         */
+                        bool operator ()(uint32_t first, uint32_t second) const;
+
+                private:
+                        const std::vector<Record>& records_;
+
+                };
+
+                FileManager* fileManager_;
+                std::vector<Record> records_;
+                std::unordered_map<const Texture*, uint32_t> indices_;
+                std::vector<uint32_t> order_;
+
+                uint32_t budget_, minSize_, referenceSize_, maxLoadSize_;
+                uint32_t numResidentBytes_, numLoadedBytes_, numEvictedBytes_;
+                uint32_t frame_;
+
+                /**
+                 * \brief Finds record of the texture and adds it, if it has not been found.
+                 * \param[in] texture instance of the texture
+                 * \return pointer to the record, or nullptr if texture could not be added
+                 */
+                Record* findRecord(const Resource::Instance<Texture>& texture);
+
+                /**
+                 * \brief Removes textures, which have been destroyed.
+                 */
+                void removeDestroyedTextures();
+
+                /**
+                 * \brief Computes level of the mip map, which is needed for given importance.
+                 * \param[in] record record of the texture
+                 * \return level of the mip map
+                 */
+                uint32_t computeMipMapLevel(const Record& record) const;
+
+                /**
+                 * \brief Computes size of the mip maps, starting from given level.
+                 * \param[in] record record of the texture
+                 * \param[in] mipMapLevel level of the first mip map
+                 * \return size of the mip maps in bytes
+                 */
+                uint32_t computeSize(const Record& record, uint32_t mipMapLevel) const;
+
+                /**
+                 * \brief Loads mip maps of the texture, starting from given level.
+                 * \param[in] record record of the texture
+                 * \param[in] mipMapLevel level of the first mip map
+                 * \return true if mip maps have been successfully loaded
+                 */
+                bool loadMipMaps(Record& record, uint32_t mipMapLevel);
+
+                /**
+                 * \brief Evicts mip maps of the texture, which are finer than given level.
+                 * \param[in] record record of the texture
+                 * \param[in] mipMapLevel level of the first mip map, which remains resident
+                 * \return true if mip maps have been successfully evicted
+                 */
+                bool evictMipMaps(Record& record, uint32_t mipMapLevel);
+
+                /**
+                 * \brief Replaces texture data.
+                 *
+                 * Texture is discarded, its data is swapped with given data, then texture is retained. If
+                 * texture could not be retained, then previous data is restored.
+                 * \param[in] record record of the texture
+                 * \param[in,out] textureData new texture data (holds previous texture data on return)
+                 * \return true if texture data has been successfully replaced
+                 */
+                bool replaceData(Record& record, Texture::Data& textureData);
+
+                /**
+                 * \brief Swaps texture data.
+                 * \param[in,out] first first texture data
+                 * \param[in,out] second second texture data
+                 */
+                static void swapData(Texture::Data& first, Texture::Data& second);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
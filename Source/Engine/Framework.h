@@ -14,10 +14,14 @@
 #ifndef FRAMEWORK_H
 #define FRAMEWORK_H
 
+#include "Core/FileManager/PackFileManager.h"
 #include "Core/FileManager/FileManager.h"
 
+#include "Core/Helpers/ThreadPool.h"
+#include "Core/Helpers/NameTable.h"
 #include "Core/Helpers/Utility.h"
 
+#include "Core/Material/MaterialRegistry.h"
 #include "Core/Material/Material.h"
 
 #include "Core/Math/Vector.h"
@@ -32,6 +36,7 @@
 
 #include "Core/Resources/MeshAnimation/MeshAnimationFactory.h"
 #include "Core/Resources/MeshAnimation/MeshAnimation.h"
+#include "Core/Resources/Texture/TextureStreamer.h"
 #include "Core/Resources/Texture/TextureFactory.h"
 #include "Core/Resources/Texture/Texture.h"
 #include "Core/Resources/Mesh/MeshFactory.h"
@@ -40,8 +45,10 @@
 #include "Scene/Nodes/Camera.h"
 #include "Scene/Nodes/Actor.h"
 #include "Scene/Nodes/Light.h"
+#include "Scene/StaticBatcher.h"
 #include "Scene/Scene.h"
 
+#include "GUI/GUIGeometryBuilder.h"
 #include "GUI/TextBox.h"
 #include "GUI/Button.h"
 #include "GUI/Label.h"
@@ -3,6 +3,8 @@
 
 #include "GUI.h"
 
+#include <algorithm>
+
 namespace selene
 {
 
@@ -16,7 +18,7 @@ namespace selene
                 callbackFunction_(callbackFunction), blackColor_(),
                 fontSize_(fontSize), position_(position),
                 size_(size), text_(), id_(-1),
-                gui_(nullptr)
+                revision_(0), gui_(nullptr)
         {
                 std::memcpy(backgroundColors_, backgroundColors, sizeof(backgroundColors_));
                 std::memcpy(textColors_, textColors, sizeof(textColors_));
@@ -106,17 +108,30 @@ namespace selene
                 return OUTSIDE;
         }
 
+        //-----------------------------------------------------------------------------------------------------------
+        uint32_t Gui::Element::getRevision() const
+        {
+                return revision_;
+        }
+
         //-----------------------------------------------------------------------------------------------------------
         void Gui::Element::onChange()
         {
                 if(gui_ != nullptr)
+                {
+                        revision_ = ++gui_->nextRevision_;
+                        gui_->isProcessingNeeded_ = true;
                         gui_->clearFlags(GUI_UPDATED);
+                }
         }
 
         //-----------------------------------------------------------------------------------------------------------
         void Gui::Element::setGui(Gui* gui)
         {
                 gui_ = gui;
+
+                if(gui_ != nullptr)
+                        revision_ = ++gui_->nextRevision_;
         }
 
         //-----------------------------------------------------------------------------------------------------------
@@ -136,7 +151,10 @@ namespace selene
                         setFlags(GUI_ELEMENT_TOUCHED);
         }
 
-        Gui::Gui(): elements_(), activeElement_(), cursorPosition_(), nextElementId_(0) {}
+        Gui::Gui(float cellSize):
+                elements_(), activeElement_(), cursorPosition_(), nextElementId_(0), nextRevision_(0),
+                grid_(), largeElements_(), trackedElementIds_(), processedElements_(),
+                cellSize_(cellSize > SELENE_EPSILON ? cellSize : 0.125f), isProcessingNeeded_(true) {}
         Gui::~Gui()
         {
                 destroy();
@@ -145,8 +163,18 @@ namespace selene
         //-----------------------------------------------------------------------------------------------------------
         void Gui::destroy()
         {
+                for(auto it = elements_.begin(); it != elements_.end(); ++it)
+                        it->second->setGui(nullptr);
+
                 nextElementId_ = 0;
                 elements_.clear();
+
+                grid_.clear();
+                largeElements_.clear();
+                trackedElementIds_.clear();
+                processedElements_.clear();
+                isProcessingNeeded_ = true;
+
                 clearFlags(GUI_UPDATED);
         }
 
@@ -164,6 +192,8 @@ namespace selene
                 elementPointer->setId(nextElementId_);
                 elementPointer->setGui(this);
 
+                Element* addedElement = elementPointer.get();
+
                 try
                 {
                         auto result =
@@ -178,6 +208,14 @@ namespace selene
                         return -1;
                 }
 
+                if(!addToGrid(addedElement))
+                {
+                        addedElement->setGui(nullptr);
+                        elements_.erase(nextElementId_);
+                        return -1;
+                }
+
+                isProcessingNeeded_ = true;
                 clearFlags(GUI_UPDATED);
 
                 return nextElementId_++;
@@ -191,7 +229,11 @@ namespace selene
                 if(it == elements_.end())
                         return false;
 
+                removeFromGrid(it->second.get());
+                it->second->setGui(nullptr);
+
                 elements_.erase(it);
+                isProcessingNeeded_ = true;
                 clearFlags(GUI_UPDATED);
 
                 return true;
@@ -242,17 +284,53 @@ namespace selene
                 if(is(GUI_HIDDEN | GUI_DISABLED))
                         return;
 
+                if(!isProcessingNeeded_ && pressedControlButtons == 0 && key == 0 &&
+                   cursorPosition.x == cursorPosition_.x && cursorPosition.y == cursorPosition_.y)
+                        return;
+
                 cursorPosition_ = cursorPosition;
+                isProcessingNeeded_ = false;
 
-                for(auto it = elements_.begin(); it != elements_.end(); ++it)
+                if(!collectElements(cursorPosition))
                 {
-                        Element& element = *it->second.get();
+                        // fall back to processing of all elements
+                        processedElements_.clear();
+                        trackedElementIds_.clear();
+
+                        for(auto it = elements_.begin(); it != elements_.end(); ++it)
+                        {
+                                Element& element = *it->second.get();
+
+                                if(element.is(GUI_ELEMENT_HIDDEN) || element.gui_ != this)
+                                        continue;
+
+                                element.process(cursorPosition, pressedControlButtons, key);
+                        }
 
-                        if(element.is(GUI_ELEMENT_HIDDEN))
+                        isProcessingNeeded_ = true;
+                        return;
+                }
+
+                // callback functions of the elements might change the GUI, so collected elements are held
+                // by the local array while they are processed
+                std::vector<std::shared_ptr<Element>> elements;
+                elements.swap(processedElements_);
+
+                for(auto it = elements.begin(); it != elements.end(); ++it)
+                {
+                        Element& element = *it->get();
+
+                        if(element.is(GUI_ELEMENT_HIDDEN) || element.gui_ != this)
                                 continue;
 
                         element.process(cursorPosition, pressedControlButtons, key);
                 }
+
+                if(!updateTrackedElements(elements, cursorPosition))
+                        isProcessingNeeded_ = true;
+
+                elements.clear();
+                processedElements_.swap(elements);
         }
 
         //-----------------------------------------------------------------------------------------------------------
@@ -279,4 +357,199 @@ namespace selene
                 }
         }
 
+        //-----------------------------------------------------------------------------------------------------------
+        bool Gui::addToGrid(Element* element)
+        {
+                int32_t cells[4];
+
+                try
+                {
+                        if(!computeCells(*element, cells))
+                        {
+                                largeElements_.push_back(element);
+                                return true;
+                        }
+
+                        for(int32_t y = cells[1]; y <= cells[3]; ++y)
+                        {
+                                for(int32_t x = cells[0]; x <= cells[2]; ++x)
+                                        grid_[packCell(x, y)].push_back(element);
+                        }
+                }
+                catch(...)
+                {
+                        removeFromGrid(element);
+                        return false;
+                }
+
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        void Gui::removeFromGrid(Element* element)
+        {
+                int32_t cells[4];
+
+                if(!computeCells(*element, cells))
+                {
+                        auto it = std::find(largeElements_.begin(), largeElements_.end(), element);
+
+                        if(it != largeElements_.end())
+                                largeElements_.erase(it);
+
+                        return;
+                }
+
+                for(int32_t y = cells[1]; y <= cells[3]; ++y)
+                {
+                        for(int32_t x = cells[0]; x <= cells[2]; ++x)
+                        {
+                                auto cell = grid_.find(packCell(x, y));
+
+                                if(cell == grid_.end())
+                                        continue;
+
+                                auto& elements = cell->second;
+                                auto it = std::find(elements.begin(), elements.end(), element);
+
+                                if(it != elements.end())
+                                {
+                                        *it = elements.back();
+                                        elements.pop_back();
+                                }
+
+                                if(elements.empty())
+                                        grid_.erase(cell);
+                        }
+                }
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        bool Gui::collectElements(const Vector2d& cursorPosition)
+        {
+                processedElements_.clear();
+
+                try
+                {
+                        for(auto it = trackedElementIds_.begin(); it != trackedElementIds_.end(); ++it)
+                        {
+                                auto element = elements_.find(*it);
+
+                                if(element != elements_.end())
+                                        processedElements_.push_back(element->second);
+                        }
+
+                        std::shared_ptr<Element> activeElement = activeElement_.lock();
+
+                        if(activeElement && activeElement->gui_ == this)
+                                processedElements_.push_back(activeElement);
+
+                        for(auto it = largeElements_.begin(); it != largeElements_.end(); ++it)
+                        {
+                                if((*it)->determineRelation(cursorPosition) == INSIDE)
+                                        processedElements_.push_back(elements_[(*it)->getId()]);
+                        }
+
+                        int32_t x, y;
+
+                        if(computeCellCoordinate(cursorPosition.x, x) && computeCellCoordinate(cursorPosition.y, y))
+                        {
+                                auto cell = grid_.find(packCell(x, y));
+
+                                if(cell != grid_.end())
+                                {
+                                        const auto& elements = cell->second;
+
+                                        for(auto it = elements.begin(); it != elements.end(); ++it)
+                                        {
+                                                if((*it)->determineRelation(cursorPosition) == INSIDE)
+                                                        processedElements_.push_back(elements_[(*it)->getId()]);
+                                        }
+                                }
+                        }
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                std::sort(processedElements_.begin(), processedElements_.end(),
+                          [](const std::shared_ptr<Element>& first, const std::shared_ptr<Element>& second)
+                          {
+                                  return first->getId() < second->getId();
+                          });
+                processedElements_.erase(std::unique(processedElements_.begin(), processedElements_.end()),
+                                         processedElements_.end());
+
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        bool Gui::updateTrackedElements(const std::vector<std::shared_ptr<Element>>& elements,
+                                        const Vector2d& cursorPosition)
+        {
+                trackedElementIds_.clear();
+
+                try
+                {
+                        for(auto it = elements.begin(); it != elements.end(); ++it)
+                        {
+                                Element& element = *it->get();
+
+                                if(element.gui_ != this)
+                                        continue;
+
+                                if(element.is(GUI_ELEMENT_TOUCHED) ||
+                                   element.determineRelation(cursorPosition) == INSIDE)
+                                        trackedElementIds_.push_back(element.getId());
+                        }
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        bool Gui::computeCells(const Element& element, int32_t* cells) const
+        {
+                const Vector2d& position = element.getPosition();
+                const Vector2d& size = element.getSize();
+
+                // cells are slightly enlarged, so rounding errors do not affect hit testing
+                float margin = 0.01f * cellSize_;
+
+                if(!computeCellCoordinate(std::min(position.x, position.x + size.x) - margin, cells[0]) ||
+                   !computeCellCoordinate(std::min(position.y, position.y + size.y) - margin, cells[1]) ||
+                   !computeCellCoordinate(std::max(position.x, position.x + size.x) + margin, cells[2]) ||
+                   !computeCellCoordinate(std::max(position.y, position.y + size.y) + margin, cells[3]))
+                        return false;
+
+                int64_t numCells = static_cast<int64_t>(cells[2] - cells[0] + 1) *
+                                   static_cast<int64_t>(cells[3] - cells[1] + 1);
+
+                return (numCells <= MAX_NUM_CELLS_PER_ELEMENT);
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        bool Gui::computeCellCoordinate(float coordinate, int32_t& cellCoordinate) const
+        {
+                float c = std::floor(coordinate / cellSize_);
+
+                if(!(c >= -static_cast<float>(MAX_CELL_COORDINATE) && c <= static_cast<float>(MAX_CELL_COORDINATE)))
+                        return false;
+
+                cellCoordinate = static_cast<int32_t>(c);
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        uint64_t Gui::packCell(int32_t x, int32_t y)
+        {
+                return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+                        static_cast<uint64_t>(static_cast<uint32_t>(y));
+        }
+
 }
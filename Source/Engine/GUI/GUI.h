@@ -8,9 +8,11 @@
 #include "../Core/Status/Status.h"
 #include "../Core/Math/Sphere.h"
 
+#include <unordered_map>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <map>
 
 namespace selene
@@ -73,6 +75,13 @@ namespace selene
          * int32_t labelId1 = gui.addElement(new(std::nothrow) Label(...));
          * int32_t textBoxId0 = gui.addElement(new(std::nothrow) TextBox(...));
          * \endcode
+         *
+         * Gui holds uniform grid of the elements (each element is assigned to the cells, which are overlapped
+         * by its rectangle), so elements under the cursor are found without testing all elements. Processing
+         * is driven by events: elements are processed only when cursor has been moved, control button has
+         * been pressed, key has been pressed or elements have been changed, and only elements under the
+         * cursor, elements which were under the cursor (or are still touched) and active element are
+         * processed.
          * \see Gui::Element
          * \see Label Button TextBox
          */
@@ -167,6 +176,16 @@ namespace selene
                          */
                         RELATION determineRelation(const Vector2d& cursorPosition) const;
 
+                        /**
+                         * \brief Returns revision.
+                         *
+                         * Revision is changed each time the element is changed (see onChange), revisions of
+                         * the elements are unique within the GUI, so cached data of the element (such as its
+                         * geometry, see GuiGeometryBuilder) can be checked for validity.
+                         * \return revision of the element
+                         */
+                        uint32_t getRevision() const;
+
                 protected:
                         friend class Gui;
 
@@ -180,6 +199,7 @@ namespace selene
                         mutable std::string text_;
 
                         int32_t id_;
+                        uint32_t revision_;
                         Gui* gui_;
 
                         /**
@@ -211,7 +231,11 @@ namespace selene
 
                 };
 
-                Gui();
+                /**
+                 * \brief Constructs GUI with given size of the cell.
+                 * \param[in] cellSize size of the cell of the grid, which is used in hit testing
+                 */
+                Gui(float cellSize = 0.125f);
                 Gui(const Gui&) = delete;
                 virtual ~Gui();
                 Gui& operator =(const Gui&) = delete;
@@ -264,8 +288,10 @@ namespace selene
                 /**
                  * \brief Processes GUI.
                  *
-                 * Each GUI element is processed separately (for each one of them their own process()
-                 * function is called).
+                 * Each affected GUI element is processed separately (for each one of them their own process()
+                 * function is called, in order of their IDs). If cursor has not been moved, no control buttons
+                 * and keys have been pressed and elements have not been changed since the last call, then no
+                 * elements are processed at all.
                  * \param[in] cursorPosition position of the cursor
                  * \param[in] pressedControlButtons pressed control buttons (mask)
                  * \param[in] key keyboard key
@@ -285,6 +311,7 @@ namespace selene
                 std::weak_ptr<Element> activeElement_;
                 Vector2d cursorPosition_;
                 int32_t nextElementId_;
+                uint32_t nextRevision_;
 
                 /**
                  * \brief Sets active element.
@@ -292,6 +319,80 @@ namespace selene
                  */
                 void setActiveElement(const std::shared_ptr<Element>& element);
 
+        private:
+                /// Helper constants
+                enum
+                {
+                        MAX_CELL_COORDINATE = 0x100000,
+                        MAX_NUM_CELLS_PER_ELEMENT = 1024
+                };
+
+                /// Grid of the elements (with packed coordinates of the cells as the keys)
+                typedef std::unordered_map<uint64_t, std::vector<Element*>> Grid;
+
+                Grid grid_;
+                std::vector<Element*> largeElements_;
+                std::vector<int32_t> trackedElementIds_;
+                std::vector<std::shared_ptr<Element>> processedElements_;
+                float cellSize_;
+                bool isProcessingNeeded_;
+
+                /**
+                 * \brief Adds element to the grid.
+                 * \param[in] element GUI element
+                 * \return true if element has been successfully added
+                 */
+                bool addToGrid(Element* element);
+
+                /**
+                 * \brief Removes element from the grid.
+                 * \param[in] element GUI element
+                 */
+                void removeFromGrid(Element* element);
+
+                /**
+                 * \brief Collects elements, which must be processed.
+                 *
+                 * Elements under the cursor, tracked elements (which were under the cursor or are touched) and
+                 * active element are collected in order of their IDs.
+                 * \param[in] cursorPosition position of the cursor
+                 * \return true if elements have been successfully collected
+                 */
+                bool collectElements(const Vector2d& cursorPosition);
+
+                /**
+                 * \brief Updates tracked elements.
+                 * \param[in] elements processed elements
+                 * \param[in] cursorPosition position of the cursor
+                 * \return true if tracked elements have been successfully updated
+                 */
+                bool updateTrackedElements(const std::vector<std::shared_ptr<Element>>& elements,
+                                           const Vector2d& cursorPosition);
+
+                /**
+                 * \brief Computes range of the cells, which are overlapped by the element.
+                 * \param[in] element GUI element
+                 * \param[out] cells range of the cells (minimum x, minimum y, maximum x, maximum y)
+                 * \return true if element overlaps a limited number of cells (see MAX_NUM_CELLS_PER_ELEMENT)
+                 */
+                bool computeCells(const Element& element, int32_t* cells) const;
+
+                /**
+                 * \brief Computes cell coordinate.
+                 * \param[in] coordinate coordinate
+                 * \param[out] cellCoordinate coordinate of the cell
+                 * \return true if coordinate of the cell is within the grid (see MAX_CELL_COORDINATE)
+                 */
+                bool computeCellCoordinate(float coordinate, int32_t& cellCoordinate) const;
+
+                /**
+                 * \brief Packs coordinates of the cell.
+                 * \param[in] x x coordinate of the cell
+                 * \param[in] y y coordinate of the cell
+                 * \return key of the cell
+                 */
+                static uint64_t packCell(int32_t x, int32_t y);
+
         };
 
         /**
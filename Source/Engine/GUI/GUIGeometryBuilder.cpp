@@ -0,0 +1,306 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "GUIGeometryBuilder.h"
+#include <algorithm>
+
+namespace selene
+{
+
+        GuiGeometryBuilder::GuiGeometryBuilder(): entries_(), vertices_(), gui_(nullptr), revision_(0)
+        {
+                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                        numQuads_[i] = 0;
+        }
+        GuiGeometryBuilder::~GuiGeometryBuilder() {}
+
+        //---------------------------------------------------------------------------------------------------
+        bool GuiGeometryBuilder::build(Gui& gui)
+        {
+                if(gui_ == &gui && gui.is(GUI_UPDATED))
+                        return false;
+
+                if(gui_ != &gui)
+                {
+                        clear();
+                        gui_ = &gui;
+                }
+
+                if(!updateEntries(gui))
+                {
+                        // GUI_UPDATED flag is not set, so geometry will be built again
+                        clear();
+                        return true;
+                }
+
+                gui.setFlags(GUI_UPDATED);
+                ++revision_;
+
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        void GuiGeometryBuilder::clear()
+        {
+                entries_.clear();
+                vertices_.clear();
+
+                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                        numQuads_[i] = 0;
+
+                gui_ = nullptr;
+                ++revision_;
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        const Vector4d* GuiGeometryBuilder::getVertices() const
+        {
+                if(vertices_.empty())
+                        return nullptr;
+
+                return &vertices_[0];
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        uint32_t GuiGeometryBuilder::getNumVertices() const
+        {
+                return static_cast<uint32_t>(vertices_.size() / NUM_OF_VECTORS_PER_VERTEX);
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        uint32_t GuiGeometryBuilder::getFirstVertex(uint8_t batch) const
+        {
+                uint32_t firstVertex = 0;
+
+                for(uint8_t i = 0; i < batch && i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                        firstVertex += numQuads_[i] * NUM_OF_VERTICES_PER_QUAD;
+
+                return firstVertex;
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        uint32_t GuiGeometryBuilder::getNumQuads(uint8_t batch) const
+        {
+                if(batch >= NUM_OF_GEOMETRY_BATCHES)
+                        return 0;
+
+                return numQuads_[batch];
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        uint32_t GuiGeometryBuilder::getRevision() const
+        {
+                return revision_;
+        }
+
+        GuiGeometryBuilder::Entry::Entry(): element(nullptr), revision(0)
+        {
+                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                        offsets[i] = 0;
+        }
+        GuiGeometryBuilder::Entry::~Entry() {}
+
+        //---------------------------------------------------------------------------------------------------
+        bool GuiGeometryBuilder::updateEntries(const Gui& gui)
+        {
+                const auto& elements = gui.getElements();
+                bool shouldPackEntries = false;
+
+                try
+                {
+                        // entries and elements are sorted by IDs, so they are merged in one pass
+                        auto entry = entries_.begin();
+                        for(auto it = elements.begin(); it != elements.end(); ++it)
+                        {
+                                if(!it->second)
+                                        continue;
+
+                                const Gui::Element& element = *it->second;
+
+                                while(entry != entries_.end() && entry->first < it->first)
+                                {
+                                        entry = entries_.erase(entry);
+                                        shouldPackEntries = true;
+                                }
+
+                                if(entry == entries_.end() || entry->first != it->first)
+                                {
+                                        entry = entries_.insert(entry, std::make_pair(it->first, Entry()));
+                                        shouldPackEntries = true;
+                                }
+
+                                Entry& currentEntry = entry->second;
+                                ++entry;
+
+                                if(currentEntry.element == &element &&
+                                   currentEntry.revision == element.getRevision())
+                                        continue;
+
+                                size_t sizes[NUM_OF_GEOMETRY_BATCHES];
+                                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                                        sizes[i] = currentEntry.vertices[i].size();
+
+                                if(!buildElement(element, currentEntry))
+                                        return false;
+
+                                currentEntry.element = &element;
+                                currentEntry.revision = element.getRevision();
+
+                                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                                {
+                                        if(currentEntry.vertices[i].size() != sizes[i])
+                                                shouldPackEntries = true;
+                                }
+
+                                // geometry of the same size is written in place
+                                if(shouldPackEntries)
+                                        continue;
+
+                                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                                {
+                                        std::copy(currentEntry.vertices[i].begin(), currentEntry.vertices[i].end(),
+                                                  vertices_.begin() + currentEntry.offsets[i]);
+                                }
+                        }
+
+                        if(entry != entries_.end())
+                        {
+                                entries_.erase(entry, entries_.end());
+                                shouldPackEntries = true;
+                        }
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                if(shouldPackEntries)
+                        return packEntries();
+
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        bool GuiGeometryBuilder::packEntries()
+        {
+                size_t numVectors = 0;
+                for(auto it = entries_.begin(); it != entries_.end(); ++it)
+                {
+                        for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                                numVectors += it->second.vertices[i].size();
+                }
+
+                try
+                {
+                        vertices_.resize(numVectors);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                uint32_t offset = 0;
+                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                {
+                        uint32_t firstOffset = offset;
+
+                        for(auto it = entries_.begin(); it != entries_.end(); ++it)
+                        {
+                                Entry& entry = it->second;
+
+                                entry.offsets[i] = offset;
+                                std::copy(entry.vertices[i].begin(), entry.vertices[i].end(),
+                                          vertices_.begin() + offset);
+                                offset += static_cast<uint32_t>(entry.vertices[i].size());
+                        }
+
+                        numQuads_[i] = (offset - firstOffset) / (NUM_OF_VERTICES_PER_QUAD * NUM_OF_VECTORS_PER_VERTEX);
+                }
+
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        bool GuiGeometryBuilder::buildElement(const Gui::Element& element, Entry& entry)
+        {
+                const float characterSize = 0.0625f;
+
+                for(uint8_t i = 0; i < NUM_OF_GEOMETRY_BATCHES; ++i)
+                        entry.vertices[i].clear();
+
+                if(element.is(GUI_ELEMENT_HIDDEN))
+                        return true;
+
+                uint8_t colorType = GUI_ELEMENT_COLOR_DEFAULT;
+
+                if(element.is(GUI_ELEMENT_SELECTED))
+                        colorType = GUI_ELEMENT_COLOR_SELECTED;
+                else if(element.is(GUI_ELEMENT_TOUCHED))
+                        colorType = GUI_ELEMENT_COLOR_TOUCHED;
+
+                const std::string& text = element.getText();
+                const Vector2d& fontSize = element.getFontSize();
+                const Vector2d& size = element.getSize();
+                Vector2d position = element.getPosition();
+
+                try
+                {
+                        auto& frameVertices = entry.vertices[GEOMETRY_BATCH_FRAMES];
+                        frameVertices.reserve(NUM_OF_VERTICES_PER_QUAD * NUM_OF_VECTORS_PER_VERTEX);
+                        addQuad(position, size, Vector2d(0.0f, 1.0f), Vector2d(),
+                                element.getBackgroundColor(colorType), frameVertices);
+
+                        if(text.length() == 0)
+                                return true;
+
+                        // glyphs, which start beyond the right boundary of the element, are not rendered
+                        auto& textVertices = entry.vertices[GEOMETRY_BATCH_TEXT];
+                        textVertices.reserve(text.length() * NUM_OF_VERTICES_PER_QUAD * NUM_OF_VECTORS_PER_VERTEX);
+
+                        const Vector4d& textColor = element.getTextColor(colorType);
+                        float rightBoundary = position.x + size.x;
+
+                        for(size_t i = 0; i < text.length(); ++i)
+                        {
+                                uint8_t c = text[i];
+                                Vector2d textureCoordinates(static_cast<float>(c % 16) * characterSize,
+                                                            static_cast<float>(c >> 4) * characterSize);
+
+                                addQuad(position, fontSize, textureCoordinates, Vector2d(characterSize, characterSize),
+                                        textColor, textVertices);
+
+                                position.x += fontSize.x;
+                                if(position.x >= rightBoundary)
+                                        break;
+                        }
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------
+        void GuiGeometryBuilder::addQuad(const Vector2d& position, const Vector2d& size,
+                                         const Vector2d& textureCoordinates, const Vector2d& textureSize,
+                                         const Vector4d& color, std::vector<Vector4d>& vertices)
+        {
+                static const uint8_t vertexIndices[NUM_OF_VERTICES_PER_QUAD] = {0, 2, 1, 2, 3, 1};
+                static const float cornerOffsets[][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}};
+
+                for(uint8_t i = 0; i < NUM_OF_VERTICES_PER_QUAD; ++i)
+                {
+                        const float* offset = cornerOffsets[vertexIndices[i]];
+
+                        Vector2d vertexPosition(position.x + offset[0] * size.x, position.y + offset[1] * size.y);
+                        Vector2d vertexTextureCoordinates(textureCoordinates.x + offset[0] * textureSize.x,
+                                                          textureCoordinates.y + offset[1] * textureSize.y);
+
+                        vertices.push_back(Vector4d(vertexPosition, vertexTextureCoordinates));
+                        vertices.push_back(color);
+                }
+        }
+
+}
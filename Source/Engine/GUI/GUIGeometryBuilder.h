@@ -0,0 +1,170 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef GUI_GEOMETRY_BUILDER_H
+#define GUI_GEOMETRY_BUILDER_H
+
+#include "GUI.h"
+
+#include <vector>
+#include <map>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup GUI
+         * @{
+         */
+
+        /**
+         * Represents GUI geometry builder. Builds geometry of the GUI (frames of the elements and glyphs of
+         * their text) for the GUI renderers, which only upload and draw it.
+         *
+         * Each frame (and each glyph) is a quad of two triangles (six vertices), each vertex consists of two
+         * vectors: position (xy, in [0, 2] range, y grows downwards) with texture coordinates of the font
+         * texture (zw), and color. All frames precede all glyphs in one array of vertices, so geometry can be
+         * uploaded at once.
+         *
+         * Geometry of each element is cached with revision of the element (see Gui::Element::getRevision),
+         * and it is rebuilt only when element has been changed. If GUI has not been changed since the last
+         * build (GUI_UPDATED flag is set), then nothing is done at all. Renderer compares revision of the
+         * geometry with the revision of the uploaded data to decide, if upload is needed.
+         */
+        class GuiGeometryBuilder
+        {
+        public:
+                /// Geometry batch
+                enum GEOMETRY_BATCH
+                {
+                        GEOMETRY_BATCH_FRAMES = 0,
+                        GEOMETRY_BATCH_TEXT,
+                        NUM_OF_GEOMETRY_BATCHES
+                };
+
+                /// Helper constants
+                enum
+                {
+                        NUM_OF_VERTICES_PER_QUAD = 6,
+                        NUM_OF_VECTORS_PER_VERTEX = 2
+                };
+
+                GuiGeometryBuilder();
+                GuiGeometryBuilder(const GuiGeometryBuilder&) = delete;
+                ~GuiGeometryBuilder();
+                GuiGeometryBuilder& operator =(const GuiGeometryBuilder&) = delete;
+
+                /**
+                 * \brief Builds geometry of the GUI.
+                 * \param[in] gui GUI
+                 * \return true if geometry has been changed
+                 */
+                bool build(Gui& gui);
+
+                /**
+                 * \brief Clears geometry.
+                 */
+                void clear();
+
+                /**
+                 * \brief Returns vertices.
+                 * \return vertices of all batches (or nullptr if there are no vertices)
+                 */
+                const Vector4d* getVertices() const;
+
+                /**
+                 * \brief Returns number of vertices.
+                 * \return number of vertices of all batches
+                 */
+                uint32_t getNumVertices() const;
+
+                /**
+                 * \brief Returns index of the first vertex of the batch.
+                 * \param[in] batch batch (must be one of the selene::GuiGeometryBuilder::GEOMETRY_BATCH)
+                 * \return index of the first vertex of the batch
+                 */
+                uint32_t getFirstVertex(uint8_t batch) const;
+
+                /**
+                 * \brief Returns number of quads of the batch.
+                 * \param[in] batch batch (must be one of the selene::GuiGeometryBuilder::GEOMETRY_BATCH)
+                 * \return number of quads of the batch
+                 */
+                uint32_t getNumQuads(uint8_t batch) const;
+
+                /**
+                 * \brief Returns revision of the geometry.
+                 * \return revision, which is changed each time geometry is changed
+                 */
+                uint32_t getRevision() const;
+
+        private:
+                /**
+                 * Represents cached geometry of the element.
+                 */
+                class Entry
+                {
+                public:
+                        const Gui::Element* element;
+                        uint32_t revision;
+
+                        std::vector<Vector4d> vertices[NUM_OF_GEOMETRY_BATCHES];
+                        uint32_t offsets[NUM_OF_GEOMETRY_BATCHES];
+
+                        Entry();
+                        Entry(const Entry&) = default;
+                        ~Entry();
+                        Entry& operator =(const Entry&) = default;
+
+                };
+
+                std::map<int32_t, Entry> entries_;
+                std::vector<Vector4d> vertices_;
+                uint32_t numQuads_[NUM_OF_GEOMETRY_BATCHES];
+
+                const Gui* gui_;
+                uint32_t revision_;
+
+                /**
+                 * \brief Updates entries of the elements of the GUI.
+                 * \param[in] gui GUI
+                 * \return true if entries have been successfully updated
+                 */
+                bool updateEntries(const Gui& gui);
+
+                /**
+                 * \brief Packs geometry of all entries to the array of vertices.
+                 * \return true if geometry has been successfully packed
+                 */
+                bool packEntries();
+
+                /**
+                 * \brief Builds geometry of the element.
+                 * \param[in] element GUI element
+                 * \param[out] entry entry, which receives geometry
+                 * \return true if geometry has been successfully built
+                 */
+                static bool buildElement(const Gui::Element& element, Entry& entry);
+
+                /**
+                 * \brief Adds quad to the geometry.
+                 * \param[in] position position of the top-left corner
+                 * \param[in] size size
+                 * \param[in] textureCoordinates texture coordinates of the top-left corner
+                 * \param[in] textureSize size of the quad in the texture
+                 * \param[in] color color
+                 * \param[out] vertices vertices, which receive quad
+                 */
+                static void addQuad(const Vector2d& position, const Vector2d& size,
+                                    const Vector2d& textureCoordinates, const Vector2d& textureSize,
+                                    const Vector4d& color, std::vector<Vector4d>& vertices);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
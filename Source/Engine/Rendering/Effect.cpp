@@ -58,11 +58,10 @@ namespace selene
 
         Effect::Effect(const char* name, Quality maxQuality, ParametersList&& parametersList):
                 invalidParameter_(nullptr), parametersList_(std::move(parametersList)),
-                parametersMap_(), name_(name), quality_(0), maxQuality_(maxQuality)
+                parametersTable_(), name_(name), quality_(0), maxQuality_(maxQuality)
         {
-                for(auto& parameter: parametersList_)
-                        parametersMap_.insert(std::make_pair(parameter.getName(),
-                                                             std::ref(parameter)));
+                for(uint32_t i = 0; i < parametersList_.size(); ++i)
+                        parametersTable_.insert(parametersList_[i].getName(), i);
         }
         Effect::Effect(const Effect& other):
                 Effect(other.name_, other.maxQuality_, ParametersList(other.parametersList_))
@@ -71,7 +70,7 @@ namespace selene
         }
         Effect::Effect(Effect&& other):
                 invalidParameter_(nullptr), parametersList_(std::move(other.parametersList_)),
-                parametersMap_(std::move(other.parametersMap_)), name_(other.name_),
+                parametersTable_(std::move(other.parametersTable_)), name_(other.name_),
                 quality_(other.quality_), maxQuality_(other.maxQuality_)
         {
                 other.name_ = nullptr;
@@ -83,7 +82,7 @@ namespace selene
         Effect& Effect::operator =(Effect other)
         {
                 std::swap(parametersList_, other.parametersList_);
-                std::swap(parametersMap_,  other.parametersMap_);
+                parametersTable_.swap(other.parametersTable_);
 
                 name_ = other.name_;
 
@@ -125,23 +124,23 @@ namespace selene
         }
 
         //------------------------------------------------------------------------------------
-        Effect::Parameter& Effect::getParameter(const char* name)
+        Effect::Parameter& Effect::getParameter(const Name& name)
         {
-                auto parameter = parametersMap_.find(name);
-                if(parameter == parametersMap_.end())
+                const uint32_t* index = parametersTable_.find(name);
+                if(index == nullptr)
                         return invalidParameter_;
 
-                return parameter->second.get();
+                return parametersList_[*index];
         }
 
         //------------------------------------------------------------------------------------
-        const Effect::Parameter& Effect::getParameter(const char* name) const
+        const Effect::Parameter& Effect::getParameter(const Name& name) const
         {
-                auto parameter = parametersMap_.find(name);
-                if(parameter == parametersMap_.end())
+                const uint32_t* index = parametersTable_.find(name);
+                if(index == nullptr)
                         return invalidParameter_;
 
-                return parameter->second.get();
+                return parametersList_[*index];
         }
 
         //------------------------------------------------------------------------------------
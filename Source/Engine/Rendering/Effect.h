@@ -4,12 +4,10 @@
 #ifndef EFFECT_H
 #define EFFECT_H
 
-#include "../Core/Helpers/Utility.h"
+#include "../Core/Helpers/NameTable.h"
 
-#include <functional>
 #include <limits>
 #include <vector>
-#include <map>
 
 namespace selene
 {
@@ -144,17 +142,17 @@ namespace selene
 
                 /**
                  * \brief Returns parameter.
-                 * \param[in] name name of the parameter
+                 * \param[in] name name of the parameter (identifier of the name is compared)
                  * \return reference to the parameter
                  */
-                Parameter& getParameter(const char* name);
+                Parameter& getParameter(const Name& name);
 
                 /**
                  * \brief Returns parameter.
-                 * \param[in] name name of the parameter
+                 * \param[in] name name of the parameter (identifier of the name is compared)
                  * \return const reference to the parameter
                  */
-                const Parameter& getParameter(const char* name) const;
+                const Parameter& getParameter(const Name& name) const;
 
                 /**
                  * \brief Returns list of the parameters.
@@ -163,17 +161,10 @@ namespace selene
                 const ParametersList& getParameters() const;
 
         private:
-                /**
-                 * Represents map of the parameters.
-                 */
-                typedef std::map<const char*,
-                                 std::reference_wrapper<Parameter>,
-                                 Utility::StringComparator> ParametersMap;
-
                 Parameter invalidParameter_;
 
                 ParametersList parametersList_;
-                ParametersMap  parametersMap_;
+                NameTable<uint32_t> parametersTable_;
 
                 const char* name_;
                 Quality quality_, maxQuality_;
@@ -70,7 +70,7 @@ namespace selene
                 return addElement(element, renderingUnit);
         }
 
-        Renderer::Data::ActorNode::ActorNode(): emptyMaterialNode_() {}
+        Renderer::Data::ActorNode::ActorNode(): emptyMaterialNode_(), numFaces_(0), numCulledFaces_(0) {}
         Renderer::Data::ActorNode::~ActorNode() {}
 
         //-----------------------------------------------------------------------------------------------------------
@@ -78,10 +78,13 @@ namespace selene
         {
                 for(uint8_t i = 0; i < NUM_OF_MESH_UNITS; ++i)
                         materialNodes_[i].clear();
+
+                numFaces_ = numCulledFaces_ = 0;
         }
 
         //-----------------------------------------------------------------------------------------------------------
-        bool Renderer::Data::ActorNode::add(const Actor& actor, const Actor::Instance& instance)
+        bool Renderer::Data::ActorNode::add(const Actor& actor, const Actor::Instance& instance,
+                                            bool shouldCullClusters)
         {
                 int16_t renderingUnit = actor.getRenderingUnit();
                 if(renderingUnit < 0 || renderingUnit >= NUM_OF_MESH_UNITS)
@@ -94,12 +97,66 @@ namespace selene
                         return false;
 
                 const auto& meshData = mesh->getData();
+
+                // bounds of the clusters are not valid for the animated meshes
+                shouldCullClusters = shouldCullClusters && !meshData.clusters.isEmpty() &&
+                                     renderingUnit == UNIT_MESH_STATIC;
+
+                Volume frustum;
+                Vector3d viewer;
+                bool shouldCullBackFaces = false;
+
+                if(shouldCullClusters)
+                {
+                        // clusters are culled in the space of the mesh
+                        const auto& transform = instance.getViewProjectionTransform();
+                        frustum.define(transform.getWorldViewProjectionMatrix());
+
+                        Matrix worldViewInvMatrix = transform.getWorldViewMatrix();
+                        if(!worldViewInvMatrix.invert())
+                                shouldCullClusters = false;
+
+                        viewer = Vector3d() * worldViewInvMatrix;
+
+                        // mirroring transform swaps front and back faces
+                        const auto& a = worldViewInvMatrix.a;
+                        Vector3d axes[3] =
+                        {
+                                Vector3d(a[0][0], a[0][1], a[0][2]),
+                                Vector3d(a[1][0], a[1][1], a[1][2]),
+                                Vector3d(a[2][0], a[2][1], a[2][2])
+                        };
+                        shouldCullBackFaces = (axes[0].cross(axes[1]).dot(axes[2]) > 0.0f);
+                }
+
                 for(uint16_t i = 0; i < meshData.subsets.getSize(); ++i)
                 {
-                        if(!meshData.subsets[i].material)
+                        const Mesh::Subset& meshSubset = meshData.subsets[i];
+                        if(!meshSubset.material)
+                                continue;
+
+                        if(!shouldCullClusters || meshSubset.numClusters == 0)
+                        {
+                                if(!materialNode.add(*meshSubset.material, *mesh, meshSubset, instance))
+                                        return false;
+
+                                numFaces_ += meshSubset.numFaces;
+                                continue;
+                        }
+
+                        Actor::Instance subsetInstance(instance);
+                        uint32_t numFaces = cullClusters(meshData, meshSubset, frustum, viewer,
+                                                         shouldCullBackFaces &&
+                                                         !meshSubset.material->is(MATERIAL_TWO_SIDED),
+                                                         subsetInstance);
+
+                        numFaces_ += numFaces;
+                        numCulledFaces_ += meshSubset.numFaces - numFaces;
+
+                        if(numFaces == 0)
                                 continue;
 
-                        if(!materialNode.add(*meshData.subsets[i].material, *mesh, meshData.subsets[i], instance))
+                        if(!materialNode.add(*meshSubset.material, *mesh, meshSubset, subsetInstance))
                                 return false;
                 }
 
@@ -115,6 +172,82 @@ namespace selene
                 return materialNodes_[unit];
         }
 
+        //-----------------------------------------------------------------------------------------------------------
+        uint32_t Renderer::Data::ActorNode::getNumFaces() const
+        {
+                return numFaces_;
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        uint32_t Renderer::Data::ActorNode::getNumCulledFaces() const
+        {
+                return numCulledFaces_;
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        uint32_t Renderer::Data::ActorNode::getNumMaterials() const
+        {
+                size_t numMaterials = 0;
+                for(uint8_t i = 0; i < NUM_OF_MESH_UNITS; ++i)
+                        numMaterials += materialNodes_[i].getNumElements();
+
+                return static_cast<uint32_t>(numMaterials);
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        uint32_t Renderer::Data::ActorNode::cullClusters(const Mesh::Data& meshData, const Mesh::Subset& meshSubset,
+                                                         const Volume& frustum, const Vector3d& viewer,
+                                                         bool shouldCullBackFaces, Actor::Instance& instance)
+        {
+                Mesh::FaceRange* faceRanges = nullptr;
+
+                try
+                {
+                        faceRanges = memoryBuffer_.allocateMemory<Mesh::FaceRange>(meshSubset.numClusters);
+                }
+                catch(...)
+                {
+                        // clusters can not be culled, so whole subset is rendered
+                        return meshSubset.numFaces;
+                }
+
+                uint32_t numFaceRanges = 0, numFaces = 0;
+
+                for(uint32_t i = 0; i < meshSubset.numClusters; ++i)
+                {
+                        const Mesh::Cluster& cluster = meshData.clusters[meshSubset.clusterIndex + i];
+
+                        if(shouldCullBackFaces && cluster.isBackFacing(viewer))
+                                continue;
+
+                        if(Sphere(cluster.center, cluster.radius).determineRelation(frustum) == OUTSIDE)
+                                continue;
+
+                        numFaces += cluster.numFaces;
+
+                        // adjacent clusters are merged into one range
+                        if(numFaceRanges > 0)
+                        {
+                                Mesh::FaceRange& faceRange = faceRanges[numFaceRanges - 1];
+                                if(faceRange.faceIndex + faceRange.numFaces == cluster.faceIndex)
+                                {
+                                        faceRange.numFaces += cluster.numFaces;
+                                        continue;
+                                }
+                        }
+
+                        faceRanges[numFaceRanges].faceIndex = cluster.faceIndex;
+                        faceRanges[numFaceRanges].numFaces  = cluster.numFaces;
+                        ++numFaceRanges;
+                }
+
+                // whole subset is rendered without ranges
+                if(numFaces != meshSubset.numFaces)
+                        instance.setFaceRanges(faceRanges, numFaceRanges);
+
+                return numFaces;
+        }
+
         Renderer::Data::LightNode::LightNode(): RenderingNode(Renderer::memoryBuffer_) {}
         Renderer::Data::LightNode::~LightNode() {}
 
@@ -136,7 +269,8 @@ namespace selene
                         Actor::ViewProjectionTransform viewProjectionTransform;
                         viewProjectionTransform.compute(*shadowCaster, spotLight.getViewMatrix(),
                                                         spotLight.getViewProjectionMatrix());
-                        Actor::Instance instance(viewProjectionTransform, &shadowCaster->getSkeletonInstance());
+                        Actor::Instance instance(viewProjectionTransform, &shadowCaster->getSkeletonInstance(),
+                                                 shadowCaster->getMeshSkinner());
 
                         element->data.add(*shadowCaster, instance);
                 }
@@ -182,8 +316,9 @@ namespace selene
                 Actor::ViewProjectionTransform viewProjectionTransform;
                 viewProjectionTransform.compute(actor, camera_->getViewMatrix(), camera_->getViewProjectionMatrix());
 
-                Actor::Instance instance(viewProjectionTransform, &actor.getSkeletonInstance());
-                return actorNode_.add(actor, instance);
+                Actor::Instance instance(viewProjectionTransform, &actor.getSkeletonInstance(),
+                                         actor.getMeshSkinner());
+                return actorNode_.add(actor, instance, true);
         }
 
         //-----------------------------------------------------------------------------------------------------------
@@ -241,7 +376,8 @@ namespace selene
                 return isFullScreenEnabledFlag_;
         }
 
-        Renderer::Renderer(): parameters_(nullptr, nullptr, 0, 0, nullptr, false), effectsList_() {}
+        Renderer::Renderer(): parameters_(nullptr, nullptr, 0, 0, nullptr, false), effectsList_(),
+                maxNumBonesInModel_(0) {}
         Renderer::~Renderer() {}
 
         //-----------------------------------------------------------------------------------------------------------
@@ -250,6 +386,12 @@ namespace selene
                 return effectsList_;
         }
 
+        //-----------------------------------------------------------------------------------------------------------
+        uint16_t Renderer::getMaxNumBonesInModel() const
+        {
+                return maxNumBonesInModel_;
+        }
+
         //-----------------------------------------------------------------------------------------------------------
         bool Renderer::initializeMemoryBuffer(std::size_t size)
         {
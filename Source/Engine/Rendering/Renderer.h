@@ -244,6 +244,12 @@ namespace selene
 
                         /**
                          * Represents actor node. Contains material nodes, ordered by mesh units.
+                         *
+                         * If clusters are culled, then clusters of the static meshes (see Mesh::Cluster), which
+                         * are outside the view frustum or back-facing, are not rendered: instances of the actors
+                         * hold ranges of the faces of the remaining clusters (see Actor::Instance::getFaceRanges),
+                         * and subsets without remaining clusters are not added. Ranges are allocated from the
+                         * rendering memory buffer.
                          * \see MaterialNode
                          */
                         class ActorNode
@@ -263,9 +269,12 @@ namespace selene
                                  * \brief Adds actor.
                                  * \param[in] actor actor, which should be added to the node
                                  * \param[in] instance instance of the rendered actor
+                                 * \param[in] shouldCullClusters flag, which forces culling of the clusters of the
+                                 * mesh with the view-projection transform of the instance
                                  * \return true if actor has been successfully added
                                  */
-                                bool add(const Actor& actor, const Actor::Instance& instance);
+                                bool add(const Actor& actor, const Actor::Instance& instance,
+                                         bool shouldCullClusters = false);
 
                                 /**
                                  * \brief Returns material node.
@@ -274,9 +283,50 @@ namespace selene
                                  */
                                 MaterialNode& getMaterialNode(uint8_t unit);
 
+                                /**
+                                 * \brief Returns number of faces.
+                                 * \return number of faces, which have been added since the last clearing
+                                 */
+                                uint32_t getNumFaces() const;
+
+                                /**
+                                 * \brief Returns number of culled faces.
+                                 * \return number of faces of the culled clusters, which have not been added since
+                                 * the last clearing
+                                 */
+                                uint32_t getNumCulledFaces() const;
+
+                                /**
+                                 * \brief Returns number of materials.
+                                 *
+                                 * Renderer sets state of each material (textures and uniforms) once per pass, so
+                                 * this is the number of material state changes per pass. Meshes, which share
+                                 * materials (see MaterialRegistry), are grouped under the same material.
+                                 * \return number of distinct materials (summed over mesh units), which have been
+                                 * added since the last clearing
+                                 */
+                                uint32_t getNumMaterials() const;
+
                         private:
                                 MaterialNode materialNodes_[NUM_OF_MESH_UNITS];
                                 MaterialNode emptyMaterialNode_;
+                                uint32_t numFaces_, numCulledFaces_;
+
+                                /**
+                                 * \brief Culls clusters of the mesh subset.
+                                 * \param[in] meshData mesh data
+                                 * \param[in] meshSubset mesh subset
+                                 * \param[in] frustum view frustum (in the space of the mesh)
+                                 * \param[in] viewer position of the viewer (in the space of the mesh)
+                                 * \param[in] shouldCullBackFaces flag, which enables culling of the back-facing
+                                 * clusters
+                                 * \param[in,out] instance instance of the actor, which receives ranges of the faces
+                                 * of the remaining clusters
+                                 * \return number of faces of the remaining clusters
+                                 */
+                                static uint32_t cullClusters(const Mesh::Data& meshData, const Mesh::Subset& meshSubset,
+                                                             const Volume& frustum, const Vector3d& viewer,
+                                                             bool shouldCullBackFaces, Actor::Instance& instance);
 
                         };
 
@@ -445,6 +495,16 @@ namespace selene
                  */
                 const EffectsList& getEffects() const;
 
+                /**
+                 * \brief Returns maximum number of bones in model.
+                 *
+                 * Skin meshes, whose skeletons have more bones, are skinned on the CPU (see Actor::skinMesh), and
+                 * renderer draws their skinned vertices.
+                 * \return maximum number of bones, which can be held by skinning shaders (zero if there is no
+                 * limit)
+                 */
+                uint16_t getMaxNumBonesInModel() const;
+
                 /**
                  * \brief Initializes renderer.
                  * \param[in] parameters rendering parameters
@@ -486,6 +546,7 @@ namespace selene
         protected:
                 Parameters parameters_;
                 EffectsList effectsList_;
+                uint16_t maxNumBonesInModel_;
 
         private:
                 static RenderingMemoryBuffer memoryBuffer_;
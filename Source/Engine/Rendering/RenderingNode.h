@@ -144,6 +144,18 @@ namespace selene
                         return &((*(*currentElement_))->data);
                 }
 
+                /**
+                 * \brief Returns number of elements.
+                 * \return number of elements (keys), which have been requested since the last clearing
+                 */
+                size_t getNumElements() const
+                {
+                        if(elementsMap_ == nullptr)
+                                return 0;
+
+                        return elementsMap_->size();
+                }
+
         protected:
                 /**
                  * Represents element.
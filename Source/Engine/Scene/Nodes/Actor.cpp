@@ -43,8 +43,10 @@ namespace selene
         }
 
         Actor::Instance::Instance(const Actor::ViewProjectionTransform& viewProjectionTransform,
-                                  const Skeleton::Instance* skeletonInstance):
-                viewProjectionTransform_(viewProjectionTransform), skeletonInstance_(skeletonInstance) {}
+                                  const Skeleton::Instance* skeletonInstance,
+                                  const MeshSkinner* meshSkinner):
+                viewProjectionTransform_(viewProjectionTransform), skeletonInstance_(skeletonInstance),
+                meshSkinner_(meshSkinner), faceRanges_(nullptr), numFaceRanges_(0) {}
         Actor::Instance::~Instance() {}
 
         //------------------------------------------------------------------------------------------------------
@@ -59,13 +61,40 @@ namespace selene
                 return skeletonInstance_;
         }
 
+        //------------------------------------------------------------------------------------------------------
+        const MeshSkinner* Actor::Instance::getMeshSkinner() const
+        {
+                return meshSkinner_;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        void Actor::Instance::setFaceRanges(const Mesh::FaceRange* faceRanges, uint32_t numFaceRanges)
+        {
+                faceRanges_ = faceRanges;
+                numFaceRanges_ = (faceRanges != nullptr) ? numFaceRanges : 0;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        const Mesh::FaceRange* Actor::Instance::getFaceRanges() const
+        {
+                return faceRanges_;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        uint32_t Actor::Instance::getNumFaceRanges() const
+        {
+                return numFaceRanges_;
+        }
+
         Actor::Actor(const char* name,
                      const Resource::Instance<Mesh>& mesh,
                      const Vector3d& position,
                      const Quaternion& rotation,
                      const Vector3d& scale):
-                Scene::Node(name), meshAnimationProcessor_(),
-                mesh_(), renderingUnit_(-1)
+                Scene::Node(name), meshAnimationProcessor_(), meshSkinner_(),
+                mesh_(), renderingUnit_(-1), isBoundingBoxFitted_(false), isMeshSkinned_(false),
+                isReferenceSkinningUsed_(false), fullRateScreenSize_(0.0f), minScreenSize_(0.0f),
+                maxUpdateInterval_(0.0f), minBlendFactor_(0.0f)
         {
                 positions_[ORIGINAL] = position;
                 rotations_[ORIGINAL] = rotation;
@@ -80,7 +109,11 @@ namespace selene
         {
                 skeletonInstance_ = nullptr;
                 renderingUnit_ = -1;
+                isBoundingBoxFitted_ = false;
+                isMeshSkinned_ = false;
+                isReferenceSkinningUsed_ = false;
                 mesh_ = mesh;
+                meshSkinner_.destroy();
 
                 if(*mesh_ == nullptr)
                         return;
@@ -99,8 +132,7 @@ namespace selene
                         }
 
                         renderingUnit_ = Renderer::Data::UNIT_MESH_SKIN;
-                        skeletonInstance_ =
-                                const_cast<Skeleton::Instance*>(&meshAnimationProcessor_.getSkeletonInstance());
+                        skeletonInstance_ = &meshAnimationProcessor_.getSkeletonInstance();
                 }
                 else
                 {
@@ -158,13 +190,133 @@ namespace selene
         }
 
         //------------------------------------------------------------------------------------------------------
-        void Actor::processMeshAnimations(float elapsedTime)
+        void Actor::setMeshAnimationLevelOfDetail(float fullRateScreenSize, float minScreenSize,
+                                                  float maxUpdateInterval, float minBlendFactor)
+        {
+                fullRateScreenSize_ = fullRateScreenSize > 0.0f ? fullRateScreenSize : 0.0f;
+                minScreenSize_ = minScreenSize < fullRateScreenSize_ ? minScreenSize : fullRateScreenSize_;
+                minScreenSize_ = minScreenSize_ > 0.0f ? minScreenSize_ : 0.0f;
+
+                maxUpdateInterval_ = maxUpdateInterval > SELENE_EPSILON ? maxUpdateInterval : 0.0f;
+                minBlendFactor_ = minBlendFactor > 0.0f ? minBlendFactor : 0.0f;
+
+                if(maxUpdateInterval_ == 0.0f)
+                {
+                        meshAnimationProcessor_.setUpdateInterval(0.0f);
+                        meshAnimationProcessor_.setMinBlendFactor(0.0f);
+                }
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        float Actor::computeScreenSize(const Camera& camera) const
+        {
+                performUpdateOperation();
+
+                // compute bounding sphere
+                const Vector3d* vertices = boundingBoxes_[MODIFIED].getVertices();
+
+                Vector3d center;
+                for(uint8_t i = 0; i < Box::NUM_OF_VERTICES; ++i)
+                        center += vertices[i];
+
+                center /= static_cast<float>(Box::NUM_OF_VERTICES);
+
+                float radius = 0.0f;
+                for(uint8_t i = 0; i < Box::NUM_OF_VERTICES; ++i)
+                {
+                        float distance = (vertices[i] - center).length();
+                        radius = distance > radius ? distance : radius;
+                }
+
+                // project it
+                float distance = (center - camera.getPosition()).length();
+                if(distance <= radius)
+                        return 1.0f;
+
+                float screenSize = radius * camera.getProjectionMatrix().a[1][1] / distance;
+                return screenSize < 1.0f ? screenSize : 1.0f;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        void Actor::processMeshAnimations(float elapsedTime, float screenSize,
+                                          MeshAnimationProcessor::PoseCache* poseCache)
         {
                 if(skeletonInstance_ == nullptr)
                         return;
 
-                meshAnimationProcessor_.processMeshAnimations(elapsedTime);
-                requestChildNodesUpdateOperation();
+                // select level of detail
+                if(maxUpdateInterval_ > 0.0f)
+                {
+                        float updateInterval = 0.0f;
+
+                        if(screenSize <= minScreenSize_)
+                                updateInterval = maxUpdateInterval_;
+                        else if(screenSize < fullRateScreenSize_)
+                                updateInterval = maxUpdateInterval_ * (fullRateScreenSize_ - screenSize) /
+                                                 (fullRateScreenSize_ - minScreenSize_);
+
+                        meshAnimationProcessor_.setUpdateInterval(updateInterval);
+                        meshAnimationProcessor_.setMinBlendFactor(screenSize < minScreenSize_ ? minBlendFactor_ : 0.0f);
+                }
+
+                meshAnimationProcessor_.processMeshAnimations(elapsedTime, poseCache);
+                skeletonInstance_ = &meshAnimationProcessor_.getSkeletonInstance();
+                isMeshSkinned_ = false;
+
+                // fit bounding box to the current pose
+                isBoundingBoxFitted_ = skeletonInstance_->computeBoundingBox(boundingBoxes_[ORIGINAL]);
+                if(!isBoundingBoxFitted_)
+                        boundingBoxes_[ORIGINAL] = (*mesh_)->getData().boundingBox;
+
+                requestUpdateOperation();
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        void Actor::advanceMeshAnimations(float elapsedTime)
+        {
+                if(skeletonInstance_ == nullptr)
+                        return;
+
+                meshAnimationProcessor_.advanceMeshAnimations(elapsedTime);
+
+                if(isBoundingBoxFitted_)
+                {
+                        boundingBoxes_[ORIGINAL] = (*mesh_)->getData().boundingBox;
+                        isBoundingBoxFitted_ = false;
+                        requestUpdateOperation();
+                }
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        bool Actor::skinMesh(ThreadPool* threadPool)
+        {
+                if(skeletonInstance_ == nullptr)
+                        return false;
+
+                const Mesh::Data& meshData = (*mesh_)->getData();
+                const auto& boneTransforms = skeletonInstance_->getFinalBoneTransforms();
+
+                // mesh skinner is only needed for large skeletons, so it is initialized on the first use
+                if(meshSkinner_.getVertices(MeshSkinner::SKINNED_STREAM_POSITIONS).isEmpty())
+                {
+                        if(!meshSkinner_.initialize(meshData))
+                                return false;
+
+                        isReferenceSkinningUsed_ = !meshSkinner_.check(meshData, boneTransforms, threadPool);
+                }
+
+                if(isReferenceSkinningUsed_)
+                        isMeshSkinned_ = meshSkinner_.skinReference(meshData, boneTransforms);
+                else
+                        isMeshSkinned_ = meshSkinner_.skin(meshData, boneTransforms, threadPool);
+
+                return isMeshSkinned_;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        const MeshSkinner* Actor::getMeshSkinner() const
+        {
+                return isMeshSkinned_ ? &meshSkinner_ : nullptr;
         }
 
         //------------------------------------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 #define ACTOR_H
 
 #include "../../Core/Resources/MeshAnimation/MeshAnimationProcessor.h"
+#include "../../Core/Resources/Mesh/MeshSkinner.h"
 #include "../../Core/Resources/Mesh/Mesh.h"
 #include "../../Core/Math/Matrix.h"
 #include "../../Core/Math/Volume.h"
@@ -77,19 +78,26 @@ namespace selene
                 };
 
                 /**
-                 * Represents instance of the actor. Contains pointer to the skeleton instance of the actor
-                 * and view-projection transform.
+                 * Represents instance of the actor. Contains pointer to the skeleton instance of the actor,
+                 * view-projection transform and ranges of the faces, which should be rendered (if there are
+                 * no ranges, then all faces of the mesh subset are rendered). If mesh of the actor has been
+                 * skinned on the CPU, then instance also contains pointer to the mesh skinner, which holds
+                 * skinned vertices.
                  */
                 class Instance
                 {
                 public:
                         /**
-                         * \brief Constructs instance with given view-projection transform and skeleton instance.
+                         * \brief Constructs instance with given view-projection transform, skeleton instance and
+                         * mesh skinner.
                          * \param[in] viewProjectionTransform view-projection transform
                          * \param[in] skeletonInstance skeleton instance
+                         * \param[in] meshSkinner mesh skinner, which holds vertices skinned on the CPU (can be
+                         * nullptr)
                          */
                         Instance(const ViewProjectionTransform& viewProjectionTransform,
-                                 const Skeleton::Instance* skeletonInstance);
+                                 const Skeleton::Instance* skeletonInstance,
+                                 const MeshSkinner* meshSkinner = nullptr);
                         Instance(const Instance&) = default;
                         ~Instance();
                         Instance& operator =(const Instance&) = default;
@@ -106,9 +114,40 @@ namespace selene
                          */
                         const Skeleton::Instance* getSkeletonInstance() const;
 
+                        /**
+                         * \brief Returns mesh skinner.
+                         * \return mesh skinner, which holds vertices skinned on the CPU (or nullptr if mesh is
+                         * skinned by the renderer)
+                         */
+                        const MeshSkinner* getMeshSkinner() const;
+
+                        /**
+                         * \brief Sets ranges of the faces.
+                         * \param[in] faceRanges ranges of the faces (must remain valid while instance is
+                         * rendered, if nullptr, then all faces of the mesh subset are rendered)
+                         * \param[in] numFaceRanges number of ranges
+                         */
+                        void setFaceRanges(const Mesh::FaceRange* faceRanges, uint32_t numFaceRanges);
+
+                        /**
+                         * \brief Returns ranges of the faces.
+                         * \return pointer to the first range, or nullptr if all faces of the mesh subset should
+                         * be rendered
+                         */
+                        const Mesh::FaceRange* getFaceRanges() const;
+
+                        /**
+                         * \brief Returns number of ranges of the faces.
+                         * \return number of ranges
+                         */
+                        uint32_t getNumFaceRanges() const;
+
                 private:
                         ViewProjectionTransform viewProjectionTransform_;
                         const Skeleton::Instance* skeletonInstance_;
+                        const MeshSkinner* meshSkinner_;
+                        const Mesh::FaceRange* faceRanges_;
+                        uint32_t numFaceRanges_;
 
                 };
 
@@ -182,12 +221,72 @@ namespace selene
                  */
                 MeshAnimationProcessor::MixableMeshAnimation& getMeshAnimation(uint32_t index);
 
+                /**
+                 * \brief Sets level of detail of the mesh animations.
+                 *
+                 * Pose of the skeleton is computed on each frame while screen size of the actor is not less than
+                 * full rate screen size. For smaller actors update interval grows linearly and reaches its maximum
+                 * at minimum screen size. Actors, which are smaller than minimum screen size, are animated only
+                 * with animations, whose blend factor is not less than minimum blend factor.
+                 * \see computeScreenSize MeshAnimationProcessor::setUpdateInterval
+                 * \param[in] fullRateScreenSize screen size, starting from which pose is computed on each frame
+                 * \param[in] minScreenSize screen size, at which update interval reaches its maximum
+                 * \param[in] maxUpdateInterval maximum update interval (zero disables level of detail)
+                 * \param[in] minBlendFactor minimum blend factor for actors smaller than minimum screen size
+                 */
+                void setMeshAnimationLevelOfDetail(float fullRateScreenSize, float minScreenSize,
+                                                   float maxUpdateInterval, float minBlendFactor);
+
+                /**
+                 * \brief Computes screen size.
+                 * \param[in] camera camera, which point of view is used
+                 * \return ratio of the diameter of the projected bounding sphere to the height of the screen
+                 * (clamped to one)
+                 */
+                float computeScreenSize(const Camera& camera) const;
+
                 /**
                  * \brief Processes mesh animations.
-                 * \see MeshAnimationProcessor::processMeshAnimations
+                 *
+                 * Bounding box of the actor is fitted to the resulting pose of the skeleton.
+                 * \see MeshAnimationProcessor::processMeshAnimations Skeleton::Instance::computeBoundingBox
+                 * \param[in] elapsedTime elapsed time since last processing
+                 * \param[in] screenSize screen size of the actor (used for level of detail selection)
+                 * \param[in] poseCache pose cache, which is used to share poses between actors (can be nullptr)
+                 */
+                void processMeshAnimations(float elapsedTime, float screenSize = 1.0f,
+                                           MeshAnimationProcessor::PoseCache* poseCache = nullptr);
+
+                /**
+                 * \brief Advances mesh animations without changing pose of the skeleton.
+                 *
+                 * This function is used for actors, which are not visible. Since pose is not updated, bounding
+                 * box of the actor is reset to the bounding box of the mesh.
+                 * \see MeshAnimationProcessor::advanceMeshAnimations
                  * \param[in] elapsedTime elapsed time since last processing
                  */
-                void processMeshAnimations(float elapsedTime);
+                void advanceMeshAnimations(float elapsedTime);
+
+                /**
+                 * \brief Skins mesh on the CPU with current pose of the skeleton.
+                 *
+                 * This function is used when skeleton has more bones, than skinning shaders can hold (see
+                 * Renderer::getMaxNumBonesInModel). Mesh skinner is initialized on the first call, and its
+                 * result is checked against reference implementation (see MeshSkinner::check): if they differ,
+                 * then reference implementation is used for this actor. Skinned vertices are valid until pose
+                 * of the skeleton is changed by processMeshAnimations().
+                 * \see MeshSkinner::skin
+                 * \param[in] threadPool thread pool, which is used in skinning (can be nullptr)
+                 * \return true if mesh has been successfully skinned
+                 */
+                bool skinMesh(ThreadPool* threadPool = nullptr);
+
+                /**
+                 * \brief Returns mesh skinner.
+                 * \return pointer to the mesh skinner, which holds vertices skinned on the CPU with current pose
+                 * of the skeleton (or nullptr if mesh has not been skinned on the CPU)
+                 */
+                const MeshSkinner* getMeshSkinner() const;
 
                 /**
                  * \brief Returns bounding box.
@@ -219,9 +318,16 @@ namespace selene
 
         private:
                 MeshAnimationProcessor meshAnimationProcessor_;
+                MeshSkinner meshSkinner_;
                 mutable Box boundingBoxes_[NUM_OF_INDICES];
                 Resource::Instance<Mesh> mesh_;
                 int16_t renderingUnit_;
+                bool isBoundingBoxFitted_;
+                bool isMeshSkinned_;
+                bool isReferenceSkinningUsed_;
+
+                float fullRateScreenSize_, minScreenSize_;
+                float maxUpdateInterval_, minBlendFactor_;
 
         };
 
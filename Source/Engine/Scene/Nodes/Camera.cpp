@@ -18,12 +18,11 @@ namespace selene
                 Scene::Node(name), projectionMatrix_(), projectionInvMatrix_(), viewProjectionMatrix_(), viewMatrix_(),
                 projectionParameters_(), horizontalAngle_(0.0f), verticalAngle_(0.0f), distance_(0.0f),
                 strafeDirection_(), target_(), frustum_(), effectsList_(renderer.getEffects()),
-                effectsMap_(), invalidEffect_(nullptr, 0, Effect::ParametersList()),
+                effectsTable_(), invalidEffect_(nullptr, 0, Effect::ParametersList()),
                 renderingData_(), gui_(gui)
         {
-                for(auto& effect: effectsList_)
-                        effectsMap_.insert(std::make_pair(effect.getName(),
-                                                          std::ref(effect)));
+                for(uint32_t i = 0; i < effectsList_.size(); ++i)
+                        effectsTable_.insert(effectsList_[i].getName(), i);
 
                 setPosition(position);
                 setDirection(direction);
@@ -49,23 +48,23 @@ namespace selene
         }
 
         //-------------------------------------------------------------------------------------------------------------
-        Effect& Camera::getEffect(const char* name)
+        Effect& Camera::getEffect(const Name& name)
         {
-                auto effect = effectsMap_.find(name);
-                if(effect == effectsMap_.end())
+                const uint32_t* index = effectsTable_.find(name);
+                if(index == nullptr)
                         return invalidEffect_;
 
-                return effect->second.get();
+                return effectsList_[*index];
         }
 
         //-------------------------------------------------------------------------------------------------------------
-        const Effect& Camera::getEffect(const char* name) const
+        const Effect& Camera::getEffect(const Name& name) const
         {
-                auto effect = effectsMap_.find(name);
-                if(effect == effectsMap_.end())
+                const uint32_t* index = effectsTable_.find(name);
+                if(index == nullptr)
                         return invalidEffect_;
 
-                return effect->second.get();
+                return effectsList_[*index];
         }
 
         //-------------------------------------------------------------------------------------------------------------
@@ -64,17 +64,17 @@ namespace selene
 
                 /**
                  * \brief Returns effect.
-                 * \param[in] name name of the effect
+                 * \param[in] name name of the effect (identifier of the name is compared)
                  * \return reference to the effect
                  */
-                Effect& getEffect(const char* name);
+                Effect& getEffect(const Name& name);
 
                 /**
                  * \brief Returns effect.
-                 * \param[in] name name of the effect
+                 * \param[in] name name of the effect (identifier of the name is compared)
                  * \return const reference to the effect
                  */
-                const Effect& getEffect(const char* name) const;
+                const Effect& getEffect(const Name& name) const;
 
                 /**
                  * \brief Returns list of the effects.
@@ -231,13 +231,6 @@ namespace selene
                 RELATION determineRelation(const Volume& volume) const;
 
         protected:
-                /**
-                 * Represents map of the effects.
-                 */
-                typedef std::map<const char*,
-                                 std::reference_wrapper<Effect>,
-                                 Utility::StringComparator> EffectsMap;
-
                 mutable Matrix projectionMatrix_, projectionInvMatrix_;
                 mutable Matrix viewProjectionMatrix_, viewMatrix_;
                 Vector4d projectionParameters_;
@@ -248,7 +241,7 @@ namespace selene
                 mutable Volume frustum_;
 
                 Renderer::EffectsList effectsList_;
-                EffectsMap effectsMap_;
+                NameTable<uint32_t> effectsTable_;
                 Effect invalidEffect_;
 
                 Renderer::Data renderingData_;
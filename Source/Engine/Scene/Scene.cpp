@@ -3,7 +3,9 @@
 
 #include "Scene.h"
 
+#include "../Core/Resources/Texture/TextureStreamer.h"
 #include "../Rendering/Renderer.h"
+#include "StaticBatcher.h"
 #include "Nodes/Camera.h"
 #include "Nodes/Actor.h"
 #include "Nodes/Light.h"
@@ -222,7 +224,8 @@ namespace selene
         }
 
         Scene::Scene():
-                activeCamera_(), actors_(), lights_(), cameras_(), numVisibleActors_(0), numVisibleLights_(0) {}
+                activeCamera_(), actors_(), lights_(), cameras_(), poseCache_(),
+                textureStreamer_(nullptr), threadPool_(nullptr), numVisibleActors_(0), numVisibleLights_(0) {}
         Scene::~Scene()
         {
                 destroy();
@@ -277,6 +280,24 @@ namespace selene
                 return cameras_.size();
         }
 
+        //---------------------------------------------------------------------------------------------------------
+        const MeshAnimationProcessor::PoseCache& Scene::getPoseCache() const
+        {
+                return poseCache_;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        void Scene::setTextureStreamer(TextureStreamer* textureStreamer)
+        {
+                textureStreamer_ = textureStreamer;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        void Scene::setThreadPool(ThreadPool* threadPool)
+        {
+                threadPool_ = threadPool;
+        }
+
         //---------------------------------------------------------------------------------------------------------
         bool Scene::addNode(Node* node)
         {
@@ -399,6 +420,70 @@ namespace selene
                 return std::weak_ptr<Camera>(it->second);
         }
 
+        //---------------------------------------------------------------------------------------------------------
+        bool Scene::batchStaticActors(StaticBatcher& staticBatcher, ResourceManager& meshManager,
+                                      ResourceFactory& chunkFactory)
+        {
+                for(auto it = actors_.begin(); it != actors_.end(); ++it)
+                        staticBatcher.addActor(it->second);
+
+                size_t firstChunk = staticBatcher.getNumChunks();
+                if(!staticBatcher.build())
+                        return false;
+
+                // create chunk actors (each chunk before the last one has both mesh and actor)
+                size_t numChunks = staticBatcher.getNumChunks();
+                size_t lastChunk = firstChunk;
+                bool isMeshCreated = false;
+
+                for(; lastChunk < numChunks; ++lastChunk)
+                {
+                        const char* name = staticBatcher.getChunkName(lastChunk);
+                        isMeshCreated = (meshManager.createResource(name, chunkFactory) == SUCCESS);
+                        if(!isMeshCreated)
+                                break;
+
+                        Actor* actor = new(std::nothrow) Actor(name, meshManager.requestResource<Mesh>(name));
+                        if(actor == nullptr)
+                                break;
+
+                        if(staticBatcher.isShadowCaster(lastChunk))
+                                actor->setFlags(Node::SHADOW_CASTER);
+
+                        if(!addNode(actor))
+                                break;
+                }
+
+                if(lastChunk != numChunks)
+                {
+                        // mesh of the failed chunk may have been created, but its actor has not been added
+                        // (resource or actor with the same name, which existed before, is left intact)
+                        if(isMeshCreated)
+                                meshManager.destroyResource(staticBatcher.getChunkName(lastChunk), true);
+
+                        for(size_t i = firstChunk; i < lastChunk; ++i)
+                        {
+                                removeActor(staticBatcher.getChunkName(i));
+                                meshManager.destroyResource(staticBatcher.getChunkName(i), true);
+                        }
+
+                        // forget chunks and batched actors, so actors can be batched again
+                        staticBatcher.removeChunks(firstChunk);
+                        return false;
+                }
+
+                // hide batched actors, chunks are rendered instead
+                const auto& batchedActors = staticBatcher.getBatchedActors();
+                for(auto it = batchedActors.begin(); it != batchedActors.end(); ++it)
+                {
+                        auto actor = it->lock();
+                        if(actor)
+                                actor->setFlags(Node::HIDDEN);
+                }
+
+                return true;
+        }
+
         //---------------------------------------------------------------------------------------------------------
         bool Scene::updateAndRender(float elapsedTime, Renderer& renderer)
         {
@@ -406,11 +491,14 @@ namespace selene
                 if(!camera)
                         return false;
 
+                static constexpr Name shadowsName("Shadows");
+
                 auto& renderingData = camera->getRenderingData();
-                bool shouldRenderShadows = camera->getEffect("Shadows").getQuality() != 0;
+                bool shouldRenderShadows = camera->getEffect(shadowsName).getQuality() != 0;
 
                 renderingData.clear();
                 renderer.getMemoryBuffer().clear();
+                poseCache_.clear();
                 numVisibleActors_ = numVisibleLights_ = 0;
 
                 const Volume& cameraFrustum = camera->getFrustum();
@@ -423,10 +511,28 @@ namespace selene
                         {
                                 ++numVisibleActors_;
 
-                                actor.processMeshAnimations(elapsedTime);
+                                float screenSize = actor.computeScreenSize(*camera);
+                                actor.processMeshAnimations(elapsedTime, screenSize, &poseCache_);
+                                skinMeshIfNeeded(actor, renderer);
+
+                                // pass importance of the textures to the texture streamer
+                                if(textureStreamer_ != nullptr && *actor.getMesh() != nullptr)
+                                {
+                                        const Mesh::Data& meshData = (*actor.getMesh())->getData();
+
+                                        for(uint16_t i = 0; i < meshData.subsets.getSize(); ++i)
+                                        {
+                                                if(meshData.subsets[i].material)
+                                                        textureStreamer_->addImportance(*meshData.subsets[i].material,
+                                                                                        screenSize);
+                                        }
+                                }
+
                                 if(!renderingData.addActor(actor))
                                         break;
                         }
+                        else
+                                actor.advanceMeshAnimations(elapsedTime);
                 }
 
                 for(auto it = lights_.begin(); it != lights_.end(); ++it)
@@ -454,6 +560,8 @@ namespace selene
 
                                         if(actor.determineRelation(light.getVolume()) != OUTSIDE)
                                         {
+                                                skinMeshIfNeeded(actor, renderer);
+
                                                 if(!renderingData.addShadow(light, actor))
                                                         break;
                                         }
@@ -465,4 +573,20 @@ namespace selene
                 return true;
         }
 
+        //---------------------------------------------------------------------------------------------------------
+        void Scene::skinMeshIfNeeded(Actor& actor, const Renderer& renderer)
+        {
+                uint16_t maxNumBones = renderer.getMaxNumBonesInModel();
+
+                if(maxNumBones == 0 || actor.getRenderingUnit() != Renderer::Data::UNIT_MESH_SKIN)
+                        return;
+
+                // mesh stays skinned until pose of the skeleton is changed
+                if(actor.getMeshSkinner() != nullptr)
+                        return;
+
+                if(actor.getSkeletonInstance().getFinalBoneTransforms().getSize() > maxNumBones)
+                        actor.skinMesh(threadPool_);
+        }
+
 }
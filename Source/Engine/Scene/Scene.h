@@ -4,6 +4,7 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include "../Core/Resources/MeshAnimation/MeshAnimationProcessor.h"
 #include "../Core/Resources/Mesh/Skeleton.h"
 #include "../Core/Entity/Entity.h"
 #include "../Core/Status/Status.h"
@@ -24,6 +25,11 @@ namespace selene
          */
 
         // Forward declaration of classes
+        class ResourceFactory;
+        class ResourceManager;
+        class TextureStreamer;
+        class StaticBatcher;
+        class ThreadPool;
         class Renderer;
         class Camera;
         class Light;
@@ -180,7 +186,7 @@ namespace selene
                         mutable Vector3d   scale_[NUM_OF_INDICES];
                         mutable Matrix worldMatrix_;
 
-                        Skeleton::Instance* skeletonInstance_;
+                        const Skeleton::Instance* skeletonInstance_;
 
                         int32_t boneIndex_;
                         Node* parentNode_;
@@ -268,6 +274,32 @@ namespace selene
                  */
                 size_t getNumParticleSystems() const;
 
+                /**
+                 * \brief Returns pose cache.
+                 *
+                 * Pose cache is cleared on each call to updateAndRender() function, so it contains
+                 * statistics of the last frame.
+                 * \return const reference to the pose cache
+                 */
+                const MeshAnimationProcessor::PoseCache& getPoseCache() const;
+
+                /**
+                 * \brief Sets texture streamer.
+                 *
+                 * Screen sizes of the visible actors are passed to the texture streamer as importances of
+                 * the textures of their materials.
+                 * \see TextureStreamer::addImportance
+                 * \param[in] textureStreamer texture streamer (can be nullptr)
+                 */
+                void setTextureStreamer(TextureStreamer* textureStreamer);
+
+                /**
+                 * \brief Sets thread pool.
+                 * \param[in] threadPool thread pool, which is used to skin meshes on the CPU (if nullptr, then
+                 * meshes are skinned in the calling thread)
+                 */
+                void setThreadPool(ThreadPool* threadPool);
+
                 /**
                  * \brief Adds node.
                  * \param[in] node node, which must be added to the scene
@@ -318,8 +350,26 @@ namespace selene
                  */
                 std::weak_ptr<Camera> getCamera(const char* name);
 
+                /**
+                 * \brief Batches static actors.
+                 *
+                 * Static actors (see StaticBatcher::addActor) are merged into chunks, meshes of the chunks
+                 * are created in the mesh manager, and chunks are added to the scene as actors (with the
+                 * names of the chunks), which replace the batched actors: batched actors are hidden, so they
+                 * are neither culled nor rendered. If batching fails, then scene is not changed.
+                 * \param[in] staticBatcher static batcher
+                 * \param[in] meshManager mesh manager, in which meshes of the chunks are created
+                 * \param[in] chunkFactory factory of the meshes of the chunks (see StaticBatcher::ChunkFactory)
+                 * \return true if static actors have been successfully batched
+                 */
+                bool batchStaticActors(StaticBatcher& staticBatcher, ResourceManager& meshManager,
+                                       ResourceFactory& chunkFactory);
+
                 /**
                  * \brief Updates and renders scene.
+                 *
+                 * Meshes of the rendered actors, whose skeletons have more bones than renderer's skinning
+                 * shaders can hold (see Renderer::getMaxNumBonesInModel), are skinned on the CPU.
                  * \param[in] elapsedTime elapsed time since last render
                  * \param[in] renderer renderer, which renders scene
                  * \return true if rendering has been successfully performed
@@ -333,8 +383,18 @@ namespace selene
                 std::unordered_map<std::string, std::shared_ptr<Light>> lights_;
                 std::unordered_map<std::string, std::shared_ptr<Camera>> cameras_;
 
+                MeshAnimationProcessor::PoseCache poseCache_;
+                TextureStreamer* textureStreamer_;
+                ThreadPool* threadPool_;
                 uint32_t numVisibleActors_, numVisibleLights_;
 
+                /**
+                 * \brief Skins mesh of the actor on the CPU, if its skeleton is too large for the renderer.
+                 * \param[in] actor actor
+                 * \param[in] renderer renderer, which renders actor
+                 */
+                void skinMeshIfNeeded(Actor& actor, const Renderer& renderer);
+
         };
 
         /**
@@ -0,0 +1,483 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "StaticBatcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <cmath>
+
+namespace selene
+{
+
+        StaticBatcher::Key::Key(): material(nullptr), isShadowCaster(false)
+        {
+                cell[0] = cell[1] = cell[2] = 0;
+        }
+        StaticBatcher::Key::~Key() {}
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::Key::operator <(const Key& key) const
+        {
+                if(material != key.material)
+                        return std::less<const Material*>()(material, key.material);
+
+                for(uint8_t i = 0; i < 3; ++i)
+                {
+                        if(cell[i] != key.cell[i])
+                                return (cell[i] < key.cell[i]);
+                }
+
+                return (!isShadowCaster && key.isShadowCaster);
+        }
+
+        StaticBatcher::Piece::Piece(): actor(), subset(0) {}
+        StaticBatcher::Piece::~Piece() {}
+
+        StaticBatcher::Source::Source(): actor(), faceIndex(0) {}
+        StaticBatcher::Source::~Source() {}
+
+        StaticBatcher::Chunk::Chunk():
+                name(), material(), isShadowCaster(false), pieces(), numVertices(0), numFaces(0),
+                sources(), data() {}
+        StaticBatcher::Chunk::~Chunk() {}
+
+        StaticBatcher::StaticBatcher(float cellSize, const char* prefix):
+                actors_(), batchedActors_(), chunks_(), chunkIndices_(),
+                prefix_(prefix != nullptr ? prefix : ""), cellSize_(cellSize > SELENE_EPSILON ? cellSize : 1.0f) {}
+        StaticBatcher::~StaticBatcher() {}
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::addActor(const std::shared_ptr<Actor>& actor)
+        {
+                if(!actor || actor->is(Actor::DYNAMIC | Actor::HIDDEN))
+                        return false;
+
+                Mesh* mesh = *actor->getMesh();
+                if(mesh == nullptr || mesh->hasSkeleton())
+                        return false;
+
+                // actor is batched only if all its subsets can be batched, otherwise it would be partially hidden
+                const Mesh::Data& meshData = mesh->getData();
+                if(meshData.subsets.isEmpty())
+                        return false;
+
+                for(uint16_t i = 0; i < meshData.subsets.getSize(); ++i)
+                {
+                        if(!canBatch(meshData, meshData.subsets[i]))
+                                return false;
+                }
+
+                try
+                {
+                        // actors, which render the chunks, are not batched again
+                        if(chunkIndices_.find(std::string(actor->getName())) != chunkIndices_.end())
+                                return false;
+
+                        actors_.push_back(actor);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::build()
+        {
+                size_t firstChunk = chunks_.size();
+                batchedActors_.clear();
+
+                bool result = assignPieces();
+
+                try
+                {
+                        if(result)
+                        {
+                                batchedActors_.reserve(actors_.size());
+                                for(auto it = actors_.begin(); it != actors_.end(); ++it)
+                                        batchedActors_.push_back(*it);
+                        }
+                }
+                catch(...)
+                {
+                        result = false;
+                }
+
+                for(size_t i = firstChunk; i < chunks_.size() && result; ++i)
+                        result = buildChunk(*chunks_[i]);
+
+                actors_.clear();
+
+                if(result)
+                        return true;
+
+                // remove chunks, which have not been built
+                removeChunks(firstChunk);
+                return false;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        void StaticBatcher::removeChunks(size_t firstChunk)
+        {
+                for(size_t i = firstChunk; i < chunks_.size(); ++i)
+                        chunkIndices_.erase(chunks_[i]->name);
+
+                if(firstChunk < chunks_.size())
+                        chunks_.resize(firstChunk);
+
+                batchedActors_.clear();
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::readChunk(const char* name, Mesh::Data& meshData)
+        {
+                if(name == nullptr)
+                        return false;
+
+                auto it = chunkIndices_.find(std::string(name));
+                if(it == chunkIndices_.end())
+                        return false;
+
+                Chunk& chunk = *chunks_[it->second];
+                if(!chunk.data)
+                        return false;
+
+                for(uint8_t i = 0; i < Mesh::NUM_OF_VERTEX_STREAMS; ++i)
+                        meshData.vertices[i].swap(chunk.data->vertices[i]);
+
+                meshData.faces.swap(chunk.data->faces);
+                meshData.subsets.swap(chunk.data->subsets);
+                meshData.clusters.destroy();
+
+                meshData.boundingBox = chunk.data->boundingBox;
+                meshData.skeleton.reset();
+                meshData.mappedFile.reset();
+
+                chunk.data.reset();
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        size_t StaticBatcher::getNumChunks() const
+        {
+                return chunks_.size();
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        const char* StaticBatcher::getChunkName(size_t index) const
+        {
+                if(index >= chunks_.size())
+                        return nullptr;
+
+                return chunks_[index]->name.c_str();
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::isShadowCaster(size_t index) const
+        {
+                if(index >= chunks_.size())
+                        return false;
+
+                return chunks_[index]->isShadowCaster;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        const std::vector<std::weak_ptr<Actor>>& StaticBatcher::getBatchedActors() const
+        {
+                return batchedActors_;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        std::weak_ptr<Actor> StaticBatcher::findActor(const Actor& chunkActor, uint32_t faceIndex) const
+        {
+                auto it = chunkIndices_.find(std::string(chunkActor.getName()));
+                if(it == chunkIndices_.end())
+                        return std::weak_ptr<Actor>();
+
+                const Chunk& chunk = *chunks_[it->second];
+                if(faceIndex >= chunk.numFaces || chunk.sources.empty())
+                        return std::weak_ptr<Actor>();
+
+                // sources are sorted by the indices of their first faces
+                size_t first = 0, last = chunk.sources.size();
+                while(last - first > 1)
+                {
+                        size_t middle = (first + last) / 2;
+
+                        if(chunk.sources[middle].faceIndex <= faceIndex)
+                                first = middle;
+                        else
+                                last = middle;
+                }
+
+                return chunk.sources[first].actor;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::assignPieces()
+        {
+                // chunk of each key, which receives subsets until it is full
+                std::map<Key, size_t> openChunks;
+
+                try
+                {
+                        for(auto it = actors_.begin(); it != actors_.end(); ++it)
+                        {
+                                const Actor& actor = **it;
+                                const Mesh::Data& meshData = (*actor.getMesh())->getData();
+
+                                const Vector3d* vertices = actor.getBoundingBox().getVertices();
+                                Vector3d center = 0.5f * (vertices[0] + vertices[7]);
+
+                                Key key;
+                                key.isShadowCaster = actor.is(Actor::SHADOW_CASTER);
+                                key.cell[0] = static_cast<int32_t>(std::floor(center.x / cellSize_));
+                                key.cell[1] = static_cast<int32_t>(std::floor(center.y / cellSize_));
+                                key.cell[2] = static_cast<int32_t>(std::floor(center.z / cellSize_));
+
+                                for(uint16_t i = 0; i < meshData.subsets.getSize(); ++i)
+                                {
+                                        const Mesh::Subset& subset = meshData.subsets[i];
+                                        key.material = subset.material.get();
+
+                                        auto chunkIt = openChunks.find(key);
+                                        if(chunkIt == openChunks.end() ||
+                                           chunks_[chunkIt->second]->numVertices + subset.numVertices >
+                                           MAX_NUM_VERTICES)
+                                        {
+                                                std::unique_ptr<Chunk> chunk(new(std::nothrow) Chunk);
+                                                if(!chunk)
+                                                        return false;
+
+                                                chunk->name = prefix_ + std::to_string(chunks_.size());
+                                                chunk->material = subset.material;
+                                                chunk->isShadowCaster = key.isShadowCaster;
+
+                                                if(!chunkIndices_.insert(std::make_pair(chunk->name,
+                                                                                        chunks_.size())).second)
+                                                        return false;
+
+                                                chunks_.push_back(std::move(chunk));
+                                                openChunks[key] = chunks_.size() - 1;
+                                                chunkIt = openChunks.find(key);
+                                        }
+
+                                        Chunk& chunk = *chunks_[chunkIt->second];
+
+                                        Piece piece;
+                                        piece.actor = *it;
+                                        piece.subset = i;
+                                        chunk.pieces.push_back(piece);
+
+                                        chunk.numVertices += subset.numVertices;
+                                        chunk.numFaces += subset.numFaces;
+                                }
+                        }
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::buildChunk(Chunk& chunk)
+        {
+                chunk.data.reset(new(std::nothrow) Mesh::Data);
+                if(!chunk.data)
+                        return false;
+
+                Mesh::Data& data = *chunk.data;
+
+                auto& positions          = data.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                auto& tbnBases           = data.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                auto& textureCoordinates = data.vertices[Mesh::VERTEX_STREAM_TEXTURE_COORDINATES];
+
+                if(!positions.create(chunk.numVertices, sizeof(Vector3d)) ||
+                   !tbnBases.create(chunk.numVertices, sizeof(Vector3d) + sizeof(Vector4d)) ||
+                   !textureCoordinates.create(chunk.numVertices, sizeof(Vector2d)) ||
+                   !data.faces.create(chunk.numFaces, sizeof(uint16_t), 3) ||
+                   !data.subsets.create(1))
+                        return false;
+
+                try
+                {
+                        chunk.sources.reserve(chunk.pieces.size());
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                uint16_t* faces = reinterpret_cast<uint16_t*>(&data.faces[0]);
+                uint32_t vertexIndex = 0, faceIndex = 0;
+
+                const float maxFloat = std::numeric_limits<float>::max();
+                Vector3d minBound(maxFloat, maxFloat, maxFloat);
+                Vector3d maxBound = -minBound;
+
+                for(auto it = chunk.pieces.begin(); it != chunk.pieces.end(); ++it)
+                {
+                        const Mesh::Data& meshData = (*it->actor->getMesh())->getData();
+                        const Mesh::Subset& subset = meshData.subsets[it->subset];
+
+                        const auto& sourcePositions = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                        const auto& sourceTbnBases  = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                        const auto& sourceTextureCoordinates =
+                                meshData.vertices[Mesh::VERTEX_STREAM_TEXTURE_COORDINATES];
+
+                        // normals are transformed with the inverse transpose of the world matrix
+                        const Matrix& worldMatrix = it->actor->getWorldMatrix();
+                        Matrix normalsMatrix = worldMatrix;
+                        normalsMatrix.invert();
+                        normalsMatrix.transpose();
+
+                        // mirroring transform swaps front and back faces and flips handedness of the TBN bases
+                        const auto& a = worldMatrix.a;
+                        Vector3d axes[3] =
+                        {
+                                Vector3d(a[0][0], a[0][1], a[0][2]),
+                                Vector3d(a[1][0], a[1][1], a[1][2]),
+                                Vector3d(a[2][0], a[2][1], a[2][2])
+                        };
+                        bool isMirrored = (axes[0].cross(axes[1]).dot(axes[2]) < 0.0f);
+
+                        for(uint32_t i = 0; i < subset.numVertices; ++i)
+                        {
+                                uint32_t sourceIndex = subset.vertexIndex + i;
+                                uint32_t index = vertexIndex + i;
+
+                                const Vector3d& position = *reinterpret_cast<const Vector3d*>(
+                                        &sourcePositions[sourceIndex * sourcePositions.getStride()]);
+                                const uint8_t* tbnBasis = &sourceTbnBases[sourceIndex * sourceTbnBases.getStride()];
+                                const Vector3d& normal  = *reinterpret_cast<const Vector3d*>(tbnBasis);
+                                const Vector4d& tangent = *reinterpret_cast<const Vector4d*>(tbnBasis +
+                                                                                             sizeof(Vector3d));
+
+                                Vector3d worldPosition = position * worldMatrix;
+                                Vector4d worldNormal  = Vector4d(normal, 0.0f) * normalsMatrix;
+                                Vector4d worldTangent = Vector4d(tangent.x, tangent.y, tangent.z, 0.0f) * worldMatrix;
+
+                                Vector3d resultNormal(worldNormal.x, worldNormal.y, worldNormal.z);
+                                Vector3d resultTangent(worldTangent.x, worldTangent.y, worldTangent.z);
+                                resultNormal.normalize();
+                                resultTangent.normalize();
+
+                                uint8_t* resultTbnBasis = &tbnBases[index * tbnBases.getStride()];
+                                *reinterpret_cast<Vector3d*>(&positions[index * positions.getStride()]) =
+                                        worldPosition;
+                                *reinterpret_cast<Vector3d*>(resultTbnBasis) = resultNormal;
+                                *reinterpret_cast<Vector4d*>(resultTbnBasis + sizeof(Vector3d)) =
+                                        Vector4d(resultTangent, isMirrored ? -tangent.w : tangent.w);
+
+                                std::memcpy(&textureCoordinates[index * textureCoordinates.getStride()],
+                                            &sourceTextureCoordinates[sourceIndex *
+                                                                      sourceTextureCoordinates.getStride()],
+                                            sizeof(Vector2d));
+
+                                minBound.define(std::min(minBound.x, worldPosition.x),
+                                                std::min(minBound.y, worldPosition.y),
+                                                std::min(minBound.z, worldPosition.z));
+                                maxBound.define(std::max(maxBound.x, worldPosition.x),
+                                                std::max(maxBound.y, worldPosition.y),
+                                                std::max(maxBound.z, worldPosition.z));
+                        }
+
+                        // indices of the subset are validated by canBatch
+                        for(uint32_t i = 0; i < 3 * subset.numFaces; i += 3)
+                        {
+                                uint32_t sourceFace[3];
+                                for(uint8_t j = 0; j < 3; ++j)
+                                {
+                                        uint32_t k = 3 * subset.faceIndex + i + j;
+                                        sourceFace[j] = (meshData.faces.getStride() == 2) ?
+                                                reinterpret_cast<const uint16_t*>(&meshData.faces[0])[k] :
+                                                reinterpret_cast<const uint32_t*>(&meshData.faces[0])[k];
+                                }
+
+                                if(isMirrored)
+                                        std::swap(sourceFace[1], sourceFace[2]);
+
+                                uint16_t* face = faces + 3 * faceIndex + i;
+                                for(uint8_t j = 0; j < 3; ++j)
+                                        face[j] = static_cast<uint16_t>(sourceFace[j] - subset.vertexIndex +
+                                                                        vertexIndex);
+                        }
+
+                        if(chunk.sources.empty() || chunk.sources.back().actor.lock() != it->actor)
+                        {
+                                Source source;
+                                source.actor = it->actor;
+                                source.faceIndex = faceIndex;
+                                chunk.sources.push_back(source);
+                        }
+
+                        vertexIndex += subset.numVertices;
+                        faceIndex += subset.numFaces;
+                }
+
+                Mesh::Subset& subset = data.subsets[0];
+                subset.vertexIndex = 0;
+                subset.numVertices = chunk.numVertices;
+                subset.faceIndex = 0;
+                subset.numFaces = chunk.numFaces;
+                subset.material = chunk.material;
+
+                Vector3d size = maxBound - minBound;
+                data.boundingBox.define(0.5f * (minBound + maxBound), size.x, size.y, size.z);
+
+                // source actors are not needed anymore
+                chunk.pieces.clear();
+                chunk.pieces.shrink_to_fit();
+
+                return true;
+        }
+
+        //---------------------------------------------------------------------------------------------------------
+        bool StaticBatcher::canBatch(const Mesh::Data& meshData, const Mesh::Subset& subset)
+        {
+                if(!subset.material || subset.numVertices == 0 || subset.numVertices > MAX_NUM_VERTICES ||
+                   subset.numFaces == 0)
+                        return false;
+
+                const auto& positions          = meshData.vertices[Mesh::VERTEX_STREAM_POSITIONS];
+                const auto& tbnBases           = meshData.vertices[Mesh::VERTEX_STREAM_TBN_BASES];
+                const auto& textureCoordinates = meshData.vertices[Mesh::VERTEX_STREAM_TEXTURE_COORDINATES];
+
+                if(positions.getStride() < sizeof(Vector3d) ||
+                   tbnBases.getStride() < sizeof(Vector3d) + sizeof(Vector4d) ||
+                   textureCoordinates.getStride() < sizeof(Vector2d))
+                        return false;
+
+                uint64_t lastVertex = static_cast<uint64_t>(subset.vertexIndex) + subset.numVertices;
+                uint64_t lastFace   = static_cast<uint64_t>(subset.faceIndex) + subset.numFaces;
+
+                if(lastVertex > positions.getSize() || lastVertex > tbnBases.getSize() ||
+                   lastVertex > textureCoordinates.getSize() || lastFace > meshData.faces.getSize())
+                        return false;
+
+                // faces of the subset must only reference vertices of the subset
+                uint8_t faceStride = meshData.faces.getStride();
+                if(faceStride != 2 && faceStride != 4)
+                        return false;
+
+                for(uint32_t i = 3 * subset.faceIndex; i < 3 * static_cast<uint32_t>(lastFace); ++i)
+                {
+                        uint32_t index = (faceStride == 2) ?
+                                reinterpret_cast<const uint16_t*>(&meshData.faces[0])[i] :
+                                reinterpret_cast<const uint32_t*>(&meshData.faces[0])[i];
+
+                        if(index < subset.vertexIndex || index >= lastVertex)
+                                return false;
+                }
+
+                return true;
+        }
+
+}
@@ -0,0 +1,295 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef STATIC_BATCHER_H
+#define STATIC_BATCHER_H
+
+#include "../Core/Resources/ResourceFactory.h"
+#include "Nodes/Actor.h"
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Scene
+         * @{
+         */
+
+        /**
+         * Represents static batcher. Merges static actors (actors without Scene::Node::DYNAMIC flag, whose meshes
+         * have no skeleton), which share material, into chunks: meshes, which hold vertices and faces of the
+         * actors in world space. Actors are assigned to the cells of the uniform grid (by the centers of their
+         * bounding boxes), and each chunk holds subsets with the same material (and shadow casting flag) of the
+         * actors from the same cell, so chunk has its own bounds and is culled and added to the rendering data
+         * as a single actor. Chunk holds at most 65535 vertices (its faces use 16-bit indices), if subsets
+         * of the cell do not fit, then cell is split into several chunks.
+         *
+         * Batching is done once at load time (see Scene::batchStaticActors), batched actors are hidden and
+         * must not be moved or removed from the scene afterwards. Each chunk remembers which ranges of its
+         * faces belong to which actors, so picked faces of the chunk are mapped back to the original actors
+         * (see findActor).
+         * \code
+         * selene::StaticBatcher staticBatcher(16.0f);
+         * selene::StaticBatcher::ChunkFactory<selene::Platform::Mesh> chunkFactory(staticBatcher);
+         *
+         * // chunk meshes are created in the mesh manager, chunk actors are added to the scene
+         * scene.batchStaticActors(staticBatcher, meshManager, chunkFactory);
+         * \endcode
+         */
+        class StaticBatcher
+        {
+        public:
+                /**
+                 * Represents factory of the chunk meshes. Mesh of the chunk with given name is created
+                 * with data, which has been built by the static batcher.
+                 */
+                template <class T> class ChunkFactory: public ResourceFactory
+                {
+                public:
+                        /**
+                         * \brief Constructs chunk factory with given static batcher.
+                         * \param[in] staticBatcher static batcher, which builds chunks
+                         */
+                        ChunkFactory(StaticBatcher& staticBatcher):
+                                ResourceFactory(), staticBatcher_(&staticBatcher) {}
+                        ~ChunkFactory() {}
+
+                        /**
+                         * \brief Creates mesh of the chunk.
+                         * \param[in] name name of the chunk
+                         * \return pointer to the created mesh, or nullptr if mesh could not be created
+                         */
+                        Resource* createResource(const char* name)
+                        {
+                                if(name == nullptr)
+                                        return nullptr;
+
+                                std::unique_ptr<T> resource(new(std::nothrow) T(name));
+                                if(resource.get() == nullptr)
+                                        return nullptr;
+
+                                if(!staticBatcher_->readChunk(name, resource->getData()))
+                                        return nullptr;
+
+                                return resource.release();
+                        }
+
+                private:
+                        StaticBatcher* staticBatcher_;
+
+                };
+
+                /**
+                 * \brief Constructs static batcher with given size of the cell.
+                 * \param[in] cellSize size of the cell of the grid, which splits actors into chunks
+                 * \param[in] prefix prefix of the names of the chunks (names of the chunk actors and meshes)
+                 */
+                StaticBatcher(float cellSize = 16.0f, const char* prefix = "static batch ");
+                StaticBatcher(const StaticBatcher&) = delete;
+                ~StaticBatcher();
+                StaticBatcher& operator =(const StaticBatcher&) = delete;
+
+                /**
+                 * \brief Adds actor.
+                 *
+                 * Actors, which render the chunks of this batcher, are not added.
+                 * \param[in] actor actor
+                 * \return true if actor can be batched and has been added
+                 */
+                bool addActor(const std::shared_ptr<Actor>& actor);
+
+                /**
+                 * \brief Builds chunks.
+                 *
+                 * Vertices and faces of the added actors are transformed to world space and copied to the
+                 * chunks. Added actors are forgotten (except for the ranges of the faces, which are used in
+                 * picking), so batcher can be used again.
+                 * \return true if chunks have been successfully built
+                 */
+                bool build();
+
+                /**
+                 * \brief Removes chunks.
+                 *
+                 * Used when chunks could not be added to the scene: removed chunks and batched actors are
+                 * forgotten, so actors can be batched again.
+                 * \param[in] firstChunk index of the first chunk, which is removed (chunks, which have been
+                 * built earlier, are kept)
+                 */
+                void removeChunks(size_t firstChunk);
+
+                /**
+                 * \brief Reads chunk (used by ChunkFactory).
+                 *
+                 * Data of the chunk is moved to the mesh data, so chunk can be read only once.
+                 * \param[in] name name of the chunk
+                 * \param[out] meshData mesh data
+                 * \return true if chunk has been successfully read
+                 */
+                bool readChunk(const char* name, Mesh::Data& meshData);
+
+                /**
+                 * \brief Returns number of chunks.
+                 * \return number of chunks, which have been built
+                 */
+                size_t getNumChunks() const;
+
+                /**
+                 * \brief Returns name of the chunk.
+                 * \param[in] index index of the chunk
+                 * \return name of the chunk, or nullptr if index is out of range
+                 */
+                const char* getChunkName(size_t index) const;
+
+                /**
+                 * \brief Returns true if chunk casts shadows.
+                 * \param[in] index index of the chunk
+                 * \return true if actors of the chunk are shadow casters
+                 */
+                bool isShadowCaster(size_t index) const;
+
+                /**
+                 * \brief Returns batched actors.
+                 * \return actors, which have been batched by the last call of build
+                 */
+                const std::vector<std::weak_ptr<Actor>>& getBatchedActors() const;
+
+                /**
+                 * \brief Finds original actor of the face of the chunk.
+                 * \param[in] chunkActor actor, which renders the chunk (its name is the name of the chunk)
+                 * \param[in] faceIndex index of the face of the chunk
+                 * \return actor, whose face has given index in the chunk, or empty pointer if there is no
+                 * such actor
+                 */
+                std::weak_ptr<Actor> findActor(const Actor& chunkActor, uint32_t faceIndex) const;
+
+        private:
+                /// Helper constants
+                enum
+                {
+                        MAX_NUM_VERTICES = 65535
+                };
+
+                /**
+                 * Represents key of the chunk (material, cell and shadow casting flag).
+                 */
+                class Key
+                {
+                public:
+                        const Material* material;
+                        int32_t cell[3];
+                        bool isShadowCaster;
+
+                        Key();
+                        Key(const Key&) = default;
+                        ~Key();
+                        Key& operator =(const Key&) = default;
+
+                        /**
+                         * \brief Compares keys.
+                         * \param[in] key another key
+                         * \return true if this key is less than another key
+                         */
+                        bool operator <(const Key& key) const;
+
+                };
+
+                /**
+                 * Represents piece of the chunk: subset of the actor's mesh.
+                 */
+                class Piece
+                {
+                public:
+                        std::shared_ptr<Actor> actor;
+                        uint16_t subset;
+
+                        Piece();
+                        Piece(const Piece&) = default;
+                        ~Piece();
+                        Piece& operator =(const Piece&) = default;
+
+                };
+
+                /**
+                 * Represents range of the faces of the chunk, which belongs to the actor.
+                 */
+                class Source
+                {
+                public:
+                        std::weak_ptr<Actor> actor;
+                        uint32_t faceIndex;
+
+                        Source();
+                        Source(const Source&) = default;
+                        ~Source();
+                        Source& operator =(const Source&) = default;
+
+                };
+
+                /**
+                 * Represents chunk.
+                 */
+                class Chunk
+                {
+                public:
+                        std::string name;
+                        std::shared_ptr<Material> material;
+                        bool isShadowCaster;
+
+                        std::vector<Piece> pieces;
+                        uint32_t numVertices, numFaces;
+
+                        std::vector<Source> sources;
+                        std::unique_ptr<Mesh::Data> data;
+
+                        Chunk();
+                        Chunk(const Chunk&) = delete;
+                        ~Chunk();
+                        Chunk& operator =(const Chunk&) = delete;
+
+                };
+
+                std::vector<std::shared_ptr<Actor>> actors_;
+                std::vector<std::weak_ptr<Actor>> batchedActors_;
+                std::vector<std::unique_ptr<Chunk>> chunks_;
+                std::unordered_map<std::string, size_t> chunkIndices_;
+
+                std::string prefix_;
+                float cellSize_;
+
+                /**
+                 * \brief Assigns subsets of the added actors to the chunks.
+                 * \return true if subsets have been successfully assigned
+                 */
+                bool assignPieces();
+
+                /**
+                 * \brief Builds mesh data of the chunk.
+                 * \param[in,out] chunk chunk
+                 * \return true if mesh data has been successfully built
+                 */
+                bool buildChunk(Chunk& chunk);
+
+                /**
+                 * \brief Returns true if subset of the mesh can be batched.
+                 * \param[in] meshData mesh data
+                 * \param[in] subset subset of the mesh
+                 * \return true if subset can be batched
+                 */
+                static bool canBatch(const Mesh::Data& meshData, const Mesh::Subset& subset);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
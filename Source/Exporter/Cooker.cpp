@@ -0,0 +1,473 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "Cooker.h"
+
+#include <sys/stat.h>
+#include <functional>
+#include <algorithm>
+#include <dirent.h>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+
+namespace selene
+{
+
+        Cooker::Asset::Asset():
+                path(), name(), hash(0), inputSize(0), outputSize(0), time(0.0), status(STATUS_FAILED) {}
+        Cooker::Asset::~Asset() {}
+
+        Cooker::CacheEntry::CacheEntry(): hash(0), outputSize(0) {}
+        Cooker::CacheEntry::~CacheEntry() {}
+
+        Cooker::Cooker(const MeshManager::VertexFormat* vertexFormat, bool shouldReduceOverdraw):
+                assets_(), cache_(), vertexFormat_(), isQuantized_(vertexFormat != nullptr),
+                shouldReduceOverdraw_(shouldReduceOverdraw), optionsHash_(0), outputFolder_(), mutex_(),
+                jobsFinished_(), numPendingJobs_(0)
+        {
+                if(vertexFormat != nullptr)
+                        vertexFormat_ = *vertexFormat;
+
+                // hash of each asset depends on the export options, so changed options invalidate cache
+                uint8_t options[] =
+                {
+                        CACHE_VERSION, isQuantized_, shouldReduceOverdraw_,
+                        vertexFormat_.positions, vertexFormat_.tbnBases,
+                        vertexFormat_.textureCoordinates, vertexFormat_.boneIndicesAndWeights
+                };
+
+                optionsHash_ = computeHash(options, sizeof(options), 14695981039346656037ULL);
+        }
+        Cooker::~Cooker() {}
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::addAssets(const char* path)
+        {
+                if(path == nullptr)
+                        return false;
+
+                struct stat fileStatus;
+                if(stat(path, &fileStatus) != 0)
+                        return false;
+
+                bool result = false;
+                std::string folder(path);
+
+                if(S_ISDIR(fileStatus.st_mode))
+                {
+                        if(!folder.empty() && folder[folder.length() - 1] != '/')
+                                folder += '/';
+
+                        result = addFiles(folder, std::string());
+                }
+                else
+                        result = addManifest(folder);
+
+                // sort assets, so reports and cache do not depend on the order of the directory entries
+                std::sort(assets_.begin(), assets_.end());
+                assets_.erase(std::unique(assets_.begin(), assets_.end()), assets_.end());
+
+                return result;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        size_t Cooker::getNumAssets() const
+        {
+                return assets_.size();
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::cook(const char* outputFolder, size_t numWorkers)
+        {
+                if(outputFolder == nullptr)
+                        return false;
+
+                outputFolder_ = outputFolder;
+                if(!outputFolder_.empty() && outputFolder_[outputFolder_.length() - 1] != '/')
+                        outputFolder_ += '/';
+
+                if(!createFolders(outputFolder_))
+                {
+                        std::cout << "error: could not create output folder" << std::endl;
+                        return false;
+                }
+
+                readCache();
+
+                if(numWorkers == 0)
+                        numWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+
+                auto startTime = std::chrono::steady_clock::now();
+
+                try
+                {
+                        ThreadPool threadPool(numWorkers);
+                        numPendingJobs_ = assets_.size();
+
+                        for(auto it = assets_.begin(); it != assets_.end(); ++it)
+                                threadPool.addJob(std::bind(&Cooker::executeJob, this, std::ref(*it)));
+
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        while(numPendingJobs_ != 0)
+                                jobsFinished_.wait(lock);
+                }
+                catch(...)
+                {
+                        std::cout << "error: could not start workers" << std::endl;
+                        return false;
+                }
+
+                std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - startTime;
+
+                uint32_t numStatuses[3] = {0, 0, 0};
+                for(auto it = assets_.begin(); it != assets_.end(); ++it)
+                        ++numStatuses[it->status];
+
+                std::cout << "status: " << numStatuses[STATUS_COOKED] << " cooked, " <<
+                             numStatuses[STATUS_SKIPPED] << " skipped, " << numStatuses[STATUS_FAILED] <<
+                             " failed in " << time.count() << " ms (" << numWorkers << " workers)" << std::endl;
+
+                if(!writeCache())
+                {
+                        std::cout << "error: could not write cache manifest" << std::endl;
+                        return false;
+                }
+
+                return (numStatuses[STATUS_FAILED] == 0);
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::Asset::operator <(const Asset& asset) const
+        {
+                return name < asset.name;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::Asset::operator ==(const Asset& asset) const
+        {
+                return name == asset.name;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::addFiles(const std::string& path, const std::string& prefix)
+        {
+                DIR* directory = opendir(path.c_str());
+                if(directory == nullptr)
+                        return false;
+
+                bool result = true;
+
+                for(dirent* directoryEntry = readdir(directory); directoryEntry != nullptr;
+                    directoryEntry = readdir(directory))
+                {
+                        std::string name(directoryEntry->d_name);
+
+                        // skip hidden files, current and parent folders
+                        if(name.empty() || name[0] == '.')
+                                continue;
+
+                        struct stat fileStatus;
+                        std::string filePath = path + name;
+
+                        if(stat(filePath.c_str(), &fileStatus) != 0)
+                                continue;
+
+                        if(S_ISDIR(fileStatus.st_mode))
+                        {
+                                if(!addFiles(filePath + '/', prefix + name + '/'))
+                                        result = false;
+
+                                continue;
+                        }
+
+                        // add only raw meshes
+                        if(name.length() < 5 || name.compare(name.length() - 5, 5, ".sdif") != 0)
+                                continue;
+
+                        try
+                        {
+                                Asset asset;
+                                asset.path = filePath;
+                                asset.name = prefix + name;
+                                assets_.push_back(asset);
+                        }
+                        catch(...)
+                        {
+                                result = false;
+                                break;
+                        }
+                }
+
+                closedir(directory);
+                return result;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::addManifest(const std::string& fileName)
+        {
+                std::ifstream stream(fileName.c_str());
+                if(!stream.good())
+                        return false;
+
+                // names are relative to the folder of the manifest
+                size_t separator = fileName.find_last_of('/');
+                std::string folder = (separator == std::string::npos) ? std::string() :
+                                     fileName.substr(0, separator + 1);
+
+                try
+                {
+                        std::string line;
+                        while(std::getline(stream, line))
+                        {
+                                size_t first = line.find_first_not_of(" \t\r");
+                                size_t last = line.find_last_not_of(" \t\r");
+
+                                if(first == std::string::npos || line[first] == '#')
+                                        continue;
+
+                                Asset asset;
+                                asset.name = line.substr(first, last - first + 1);
+                                asset.path = folder + asset.name;
+                                assets_.push_back(asset);
+                        }
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                return !stream.bad();
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void Cooker::readCache()
+        {
+                cache_.clear();
+
+                std::ifstream stream((outputFolder_ + ".cache").c_str());
+                if(!stream.good())
+                        return;
+
+                // cache manifest is a text file: signature and version, then one line per asset with
+                // hash of the asset, size of its output file and its name
+                std::string signature;
+                uint32_t version = 0;
+
+                stream >> signature >> version;
+                if(signature != "SDCC" || version != CACHE_VERSION)
+                        return;
+
+                try
+                {
+                        CacheEntry entry;
+                        std::string name;
+
+                        while(stream >> std::hex >> entry.hash >> std::dec >> entry.outputSize &&
+                              std::getline(stream, name))
+                        {
+                                if(name.length() > 1 && name[0] == ' ')
+                                        cache_[name.substr(1)] = entry;
+                        }
+                }
+                catch(...)
+                {
+                        cache_.clear();
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::writeCache() const
+        {
+                // cache is written to the temporary file first, so broken cache manifest is never read
+                std::string fileName = outputFolder_ + ".cache";
+                std::string temporaryFileName = fileName + ".tmp";
+
+                {
+                        std::ofstream stream(temporaryFileName.c_str());
+                        if(!stream.good())
+                                return false;
+
+                        stream << "SDCC " << static_cast<uint32_t>(CACHE_VERSION) << std::endl;
+
+                        for(auto it = assets_.begin(); it != assets_.end(); ++it)
+                        {
+                                if(it->status == STATUS_FAILED)
+                                        continue;
+
+                                stream << std::hex << std::setw(16) << std::setfill('0') << it->hash <<
+                                          std::dec << ' ' << it->outputSize << ' ' << it->name << std::endl;
+                        }
+
+                        if(!stream.good())
+                                return false;
+                }
+
+                return (std::rename(temporaryFileName.c_str(), fileName.c_str()) == 0);
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void Cooker::executeJob(Asset& asset)
+        {
+                auto startTime = std::chrono::steady_clock::now();
+                std::ostringstream log;
+
+                try
+                {
+                        cookAsset(asset, log);
+                }
+                catch(...)
+                {
+                        asset.status = STATUS_FAILED;
+                }
+
+                std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - startTime;
+                asset.time = time.count();
+
+                const char* statuses[] = {"failed", "cooked", "skipped"};
+
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                std::cout << statuses[asset.status] << ": " << asset.name << ", " << asset.time << " ms, " <<
+                             asset.inputSize << " -> " << asset.outputSize << " bytes" << std::endl;
+
+                if(asset.status == STATUS_FAILED)
+                        std::cout << log.str();
+
+                --numPendingJobs_;
+                jobsFinished_.notify_one();
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void Cooker::cookAsset(Asset& asset, std::ostream& log)
+        {
+                asset.status = STATUS_FAILED;
+
+                std::vector<char> contents;
+                if(!readFile(asset.path, contents))
+                {
+                        log << "error: could not open file" << std::endl;
+                        return;
+                }
+
+                asset.inputSize = contents.size();
+                asset.hash = computeHash(contents.empty() ? nullptr : &contents[0], contents.size(), optionsHash_);
+
+                std::string outputPath = getOutputPath(asset);
+
+                // cache is not changed during cooking, so it is read without lock
+                auto entry = cache_.find(asset.name);
+                if(entry != cache_.end() && entry->second.hash == asset.hash &&
+                   getFileSize(outputPath, asset.outputSize) && asset.outputSize == entry->second.outputSize)
+                {
+                        asset.status = STATUS_SKIPPED;
+                        return;
+                }
+
+                asset.outputSize = 0;
+                contents.clear();
+
+                if(!createFolders(outputPath))
+                {
+                        log << "error: could not create output folder" << std::endl;
+                        return;
+                }
+
+                // assets are cooked in parallel, so each exporter works in the calling thread
+                RawMesh rawMesh(log);
+                if(!rawMesh.read(asset.path.c_str()))
+                        return;
+
+                Exporter exporter(log, 1);
+                if(!exporter.processMesh(rawMesh, outputPath.c_str(), isQuantized_ ? &vertexFormat_ : nullptr,
+                                         shouldReduceOverdraw_))
+                        return;
+
+                if(getFileSize(outputPath, asset.outputSize))
+                        asset.status = STATUS_COOKED;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        std::string Cooker::getOutputPath(const Asset& asset) const
+        {
+                std::string name = asset.name;
+
+                if(name.length() >= 5 && name.compare(name.length() - 5, 5, ".sdif") == 0)
+                        name.erase(name.length() - 5);
+
+                return outputFolder_ + name + ".sdmf";
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::createFolders(const std::string& path)
+        {
+                for(size_t i = path.find('/', 1); i != std::string::npos; i = path.find('/', i + 1))
+                {
+                        std::string folder = path.substr(0, i);
+
+                        if(mkdir(folder.c_str(), 0755) != 0 && errno != EEXIST)
+                                return false;
+                }
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::getFileSize(const std::string& path, uint64_t& size)
+        {
+                struct stat fileStatus;
+                if(stat(path.c_str(), &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+                        return false;
+
+                size = static_cast<uint64_t>(fileStatus.st_size);
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Cooker::readFile(const std::string& path, std::vector<char>& contents)
+        {
+                std::ifstream stream(path.c_str(), std::ios_base::binary);
+                if(!stream.good())
+                        return false;
+
+                stream.seekg(0, std::ios_base::end);
+                std::streamoff size = stream.tellg();
+                stream.seekg(0, std::ios_base::beg);
+
+                if(size < 0)
+                        return false;
+
+                try
+                {
+                        contents.resize(static_cast<size_t>(size));
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                if(size > 0)
+                        stream.read(&contents[0], size);
+
+                return !stream.fail();
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        uint64_t Cooker::computeHash(const void* data, size_t size, uint64_t hash)
+        {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+
+                for(size_t i = 0; i < size; ++i)
+                {
+                        hash ^= bytes[i];
+                        hash *= 1099511628211ULL;
+                }
+
+                return hash;
+        }
+
+}
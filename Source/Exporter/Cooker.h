@@ -0,0 +1,241 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef COOKER_H
+#define COOKER_H
+
+#include "Exporter.h"
+
+#include <condition_variable>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <map>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Exporter
+         * @{
+         */
+
+        /**
+         * Represents cooker. Exports many raw meshes (SDIF) to the engine's mesh format (SDMF) in parallel.
+         * Each mesh is processed by its own Exporter in the worker of the thread pool, so output files are
+         * the same as the files, which are written by the serial runs of the exporter.
+         *
+         * Cooking is incremental: content hash of each input file (combined with the export options) is
+         * stored in the cache manifest (hidden file ".cache" in the output folder), and mesh is skipped if
+         * its hash has not changed and its output file still exists.
+         */
+        class Cooker
+        {
+        public:
+                /**
+                 * \brief Constructs cooker with given export options.
+                 * \param[in] vertexFormat vertex format of the exported meshes (if nullptr, then meshes are
+                 * written in version 1 of the mesh format, see Exporter::processMesh)
+                 * \param[in] shouldReduceOverdraw flag, which forces ordering of the faces to reduce overdraw
+                 */
+                Cooker(const MeshManager::VertexFormat* vertexFormat, bool shouldReduceOverdraw);
+                Cooker(const Cooker&) = delete;
+                ~Cooker();
+                Cooker& operator =(const Cooker&) = delete;
+
+                /**
+                 * \brief Adds assets.
+                 *
+                 * If path is a folder, then all raw meshes (files with ".sdif" extension) of the folder
+                 * and its subfolders are added. Otherwise path is a manifest: text file, each line of which
+                 * holds name of the raw mesh (relative to the folder of the manifest), empty lines and lines,
+                 * which start with '#', are skipped. Names of the output files are relative to the output
+                 * folder in the same way.
+                 * \param[in] path path to the folder or manifest
+                 * \return true if assets have been successfully added
+                 */
+                bool addAssets(const char* path);
+
+                /**
+                 * \brief Returns number of assets.
+                 * \return number of assets, which will be cooked
+                 */
+                size_t getNumAssets() const;
+
+                /**
+                 * \brief Cooks assets.
+                 *
+                 * Writes report line (status, time, input and output sizes) for each asset, and log of the
+                 * exporter for each asset, which could not be cooked.
+                 * \param[in] outputFolder output folder
+                 * \param[in] numWorkers number of workers (if zero, then number of hardware threads is used)
+                 * \return true if all assets have been successfully cooked (or skipped)
+                 */
+                bool cook(const char* outputFolder, size_t numWorkers);
+
+        private:
+                /// Helper constants
+                enum
+                {
+                        CACHE_VERSION = 1
+                };
+
+                /// Status of the asset
+                enum STATUS
+                {
+                        STATUS_FAILED = 0,
+                        STATUS_COOKED,
+                        STATUS_SKIPPED
+                };
+
+                /**
+                 * Represents asset.
+                 */
+                class Asset
+                {
+                public:
+                        std::string path;
+                        std::string name;
+
+                        uint64_t hash;
+                        uint64_t inputSize, outputSize;
+                        double time;
+                        STATUS status;
+
+                        Asset();
+                        Asset(const Asset&) = default;
+                        ~Asset();
+                        Asset& operator =(const Asset&) = default;
+
+                        /**
+                         * \brief Compares assets by names.
+                         * \param[in] asset another asset
+                         * \return true if name of this asset is less than name of another asset
+                         */
+                        bool operator <(const Asset& asset) const;
+
+                        /**
+                         * \brief Checks equality of the names of the assets.
+                         * \param[in] asset another asset
+                         * \return true if names of the assets are equal
+                         */
+                        bool operator ==(const Asset& asset) const;
+
+                };
+
+                /**
+                 * Represents entry of the cache manifest.
+                 */
+                class CacheEntry
+                {
+                public:
+                        uint64_t hash;
+                        uint64_t outputSize;
+
+                        CacheEntry();
+                        CacheEntry(const CacheEntry&) = default;
+                        ~CacheEntry();
+                        CacheEntry& operator =(const CacheEntry&) = default;
+
+                };
+
+                std::vector<Asset> assets_;
+                std::map<std::string, CacheEntry> cache_;
+
+                MeshManager::VertexFormat vertexFormat_;
+                bool isQuantized_, shouldReduceOverdraw_;
+                uint64_t optionsHash_;
+
+                std::string outputFolder_;
+
+                std::mutex mutex_;
+                std::condition_variable jobsFinished_;
+                size_t numPendingJobs_;
+
+                /**
+                 * \brief Adds raw meshes of the folder recursively.
+                 * \param[in] path path to the folder
+                 * \param[in] prefix prefix of the names of the assets
+                 * \return true if folder has been successfully read
+                 */
+                bool addFiles(const std::string& path, const std::string& prefix);
+
+                /**
+                 * \brief Adds raw meshes, which are listed in the manifest.
+                 * \param[in] fileName name of the manifest
+                 * \return true if manifest has been successfully read
+                 */
+                bool addManifest(const std::string& fileName);
+
+                /**
+                 * \brief Reads cache manifest from the output folder.
+                 */
+                void readCache();
+
+                /**
+                 * \brief Writes cache manifest to the output folder.
+                 * \return true on success
+                 */
+                bool writeCache() const;
+
+                /**
+                 * \brief Cooks asset (executed by the worker of the thread pool).
+                 * \param[in,out] asset asset
+                 */
+                void executeJob(Asset& asset);
+
+                /**
+                 * \brief Cooks asset.
+                 * \param[in,out] asset asset
+                 * \param[in] log stream, to which log of the exporter is written
+                 */
+                void cookAsset(Asset& asset, std::ostream& log);
+
+                /**
+                 * \brief Returns path to the output file of the asset.
+                 * \param[in] asset asset
+                 * \return path to the output file
+                 */
+                std::string getOutputPath(const Asset& asset) const;
+
+                /**
+                 * \brief Creates folders of the path (if they do not exist).
+                 * \param[in] path path to the file
+                 * \return true if folders exist or have been successfully created
+                 */
+                static bool createFolders(const std::string& path);
+
+                /**
+                 * \brief Returns size of the file.
+                 * \param[in] path path to the file
+                 * \param[out] size size of the file
+                 * \return true if file exists
+                 */
+                static bool getFileSize(const std::string& path, uint64_t& size);
+
+                /**
+                 * \brief Reads file.
+                 * \param[in] path path to the file
+                 * \param[out] contents contents of the file
+                 * \return true if file has been successfully read
+                 */
+                static bool readFile(const std::string& path, std::vector<char>& contents);
+
+                /**
+                 * \brief Computes 64-bit FNV-1a hash.
+                 * \param[in] data data
+                 * \param[in] size size of the data
+                 * \param[in] hash hash of the preceding data
+                 * \return hash of the data
+                 */
+                static uint64_t computeHash(const void* data, size_t size, uint64_t hash);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
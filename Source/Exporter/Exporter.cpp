@@ -3,68 +3,174 @@
 
 #include "Exporter.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <chrono>
+#include <cmath>
 
 namespace selene
 {
 
-        Exporter::Exporter():
-                rawMesh_(nullptr), meshData_(), faces_(), boneIndices_(),
-                boneWeights_(), numVertices_(0), vertices_(), newToOldVertexMapping_() {}
-        Exporter::~Exporter() {}
+        const uint32_t Exporter::HashTable::INVALID_INDEX;
+
+        Exporter::HashTable::HashTable():
+                slots_(), keySize_(0), capacity_(0), numKeys_(0) {}
+        Exporter::HashTable::~HashTable() {}
 
         //-------------------------------------------------------------------------------------------------------
-        bool Exporter::processMesh(RawMesh& rawMesh, const char* fileName)
+        bool Exporter::HashTable::create(uint32_t keySize, uint32_t numExpectedKeys)
         {
-                rawMesh_ = &rawMesh;
-                meshData_.reset(new(std::nothrow) Mesh::Data);
-                if(!meshData_)
+                keySize_ = keySize;
+                numKeys_ = 0;
+
+                // capacity of the table is a power of two, so slot is found with the mask
+                capacity_ = 16;
+                while(capacity_ < 2 * static_cast<uint64_t>(numExpectedKeys) && capacity_ < 0x80000000)
+                        capacity_ <<= 1;
+
+                try
+                {
+                        slots_.assign(static_cast<size_t>(capacity_) * (keySize_ + 1), INVALID_INDEX);
+                }
+                catch(...)
                 {
-                        std::cout << "error: not enough memory" << std::endl;
+                        capacity_ = 0;
                         return false;
                 }
 
-                numVertices_ = rawMesh_->positions_.getSize();
-                meshData_->boundingBox = rawMesh_->boundingBox_;
+                return true;
+        }
 
-                boneIndices_.destroy();
-                boneWeights_.destroy();
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::HashTable::insert(const uint32_t* key, uint32_t& index)
+        {
+                if(capacity_ == 0)
+                        return false;
 
-                vertices_.clear();
-                newToOldVertexMapping_.clear();
+                uint32_t* slot = findSlot(key);
+                if(slot[0] != INVALID_INDEX)
+                {
+                        index = slot[0];
+                        return true;
+                }
 
-                std::cout << "processing raw mesh..." << std::endl;
-                faces_ = rawMesh_->faces_;
-                if(faces_.getSize() != rawMesh_->faces_.getSize())
+                index = slot[0] = numKeys_++;
+                std::copy(key, key + keySize_, slot + 1);
+
+                // table is grown, when it becomes half full
+                if(2 * static_cast<uint64_t>(numKeys_) > capacity_)
+                        return grow();
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        uint32_t Exporter::HashTable::getNumKeys() const
+        {
+                return numKeys_;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::HashTable::grow()
+        {
+                if(capacity_ >= 0x80000000)
+                        return false;
+
+                std::vector<uint32_t> slots;
+
+                try
+                {
+                        slots.assign(2 * static_cast<size_t>(capacity_) * (keySize_ + 1), INVALID_INDEX);
+                }
+                catch(...)
                 {
-                        std::cout << "error: not enough memory" << std::endl;
                         return false;
                 }
 
-                std::cout << "merging faces..." << std::endl;
+                slots_.swap(slots);
+                capacity_ <<= 1;
 
-                numVertices_ = mergeFaces(faces_, rawMesh_->normalFaces_, faces_, numVertices_);
-                if(numVertices_ == 0)
+                for(size_t i = 0; i < slots.size(); i += keySize_ + 1)
                 {
-                        std::cout << "error: could not merge faces" << std::endl;
-                        return false;
+                        if(slots[i] == INVALID_INDEX)
+                                continue;
+
+                        uint32_t* slot = findSlot(&slots[i + 1]);
+                        std::copy(&slots[i], &slots[i] + keySize_ + 1, slot);
+                }
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        uint32_t* Exporter::HashTable::findSlot(const uint32_t* key)
+        {
+                uint32_t mask = capacity_ - 1;
+                uint32_t slotIndex = hashKey(key, keySize_) & mask;
+
+                // linear probing (table is at most half full, so empty slot is always found)
+                for(;; slotIndex = (slotIndex + 1) & mask)
+                {
+                        uint32_t* slot = &slots_[static_cast<size_t>(slotIndex) * (keySize_ + 1)];
+
+                        if(slot[0] == INVALID_INDEX || std::equal(key, key + keySize_, slot + 1))
+                                return slot;
                 }
+        }
 
-                numVertices_ = mergeFaces(faces_, rawMesh_->textureFaces_, faces_, numVertices_);
-                if(numVertices_ == 0)
+        //-------------------------------------------------------------------------------------------------------
+        uint32_t Exporter::HashTable::hashKey(const uint32_t* key, uint32_t keySize)
+        {
+                // FNV-1a over the words of the key, followed by the finalizer of MurmurHash3, so the low-order
+                // bits (which are used by the mask of the table) depend on all bits of the key
+                uint32_t hash = Name::HASH_OFFSET_BASIS;
+                for(uint32_t i = 0; i < keySize; ++i)
+                        hash = (hash ^ key[i]) * Name::HASH_PRIME;
+
+                hash ^= hash >> 16;
+                hash *= 0x85EBCA6BU;
+                hash ^= hash >> 13;
+                hash *= 0xC2B2AE35U;
+                hash ^= hash >> 16;
+
+                return hash;
+        }
+
+        Exporter::Exporter(std::ostream& log, size_t numWorkers):
+                log_(log), numWorkers_(numWorkers), rawMesh_(nullptr), meshData_(), faces_(), boneIndices_(),
+                boneWeights_(), numVertices_(0), vertices_(), newToOldVertexMapping_()
+        {
+                if(numWorkers_ == 0)
+                        numWorkers_ = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        Exporter::~Exporter() {}
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::processMesh(RawMesh& rawMesh, const char* fileName,
+                                   const MeshManager::VertexFormat* vertexFormat,
+                                   bool shouldReduceOverdraw)
+        {
+                if(!mergeRawFaces(rawMesh))
+                        return false;
+
+                meshData_.reset(new(std::nothrow) Mesh::Data);
+                if(!meshData_)
                 {
-                        std::cout << "error: could not merge faces" << std::endl;
+                        log_ << "error: not enough memory" << std::endl;
                         return false;
                 }
 
+                meshData_->boundingBox = rawMesh_->boundingBox_;
+
                 if(!rawMesh_->bones_.isEmpty())
                 {
-                        std::cout << "reading bone indices and weights..." << std::endl;
+                        log_ << "reading bone indices and weights..." << std::endl;
 
                         if(!boneIndices_.create(numVertices_) || !boneWeights_.create(numVertices_))
                         {
-                                std::cout << "error: not enough memory" << std::endl;
+                                log_ << "error: not enough memory" << std::endl;
                                 return false;
                         }
 
@@ -82,135 +188,424 @@ namespace selene
                         }
                 }
 
-                std::cout << "computing tangent space..." << std::endl;
+                log_ << "computing tangent space..." << std::endl;
                 if(!computeTangentSpace())
                 {
-                        std::cout << "error: broken mesh" << std::endl;
+                        log_ << "error: broken mesh" << std::endl;
+                        return false;
+                }
+
+                log_ << "optimizing faces..." << std::endl;
+                if(!optimizeFaces(shouldReduceOverdraw))
+                {
+                        log_ << "error: could not optimize faces" << std::endl;
                         return false;
                 }
 
-                std::cout << "preparing vertex streams..." << std::endl;
+                log_ << "preparing vertex streams..." << std::endl;
                 if(!prepareVertexStreams())
                 {
-                        std::cout << "error: not enough memory" << std::endl;
+                        log_ << "error: not enough memory" << std::endl;
                         return false;
                 }
 
-                std::cout << "preparing faces..." << std::endl;
+                log_ << "preparing faces..." << std::endl;
                 if(!prepareFaces())
                 {
-                        std::cout << "error: not enough memory" << std::endl;
+                        log_ << "error: not enough memory" << std::endl;
                         return false;
                 }
 
-                std::cout << "preparing subsets..." << std::endl;
+                log_ << "preparing subsets..." << std::endl;
                 if(!prepareSubsets())
                 {
-                        std::cout << "error: not enough memory" << std::endl;
+                        log_ << "error: not enough memory" << std::endl;
                         return false;
                 }
 
+                // bounds of the clusters are not valid for the animated meshes
+                if(rawMesh_->bones_.isEmpty())
+                {
+                        log_ << "preparing clusters..." << std::endl;
+                        if(!prepareClusters())
+                        {
+                                log_ << "error: not enough memory" << std::endl;
+                                return false;
+                        }
+                }
+
                 if(!rawMesh_->bones_.isEmpty())
                 {
-                        std::cout << "preparing skeleton...";
+                        log_ << "preparing skeleton...";
                         auto& skeleton = meshData_->skeleton;
 
                         skeleton.reset(new(std::nothrow) Skeleton);
                         if(!skeleton)
                         {
-                                std::cout << "error: not enough memory" << std::endl;
+                                log_ << "error: not enough memory" << std::endl;
                                 return false;
                         }
 
                         skeleton->getBones() = rawMesh_->bones_;
                         if(skeleton->getBones().getSize() != rawMesh_->bones_.getSize())
                         {
-                                std::cout << "error: not enough memory" << std::endl;
+                                log_ << "error: not enough memory" << std::endl;
                                 return false;
                         }
                 }
 
-                std::cout << "writing mesh to the file..." << std::endl;
+                log_ << "writing mesh to the file..." << std::endl;
 
                 std::ofstream stream(fileName, std::ios_base::binary);
                 MeshManager meshManager;
 
-                if(!meshManager.writeMesh(stream, *meshData_))
+                if(!meshManager.writeMesh(stream, *meshData_, vertexFormat))
                 {
-                        std::cout << "error: could not write mesh to the file" << std::endl;
+                        log_ << "error: could not write mesh to the file" << std::endl;
                         return false;
                 }
 
-                std::cout << "mesh has " << numVertices_;
-                std::cout << " vertices and " << faces_.getSize() << " faces" << std::endl;
+                log_ << "mesh has " << numVertices_;
+                log_ << " vertices and " << faces_.getSize() << " faces" << std::endl;
 
                 return true;
         }
 
         //-------------------------------------------------------------------------------------------------------
-        uint32_t Exporter::mergeFaces(const Array<RawMesh::Face, uint32_t>& faces0,
-                                      const Array<RawMesh::Face, uint32_t>& faces1,
-                                      Array<RawMesh::Face, uint32_t>& result,
-                                      uint32_t numVertices)
+        bool Exporter::compareTangentSpace(RawMesh& rawMesh)
         {
-                uint32_t numFaces = faces0.getSize();
-                if(numFaces == 0 || faces1.getSize() != numFaces)
-                        return 0;
+                if(!mergeRawFaces(rawMesh))
+                        return false;
+
+                std::vector<unsigned int> indices;
+                if(!prepareTangentSpace(indices))
+                {
+                        log_ << "error: not enough memory" << std::endl;
+                        return false;
+                }
+
+                std::vector<MeshMender::Vertex> menderVertices(vertices_), generatorVertices(vertices_);
+                std::vector<unsigned int> menderIndices(indices), generatorIndices(indices);
+                std::vector<unsigned int> menderMapping, generatorMapping;
+
+                log_ << "computing tangent space with NVMeshMender..." << std::endl;
+                auto startTime = std::chrono::steady_clock::now();
+
+                MeshMender meshMender;
+                if(!meshMender.Mend(menderVertices, menderIndices, menderMapping,
+                                    0.0f, 0.0f, 0.0f, 1.0f, MeshMender::DONT_CALCULATE_NORMALS))
+                {
+                        log_ << "error: broken mesh" << std::endl;
+                        return false;
+                }
 
-                Array<MultiVertex, uint32_t> vertices;
-                if(!vertices.create(numVertices))
-                        return 0;
+                auto menderTime = std::chrono::steady_clock::now() - startTime;
 
-                Array<RawMesh::Face, uint32_t> newFaces;
-                if(!newFaces.create(numFaces))
-                        return 0;
+                log_ << "computing tangent space with TangentSpaceGenerator..." << std::endl;
+                startTime = std::chrono::steady_clock::now();
 
-                uint32_t newVertexIndex = 0;
+                std::unique_ptr<ThreadPool> threadPool;
 
                 try
                 {
-                        for(uint32_t faceNo = 0; faceNo < numFaces; ++faceNo)
+                        if(numWorkers_ > 1)
+                                threadPool.reset(new ThreadPool(numWorkers_));
+                }
+                catch(...)
+                {
+                        log_ << "error: could not create thread pool" << std::endl;
+                        return false;
+                }
+
+                TangentSpaceGenerator tangentSpaceGenerator(threadPool.get());
+                if(!tangentSpaceGenerator.generate(generatorVertices, generatorIndices, generatorMapping))
+                {
+                        log_ << "error: broken mesh" << std::endl;
+                        return false;
+                }
+
+                auto generatorTime = std::chrono::steady_clock::now() - startTime;
+
+                // tangent space is not defined at the singular points (like poles of the sphere), where
+                // tangents of the faces around the position cancel out, so any result is valid there
+                const auto& pivots = tangentSpaceGenerator.getPivots();
+                const auto& faceTangents = tangentSpaceGenerator.getFaceTangents();
+                const auto& faceBinormals = tangentSpaceGenerator.getFaceBinormals();
+
+                uint32_t numPivots = 0;
+                for(auto it = pivots.begin(); it != pivots.end(); ++it)
+                        numPivots = std::max(numPivots, *it + 1);
+
+                std::vector<Vector3d> pivotTangents;
+                std::vector<uint32_t> pivotValences;
+                std::vector<bool> isSingularPivot;
+
+                try
+                {
+                        pivotTangents.resize(numPivots);
+                        pivotValences.resize(numPivots);
+                        isSingularPivot.resize(numPivots);
+                }
+                catch(...)
+                {
+                        log_ << "error: not enough memory" << std::endl;
+                        return false;
+                }
+
+                for(size_t i = 0; i < indices.size(); ++i)
+                {
+                        uint32_t pivot = pivots[indices[i]];
+                        Vector3d tangent = faceTangents[i / 3];
+
+                        if(tangent.length() > 0.0f)
+                                tangent.normalize();
+
+                        pivotTangents[pivot] += tangent;
+                        ++pivotValences[pivot];
+                }
+
+                for(uint32_t i = 0; i < numPivots; ++i)
+                        isSingularPivot[i] = (pivotTangents[i].length() < 0.25f * pivotValences[i]);
+
+                // compare vectors at the corners of the faces, since vertices may be split differently,
+                // small deviations are expected near the singular points, since NVMeshMender adds the last
+                // face of the closed fan to the group twice, and its fuzzy ordering of the positions may
+                // split fans
+                const float maxAngle = 5.0f;
+                float maxTangentAngle = 0.0f, maxBinormalAngle = 0.0f;
+                double sumTangentAngles = 0.0, sumBinormalAngles = 0.0;
+                uint32_t numComparedCorners = 0, numDifferentCorners = 0;
+                uint32_t numSingularCorners = 0, numInvalidCorners = 0;
+
+                for(size_t i = 0; i < indices.size(); ++i)
+                {
+                        const auto& menderVertex = menderVertices[menderIndices[i]];
+                        const auto& generatorVertex = generatorVertices[generatorIndices[i]];
+
+                        if(menderMapping[menderIndices[i]] != generatorMapping[generatorIndices[i]])
                         {
-                                for(uint8_t i = 0; i < 3; ++i)
-                                {
-                                        MultiVertex& multiVertex = vertices[faces0[faceNo].indices[i]];
-                                        uint32_t vertexIndex = faces1[faceNo].indices[i];
+                                log_ << "error: vertices of the corner " << i << " do not match" << std::endl;
+                                return false;
+                        }
 
-                                        auto duplicate = multiVertex.find(vertexIndex);
+                        if(isSingularPivot[pivots[indices[i]]])
+                        {
+                                ++numSingularCorners;
+                                continue;
+                        }
 
-                                        if(duplicate == multiVertex.end())
-                                        {
-                                                multiVertex.insert(std::make_pair(vertexIndex, newVertexIndex));
-                                                newFaces[faceNo].indices[i] = newVertexIndex++;
-                                        }
-                                        else
-                                                newFaces[faceNo].indices[i] = duplicate->second;
-                                }
+                        // NVMeshMender produces NaNs for the vertices with null tangents or binormals
+                        if(std::isnan(menderVertex.tangent.length()) || std::isnan(menderVertex.binormal.length()))
+                        {
+                                ++numInvalidCorners;
+                                continue;
+                        }
+
+                        // when vertex is split only by binormals (or only by tangents), NVMeshMender may give
+                        // the vector of the other group to the corner, so the vector points against the vector
+                        // of its own face
+                        const Vector3d& faceTangent = faceTangents[i / 3];
+                        const Vector3d& faceBinormal = faceBinormals[i / 3];
+
+                        if((menderVertex.tangent.dot(faceTangent) < 0.0f &&
+                            generatorVertex.tangent.dot(faceTangent) >= 0.0f) ||
+                           (menderVertex.binormal.dot(faceBinormal) < 0.0f &&
+                            generatorVertex.binormal.dot(faceBinormal) >= 0.0f))
+                        {
+                                ++numInvalidCorners;
+                                continue;
                         }
+
+                        float tangentAngle = std::acos(std::max(-1.0f, std::min(1.0f,
+                                                       menderVertex.tangent.dot(generatorVertex.tangent))));
+                        float binormalAngle = std::acos(std::max(-1.0f, std::min(1.0f,
+                                                        menderVertex.binormal.dot(generatorVertex.binormal))));
+
+                        tangentAngle  *= 180.0f / SELENE_PI;
+                        binormalAngle *= 180.0f / SELENE_PI;
+
+                        maxTangentAngle  = std::max(maxTangentAngle,  tangentAngle);
+                        maxBinormalAngle = std::max(maxBinormalAngle, binormalAngle);
+                        sumTangentAngles  += tangentAngle;
+                        sumBinormalAngles += binormalAngle;
+                        ++numComparedCorners;
+
+                        if(tangentAngle > maxAngle || binormalAngle > maxAngle)
+                                ++numDifferentCorners;
+                }
+
+                typedef std::chrono::duration<double, std::milli> Milliseconds;
+                double numCorners = std::max(numComparedCorners, 1u);
+
+                log_ << "        NVMeshMender: " << menderVertices.size() << " vertices, " <<
+                        Milliseconds(menderTime).count() << " ms" << std::endl;
+                log_ << "        TangentSpaceGenerator: " << generatorVertices.size() << " vertices, " <<
+                        Milliseconds(generatorTime).count() << " ms (" << numWorkers_ <<
+                        " workers)" << std::endl;
+                log_ << "        compared " << numComparedCorners << " of " << indices.size() << " corners (" <<
+                        numSingularCorners << " corners are at the singular points, " << numInvalidCorners <<
+                        " corners are not valid in the output of NVMeshMender)" << std::endl;
+                log_ << "        deviation of tangents: max " << maxTangentAngle << ", mean " <<
+                        sumTangentAngles / numCorners << " degrees" << std::endl;
+                log_ << "        deviation of binormals: max " << maxBinormalAngle << ", mean " <<
+                        sumBinormalAngles / numCorners << " degrees" << std::endl;
+                log_ << "        " << numDifferentCorners << " corners deviate by more than " << maxAngle <<
+                        " degrees" << std::endl;
+
+                return (numDifferentCorners == 0);
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::mergeRawFaces(RawMesh& rawMesh)
+        {
+                rawMesh_ = &rawMesh;
+                meshData_.reset();
+
+                numVertices_ = 0;
+
+                boneIndices_.destroy();
+                boneWeights_.destroy();
+
+                vertices_.clear();
+                newToOldVertexMapping_.clear();
+
+                log_ << "processing raw mesh..." << std::endl;
+                log_ << "welding vertices..." << std::endl;
+
+                if(!weldFaces())
+                {
+                        log_ << "error: could not weld vertices" << std::endl;
+                        return false;
+                }
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::weldFaces()
+        {
+                uint32_t numFaces = rawMesh_->faces_.getSize();
+                if(numFaces == 0 || rawMesh_->normalFaces_.getSize() != numFaces ||
+                   rawMesh_->textureFaces_.getSize() != numFaces)
+                        return false;
+
+                const auto& positions = rawMesh_->positions_;
+                const auto& normals = rawMesh_->normals_;
+                const auto& textureCoordinates = rawMesh_->textureCoordinates_;
+
+                uint32_t numPositions = positions.getSize();
+                uint32_t numNormals = normals.getSize();
+                uint32_t numTextureCoordinates = textureCoordinates.getSize();
+
+                const uint32_t vector2dSize = sizeof(Vector2d) / sizeof(uint32_t);
+                const uint32_t vector3dSize = sizeof(Vector3d) / sizeof(uint32_t);
+                const uint32_t vector4dSize = sizeof(Vector4d) / sizeof(uint32_t);
+
+                // positions of the skinned mesh can only be welded, if their bone indices and weights are equal
+                bool hasBones = !rawMesh_->bones_.isEmpty();
+                uint32_t positionKey[vector3dSize + 2 * vector4dSize];
+                uint32_t positionKeySize = hasBones ? vector3dSize + 2 * vector4dSize : vector3dSize;
+
+                std::vector<uint32_t> positionIndices, normalIndices, textureCoordinatesIndices;
+
+                try
+                {
+                        positionIndices.resize(numPositions);
+                        normalIndices.resize(numNormals);
+                        textureCoordinatesIndices.resize(numTextureCoordinates);
                 }
                 catch(...)
                 {
-                        return 0;
+                        return false;
+                }
+
+                HashTable hashTable;
+                if(!hashTable.create(positionKeySize, numPositions))
+                        return false;
+
+                for(uint32_t i = 0; i < numPositions; ++i)
+                {
+                        std::memcpy(positionKey, &positions[i], sizeof(Vector3d));
+
+                        if(hasBones)
+                        {
+                                std::memcpy(positionKey + vector3dSize, &rawMesh_->boneIndices_[i], sizeof(Vector4d));
+                                std::memcpy(positionKey + vector3dSize + vector4dSize, &rawMesh_->boneWeights_[i],
+                                            sizeof(Vector4d));
+                        }
+
+                        if(!hashTable.insert(positionKey, positionIndices[i]))
+                                return false;
                 }
 
-                result = newFaces;
-                if(result.getSize() != newFaces.getSize())
-                        return 0;
+                // normals and texture coordinates are often stored per corner, but after welding their number
+                // is usually close to the number of positions
+                if(!hashTable.create(vector3dSize, std::min(numNormals, numPositions)))
+                        return false;
+
+                for(uint32_t i = 0; i < numNormals; ++i)
+                {
+                        if(!hashTable.insert(reinterpret_cast<const uint32_t*>(&normals[i]), normalIndices[i]))
+                                return false;
+                }
 
-                return newVertexIndex;
+                if(!hashTable.create(vector2dSize, std::min(numTextureCoordinates, numPositions)))
+                        return false;
+
+                for(uint32_t i = 0; i < numTextureCoordinates; ++i)
+                {
+                        if(!hashTable.insert(reinterpret_cast<const uint32_t*>(&textureCoordinates[i]),
+                                             textureCoordinatesIndices[i]))
+                                return false;
+                }
+
+                // each corner is a tuple of the welded position, normal and texture coordinates
+                if(!faces_.create(numFaces) || !hashTable.create(3, numPositions))
+                        return false;
+
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        const RawMesh::Face& face = rawMesh_->faces_[i];
+                        const RawMesh::Face& normalFace = rawMesh_->normalFaces_[i];
+                        const RawMesh::Face& textureFace = rawMesh_->textureFaces_[i];
+
+                        for(uint8_t j = 0; j < 3; ++j)
+                        {
+                                if(face.indices[j] >= numPositions || normalFace.indices[j] >= numNormals ||
+                                   textureFace.indices[j] >= numTextureCoordinates)
+                                        return false;
+
+                                uint32_t vertexKey[3] =
+                                {
+                                        positionIndices[face.indices[j]],
+                                        normalIndices[normalFace.indices[j]],
+                                        textureCoordinatesIndices[textureFace.indices[j]]
+                                };
+
+                                if(!hashTable.insert(vertexKey, faces_[i].indices[j]))
+                                        return false;
+                        }
+                }
+
+                numVertices_ = hashTable.getNumKeys();
+
+                return true;
         }
 
         //-------------------------------------------------------------------------------------------------------
-        bool Exporter::computeTangentSpace()
+        bool Exporter::prepareTangentSpace(std::vector<unsigned int>& indices)
         {
                 uint32_t numFaces = faces_.getSize();
 
-                std::vector<unsigned int> newFaces;
-                newFaces.reserve(3 * numFaces);
-
-                vertices_.reserve(numVertices_);
-                for(uint32_t i = 0; i < numVertices_; ++i)
-                        vertices_.push_back(MeshMender::Vertex());
+                try
+                {
+                        indices.resize(3 * numFaces);
+                        vertices_.assign(numVertices_, MeshMender::Vertex());
+                }
+                catch(...)
+                {
+                        return false;
+                }
 
                 for(uint32_t i = 0; i < numFaces; ++i)
                 {
@@ -222,7 +617,7 @@ namespace selene
                         {
                                 uint32_t vertexIndex = faces_[i].indices[j];
 
-                                newFaces.push_back(vertexIndex);
+                                indices[3 * i + j] = vertexIndex;
                                 MeshMender::Vertex& vertex = vertices_[vertexIndex];
 
                                 const auto& position = rawMesh_->positions_[face.indices[j]];
@@ -237,11 +632,35 @@ namespace selene
                         }
                 }
 
-                MeshMender meshMender;
-                if(!meshMender.Mend(vertices_, newFaces, newToOldVertexMapping_,
-                                    0.0f, 0.0f, 0.0f, 1.0f, MeshMender::DONT_CALCULATE_NORMALS))
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::computeTangentSpace()
+        {
+                uint32_t numFaces = faces_.getSize();
+
+                std::vector<unsigned int> newFaces;
+                if(!prepareTangentSpace(newFaces))
                         return false;
 
+                try
+                {
+                        // mesh is processed in the calling thread, if there is only one worker
+                        std::unique_ptr<ThreadPool> threadPool;
+                        if(numWorkers_ > 1)
+                                threadPool.reset(new ThreadPool(numWorkers_));
+
+                        TangentSpaceGenerator tangentSpaceGenerator(threadPool.get());
+
+                        if(!tangentSpaceGenerator.generate(vertices_, newFaces, newToOldVertexMapping_))
+                                return false;
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
                 numVertices_ = vertices_.size();
                 for(uint32_t i = 0; i < numFaces; ++i)
                 {
@@ -252,6 +671,76 @@ namespace selene
                 return true;
         }
 
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::optimizeFaces(bool shouldReduceOverdraw)
+        {
+                uint32_t numFaces = faces_.getSize();
+                if(numFaces == 0)
+                        return true;
+
+                MeshOptimizer meshOptimizer;
+                MeshOptimizer::Statistics statistics = meshOptimizer.computeStatistics(&faces_[0], numFaces,
+                                                                                       numVertices_);
+
+                log_ << "        ACMR: " << statistics.acmr << ", ATVR: " << statistics.atvr;
+
+                // faces of each subset are rendered separately, so they are reordered separately
+                uint16_t numSubsets = rawMesh_->materials_.getSize();
+                for(uint16_t i = 0; i < numSubsets; ++i)
+                {
+                        uint32_t firstFaceIndex = rawMesh_->materials_[i].second;
+                        uint32_t lastFaceIndex = (i + 1 < numSubsets) ? rawMesh_->materials_[i + 1].second :
+                                                 numFaces;
+
+                        if(firstFaceIndex >= lastFaceIndex || lastFaceIndex > numFaces)
+                                return false;
+
+                        if(!meshOptimizer.reorderFaces(&faces_[firstFaceIndex], lastFaceIndex - firstFaceIndex,
+                                                       vertices_, shouldReduceOverdraw))
+                                return false;
+                }
+
+                // renumber vertices by their first use
+                std::vector<uint32_t> newIndices;
+                if(!meshOptimizer.computeVertexOrder(&faces_[0], numFaces, numVertices_, newIndices))
+                        return false;
+
+                std::vector<MeshMender::Vertex> vertices;
+                std::vector<unsigned int> newToOldVertexMapping;
+
+                try
+                {
+                        vertices.resize(numVertices_);
+                        newToOldVertexMapping.resize(newToOldVertexMapping_.size());
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                for(uint32_t i = 0; i < numVertices_; ++i)
+                {
+                        vertices[newIndices[i]] = vertices_[i];
+
+                        if(i < newToOldVertexMapping_.size())
+                                newToOldVertexMapping[newIndices[i]] = newToOldVertexMapping_[i];
+                }
+
+                vertices_.swap(vertices);
+                newToOldVertexMapping_.swap(newToOldVertexMapping);
+
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        for(uint8_t j = 0; j < 3; ++j)
+                                faces_[i].indices[j] = newIndices[faces_[i].indices[j]];
+                }
+
+                statistics = meshOptimizer.computeStatistics(&faces_[0], numFaces, numVertices_);
+                log_ << " -> ACMR: " << statistics.acmr << ", ATVR: " << statistics.atvr << std::endl;
+
+                return true;
+        }
+
         //-------------------------------------------------------------------------------------------------------
         bool Exporter::prepareVertexStreams()
         {
@@ -310,8 +799,8 @@ namespace selene
                                         tangent.define(t, -1.0f);
                                 else
                                 {
-                                        std::cout << "warning: vertex " << vertexIndex <<
-                                                     " has bad TBN basis" << std::endl;
+                                        log_ << "warning: vertex " << vertexIndex <<
+                                                " has bad TBN basis" << std::endl;
                                         tangent = Vector4d(t, -1.0f);
                                 }
 
@@ -329,9 +818,9 @@ namespace selene
                                         boneWeights = boneWeights_[oldVertexIndex];
 
                                         if(std::fabs(boneWeights.x + boneWeights.y +
-                                                     boneWeights.z + boneWeights.w - 1.0f) > SELENE_EPSILON)
-                                                std::cout << "warning: vertex " << vertexIndex <<
-                                                             " has bad bone weights" << std::endl;
+                                                     boneWeights.z + boneWeights.w - 1.0f) > 0.0f)
+                                                log_ << "warning: vertex " << vertexIndex <<
+                                                        " has bad bone weights" << std::endl;
                                 }
                         }
                 }
@@ -433,4 +922,168 @@ namespace selene
                 return true;
         }
 
+        //-------------------------------------------------------------------------------------------------------
+        bool Exporter::prepareClusters()
+        {
+                auto& subsets = meshData_->subsets;
+                uint32_t numFaces = faces_.getSize();
+
+                if(numFaces == 0 || vertices_.empty())
+                        return true;
+
+                std::vector<Vector3d> faceNormals;
+                std::vector<Mesh::Cluster> clusters;
+
+                try
+                {
+                        faceNormals.resize(numFaces);
+                        clusters.reserve(numFaces / MIN_CLUSTER_SIZE + subsets.getSize());
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                // compute normals of the faces, front side of the faces is determined by the majority of the faces,
+                // whose geometric normals agree with normals of their vertices
+                int64_t orientation = 0;
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        const auto& indices = faces_[i].indices;
+                        const Vector3d& p0 = vertices_[indices[0]].pos;
+
+                        faceNormals[i] = (vertices_[indices[1]].pos - p0).cross(vertices_[indices[2]].pos - p0);
+
+                        Vector3d normal = vertices_[indices[0]].normal + vertices_[indices[1]].normal +
+                                          vertices_[indices[2]].normal;
+                        orientation += (faceNormals[i].dot(normal) < 0.0f) ? -1 : 1;
+                }
+
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        float length = faceNormals[i].length();
+                        if(length > 0.0f)
+                                faceNormals[i] /= (orientation < 0) ? -length : length;
+                        else
+                                faceNormals[i].define(0.0f);
+                }
+
+                // spheres are padded to cover error of the quantized positions
+                Vector3d minBound = vertices_[0].pos, maxBound = vertices_[0].pos;
+                for(size_t i = 1; i < vertices_.size(); ++i)
+                {
+                        const Vector3d& position = vertices_[i].pos;
+                        minBound.define(std::min(minBound.x, position.x), std::min(minBound.y, position.y),
+                                        std::min(minBound.z, position.z));
+                        maxBound.define(std::max(maxBound.x, position.x), std::max(maxBound.y, position.y),
+                                        std::max(maxBound.z, position.z));
+                }
+                float padding = 1e-3f * (maxBound - minBound).length();
+
+                // cone of the normals is not wider than 60 degrees around the average normal
+                const float maxDeviation = 0.5f;
+
+                for(uint16_t i = 0; i < subsets.getSize(); ++i)
+                {
+                        Mesh::Subset& subset = subsets[i];
+                        subset.clusterIndex = static_cast<uint32_t>(clusters.size());
+                        subset.numClusters = 0;
+
+                        uint32_t lastFaceIndex = subset.faceIndex + subset.numFaces;
+                        for(uint32_t first = subset.faceIndex; first < lastFaceIndex;)
+                        {
+                                // gather faces
+                                Vector3d normalSum = faceNormals[first];
+                                uint32_t last = first + 1;
+
+                                for(; last < lastFaceIndex && (last - first) < MAX_CLUSTER_SIZE; ++last)
+                                {
+                                        if((last - first) >= MIN_CLUSTER_SIZE)
+                                        {
+                                                Vector3d axis = normalSum;
+                                                float length = axis.length();
+                                                if(length > 0.0f &&
+                                                   faceNormals[last].dot(axis) < maxDeviation * length)
+                                                        break;
+                                        }
+
+                                        normalSum += faceNormals[last];
+                                }
+
+                                Mesh::Cluster cluster;
+                                cluster.faceIndex = first;
+                                cluster.numFaces = last - first;
+
+                                // compute bounding sphere
+                                Vector3d minCorner = vertices_[faces_[first].indices[0]].pos;
+                                Vector3d maxCorner = minCorner;
+
+                                for(uint32_t j = first; j < last; ++j)
+                                {
+                                        for(uint8_t k = 0; k < 3; ++k)
+                                        {
+                                                const Vector3d& p = vertices_[faces_[j].indices[k]].pos;
+                                                minCorner.define(std::min(minCorner.x, p.x), std::min(minCorner.y, p.y),
+                                                                 std::min(minCorner.z, p.z));
+                                                maxCorner.define(std::max(maxCorner.x, p.x), std::max(maxCorner.y, p.y),
+                                                                 std::max(maxCorner.z, p.z));
+                                        }
+                                }
+
+                                cluster.center = 0.5f * (minCorner + maxCorner);
+                                cluster.radius = 0.0f;
+
+                                for(uint32_t j = first; j < last; ++j)
+                                {
+                                        for(uint8_t k = 0; k < 3; ++k)
+                                        {
+                                                const Vector3d& position = vertices_[faces_[j].indices[k]].pos;
+                                                cluster.radius = std::max(cluster.radius,
+                                                                          (position - cluster.center).length());
+                                        }
+                                }
+                                cluster.radius += padding;
+
+                                // compute cone of the normals
+                                cluster.coneAxis = normalSum;
+                                if(cluster.coneAxis.length() > 0.0f)
+                                {
+                                        cluster.coneAxis.normalize();
+
+                                        float minDot = 1.0f;
+                                        for(uint32_t j = first; j < last; ++j)
+                                                minDot = std::min(minDot, faceNormals[j].dot(cluster.coneAxis));
+
+                                        // wide cones are almost never back-facing
+                                        if(minDot > 0.1f)
+                                                cluster.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+                                }
+
+                                try
+                                {
+                                        clusters.push_back(cluster);
+                                }
+                                catch(...)
+                                {
+                                        return false;
+                                }
+
+                                ++subset.numClusters;
+                                first = last;
+                        }
+                }
+
+                if(!meshData_->clusters.create(static_cast<uint32_t>(clusters.size())))
+                        return false;
+
+                for(uint32_t i = 0; i < meshData_->clusters.getSize(); ++i)
+                        meshData_->clusters[i] = clusters[i];
+
+                log_ << "        " << clusters.size() << " clusters, " <<
+                        static_cast<float>(numFaces) / static_cast<float>(clusters.size()) <<
+                        " faces per cluster" << std::endl;
+
+                return true;
+        }
+
 }
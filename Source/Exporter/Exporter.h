@@ -4,11 +4,14 @@
 #ifndef EXPORTER_H
 #define EXPORTER_H
 
+#include "TangentSpaceGenerator.h"
+#include "MeshOptimizer.h"
 #include "NVMeshMender.h"
 #include "RawMesh.h"
 
+#include <iostream>
 #include <memory>
-#include <map>
+#include <vector>
 
 namespace selene
 {
@@ -20,12 +23,21 @@ namespace selene
 
         /**
          * Represents exporter. Processes RawMesh and saves the result in engine's mesh format.
-         * Uses NVMeshMender to compute TBN basis for vertices.
+         * Uses TangentSpaceGenerator to compute TBN basis for vertices (NVMeshMender is only used to
+         * validate its results) and MeshOptimizer to reorder faces and vertices for the vertex cache.
+         * Faces of static meshes are split into clusters (see Mesh::Cluster), which are culled by the
+         * renderer.
          */
         class Exporter
         {
         public:
-                Exporter();
+                /**
+                 * \brief Constructs exporter.
+                 * \param[in] log stream, to which progress and errors are written
+                 * \param[in] numWorkers number of workers, which compute tangent space (if zero, then
+                 * number of hardware threads is used; if one, then mesh is processed in the calling thread)
+                 */
+                Exporter(std::ostream& log = std::cout, size_t numWorkers = 0);
                 Exporter(const Exporter&) = delete;
                 ~Exporter();
                 Exporter& operator =(const Exporter&) = delete;
@@ -34,15 +46,107 @@ namespace selene
                  * \brief Processes mesh and writes result to the file.
                  * \param[in] rawMesh raw mesh, which shall be processed
                  * \param[in] fileName name of the file, which will hold exported mesh
+                 * \param[in] vertexFormat vertex format of the exported mesh (if nullptr, then mesh is
+                 * written in version 1 of the mesh format, see MeshManager::writeMesh)
+                 * \param[in] shouldReduceOverdraw flag, which forces ordering of the faces of each subset
+                 * from the outside of the mesh to the inside (see MeshOptimizer)
                  * \return true on success
                  */
-                bool processMesh(RawMesh& rawMesh, const char* fileName);
+                bool processMesh(RawMesh& rawMesh, const char* fileName,
+                                 const MeshManager::VertexFormat* vertexFormat,
+                                 bool shouldReduceOverdraw = false);
+
+                /**
+                 * \brief Compares tangent space, which is computed by TangentSpaceGenerator, with tangent
+                 * space, which is computed by NVMeshMender, and prints results of the comparison.
+                 *
+                 * Tangents and binormals are compared at the corners of the faces, since generators may
+                 * split and order vertices differently.
+                 * \param[in] rawMesh raw mesh
+                 * \return true if tangent spaces are equivalent (tangents and binormals at each corner,
+                 * which is not at the singular point, deviate by no more than five degrees)
+                 */
+                bool compareTangentSpace(RawMesh& rawMesh);
 
         private:
+                /// Helper constants
+                enum
+                {
+                        MIN_CLUSTER_SIZE = 32,
+                        MAX_CLUSTER_SIZE = 128
+                };
+
                 /**
-                 * Represents vertex with duplicates.
+                 * Represents open addressing hash table, which welds bit-identical keys. Each key is a
+                 * sequence of 32-bit words, keys are stored in the slots of the table (together with
+                 * their indices), so each lookup usually touches one cache line.
                  */
-                typedef std::map<uint32_t, uint32_t> MultiVertex;
+                class HashTable
+                {
+                public:
+                        HashTable();
+                        HashTable(const HashTable&) = delete;
+                        ~HashTable();
+                        HashTable& operator =(const HashTable&) = delete;
+
+                        /**
+                         * \brief Creates hash table.
+                         * \param[in] keySize size of the key (in 32-bit words)
+                         * \param[in] numExpectedKeys expected number of unique keys (capacity of the table
+                         * is reserved for this number, and doubled when table becomes half full)
+                         * \return true if hash table has been successfully created
+                         */
+                        bool create(uint32_t keySize, uint32_t numExpectedKeys);
+
+                        /**
+                         * \brief Inserts key.
+                         * \param[in] key key
+                         * \param[out] index index of the unique key (unique keys are numbered in order of
+                         * their insertion)
+                         * \return true if key has been successfully inserted (or it is already in the table)
+                         */
+                        bool insert(const uint32_t* key, uint32_t& index);
+
+                        /**
+                         * \brief Returns number of unique keys.
+                         * \return number of unique keys
+                         */
+                        uint32_t getNumKeys() const;
+
+                private:
+                        /// Index, which marks empty slot
+                        static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+                        // each slot holds index of the key, followed by the key
+                        std::vector<uint32_t> slots_;
+                        uint32_t keySize_, capacity_, numKeys_;
+
+                        /**
+                         * \brief Doubles capacity of the table.
+                         * \return true on success
+                         */
+                        bool grow();
+
+                        /**
+                         * \brief Finds slot of the key.
+                         * \param[in] key key
+                         * \return pointer to the slot, which holds given key, or to the empty slot, where
+                         * key should be inserted
+                         */
+                        uint32_t* findSlot(const uint32_t* key);
+
+                        /**
+                         * \brief Computes hash of the key.
+                         * \param[in] key key
+                         * \param[in] keySize size of the key (in 32-bit words)
+                         * \return hash of the key
+                         */
+                        static uint32_t hashKey(const uint32_t* key, uint32_t keySize);
+
+                };
+
+                std::ostream& log_;
+                size_t numWorkers_;
 
                 RawMesh* rawMesh_;
                 std::unique_ptr<Mesh::Data> meshData_;
@@ -57,17 +161,29 @@ namespace selene
                 std::vector<unsigned int> newToOldVertexMapping_;
 
                 /**
-                 * \brief Merges two sets of faces into one.
-                 * \param[in] faces0 the first set of faces
-                 * \param[in] faces1 the second set of faces
-                 * \param[out] result new set of faces, which is the result of merge operation
-                 * \param[in] numVertices number of vertices
-                 * \return new number of vertices on success, zero on failure
+                 * \brief Welds vertices of the faces.
+                 *
+                 * Each corner of the raw face references position, normal and texture coordinates by
+                 * separate indices. Bit-identical attribute values (positions together with their bone
+                 * indices and weights) are welded first, then corners with the same welded attributes
+                 * share one vertex (see HashTable). Vertices are numbered in order of their first use.
+                 * \return true on success
+                 */
+                bool weldFaces();
+
+                /**
+                 * \brief Resets state of the exporter and welds vertices of the raw mesh.
+                 * \param[in] rawMesh raw mesh
+                 * \return true on success
                  */
-                uint32_t mergeFaces(const Array<RawMesh::Face, uint32_t>& faces0,
-                                    const Array<RawMesh::Face, uint32_t>& faces1,
-                                    Array<RawMesh::Face, uint32_t>& result,
-                                    uint32_t numVertices);
+                bool mergeRawFaces(RawMesh& rawMesh);
+
+                /**
+                 * \brief Prepares vertices and indices for the computation of the tangent space.
+                 * \param[out] indices indices of the faces
+                 * \return true on success
+                 */
+                bool prepareTangentSpace(std::vector<unsigned int>& indices);
 
                 /**
                  * \brief Computes tangent space.
@@ -75,6 +191,15 @@ namespace selene
                  */
                 bool computeTangentSpace();
 
+                /**
+                 * \brief Optimizes faces and vertices for the vertex cache.
+                 *
+                 * Reorders faces of each subset, then renumbers vertices by their first use.
+                 * \param[in] shouldReduceOverdraw flag, which forces ordering of the faces to reduce overdraw
+                 * \return true on success
+                 */
+                bool optimizeFaces(bool shouldReduceOverdraw);
+
                 /**
                  * \brief Prepares vertex streams.
                  * \return true on success
@@ -93,6 +218,17 @@ namespace selene
                  */
                 bool prepareSubsets();
 
+                /**
+                 * \brief Prepares clusters of faces.
+                 *
+                 * Splits faces of each subset (which are already ordered by MeshOptimizer, so neighbouring
+                 * faces are close to each other) into clusters of at most MAX_CLUSTER_SIZE faces. Cluster
+                 * with at least MIN_CLUSTER_SIZE faces is also closed, when normal of the next face deviates
+                 * too much from the average normal of the cluster, so cones of the normals stay narrow.
+                 * \return true on success
+                 */
+                bool prepareClusters();
+
         };
 
         /**
@@ -1,8 +1,9 @@
 // Copyright (c) 2012 Nezametdinov E. Ildus
 // Licensed under the MIT License (see LICENSE.txt for details)
 
-#include "Exporter.h"
+#include "Cooker.h"
 #include <iostream>
+#include <cstdlib>
 #include <string>
 
 using namespace selene;
@@ -13,7 +14,10 @@ void showHelp()
         std::cout << "NAME" << std::endl;
         std::cout << "        Exporter - SELENE Device mesh exporter" << std::endl << std::endl;
         std::cout << "SYNOPSIS" << std::endl;
-        std::cout << "        Exporter -i input_file -o output_file" << std::endl;
+        std::cout << "        Exporter -i input_file -o output_file [-f | -x] [-d]" << std::endl;
+        std::cout << "        Exporter -i input_file -c" << std::endl;
+        std::cout << "        Exporter -k input_folder_or_manifest -o output_folder [-j num_workers] [-f | -x] [-d]";
+        std::cout << std::endl;
         std::cout << "        Exporter -h" << std::endl << std::endl;
         std::cout << "DESCRIPTION" << std::endl;
         std::cout << "        Exporter converts intermediate mesh format (SDIF) to the ";
@@ -24,12 +28,34 @@ void showHelp()
         std::cout << "        -o, --output" << std::endl;
         std::cout << "                Specifies output file name. ";
         std::cout << "Input and output file names may be the same." << std::endl;
+        std::cout << "        -f, --float" << std::endl;
+        std::cout << "                Writes vertices as 32-bit floats (version 1 of SDMF). By default vertices ";
+        std::cout << "are quantized and interleaved (version 2 of SDMF)." << std::endl;
+        std::cout << "        -x, --half" << std::endl;
+        std::cout << "                Encodes positions and texture coordinates of the quantized vertices as ";
+        std::cout << "half floats instead of normalized integers." << std::endl;
+        std::cout << "        -d, --overdraw" << std::endl;
+        std::cout << "                Orders faces of each subset from the outside of the mesh to the inside ";
+        std::cout << "to reduce overdraw (at small cost of vertex cache efficiency)." << std::endl;
+        std::cout << "        -c, --compare" << std::endl;
+        std::cout << "                Computes tangent space with both TangentSpaceGenerator and NVMeshMender, ";
+        std::cout << "compares results and writes nothing." << std::endl;
+        std::cout << "        -k, --cook" << std::endl;
+        std::cout << "                Cooks all SDIF files of the folder tree, or files listed in the manifest ";
+        std::cout << "(one file name per line, relative to the manifest). Output files are written to the ";
+        std::cout << "output folder (-o) with the same relative names. Meshes are exported in parallel, ";
+        std::cout << "unchanged meshes are skipped (content hashes are stored in the output folder)." << std::endl;
+        std::cout << "        -j, --jobs" << std::endl;
+        std::cout << "                Specifies number of workers, which cook meshes (by default, number of ";
+        std::cout << "hardware threads)." << std::endl;
         std::cout << "        -h, --help" << std::endl;
         std::cout << "                Shows help." << std::endl << std::endl;
         std::cout << "EXIT STATUS" << std::endl;
         std::cout << "        0      Successful program execution." << std::endl;
         std::cout << "        1      Input file is broken or does not exist." << std::endl;
-        std::cout << "        2      Could not create output file." << std::endl << std::endl;
+        std::cout << "        2      Could not create output file." << std::endl;
+        std::cout << "        3      Tangent spaces differ (when comparing)." << std::endl;
+        std::cout << "        4      Some meshes could not be cooked." << std::endl << std::endl;
         std::cout << "HISTORY" << std::endl;
         std::cout << "        2010 - Originally written by Nezametdinov E. Ildus." << std::endl;
         std::cout << "        (neil.log@gmail.com)." << std::endl;
@@ -39,9 +65,14 @@ void showHelp()
 
 int main(int argc, char* args[])
 {
-        std::string inputFileName(""), outputFileName("");
+        std::string inputFileName(""), outputFileName(""), cookInput(""), numWorkers("");
         std::string* currentFileName = nullptr;
 
+        MeshManager::VertexFormat vertexFormat;
+        bool isQuantized = true;
+        bool shouldReduceOverdraw = false;
+        bool shouldCompareTangentSpace = false;
+
         std::cout << "SELENE Device exporter" << std::endl;
 
         for(int i = 0; i < argc; ++i)
@@ -62,6 +93,31 @@ int main(int argc, char* args[])
                 {
                         currentFileName = &outputFileName;
                 }
+                else if(argument == "-k" || argument == "--cook")
+                {
+                        currentFileName = &cookInput;
+                }
+                else if(argument == "-j" || argument == "--jobs")
+                {
+                        currentFileName = &numWorkers;
+                }
+                else if(argument == "-f" || argument == "--float")
+                {
+                        isQuantized = false;
+                }
+                else if(argument == "-x" || argument == "--half")
+                {
+                        vertexFormat.positions = MeshManager::ENCODING_FLOAT16;
+                        vertexFormat.textureCoordinates = MeshManager::ENCODING_FLOAT16;
+                }
+                else if(argument == "-d" || argument == "--overdraw")
+                {
+                        shouldReduceOverdraw = true;
+                }
+                else if(argument == "-c" || argument == "--compare")
+                {
+                        shouldCompareTangentSpace = true;
+                }
                 else if(argument == "-h" || argument == "--help")
                 {
                         showHelp();
@@ -69,6 +125,25 @@ int main(int argc, char* args[])
                 }
         }
 
+        if(cookInput != "")
+        {
+                if(outputFileName == "")
+                {
+                        std::cout << "error: no output folder specified" << std::endl;
+                        showHelp();
+                        return 0;
+                }
+
+                Cooker cooker(isQuantized ? &vertexFormat : nullptr, shouldReduceOverdraw);
+                if(!cooker.addAssets(cookInput.c_str()))
+                        return 1;
+
+                std::cout << "status: cooking " << cooker.getNumAssets() << " meshes" << std::endl;
+
+                size_t numCookWorkers = static_cast<size_t>(std::strtoul(numWorkers.c_str(), nullptr, 10));
+                return cooker.cook(outputFileName.c_str(), numCookWorkers) ? 0 : 4;
+        }
+
         if(inputFileName == "")
         {
                 std::cout << "error: no input file name specified" << std::endl;
@@ -76,6 +151,16 @@ int main(int argc, char* args[])
                 return 0;
         }
 
+        if(shouldCompareTangentSpace)
+        {
+                RawMesh rawMesh;
+                if(!rawMesh.read(inputFileName.c_str()))
+                        return 1;
+
+                Exporter exporter;
+                return exporter.compareTangentSpace(rawMesh) ? 0 : 3;
+        }
+
         if(outputFileName == "")
         {
                 std::cout << "error: no output file name specified" << std::endl;
@@ -88,7 +173,8 @@ int main(int argc, char* args[])
         if(rawMesh.read(inputFileName.c_str()))
         {
                 Exporter exporter;
-                if(!exporter.processMesh(rawMesh, outputFileName.c_str()))
+                if(!exporter.processMesh(rawMesh, outputFileName.c_str(), isQuantized ? &vertexFormat : nullptr,
+                                         shouldReduceOverdraw))
                         return 2;
         }
         else
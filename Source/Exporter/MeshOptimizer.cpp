@@ -0,0 +1,377 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+
+namespace selene
+{
+
+        const uint32_t MeshOptimizer::INVALID_INDEX;
+
+        MeshOptimizer::Statistics::Statistics(): acmr(0.0f), atvr(0.0f) {}
+        MeshOptimizer::Statistics::~Statistics() {}
+
+        MeshOptimizer::MeshOptimizer(uint32_t cacheSize):
+                cacheSize_(cacheSize), localIndices_(), globalIndices_(), liveTriangles_(),
+                adjacencyOffsets_(), adjacency_(), timeStamps_(), deadEnds_(), candidates_(),
+                order_(), isEmitted_(), clusters_(), reorderedFaces_()
+        {
+                if(cacheSize_ < 3)
+                        cacheSize_ = 3;
+        }
+        MeshOptimizer::~MeshOptimizer() {}
+
+        //-------------------------------------------------------------------------------------------------------
+        bool MeshOptimizer::reorderFaces(RawMesh::Face* faces, uint32_t numFaces,
+                                         const std::vector<MeshMender::Vertex>& vertices,
+                                         bool shouldReduceOverdraw)
+        {
+                if(faces == nullptr || numFaces == 0)
+                        return true;
+
+                try
+                {
+                        buildAdjacency(faces, numFaces, static_cast<uint32_t>(vertices.size()));
+                        emitFaces(faces, numFaces);
+
+                        if(shouldReduceOverdraw && clusters_.size() > 1)
+                        {
+                                computeSortKeys(faces, vertices);
+                                std::sort(clusters_.begin(), clusters_.end(), Comparator());
+                        }
+
+                        reorderedFaces_.clear();
+                        reorderedFaces_.reserve(numFaces);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                for(auto it = clusters_.begin(); it != clusters_.end(); ++it)
+                {
+                        for(uint32_t i = it->firstFace; i < it->firstFace + it->numFaces; ++i)
+                                reorderedFaces_.push_back(faces[order_[i]]);
+                }
+
+                std::copy(reorderedFaces_.begin(), reorderedFaces_.end(), faces);
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool MeshOptimizer::computeVertexOrder(const RawMesh::Face* faces, uint32_t numFaces, uint32_t numVertices,
+                                               std::vector<uint32_t>& newIndices)
+        {
+                try
+                {
+                        newIndices.assign(numVertices, INVALID_INDEX);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                uint32_t numOrderedVertices = 0;
+
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        for(uint8_t j = 0; j < 3; ++j)
+                        {
+                                uint32_t vertexIndex = faces[i].indices[j];
+                                if(vertexIndex >= numVertices)
+                                        return false;
+
+                                if(newIndices[vertexIndex] == INVALID_INDEX)
+                                        newIndices[vertexIndex] = numOrderedVertices++;
+                        }
+                }
+
+                // vertices, which are not used by faces
+                for(uint32_t i = 0; i < numVertices; ++i)
+                {
+                        if(newIndices[i] == INVALID_INDEX)
+                                newIndices[i] = numOrderedVertices++;
+                }
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        MeshOptimizer::Statistics MeshOptimizer::computeStatistics(const RawMesh::Face* faces, uint32_t numFaces,
+                                                                   uint32_t numVertices) const
+        {
+                Statistics statistics;
+                if(numFaces == 0 || numVertices == 0)
+                        return statistics;
+
+                // vertex is in the FIFO cache, if it has been transformed less than cacheSize_ misses ago
+                std::vector<uint32_t> timeStamps;
+
+                try
+                {
+                        timeStamps.assign(numVertices, 0);
+                }
+                catch(...)
+                {
+                        return statistics;
+                }
+
+                uint32_t time = cacheSize_ + 1;
+                uint32_t numTransformedVertices = 0;
+
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        for(uint8_t j = 0; j < 3; ++j)
+                        {
+                                uint32_t vertexIndex = faces[i].indices[j];
+                                if(vertexIndex >= numVertices)
+                                        continue;
+
+                                if(time - timeStamps[vertexIndex] > cacheSize_)
+                                {
+                                        timeStamps[vertexIndex] = time++;
+                                        ++numTransformedVertices;
+                                }
+                        }
+                }
+
+                statistics.acmr = static_cast<float>(numTransformedVertices) / static_cast<float>(numFaces);
+                statistics.atvr = static_cast<float>(numTransformedVertices) / static_cast<float>(numVertices);
+
+                return statistics;
+        }
+
+        MeshOptimizer::Cluster::Cluster():
+                normal(0.0f, 0.0f, 0.0f), firstFace(0), numFaces(0), sortKey(0.0f) {}
+        MeshOptimizer::Cluster::~Cluster() {}
+
+        MeshOptimizer::Comparator::Comparator() {}
+        MeshOptimizer::Comparator::~Comparator() {}
+
+        //-------------------------------------------------------------------------------------------------------
+        bool MeshOptimizer::Comparator::operator ()(const Cluster& first, const Cluster& second) const
+        {
+                if(first.sortKey != second.sortKey)
+                        return (first.sortKey > second.sortKey);
+
+                return (first.firstFace < second.firstFace);
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void MeshOptimizer::buildAdjacency(const RawMesh::Face* faces, uint32_t numFaces, uint32_t numVertices)
+        {
+                // only vertices of the given faces are processed, so local indices are assigned to them
+                // (local indices of the previous subset are reset, so each subset is processed in linear time)
+                if(localIndices_.size() != numVertices)
+                        localIndices_.assign(numVertices, INVALID_INDEX);
+                else
+                {
+                        for(auto it = globalIndices_.begin(); it != globalIndices_.end(); ++it)
+                                localIndices_[*it] = INVALID_INDEX;
+                }
+
+                globalIndices_.clear();
+
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        for(uint8_t j = 0; j < 3; ++j)
+                        {
+                                uint32_t& localIndex = localIndices_[faces[i].indices[j]];
+                                if(localIndex != INVALID_INDEX)
+                                        continue;
+
+                                localIndex = static_cast<uint32_t>(globalIndices_.size());
+                                globalIndices_.push_back(faces[i].indices[j]);
+                        }
+                }
+
+                uint32_t numLocalVertices = static_cast<uint32_t>(globalIndices_.size());
+
+                // count faces of each vertex
+                liveTriangles_.assign(numLocalVertices, 0);
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        for(uint8_t j = 0; j < 3; ++j)
+                                ++liveTriangles_[localIndices_[faces[i].indices[j]]];
+                }
+
+                // faces of the vertex i are stored in adjacency_ from adjacencyOffsets_[i] to
+                // adjacencyOffsets_[i + 1]
+                adjacencyOffsets_.assign(numLocalVertices + 1, 0);
+                for(uint32_t i = 0; i < numLocalVertices; ++i)
+                        adjacencyOffsets_[i + 1] = adjacencyOffsets_[i] + liveTriangles_[i];
+
+                adjacency_.resize(3 * numFaces);
+                for(uint32_t i = 0; i < numFaces; ++i)
+                {
+                        for(uint8_t j = 0; j < 3; ++j)
+                                adjacency_[adjacencyOffsets_[localIndices_[faces[i].indices[j]]]++] = i;
+                }
+
+                // offsets have been moved to the ends of the ranges, so restore them
+                for(uint32_t i = numLocalVertices; i > 0; --i)
+                        adjacencyOffsets_[i] = adjacencyOffsets_[i - 1];
+                adjacencyOffsets_[0] = 0;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void MeshOptimizer::emitFaces(const RawMesh::Face* faces, uint32_t numFaces)
+        {
+                timeStamps_.assign(globalIndices_.size(), 0);
+                isEmitted_.assign(numFaces, false);
+                deadEnds_.clear();
+                order_.clear();
+                order_.reserve(numFaces);
+                clusters_.clear();
+
+                uint32_t time = cacheSize_ + 1;
+                uint32_t cursor = 0;
+                uint32_t vertex = 0;
+
+                while(vertex != INVALID_INDEX)
+                {
+                        // vertex is not in the cache, so locality is broken, and new cluster starts here
+                        if(time - timeStamps_[vertex] > cacheSize_)
+                        {
+                                Cluster cluster;
+                                cluster.firstFace = static_cast<uint32_t>(order_.size());
+                                clusters_.push_back(cluster);
+                        }
+
+                        // emit all faces of the fanning vertex
+                        candidates_.clear();
+                        for(uint32_t i = adjacencyOffsets_[vertex]; i < adjacencyOffsets_[vertex + 1]; ++i)
+                        {
+                                uint32_t faceIndex = adjacency_[i];
+                                if(isEmitted_[faceIndex])
+                                        continue;
+
+                                isEmitted_[faceIndex] = true;
+                                order_.push_back(faceIndex);
+
+                                for(uint8_t j = 0; j < 3; ++j)
+                                {
+                                        uint32_t localIndex = localIndices_[faces[faceIndex].indices[j]];
+
+                                        deadEnds_.push_back(localIndex);
+                                        candidates_.push_back(localIndex);
+                                        --liveTriangles_[localIndex];
+
+                                        if(time - timeStamps_[localIndex] > cacheSize_)
+                                                timeStamps_[localIndex] = time++;
+                                }
+                        }
+
+                        vertex = getNextVertex(cursor, time);
+                }
+
+                // compute sizes of the clusters
+                for(size_t i = 0; i < clusters_.size(); ++i)
+                {
+                        uint32_t lastFace = (i + 1 < clusters_.size()) ? clusters_[i + 1].firstFace :
+                                            static_cast<uint32_t>(order_.size());
+                        clusters_[i].numFaces = lastFace - clusters_[i].firstFace;
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        uint32_t MeshOptimizer::getNextVertex(uint32_t& cursor, uint32_t time)
+        {
+                // choose the oldest candidate, which will still be in the cache after its faces are emitted
+                uint32_t nextVertex = INVALID_INDEX;
+                int64_t highestPriority = -1;
+
+                for(auto it = candidates_.begin(); it != candidates_.end(); ++it)
+                {
+                        uint32_t vertex = *it;
+                        if(liveTriangles_[vertex] == 0)
+                                continue;
+
+                        int64_t priority = 0;
+                        if(time - timeStamps_[vertex] + 2 * liveTriangles_[vertex] <= cacheSize_)
+                                priority = time - timeStamps_[vertex];
+
+                        if(priority > highestPriority)
+                        {
+                                highestPriority = priority;
+                                nextVertex = vertex;
+                        }
+                }
+
+                if(nextVertex != INVALID_INDEX)
+                        return nextVertex;
+
+                // dead end: try recently used vertices
+                while(!deadEnds_.empty())
+                {
+                        uint32_t vertex = deadEnds_.back();
+                        deadEnds_.pop_back();
+
+                        if(liveTriangles_[vertex] > 0)
+                                return vertex;
+                }
+
+                // then scan vertices in input order
+                for(; cursor < static_cast<uint32_t>(globalIndices_.size()); ++cursor)
+                {
+                        if(liveTriangles_[cursor] > 0)
+                                return cursor;
+                }
+
+                return INVALID_INDEX;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void MeshOptimizer::computeSortKeys(const RawMesh::Face* faces,
+                                            const std::vector<MeshMender::Vertex>& vertices)
+        {
+                // center of the subset is the area-weighted average of the centers of its faces
+                Vector3d center(0.0f, 0.0f, 0.0f);
+                float area = 0.0f;
+
+                for(auto it = clusters_.begin(); it != clusters_.end(); ++it)
+                {
+                        Vector3d clusterCenter(0.0f, 0.0f, 0.0f);
+                        float clusterArea = 0.0f;
+
+                        it->normal = Vector3d(0.0f, 0.0f, 0.0f);
+                        for(uint32_t i = it->firstFace; i < it->firstFace + it->numFaces; ++i)
+                        {
+                                const RawMesh::Face& face = faces[order_[i]];
+
+                                const Vector3d& a = vertices[face.indices[0]].pos;
+                                const Vector3d& b = vertices[face.indices[1]].pos;
+                                const Vector3d& c = vertices[face.indices[2]].pos;
+
+                                // length of the cross product is the doubled area of the face
+                                Vector3d normal = (b - a).cross(c - a);
+                                float faceArea = normal.length();
+
+                                it->normal += normal;
+                                clusterCenter += (a + b + c) * (faceArea / 3.0f);
+                                clusterArea += faceArea;
+                        }
+
+                        center += clusterCenter;
+                        area += clusterArea;
+
+                        if(clusterArea > SELENE_EPSILON)
+                                clusterCenter /= clusterArea;
+
+                        if(it->normal.length() > SELENE_EPSILON)
+                                it->normal.normalize();
+
+                        it->sortKey = clusterCenter.dot(it->normal);
+                }
+
+                if(area > SELENE_EPSILON)
+                        center /= area;
+
+                // clusters, which face away from the center, are drawn first
+                for(auto it = clusters_.begin(); it != clusters_.end(); ++it)
+                        it->sortKey -= center.dot(it->normal);
+        }
+
+}
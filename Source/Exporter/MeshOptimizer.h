@@ -0,0 +1,200 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include "NVMeshMender.h"
+#include "RawMesh.h"
+
+#include <vector>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Exporter
+         * @{
+         */
+
+        /**
+         * Represents mesh optimizer. Reorders faces for the post-transform vertex cache of the GPU and
+         * vertices for the locality of the vertex fetch.
+         *
+         * Faces are reordered with Tipsify (Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex
+         * Locality and Reduced Overdraw"), which runs in linear time: triangles are emitted in fans around
+         * vertices, which are still in the cache, and the next fanning vertex is chosen among vertices of
+         * the emitted triangles. When there is no such vertex, the sequence is broken, and triangles are
+         * split into clusters at these points. Clusters may then be sorted from the outside of the mesh to
+         * the inside (by the dot product of the cluster's normal and the direction from the center of the
+         * mesh to the cluster), so front faces tend to be drawn first and overdraw is reduced.
+         *
+         * Efficiency of the vertex cache is measured by ACMR (average cache miss ratio, number of
+         * transformed vertices per triangle) and ATVR (average transform to vertex ratio, number of
+         * transformed vertices per vertex, 1.0 is optimal), which are computed with FIFO cache.
+         */
+        class MeshOptimizer
+        {
+        public:
+                /// Helper constants
+                enum
+                {
+                        DEFAULT_CACHE_SIZE = 16
+                };
+
+                /**
+                 * Represents statistics of the vertex cache.
+                 */
+                class Statistics
+                {
+                public:
+                        float acmr, atvr;
+
+                        Statistics();
+                        Statistics(const Statistics&) = default;
+                        ~Statistics();
+                        Statistics& operator =(const Statistics&) = default;
+
+                };
+
+                /**
+                 * \brief Constructs mesh optimizer with given size of the vertex cache.
+                 * \param[in] cacheSize number of vertices in the post-transform vertex cache
+                 */
+                MeshOptimizer(uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+                MeshOptimizer(const MeshOptimizer&) = delete;
+                ~MeshOptimizer();
+                MeshOptimizer& operator =(const MeshOptimizer&) = delete;
+
+                /**
+                 * \brief Reorders faces.
+                 *
+                 * Faces of each subset should be reordered separately, since they are rendered separately.
+                 * \param[in,out] faces faces
+                 * \param[in] numFaces number of faces
+                 * \param[in] vertices vertices (positions are used to reduce overdraw)
+                 * \param[in] shouldReduceOverdraw flag, which forces sorting of the clusters of faces to
+                 * reduce overdraw
+                 * \return true if faces have been successfully reordered
+                 */
+                bool reorderFaces(RawMesh::Face* faces, uint32_t numFaces,
+                                  const std::vector<MeshMender::Vertex>& vertices,
+                                  bool shouldReduceOverdraw);
+
+                /**
+                 * \brief Computes order of the vertices.
+                 *
+                 * Vertices are ordered by their first use in the faces, vertices, which are not used, are
+                 * placed at the end.
+                 * \param[in] faces faces
+                 * \param[in] numFaces number of faces
+                 * \param[in] numVertices number of vertices
+                 * \param[out] newIndices new indices of the vertices
+                 * \return true if order of the vertices has been successfully computed
+                 */
+                bool computeVertexOrder(const RawMesh::Face* faces, uint32_t numFaces, uint32_t numVertices,
+                                        std::vector<uint32_t>& newIndices);
+
+                /**
+                 * \brief Computes statistics of the vertex cache.
+                 * \param[in] faces faces
+                 * \param[in] numFaces number of faces
+                 * \param[in] numVertices number of vertices
+                 * \return statistics of the vertex cache
+                 */
+                Statistics computeStatistics(const RawMesh::Face* faces, uint32_t numFaces,
+                                             uint32_t numVertices) const;
+
+        private:
+                /**
+                 * Represents cluster of faces.
+                 */
+                class Cluster
+                {
+                public:
+                        Vector3d normal;
+                        uint32_t firstFace, numFaces;
+                        float sortKey;
+
+                        Cluster();
+                        Cluster(const Cluster&) = default;
+                        ~Cluster();
+                        Cluster& operator =(const Cluster&) = default;
+
+                };
+
+                /**
+                 * Represents comparator, which sorts clusters from the outside of the mesh to the inside.
+                 */
+                class Comparator
+                {
+                public:
+                        Comparator();
+                        Comparator(const Comparator&) = default;
+                        ~Comparator();
+                        Comparator& operator =(const Comparator&) = default;
+
+                        /**
+                         * \brief Compares sort keys of the clusters.
+                         * \param[in] first the first cluster
+                         * \param[in] second the second cluster
+                         * \return true if the first cluster should be drawn before the second
+                         */
+                        bool operator ()(const Cluster& first, const Cluster& second) const;
+
+                };
+
+                /// Index, which marks absence of the vertex
+                static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+                uint32_t cacheSize_;
+
+                // state of the Tipsify, which is kept between subsets to avoid reallocations
+                std::vector<uint32_t> localIndices_, globalIndices_;
+                std::vector<uint32_t> liveTriangles_, adjacencyOffsets_, adjacency_;
+                std::vector<uint32_t> timeStamps_, deadEnds_, candidates_;
+                std::vector<uint32_t> order_;
+                std::vector<bool> isEmitted_;
+                std::vector<Cluster> clusters_;
+                std::vector<RawMesh::Face> reorderedFaces_;
+
+                /**
+                 * \brief Builds local indices and adjacency of the vertices.
+                 * \param[in] faces faces
+                 * \param[in] numFaces number of faces
+                 * \param[in] numVertices number of vertices
+                 */
+                void buildAdjacency(const RawMesh::Face* faces, uint32_t numFaces, uint32_t numVertices);
+
+                /**
+                 * \brief Emits faces in Tipsify order and splits them into clusters.
+                 * \param[in] faces faces
+                 * \param[in] numFaces number of faces
+                 */
+                void emitFaces(const RawMesh::Face* faces, uint32_t numFaces);
+
+                /**
+                 * \brief Returns next fanning vertex.
+                 * \param[in,out] cursor index of the next local vertex, which is checked when there are no
+                 * candidates
+                 * \param[in] time current time stamp of the cache
+                 * \return local index of the vertex, or INVALID_INDEX if all faces have been emitted
+                 */
+                uint32_t getNextVertex(uint32_t& cursor, uint32_t time);
+
+                /**
+                 * \brief Computes sort keys of the clusters.
+                 * \param[in] faces faces
+                 * \param[in] vertices vertices
+                 */
+                void computeSortKeys(const RawMesh::Face* faces, const std::vector<MeshMender::Vertex>& vertices);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
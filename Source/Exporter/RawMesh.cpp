@@ -7,8 +7,8 @@
 namespace selene
 {
 
-        RawMesh::RawMesh():
-                positions_(), normals_(), textureCoordinates_(), boneWeights_(), boneIndices_(), faces_(),
+        RawMesh::RawMesh(std::ostream& log):
+                log_(log), positions_(), normals_(), textureCoordinates_(), boneWeights_(), boneIndices_(), faces_(),
                 normalFaces_(), textureFaces_(), materials_(), bones_(), boundingBox_(), resourceManager_() {}
         RawMesh::~RawMesh() {}
 
@@ -21,7 +21,7 @@ namespace selene
                 std::ifstream stream(fileName, std::ios::binary);
                 if(!stream)
                 {
-                        std::cout << "error: could not open file" << std::endl;
+                        log_ << "error: could not open file" << std::endl;
                         return false;
                 }
 
@@ -42,7 +42,7 @@ namespace selene
 
                 if(stream.fail())
                 {
-                        std::cout << "error: broken file" << std::endl;
+                        log_ << "error: broken file" << std::endl;
                         return false;
                 }
 
@@ -65,7 +65,7 @@ namespace selene
         {
                 if(!stream.good())
                 {
-                        std::cout << "error: broken file" << std::endl;
+                        log_ << "error: broken file" << std::endl;
                         return false;
                 }
 
@@ -77,7 +77,7 @@ namespace selene
 
                 if(std::memcmp(header, "SDIF", sizeof(header)) != 0)
                 {
-                        std::cout << "error: broken file" << std::endl;
+                        log_ << "error: broken file" << std::endl;
                         return false;
                 }
 
@@ -110,7 +110,7 @@ namespace selene
 
                 if(!isAllocationSuccessful)
                 {
-                        std::cout << "error: not enough memory" << std::endl;
+                        log_ << "error: not enough memory" << std::endl;
                         return false;
                 }
 
@@ -122,7 +122,7 @@ namespace selene
         {
                 if(!stream.good())
                 {
-                        std::cout << "error: broken file" << std::endl;
+                        log_ << "error: broken file" << std::endl;
                         return false;
                 }
 
@@ -175,7 +175,7 @@ namespace selene
         {
                 if(!stream.good())
                 {
-                        std::cout << "error: broken file" << std::endl;
+                        log_ << "error: broken file" << std::endl;
                         return false;
                 }
 
@@ -195,14 +195,14 @@ namespace selene
                         uint32_t* face = faces_[i].indices;
                         if(face[2] >= numPositions || face[0] >= numPositions || face[1] >= numPositions)
                         {
-                                std::cout << "error: face " << i << " contains bad reference" << std::endl;
+                                log_ << "error: face " << i << " contains bad reference" << std::endl;
                                 return false;
                         }
 
                         face = normalFaces_[i].indices;
                         if(face[2] >= numNormals || face[0] >= numNormals || face[1] >= numNormals)
                         {
-                                std::cout << "error: normal face " << i << " contains bad reference" << std::endl;
+                                log_ << "error: normal face " << i << " contains bad reference" << std::endl;
                                 return false;
                         }
 
@@ -211,7 +211,7 @@ namespace selene
                            face[0] >= numTextureCoordinates ||
                            face[1] >= numTextureCoordinates)
                         {
-                                std::cout << "error: texture face " << i << " contains bad reference" << std::endl;
+                                log_ << "error: texture face " << i << " contains bad reference" << std::endl;
                                 return false;
                         }
                 }
@@ -224,7 +224,7 @@ namespace selene
         {
                 if(!stream.good())
                 {
-                        std::cout << "error: broken file" << std::endl;
+                        log_ << "error: broken file" << std::endl;
                         return false;
                 }
 
@@ -234,7 +234,7 @@ namespace selene
                         material.reset(new(std::nothrow) Material);
                         if(!material)
                         {
-                                std::cout << "error: not enough memory" << std::endl;
+                                log_ << "error: not enough memory" << std::endl;
                                 return false;
                         }
 
@@ -242,13 +242,13 @@ namespace selene
 
                         if(materials_[i].second >= faces_.getSize())
                         {
-                                std::cout << "error: broken material data" << std::endl;
+                                log_ << "error: broken material data" << std::endl;
                                 return false;
                         }
 
                         if(!readMaterial(stream, *material.get()))
                         {
-                                std::cout << "error: could not read material " << i << std::endl;
+                                log_ << "error: could not read material " << i << std::endl;
                                 return false;
                         }
                 }
@@ -307,7 +307,7 @@ namespace selene
 
                 if(!stream.good())
                 {
-                        std::cout << "error: broken file" << std::endl;
+                        log_ << "error: broken file" << std::endl;
                         return false;
                 }
 
@@ -316,7 +316,7 @@ namespace selene
                 {
                         if(!Utility::readString(stream, boneName))
                         {
-                                std::cout << "error: could not read name of the bone " << i << std::endl;
+                                log_ << "error: could not read name of the bone " << i << std::endl;
                                 return false;
                         }
 
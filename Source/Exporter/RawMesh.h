@@ -6,6 +6,7 @@
 
 #include "../Engine/Framework.h"
 
+#include <iostream>
 #include <utility>
 #include <memory>
 
@@ -34,7 +35,11 @@ namespace selene
 
                 };
 
-                RawMesh();
+                /**
+                 * \brief Constructs raw mesh.
+                 * \param[in] log stream, to which errors are written
+                 */
+                RawMesh(std::ostream& log = std::cout);
                 RawMesh(const RawMesh&) = delete;
                 ~RawMesh();
                 RawMesh& operator =(const RawMesh&) = delete;
@@ -97,6 +102,8 @@ namespace selene
 
                 };
 
+                std::ostream& log_;
+
                 Array<Vector3d, uint32_t> positions_, normals_;
                 Array<Vector2d, uint32_t> textureCoordinates_;
                 Array<Vector4d, uint32_t> boneWeights_;
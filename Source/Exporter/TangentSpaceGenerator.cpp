@@ -0,0 +1,615 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "TangentSpaceGenerator.h"
+
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+namespace selene
+{
+
+        const uint32_t TangentSpaceGenerator::INVALID_INDEX;
+
+        TangentSpaceGenerator::Corner::Corner(): vertex(0), tangentGroup(0), binormalGroup(0), slot(0) {}
+        TangentSpaceGenerator::Corner::~Corner() {}
+
+        TangentSpaceGenerator::Comparator::Comparator() {}
+        TangentSpaceGenerator::Comparator::~Comparator() {}
+
+        //-------------------------------------------------------------------------------------------------------
+        bool TangentSpaceGenerator::Comparator::operator ()(const Corner& first, const Corner& second) const
+        {
+                if(first.vertex != second.vertex)
+                        return (first.vertex < second.vertex);
+
+                if(first.tangentGroup != second.tangentGroup)
+                        return (first.tangentGroup < second.tangentGroup);
+
+                if(first.binormalGroup != second.binormalGroup)
+                        return (first.binormalGroup < second.binormalGroup);
+
+                return (first.slot < second.slot);
+        }
+
+        TangentSpaceGenerator::Scratch::Scratch():
+                edges(), tangentParents(), binormalParents(), tangentSums(), binormalSums(), corners() {}
+        TangentSpaceGenerator::Scratch::~Scratch() {}
+
+        TangentSpaceGenerator::TangentSpaceGenerator(ThreadPool* threadPool):
+                threadPool_(threadPool), mutex_(), jobsFinished_(), numPendingJobs_(0), isFailed_(false),
+                vertices_(nullptr), indices_(nullptr), newToOldVertexMapping_(nullptr),
+                minTangentsCreaseCosAngle_(0.0f), minBinormalsCreaseCosAngle_(0.0f), numVertices_(0),
+                numFaces_(0), faceTangents_(), faceBinormals_(), pivots_(), fanOffsets_(), fans_(),
+                slotTangents_(), slotBinormals_(), slotVertices_(), newVertexOffsets_() {}
+        TangentSpaceGenerator::~TangentSpaceGenerator() {}
+
+        //-------------------------------------------------------------------------------------------------------
+        bool TangentSpaceGenerator::generate(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                                             std::vector<unsigned int>& newToOldVertexMapping,
+                                             float minTangentsCreaseCosAngle,
+                                             float minBinormalsCreaseCosAngle)
+        {
+                if((indices.size() % 3) != 0 || vertices.size() >= 0x7FFFFFFF)
+                        return false;
+
+                vertices_ = &vertices;
+                indices_ = &indices;
+                newToOldVertexMapping_ = &newToOldVertexMapping;
+                minTangentsCreaseCosAngle_  = minTangentsCreaseCosAngle;
+                minBinormalsCreaseCosAngle_ = minBinormalsCreaseCosAngle;
+
+                numVertices_ = static_cast<uint32_t>(vertices.size());
+                numFaces_ = static_cast<uint32_t>(indices.size() / 3);
+
+                for(uint32_t i = 0; i < 3 * numFaces_; ++i)
+                {
+                        if(indices[i] >= numVertices_)
+                                return false;
+                }
+
+                try
+                {
+                        faceTangents_.resize(numFaces_);
+                        faceBinormals_.resize(numFaces_);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                if(!executeStage(STAGE_FACES, numFaces_))
+                        return false;
+
+                uint32_t numPivots = 0;
+                if(!weldPositions(numPivots) || !buildFans(numPivots))
+                        return false;
+
+                try
+                {
+                        slotTangents_.resize(fans_.size());
+                        slotBinormals_.resize(fans_.size());
+                        slotVertices_.resize(fans_.size());
+                        newVertexOffsets_.assign(numPivots + 1, 0);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                if(!executeStage(STAGE_FANS, numPivots))
+                        return false;
+
+                // new vertices are placed after the old ones, in the order of the pivots
+                uint32_t numNewVertices = 0;
+                for(uint32_t i = 0; i <= numPivots; ++i)
+                {
+                        uint32_t numPivotVertices = newVertexOffsets_[i];
+                        newVertexOffsets_[i] = numVertices_ + numNewVertices;
+                        numNewVertices += numPivotVertices;
+                }
+
+                try
+                {
+                        newToOldVertexMapping.resize(numVertices_ + numNewVertices);
+                        vertices.resize(numVertices_ + numNewVertices);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                for(uint32_t i = 0; i < numVertices_; ++i)
+                        newToOldVertexMapping[i] = i;
+
+                if(!executeStage(STAGE_VERTICES, numPivots))
+                        return false;
+
+                return executeStage(STAGE_ORTHOGONALIZATION, static_cast<uint32_t>(vertices.size()));
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        const std::vector<uint32_t>& TangentSpaceGenerator::getPivots() const
+        {
+                return pivots_;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        const std::vector<Vector3d>& TangentSpaceGenerator::getFaceTangents() const
+        {
+                return faceTangents_;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        const std::vector<Vector3d>& TangentSpaceGenerator::getFaceBinormals() const
+        {
+                return faceBinormals_;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool TangentSpaceGenerator::weldPositions(uint32_t& numPivots)
+        {
+                const auto& vertices = *vertices_;
+                numPivots = 0;
+
+                // pivots are chained in the cells of the hash table
+                std::vector<uint32_t> heads, next, representatives;
+                std::vector<int64_t> cells;
+
+                uint32_t numSlots = 1;
+                while(numSlots < 2 * numVertices_)
+                        numSlots <<= 1;
+
+                try
+                {
+                        pivots_.resize(numVertices_);
+                        heads.assign(numSlots, INVALID_INDEX);
+                        next.reserve(numVertices_);
+                        representatives.reserve(numVertices_);
+                        cells.reserve(3 * static_cast<size_t>(numVertices_));
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                const float cellSize = SELENE_EPSILON;
+                const uint32_t mask = numSlots - 1;
+
+                for(uint32_t i = 0; i < numVertices_; ++i)
+                {
+                        const Vector3d& position = vertices[i].pos;
+                        int64_t cell[3] =
+                        {
+                                static_cast<int64_t>(std::floor(position.x / cellSize)),
+                                static_cast<int64_t>(std::floor(position.y / cellSize)),
+                                static_cast<int64_t>(std::floor(position.z / cellSize))
+                        };
+
+                        // positions, which are closer than the size of the cell, are in the neighbouring cells
+                        uint32_t pivot = INVALID_INDEX;
+                        for(uint8_t j = 0; j < NUM_HASH_NEIGHBOURS && pivot == INVALID_INDEX; ++j)
+                        {
+                                int64_t neighbour[3] = {cell[0] + j % 3 - 1, cell[1] + (j / 3) % 3 - 1,
+                                                        cell[2] + j / 9 - 1};
+                                uint32_t slot = hashCell(neighbour) & mask;
+
+                                for(uint32_t k = heads[slot]; k != INVALID_INDEX; k = next[k])
+                                {
+                                        if(cells[3 * k] != neighbour[0] || cells[3 * k + 1] != neighbour[1] ||
+                                           cells[3 * k + 2] != neighbour[2])
+                                                continue;
+
+                                        const Vector3d& pivotPosition = vertices[representatives[k]].pos;
+                                        if(std::fabs(position.x - pivotPosition.x) < SELENE_EPSILON &&
+                                           std::fabs(position.y - pivotPosition.y) < SELENE_EPSILON &&
+                                           std::fabs(position.z - pivotPosition.z) < SELENE_EPSILON)
+                                        {
+                                                pivot = k;
+                                                break;
+                                        }
+                                }
+                        }
+
+                        if(pivot == INVALID_INDEX)
+                        {
+                                pivot = numPivots++;
+                                uint32_t slot = hashCell(cell) & mask;
+
+                                next.push_back(heads[slot]);
+                                heads[slot] = pivot;
+                                representatives.push_back(i);
+                                cells.insert(cells.end(), cell, cell + 3);
+                        }
+
+                        pivots_[i] = pivot;
+                }
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool TangentSpaceGenerator::buildFans(uint32_t numPivots)
+        {
+                const auto& indices = *indices_;
+
+                try
+                {
+                        fanOffsets_.assign(numPivots + 1, 0);
+                        fans_.resize(indices.size());
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                for(size_t i = 0; i < indices.size(); ++i)
+                        ++fanOffsets_[pivots_[indices[i]] + 1];
+
+                for(uint32_t i = 0; i < numPivots; ++i)
+                        fanOffsets_[i + 1] += fanOffsets_[i];
+
+                // corners are placed in the order of the faces, so processing of the fans is deterministic
+                std::vector<uint32_t> cursors;
+
+                try
+                {
+                        cursors.assign(fanOffsets_.begin(), fanOffsets_.end() - 1);
+                }
+                catch(...)
+                {
+                        return false;
+                }
+
+                for(size_t i = 0; i < indices.size(); ++i)
+                        fans_[cursors[pivots_[indices[i]]]++] = static_cast<uint32_t>(i);
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool TangentSpaceGenerator::executeStage(STAGE stage, uint32_t numElements)
+        {
+                isFailed_ = false;
+                if(numElements == 0)
+                        return true;
+
+                size_t numWorkers = (threadPool_ != nullptr) ? threadPool_->getNumWorkers() : 0;
+                uint32_t batchSize = std::max(static_cast<uint32_t>(MIN_BATCH_SIZE),
+                                              static_cast<uint32_t>(numElements / (4 * numWorkers + 1) + 1));
+
+                if(numWorkers == 0 || numElements <= batchSize)
+                {
+                        executeJob(stage, 0, numElements);
+                        return !isFailed_;
+                }
+
+                for(uint32_t first = 0; first < numElements; first += batchSize)
+                {
+                        uint32_t last = std::min(numElements, first + batchSize);
+
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        try
+                        {
+                                threadPool_->addJob(std::bind(&TangentSpaceGenerator::executeJob, this, stage,
+                                                              first, last));
+                                ++numPendingJobs_;
+                        }
+                        catch(...)
+                        {
+                                isFailed_ = true;
+                                break;
+                        }
+                }
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                while(numPendingJobs_ != 0)
+                        jobsFinished_.wait(lock);
+
+                return !isFailed_;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void TangentSpaceGenerator::executeJob(STAGE stage, uint32_t first, uint32_t last)
+        {
+                bool isSuccessful = true;
+
+                try
+                {
+                        switch(stage)
+                        {
+                                case STAGE_FACES:
+                                        processFaces(first, last);
+                                        break;
+
+                                case STAGE_FANS:
+                                {
+                                        Scratch scratch;
+                                        processFans(first, last, scratch);
+                                        break;
+                                }
+
+                                case STAGE_VERTICES:
+                                        writeVertices(first, last);
+                                        break;
+
+                                case STAGE_ORTHOGONALIZATION:
+                                        orthogonalize(first, last);
+                                        break;
+                        }
+                }
+                catch(...)
+                {
+                        isSuccessful = false;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(!isSuccessful)
+                        isFailed_ = true;
+
+                if(numPendingJobs_ != 0)
+                {
+                        --numPendingJobs_;
+                        if(numPendingJobs_ == 0)
+                                jobsFinished_.notify_all();
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void TangentSpaceGenerator::processFaces(uint32_t first, uint32_t last)
+        {
+                const auto& vertices = *vertices_;
+                const auto& indices = *indices_;
+
+                for(uint32_t i = first; i < last; ++i)
+                {
+                        const Vertex& v0 = vertices[indices[3 * i]];
+                        const Vertex& v1 = vertices[indices[3 * i + 1]];
+                        const Vertex& v2 = vertices[indices[3 * i + 2]];
+
+                        // the same gradients as in MeshMender (Eric Lengyel's approach)
+                        Vector3d p = v1.pos - v0.pos;
+                        Vector3d q = v2.pos - v0.pos;
+
+                        float s1 = v1.s - v0.s, t1 = v1.t - v0.t;
+                        float s2 = v2.s - v0.s, t2 = v2.t - v0.t;
+
+                        float determinant = s1 * t2 - s2 * t1;
+                        float scale = (std::fabs(determinant) <= 0.0001f) ? 1.0f : 1.0f / determinant;
+
+                        faceTangents_[i]  = scale * (t2 * p - t1 * q);
+                        faceBinormals_[i] = scale * (s1 * q - s2 * p);
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void TangentSpaceGenerator::processFans(uint32_t first, uint32_t last, Scratch& scratch)
+        {
+                const auto& indices = *indices_;
+
+                for(uint32_t pivot = first; pivot < last; ++pivot)
+                {
+                        uint32_t fanOffset = fanOffsets_[pivot];
+                        uint32_t fanSize = fanOffsets_[pivot + 1] - fanOffset;
+                        const uint32_t* fan = &fans_[fanOffset];
+
+                        if(fanSize == 0)
+                                continue;
+
+                        // faces of the fan, which share edge, have the same pivot at the opposite end of the edge
+                        scratch.edges.clear();
+                        for(uint32_t i = 0; i < fanSize; ++i)
+                        {
+                                uint32_t face = fan[i] / 3, corner = fan[i] % 3;
+
+                                for(uint8_t j = 1; j < 3; ++j)
+                                {
+                                        uint64_t opposite = pivots_[indices[3 * face + (corner + j) % 3]];
+                                        if(opposite != pivot)
+                                                scratch.edges.push_back((opposite << 32) | i);
+                                }
+                        }
+
+                        std::sort(scratch.edges.begin(), scratch.edges.end());
+
+                        scratch.tangentParents.resize(fanSize);
+                        scratch.binormalParents.resize(fanSize);
+                        for(uint32_t i = 0; i < fanSize; ++i)
+                                scratch.tangentParents[i] = scratch.binormalParents[i] = i;
+
+                        // faces, which share edge and can be smoothed together, form group
+                        for(size_t i = 1; i < scratch.edges.size(); ++i)
+                        {
+                                if((scratch.edges[i] >> 32) != (scratch.edges[i - 1] >> 32))
+                                        continue;
+
+                                uint32_t a = static_cast<uint32_t>(scratch.edges[i - 1] & 0xFFFFFFFF);
+                                uint32_t b = static_cast<uint32_t>(scratch.edges[i] & 0xFFFFFFFF);
+                                uint32_t faceA = fan[a] / 3, faceB = fan[b] / 3;
+
+                                if(canSmooth(faceTangents_[faceA], faceTangents_[faceB], minTangentsCreaseCosAngle_))
+                                {
+                                        uint32_t rootA = findRoot(scratch.tangentParents, a);
+                                        uint32_t rootB = findRoot(scratch.tangentParents, b);
+                                        scratch.tangentParents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+                                }
+
+                                if(canSmooth(faceBinormals_[faceA], faceBinormals_[faceB],
+                                             minBinormalsCreaseCosAngle_))
+                                {
+                                        uint32_t rootA = findRoot(scratch.binormalParents, a);
+                                        uint32_t rootB = findRoot(scratch.binormalParents, b);
+                                        scratch.binormalParents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+                                }
+                        }
+
+                        // sum vectors of the groups
+                        scratch.tangentSums.assign(fanSize, Vector3d());
+                        scratch.binormalSums.assign(fanSize, Vector3d());
+                        scratch.corners.resize(fanSize);
+
+                        for(uint32_t i = 0; i < fanSize; ++i)
+                        {
+                                Corner& corner = scratch.corners[i];
+                                corner.vertex = indices[fan[i]];
+                                corner.tangentGroup  = findRoot(scratch.tangentParents, i);
+                                corner.binormalGroup = findRoot(scratch.binormalParents, i);
+                                corner.slot = i;
+
+                                scratch.tangentSums[corner.tangentGroup]   += faceTangents_[fan[i] / 3];
+                                scratch.binormalSums[corner.binormalGroup] += faceBinormals_[fan[i] / 3];
+                        }
+
+                        for(uint32_t i = 0; i < fanSize; ++i)
+                        {
+                                const Corner& corner = scratch.corners[i];
+                                Vector3d tangent = scratch.tangentSums[corner.tangentGroup];
+                                Vector3d binormal = scratch.binormalSums[corner.binormalGroup];
+
+                                if(tangent.length() > 0.0f)
+                                        tangent.normalize();
+
+                                if(binormal.length() > 0.0f)
+                                        binormal.normalize();
+
+                                slotTangents_[fanOffset + i]  = tangent;
+                                slotBinormals_[fanOffset + i] = binormal;
+                        }
+
+                        // the first group of the vertex keeps it, other groups receive copies
+                        std::sort(scratch.corners.begin(), scratch.corners.end(), Comparator());
+
+                        uint32_t numNewVertices = 0, vertex = 0;
+                        for(uint32_t i = 0; i < fanSize; ++i)
+                        {
+                                const Corner& corner = scratch.corners[i];
+
+                                if(i == 0 || corner.vertex != scratch.corners[i - 1].vertex)
+                                        vertex = corner.vertex;
+                                else if(corner.tangentGroup  != scratch.corners[i - 1].tangentGroup ||
+                                        corner.binormalGroup != scratch.corners[i - 1].binormalGroup)
+                                        vertex = 0x80000000 | numNewVertices++;
+
+                                slotVertices_[fanOffset + corner.slot] = vertex;
+                        }
+
+                        newVertexOffsets_[pivot] = numNewVertices;
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void TangentSpaceGenerator::writeVertices(uint32_t first, uint32_t last)
+        {
+                auto& vertices = *vertices_;
+                auto& indices = *indices_;
+                auto& newToOldVertexMapping = *newToOldVertexMapping_;
+
+                for(uint32_t pivot = first; pivot < last; ++pivot)
+                {
+                        for(uint32_t i = fanOffsets_[pivot]; i < fanOffsets_[pivot + 1]; ++i)
+                        {
+                                uint32_t oldVertex = indices[fans_[i]];
+                                uint32_t vertex = slotVertices_[i];
+
+                                if((vertex & 0x80000000) != 0)
+                                {
+                                        vertex = newVertexOffsets_[pivot] + (vertex & 0x7FFFFFFF);
+                                        vertices[vertex] = vertices[oldVertex];
+                                        newToOldVertexMapping[vertex] = oldVertex;
+                                }
+
+                                vertices[vertex].tangent  = slotTangents_[i];
+                                vertices[vertex].binormal = slotBinormals_[i];
+                                indices[fans_[i]] = vertex;
+                        }
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void TangentSpaceGenerator::orthogonalize(uint32_t first, uint32_t last)
+        {
+                auto& vertices = *vertices_;
+
+                for(uint32_t i = first; i < last; ++i)
+                {
+                        Vertex& vertex = vertices[i];
+
+                        // Gram-Schmidt orthogonalization, the same as in MeshMender
+                        Vector3d tangent = vertex.tangent - vertex.normal.dot(vertex.tangent) * vertex.normal;
+                        Vector3d binormal = vertex.binormal - vertex.normal.dot(vertex.binormal) * vertex.normal -
+                                            tangent.dot(vertex.binormal) * tangent;
+
+                        float tangentLength = tangent.length();
+                        float binormalLength = binormal.length();
+
+                        vertex.tangent  = (tangentLength  > 0.0f) ? tangent  / tangentLength  : Vector3d();
+                        vertex.binormal = (binormalLength > 0.0f) ? binormal / binormalLength : Vector3d();
+
+                        tangentLength  = vertex.tangent.length();
+                        binormalLength = vertex.binormal.length();
+
+                        if(tangentLength <= 0.001f || binormalLength <= 0.001f)
+                        {
+                                // tangent space is ill defined, so it is built from the normal
+                                if(tangentLength > 0.5f)
+                                {
+                                        vertex.binormal = vertex.normal.cross(vertex.tangent);
+                                }
+                                else if(binormalLength > 0.5f)
+                                {
+                                        vertex.tangent = vertex.binormal.cross(vertex.normal);
+                                }
+                                else
+                                {
+                                        Vector3d xAxis(1.0f, 0.0f, 0.0f);
+                                        Vector3d yAxis(0.0f, 1.0f, 0.0f);
+                                        Vector3d axis = (xAxis.dot(vertex.normal) < yAxis.dot(vertex.normal)) ?
+                                                        xAxis : yAxis;
+
+                                        vertex.tangent = vertex.normal.cross(axis);
+                                        vertex.binormal = vertex.normal.cross(vertex.tangent);
+                                }
+                        }
+                        else if(vertex.binormal.dot(vertex.tangent) > 0.999f)
+                        {
+                                vertex.binormal = vertex.normal.cross(vertex.tangent);
+                        }
+                }
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool TangentSpaceGenerator::canSmooth(const Vector3d& first, const Vector3d& second,
+                                              float minCreaseCosAngle)
+        {
+                float firstLength = first.length(), secondLength = second.length();
+
+                // null vectors can be smoothed with each other no matter what the crease angle is
+                if(firstLength == 0.0f || secondLength == 0.0f)
+                        return (firstLength == secondLength);
+
+                return (first.dot(second) >= minCreaseCosAngle * firstLength * secondLength);
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        uint32_t TangentSpaceGenerator::hashCell(const int64_t* cell)
+        {
+                uint64_t hash = static_cast<uint64_t>(cell[0]) * 73856093ULL ^
+                                static_cast<uint64_t>(cell[1]) * 19349663ULL ^
+                                static_cast<uint64_t>(cell[2]) * 83492791ULL;
+                return static_cast<uint32_t>(hash ^ (hash >> 32));
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        uint32_t TangentSpaceGenerator::findRoot(std::vector<uint32_t>& parents, uint32_t element)
+        {
+                while(parents[element] != element)
+                {
+                        parents[element] = parents[parents[element]];
+                        element = parents[element];
+                }
+
+                return element;
+        }
+
+}
@@ -0,0 +1,286 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef TANGENT_SPACE_GENERATOR_H
+#define TANGENT_SPACE_GENERATOR_H
+
+#include "NVMeshMender.h"
+
+#include <condition_variable>
+#include <vector>
+#include <mutex>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Exporter
+         * @{
+         */
+
+        /**
+         * Represents tangent space generator. Computes tangents and binormals of the vertices like
+         * MeshMender (with given normals, without respecting existing splits and fixing of cylindrical
+         * wrapping), but in linear time:
+         * - positions of the vertices are welded with spatial hash (positions, which differ by less
+         *   than SELENE_EPSILON in each coordinate, are considered equal), welded position is called
+         *   pivot;
+         * - faces around each pivot form fan, neighbouring faces of the fan (faces, which share edge)
+         *   are found by sorting pivots of the opposite vertices;
+         * - faces of the fan are split into groups, which are connected components of the neighbouring
+         *   faces, whose tangents (or binormals) can be smoothed together;
+         * - vertex, which is used by faces from different groups, is split, so each group has its own
+         *   copy of the vertex.
+         *
+         * Fans are independent, so faces, fans and vertices are processed in parallel by the workers of
+         * the thread pool.
+         */
+        class TangentSpaceGenerator
+        {
+        public:
+                /// Vertex of the mesh (the same as the vertex of MeshMender)
+                typedef MeshMender::Vertex Vertex;
+
+                /**
+                 * \brief Constructs tangent space generator.
+                 * \param[in] threadPool thread pool, which is used to process mesh in parallel (if nullptr,
+                 * then mesh is processed in the calling thread)
+                 */
+                TangentSpaceGenerator(ThreadPool* threadPool = nullptr);
+                TangentSpaceGenerator(const TangentSpaceGenerator&) = delete;
+                ~TangentSpaceGenerator();
+                TangentSpaceGenerator& operator =(const TangentSpaceGenerator&) = delete;
+
+                /**
+                 * \brief Generates tangent space.
+                 *
+                 * Parameters have the same meaning as the parameters of MeshMender::Mend.
+                 * \param[in,out] vertices vertices (positions, normals and texture coordinates should be
+                 * initialized), new vertices may be appended
+                 * \param[in,out] indices indices of the faces
+                 * \param[out] newToOldVertexMapping mapping of the new vertex indices to the old ones
+                 * \param[in] minTangentsCreaseCosAngle minimum cosine of the angle between tangents of the
+                 * neighbouring faces, which can be smoothed together
+                 * \param[in] minBinormalsCreaseCosAngle minimum cosine of the angle between binormals of the
+                 * neighbouring faces, which can be smoothed together
+                 * \return true if tangent space has been successfully generated
+                 */
+                bool generate(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                              std::vector<unsigned int>& newToOldVertexMapping,
+                              float minTangentsCreaseCosAngle = 0.0f,
+                              float minBinormalsCreaseCosAngle = 0.0f);
+
+                /**
+                 * \brief Returns pivots of the vertices.
+                 * \return pivots of the vertices, which have been passed to the last call of generate (vertices
+                 * with the same pivot have the same positions)
+                 */
+                const std::vector<uint32_t>& getPivots() const;
+
+                /**
+                 * \brief Returns tangents of the faces.
+                 * \return tangents of the faces, which have been computed by the last call of generate
+                 */
+                const std::vector<Vector3d>& getFaceTangents() const;
+
+                /**
+                 * \brief Returns binormals of the faces.
+                 * \return binormals of the faces, which have been computed by the last call of generate
+                 */
+                const std::vector<Vector3d>& getFaceBinormals() const;
+
+        private:
+                /// Helper constants
+                enum
+                {
+                        MIN_BATCH_SIZE = 4096,
+                        NUM_HASH_NEIGHBOURS = 27
+                };
+
+                /// Stages, which are processed in parallel
+                enum STAGE
+                {
+                        STAGE_FACES = 0,
+                        STAGE_FANS,
+                        STAGE_VERTICES,
+                        STAGE_ORTHOGONALIZATION
+                };
+
+                /**
+                 * Represents corner of the face in the fan.
+                 */
+                class Corner
+                {
+                public:
+                        uint32_t vertex;
+                        uint32_t tangentGroup;
+                        uint32_t binormalGroup;
+                        uint32_t slot;
+
+                        Corner();
+                        Corner(const Corner&) = default;
+                        ~Corner();
+                        Corner& operator =(const Corner&) = default;
+
+                };
+
+                /**
+                 * Represents comparator, which sorts corners by vertices and groups.
+                 */
+                class Comparator
+                {
+                public:
+                        Comparator();
+                        Comparator(const Comparator&) = default;
+                        ~Comparator();
+                        Comparator& operator =(const Comparator&) = default;
+
+                        /**
+                         * \brief Compares corners.
+                         * \param[in] first the first corner
+                         * \param[in] second the second corner
+                         * \return true if the first corner precedes the second
+                         */
+                        bool operator ()(const Corner& first, const Corner& second) const;
+
+                };
+
+                /**
+                 * Represents scratch memory of the job, which processes fans.
+                 */
+                class Scratch
+                {
+                public:
+                        std::vector<uint64_t> edges;
+                        std::vector<uint32_t> tangentParents, binormalParents;
+                        std::vector<Vector3d> tangentSums, binormalSums;
+                        std::vector<Corner> corners;
+
+                        Scratch();
+                        Scratch(const Scratch&) = delete;
+                        ~Scratch();
+                        Scratch& operator =(const Scratch&) = delete;
+
+                };
+
+                /// Index, which marks absence of the vertex
+                static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+                ThreadPool* threadPool_;
+
+                std::mutex mutex_;
+                std::condition_variable jobsFinished_;
+                size_t numPendingJobs_;
+                bool isFailed_;
+
+                std::vector<Vertex>* vertices_;
+                std::vector<unsigned int>* indices_;
+                std::vector<unsigned int>* newToOldVertexMapping_;
+                float minTangentsCreaseCosAngle_, minBinormalsCreaseCosAngle_;
+                uint32_t numVertices_, numFaces_;
+
+                // tangents and binormals of the faces
+                std::vector<Vector3d> faceTangents_, faceBinormals_;
+
+                // pivots of the vertices and fans of the pivots (corners of the faces, which are grouped
+                // by pivots), fan of the pivot i starts at the fanOffsets_[i]
+                std::vector<uint32_t> pivots_, fanOffsets_, fans_;
+
+                // results of the processing of the fans: tangents, binormals and vertices of the corners
+                // (if vertex should be split, then its copy is stored as the local index of the new vertex
+                // of the fan, with the highest bit set), and number of new vertices of each fan
+                std::vector<Vector3d> slotTangents_, slotBinormals_;
+                std::vector<uint32_t> slotVertices_, newVertexOffsets_;
+
+                /**
+                 * \brief Welds positions of the vertices.
+                 * \param[out] numPivots number of pivots
+                 * \return true if positions have been successfully welded
+                 */
+                bool weldPositions(uint32_t& numPivots);
+
+                /**
+                 * \brief Builds fans of the pivots.
+                 * \param[in] numPivots number of pivots
+                 * \return true if fans have been successfully built
+                 */
+                bool buildFans(uint32_t numPivots);
+
+                /**
+                 * \brief Executes stage for given range of elements in parallel.
+                 * \param[in] stage stage
+                 * \param[in] numElements number of elements (faces, pivots or vertices)
+                 * \return true if stage has been successfully executed
+                 */
+                bool executeStage(STAGE stage, uint32_t numElements);
+
+                /**
+                 * \brief Executes job, which processes given range of elements.
+                 * \param[in] stage stage
+                 * \param[in] first index of the first element
+                 * \param[in] last index, which follows index of the last element
+                 */
+                void executeJob(STAGE stage, uint32_t first, uint32_t last);
+
+                /**
+                 * \brief Computes tangents and binormals of the faces.
+                 * \param[in] first index of the first face
+                 * \param[in] last index, which follows index of the last face
+                 */
+                void processFaces(uint32_t first, uint32_t last);
+
+                /**
+                 * \brief Groups faces of the fans and computes tangents and binormals of the corners.
+                 * \param[in] first index of the first pivot
+                 * \param[in] last index, which follows index of the last pivot
+                 * \param[in] scratch scratch memory
+                 */
+                void processFans(uint32_t first, uint32_t last, Scratch& scratch);
+
+                /**
+                 * \brief Writes tangents, binormals and split vertices of the fans.
+                 * \param[in] first index of the first pivot
+                 * \param[in] last index, which follows index of the last pivot
+                 */
+                void writeVertices(uint32_t first, uint32_t last);
+
+                /**
+                 * \brief Orthogonalizes tangents and binormals with the normals of the vertices.
+                 * \param[in] first index of the first vertex
+                 * \param[in] last index, which follows index of the last vertex
+                 */
+                void orthogonalize(uint32_t first, uint32_t last);
+
+                /**
+                 * \brief Returns true if two vectors can be smoothed together.
+                 * \param[in] first the first vector
+                 * \param[in] second the second vector
+                 * \param[in] minCreaseCosAngle minimum cosine of the angle between vectors
+                 * \return true if vectors can be smoothed together
+                 */
+                static bool canSmooth(const Vector3d& first, const Vector3d& second, float minCreaseCosAngle);
+
+                /**
+                 * \brief Computes hash of the cell of the spatial hash.
+                 * \param[in] cell coordinates of the cell
+                 * \return hash of the cell
+                 */
+                static uint32_t hashCell(const int64_t* cell);
+
+                /**
+                 * \brief Finds root of the group.
+                 * \param[in,out] parents parents of the elements of the groups
+                 * \param[in] element element
+                 * \return root of the group
+                 */
+                static uint32_t findRoot(std::vector<uint32_t>& parents, uint32_t element);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "Packer.h"
+#include <iostream>
+#include <string>
+
+using namespace selene;
+
+void showHelp()
+{
+        std::cout << "status: showing help page" << std::endl << std::endl;
+        std::cout << "NAME" << std::endl;
+        std::cout << "        Packer - SELENE Device asset packer" << std::endl << std::endl;
+        std::cout << "SYNOPSIS" << std::endl;
+        std::cout << "        Packer [-c] -i input_folder -o output_file" << std::endl;
+        std::cout << "        Packer -h" << std::endl << std::endl;
+        std::cout << "DESCRIPTION" << std::endl;
+        std::cout << "        Packer writes all files of the folder tree (for example, Assets) to the ";
+        std::cout << "SELENE Device pack file (SDPF)." << std::endl << std::endl;
+        std::cout << "OPTIONS" << std::endl;
+        std::cout << "        -i, --input" << std::endl;
+        std::cout << "                Specifies input folder. ";
+        std::cout << "Names of the packed files are relative to this folder." << std::endl;
+        std::cout << "        -o, --output" << std::endl;
+        std::cout << "                Specifies output file name." << std::endl;
+        std::cout << "        -c, --compress" << std::endl;
+        std::cout << "                Compresses files, which become smaller after compression." << std::endl;
+        std::cout << "        -h, --help" << std::endl;
+        std::cout << "                Shows help." << std::endl << std::endl;
+        std::cout << "EXIT STATUS" << std::endl;
+        std::cout << "        0      Successful program execution." << std::endl;
+        std::cout << "        1      Input folder could not be read." << std::endl;
+        std::cout << "        2      Could not create output file." << std::endl;
+}
+
+int main(int argc, char* args[])
+{
+        std::string inputFolder(""), outputFileName("");
+        std::string* currentArgument = nullptr;
+        bool shouldCompress = false;
+
+        std::cout << "SELENE Device packer" << std::endl;
+
+        for(int i = 1; i < argc; ++i)
+        {
+                std::string argument(args[i]);
+                if(currentArgument != nullptr)
+                {
+                        *currentArgument = argument;
+                        currentArgument = nullptr;
+                        continue;
+                }
+
+                if(argument == "-i" || argument == "--input")
+                {
+                        currentArgument = &inputFolder;
+                }
+                else if(argument == "-o" || argument == "--output")
+                {
+                        currentArgument = &outputFileName;
+                }
+                else if(argument == "-c" || argument == "--compress")
+                {
+                        shouldCompress = true;
+                }
+                else if(argument == "-h" || argument == "--help")
+                {
+                        showHelp();
+                        return 0;
+                }
+        }
+
+        if(inputFolder == "")
+        {
+                std::cout << "error: no input folder specified" << std::endl;
+                showHelp();
+                return 0;
+        }
+
+        if(outputFileName == "")
+        {
+                std::cout << "error: no output file name specified" << std::endl;
+                showHelp();
+                return 0;
+        }
+
+        Packer packer;
+        packer.setCompression(shouldCompress);
+
+        if(!packer.addFolder(inputFolder.c_str()))
+                return 1;
+
+        std::cout << "status: packing " << packer.getNumFiles() << " files" << std::endl;
+
+        if(!packer.writePack(outputFileName.c_str()))
+                return 2;
+
+        return 0;
+}
@@ -0,0 +1,333 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#include "Packer.h"
+#include "../Engine/Core/Helpers/LzCodec.h"
+#include "../Engine/Core/Helpers/Utility.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <dirent.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+namespace selene
+{
+
+        Packer::Packer(): files_(), shouldCompress_(false) {}
+        Packer::~Packer() {}
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Packer::addFolder(const char* folder)
+        {
+                if(folder == nullptr)
+                        return false;
+
+                std::string path(folder);
+                if(!path.empty() && path[path.length() - 1] != '/')
+                        path += '/';
+
+                if(!addFiles(path, std::string()))
+                        return false;
+
+                // sort files, so pack does not depend on the order of the directory entries
+                std::sort(files_.begin(), files_.end());
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        void Packer::setCompression(bool shouldCompress)
+        {
+                shouldCompress_ = shouldCompress;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        size_t Packer::getNumFiles() const
+        {
+                return files_.size();
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Packer::writePack(const char* fileName)
+        {
+                if(fileName == nullptr)
+                        return false;
+
+                // fill table of contents
+                PackFileManager::Header header;
+                std::memcpy(header.signature, "SDPF", 4);
+                header.version = PackFileManager::PACK_FILE_VERSION;
+                header.numEntries = static_cast<uint32_t>(files_.size());
+                header.numSlots = Utility::getNearestPowerOfTwo(header.numEntries * 2 + 1);
+
+                std::vector<uint32_t> slots(header.numSlots, 0);
+                std::vector<PackFileManager::Entry> entries(header.numEntries);
+                uint32_t mask = header.numSlots - 1;
+                uint32_t namesSize = 0;
+
+                for(uint32_t i = 0; i < header.numEntries; ++i)
+                {
+                        PackFileManager::Entry& entry = entries[i];
+                        const std::string& name = files_[i].name;
+
+                        entry.nameOffset = namesSize;
+                        entry.nameLength = static_cast<uint32_t>(name.length());
+                        entry.hash = PackFileManager::computeHash(name.c_str(), entry.nameLength);
+                        entry.offset = entry.size = entry.originalSize = 0;
+                        entry.compression = PackFileManager::COMPRESSION_NONE;
+                        entry.reserved = 0;
+
+                        namesSize += entry.nameLength;
+
+                        // insert entry with linear probing
+                        uint32_t slot = entry.hash & mask;
+                        while(slots[slot] != 0)
+                                slot = (slot + 1) & mask;
+
+                        slots[slot] = i + 1;
+                }
+
+                // write table of contents (entries are written again, when offsets are known)
+                std::ofstream stream(fileName, std::ios_base::binary);
+                if(!stream.good())
+                        return false;
+
+                stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                stream.write(reinterpret_cast<const char*>(&slots[0]), header.numSlots * sizeof(uint32_t));
+
+                std::streamoff entriesOffset = stream.tellp();
+                if(!entries.empty())
+                        stream.write(reinterpret_cast<const char*>(&entries[0]),
+                                     entries.size() * sizeof(PackFileManager::Entry));
+
+                for(auto it = files_.begin(); it != files_.end(); ++it)
+                        stream.write(it->name.c_str(), it->name.length());
+
+                // write contents of the files
+                std::vector<char> contents, compressedContents, filteredContents;
+                const char padding[PackFileManager::PACK_FILE_ALIGNMENT] = {0};
+                const std::streamoff alignmentMask = PackFileManager::PACK_FILE_ALIGNMENT - 1;
+
+                for(uint32_t i = 0; i < header.numEntries; ++i)
+                {
+                        if(!readFile(files_[i].path, contents))
+                                return false;
+
+                        entries[i].originalSize = static_cast<uint32_t>(contents.size());
+
+                        // compress file, if it makes file smaller
+                        if(shouldCompress_ && !contents.empty())
+                        {
+                                if(!compress(contents, PackFileManager::FILTER_NONE, compressedContents) ||
+                                   !compress(contents, PackFileManager::FILTER_SHUFFLE_DELTA, filteredContents))
+                                        return false;
+
+                                if(filteredContents.size() < compressedContents.size())
+                                        compressedContents.swap(filteredContents);
+
+                                if(compressedContents.size() < contents.size())
+                                {
+                                        entries[i].compression = PackFileManager::COMPRESSION_LZ;
+                                        contents.swap(compressedContents);
+                                }
+                        }
+
+                        std::streamoff offset = stream.tellp();
+                        std::streamoff alignedOffset = (offset + alignmentMask) & ~alignmentMask;
+
+                        if(alignedOffset + static_cast<std::streamoff>(contents.size()) > 0xFFFFFFFFLL)
+                                return false;
+
+                        stream.write(padding, alignedOffset - offset);
+                        if(!contents.empty())
+                                stream.write(&contents[0], contents.size());
+
+                        entries[i].offset = static_cast<uint32_t>(alignedOffset);
+                        entries[i].size = static_cast<uint32_t>(contents.size());
+                }
+
+                // write entries
+                stream.seekp(entriesOffset);
+                if(!entries.empty())
+                        stream.write(reinterpret_cast<const char*>(&entries[0]),
+                                     entries.size() * sizeof(PackFileManager::Entry));
+
+                return stream.good();
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Packer::File::operator <(const File& file) const
+        {
+                return name < file.name;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Packer::addFiles(const std::string& path, const std::string& prefix)
+        {
+                std::vector<std::string> fileNames, folderNames;
+                if(!readFolder(path, fileNames, folderNames))
+                        return false;
+
+                bool result = true;
+
+                for(auto it = folderNames.begin(); it != folderNames.end(); ++it)
+                {
+                        if(!addFiles(path + (*it) + '/', prefix + (*it) + '/'))
+                                result = false;
+                }
+
+                for(auto it = fileNames.begin(); it != fileNames.end(); ++it)
+                {
+                        const std::string& name = *it;
+
+                        // skip pack files
+                        if(name.length() >= 5 && name.compare(name.length() - 5, 5, ".sdpf") == 0)
+                                continue;
+
+                        File file;
+                        file.path = path + name;
+                        file.name = prefix + name;
+                        files_.push_back(file);
+                }
+
+                return result;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Packer::readFolder(const std::string& path, std::vector<std::string>& files,
+                                std::vector<std::string>& folders)
+        {
+#ifdef _WIN32
+                WIN32_FIND_DATAA findData;
+                HANDLE handle = FindFirstFileA((path + '*').c_str(), &findData);
+                if(handle == INVALID_HANDLE_VALUE)
+                        return false;
+
+                do
+                {
+                        std::string name(findData.cFileName);
+
+                        // skip hidden files, current and parent folders
+                        if(name.empty() || name[0] == '.')
+                                continue;
+
+                        if(IS_SET(findData.dwFileAttributes, FILE_ATTRIBUTE_DIRECTORY))
+                                folders.push_back(name);
+                        else
+                                files.push_back(name);
+                }
+                while(FindNextFileA(handle, &findData) != 0);
+
+                FindClose(handle);
+#else
+                DIR* directory = opendir(path.c_str());
+                if(directory == nullptr)
+                        return false;
+
+                for(dirent* directoryEntry = readdir(directory); directoryEntry != nullptr;
+                    directoryEntry = readdir(directory))
+                {
+                        std::string name(directoryEntry->d_name);
+
+                        // skip hidden files, current and parent folders
+                        if(name.empty() || name[0] == '.')
+                                continue;
+
+                        struct stat fileStatus;
+                        if(stat((path + name).c_str(), &fileStatus) != 0)
+                                continue;
+
+                        if(S_ISDIR(fileStatus.st_mode))
+                                folders.push_back(name);
+                        else
+                                files.push_back(name);
+                }
+
+                closedir(directory);
+#endif
+
+                return true;
+        }
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Packer::readFile(const std::string& path, std::vector<char>& contents)
+        {
+                std::ifstream stream(path.c_str(), std::ios_base::binary);
+                if(!stream.good())
+                        return false;
+
+                stream.seekg(0, std::ios_base::end);
+                std::streamoff size = stream.tellg();
+                stream.seekg(0, std::ios_base::beg);
+
+                if(size < 0)
+                        return false;
+
+                contents.resize(static_cast<size_t>(size));
+                if(size > 0)
+                        stream.read(&contents[0], size);
+
+                return !stream.fail();
+        }
+
+
+        //-------------------------------------------------------------------------------------------------------
+        bool Packer::compress(const std::vector<char>& contents, uint32_t filter,
+                              std::vector<char>& compressedContents)
+        {
+                const uint32_t blockSize = PackFileManager::COMPRESSION_BLOCK_SIZE;
+                uint32_t size = static_cast<uint32_t>(contents.size());
+                uint32_t numBlocks = (size + blockSize - 1) / blockSize;
+
+                // write block table (offsets are written when blocks are compressed)
+                std::vector<uint32_t> table(numBlocks + 3, 0);
+                table[0] = filter;
+                table[1] = numBlocks;
+
+                compressedContents.assign(table.size() * sizeof(uint32_t), 0);
+                table[2] = static_cast<uint32_t>(compressedContents.size());
+
+                std::vector<uint8_t> block(blockSize), compressedBlock(LzCodec::getMaxCompressedSize(blockSize));
+                const uint8_t* source = reinterpret_cast<const uint8_t*>(&contents[0]);
+
+                for(uint32_t i = 0; i < numBlocks; ++i)
+                {
+                        uint32_t offset = i * blockSize;
+                        uint32_t currentBlockSize = std::min(size - offset, blockSize);
+                        const uint8_t* input = source + offset;
+
+                        if(filter == PackFileManager::FILTER_SHUFFLE_DELTA)
+                        {
+                                LzCodec::shuffle(input, &block[0], currentBlockSize,
+                                                 PackFileManager::FILTER_ELEMENT_SIZE);
+                                LzCodec::encodeDelta(&block[0], currentBlockSize);
+                                input = &block[0];
+                        }
+
+                        uint32_t compressedSize = LzCodec::compress(input, currentBlockSize, &compressedBlock[0],
+                                                                    static_cast<uint32_t>(compressedBlock.size()));
+
+                        // blocks, which can not be compressed, are stored as-is (but filtered)
+                        if(compressedSize == 0 || compressedSize >= currentBlockSize)
+                                compressedSize = currentBlockSize;
+                        else
+                                input = &compressedBlock[0];
+
+                        compressedContents.insert(compressedContents.end(), input, input + compressedSize);
+
+                        if(compressedContents.size() > 0xFFFFFFFFULL)
+                                return false;
+
+                        table[i + 3] = static_cast<uint32_t>(compressedContents.size());
+                }
+
+                std::memcpy(&compressedContents[0], &table[0], table.size() * sizeof(uint32_t));
+                return true;
+        }
+
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2012 Nezametdinov E. Ildus
+// Licensed under the MIT License (see LICENSE.txt for details)
+
+#ifndef PACKER_H
+#define PACKER_H
+
+#include "../Engine/Core/FileManager/PackFileManager.h"
+
+#include <string>
+#include <vector>
+
+namespace selene
+{
+
+        /**
+         * \addtogroup Packer
+         * @{
+         */
+
+        /**
+         * Represents packer. Collects files from the folder tree and writes them to the pack file (SDPF),
+         * which can be mounted with PackFileManager. Files can be compressed with LzCodec, in this case
+         * each file is compressed with and without shuffle and delta filters and the smallest result is
+         * stored (files, which can not be compressed, are stored as-is).
+         */
+        class Packer
+        {
+        public:
+                Packer();
+                Packer(const Packer&) = delete;
+                ~Packer();
+                Packer& operator =(const Packer&) = delete;
+
+                /**
+                 * \brief Adds all files of the folder (and its subfolders) to the pack.
+                 *
+                 * Names of the entries are relative to the given folder. Hidden files and pack files
+                 * are skipped.
+                 * \param[in] folder folder
+                 * \return true if folder has been successfully read
+                 */
+                bool addFolder(const char* folder);
+
+                /**
+                 * \brief Sets compression.
+                 * \param[in] shouldCompress flag, which enables compression of the files
+                 */
+                void setCompression(bool shouldCompress);
+
+                /**
+                 * \brief Returns number of files.
+                 * \return number of files, which will be written to the pack
+                 */
+                size_t getNumFiles() const;
+
+                /**
+                 * \brief Writes pack file.
+                 * \param[in] fileName name of the pack file
+                 * \return true on success
+                 */
+                bool writePack(const char* fileName);
+
+        private:
+                /**
+                 * Represents packed file.
+                 */
+                class File
+                {
+                public:
+                        std::string path;
+                        std::string name;
+
+                        /**
+                         * \brief Compares files by names.
+                         * \param[in] file another file
+                         * \return true if name of this file is less than name of another file
+                         */
+                        bool operator <(const File& file) const;
+
+                };
+
+                std::vector<File> files_;
+                bool shouldCompress_;
+
+                /**
+                 * \brief Adds files of the folder recursively.
+                 * \param[in] path path to the folder
+                 * \param[in] prefix prefix of the names of the entries
+                 * \return true if folder has been successfully read
+                 */
+                bool addFiles(const std::string& path, const std::string& prefix);
+
+                /**
+                 * \brief Reads contents of the folder (with native file system API).
+                 *
+                 * Hidden files and folders (whose names start with the dot) are skipped.
+                 * \param[in] path path to the folder
+                 * \param[out] files names of the files of the folder
+                 * \param[out] folders names of the subfolders of the folder
+                 * \return true if folder has been successfully read
+                 */
+                static bool readFolder(const std::string& path, std::vector<std::string>& files,
+                                       std::vector<std::string>& folders);
+
+                /**
+                 * \brief Reads file.
+                 * \param[in] path path to the file
+                 * \param[out] contents contents of the file
+                 * \return true if file has been successfully read
+                 */
+                bool readFile(const std::string& path, std::vector<char>& contents);
+
+                /**
+                 * \brief Compresses contents of the file.
+                 * \see PackFileManager for the layout of the compressed entry
+                 * \param[in] contents contents of the file
+                 * \param[in] filter filter, which is applied to the blocks
+                 * \param[out] compressedContents compressed contents
+                 * \return true if contents have been successfully compressed
+                 */
+                bool compress(const std::vector<char>& contents, uint32_t filter,
+                              std::vector<char>& compressedContents);
+
+        };
+
+        /**
+         * @}
+         */
+
+}
+
+#endif
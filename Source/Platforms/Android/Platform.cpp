@@ -64,6 +64,8 @@ namespace selene
         //----------------------------------------------------------------------------------------------------------
         std::istream* Platform::FileManager::open(const char* fileName) const
         {
+                std::lock_guard<std::mutex> lock(mutex_);
+
                 const char* fullFileName = find(fileName);
                 if(fullFileName == nullptr || assetManager_ == nullptr)
                         return nullptr;
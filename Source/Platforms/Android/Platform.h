@@ -61,6 +61,8 @@ namespace selene
                         ~FileManager();
                         FileManager& operator =(const FileManager&) = delete;
 
+                        using selene::FileManager::find;
+
                         // FileManager interface implementation
                         const char* find(const char* fileName) const;
                         std::istream* open(const char* fileName) const;
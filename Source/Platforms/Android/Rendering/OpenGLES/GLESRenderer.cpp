@@ -32,6 +32,9 @@ namespace selene
                 if(!initializeHelpers())
                         return false;
 
+                // larger skeletons are skinned on the CPU
+                maxNumBonesInModel_ = GlesActorsRenderer::MAX_NUM_OF_BONES_IN_MODEL;
+
                 // prepare OpenGL ES
                 glEnable(GL_CULL_FACE);
                 glEnable(GL_DEPTH_TEST);
@@ -76,11 +79,15 @@ namespace selene
                                                              frameParameters_.projectionParameters.w,
                                                              frameParameters_.projectionParameters.w, 1.0f);
 
-                const auto& bloom   = camera.getEffect("Bloom");
-                const auto& shadows = camera.getEffect("Shadows");
+                // get effects (identifiers of the names are computed at compile time)
+                static constexpr Name bloomName("Bloom"), shadowsName("Shadows");
+                static constexpr Name luminanceName("Luminance"), scaleName("Scale");
+
+                const auto& bloom   = camera.getEffect(bloomName);
+                const auto& shadows = camera.getEffect(shadowsName);
 
-                frameParameters_.bloomParameters.define(bloom.getParameter("Luminance").getValue(),
-                                                        bloom.getParameter("Scale").getValue(),
+                frameParameters_.bloomParameters.define(bloom.getParameter(luminanceName).getValue(),
+                                                        bloom.getParameter(scaleName).getValue(),
                                                         0.18f, 0.64f);
                 frameParameters_.bloomQuality = bloom.getQuality();
 
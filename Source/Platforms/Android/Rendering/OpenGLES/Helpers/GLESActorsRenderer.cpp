@@ -12,7 +12,12 @@ namespace selene
 {
 
         GlesActorsRenderer::GlesActorsRenderer():
-                renderTargetContainer_(nullptr), frameParameters_(nullptr), textureHandler_(nullptr) {}
+                renderTargetContainer_(nullptr), frameParameters_(nullptr), textureHandler_(nullptr),
+                uploadedMeshSkinner_(nullptr)
+        {
+                for(uint8_t i = 0; i < MeshSkinner::NUM_OF_SKINNED_STREAMS; ++i)
+                        skinnedVertexBuffers_[i] = 0;
+        }
         GlesActorsRenderer::~GlesActorsRenderer()
         {
                 destroy();
@@ -285,6 +290,10 @@ namespace selene
                 for(uint8_t i = 0; i < NUM_OF_GLSL_PROGRAMS; ++i)
                         variables_[i].obtainLocations(programs_[i]);
 
+                // create stream vertex buffers for the meshes, which have been skinned on the CPU
+                glGenBuffers(MeshSkinner::NUM_OF_SKINNED_STREAMS, skinnedVertexBuffers_);
+                CHECK_GLES_ERROR("GlesActorsRenderer::initialize: glGenBuffers");
+
                 return true;
         }
 
@@ -294,6 +303,15 @@ namespace selene
                 for(uint8_t i = 0; i < NUM_OF_GLSL_PROGRAMS; ++i)
                         programs_[i].destroy();
 
+                for(uint8_t i = 0; i < MeshSkinner::NUM_OF_SKINNED_STREAMS; ++i)
+                {
+                        if(skinnedVertexBuffers_[i] != 0)
+                                glDeleteBuffers(1, &skinnedVertexBuffers_[i]);
+
+                        skinnedVertexBuffers_[i] = 0;
+                }
+
+                uploadedMeshSkinner_ = nullptr;
                 renderTargetContainer_ = nullptr;
                 frameParameters_ = nullptr;
                 textureHandler_ = nullptr;
@@ -509,18 +527,20 @@ namespace selene
         }
 
         //------------------------------------------------------------------------------------------------------------
-        void GlesActorsRenderer::setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms,
+        bool GlesActorsRenderer::setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms,
                                                  const GlesActorsRenderer::Variables& variables)
         {
                 if(boneTransforms.isEmpty())
-                        return;
+                        return true;
+
+                // truncated pose would distort the mesh, such meshes must be skinned on the CPU
+                if(boneTransforms.getSize() > static_cast<uint16_t>(MAX_NUM_OF_BONES_IN_MODEL))
+                        return false;
 
                 static Quaternion rotations[MAX_NUM_OF_BONES_IN_MODEL];
                 static Vector4d   positions[MAX_NUM_OF_BONES_IN_MODEL];
 
-                uint16_t numBoneTransforms =
-                        (boneTransforms.getSize() > static_cast<uint16_t>(MAX_NUM_OF_BONES_IN_MODEL)) ?
-                        static_cast<uint16_t>(MAX_NUM_OF_BONES_IN_MODEL) : boneTransforms.getSize();
+                uint16_t numBoneTransforms = boneTransforms.getSize();
 
                 for(uint16_t i = 0; i < numBoneTransforms; ++i)
                 {
@@ -533,6 +553,151 @@ namespace selene
                 glUniform4fv(variables.locationBoneRotations, numBoneTransforms,
                              reinterpret_cast<const float*>(rotations));
                 CHECK_GLES_ERROR("GlesActorsRenderer::setSkeletonPose: glUniform4fv");
+                return true;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void GlesActorsRenderer::setVertexAttributes(GlesMesh& glesMesh, const MeshSkinner* meshSkinner,
+                                                     uint8_t meshRenderingUnit, uint8_t pass)
+        {
+                static const uint8_t vertexBufferObjectIndices[NUM_OF_RENDERING_PASSES]
+                                                              [MAX_NUM_OF_VERTEX_ATTRIBUTES_PER_PASS] =
+                {
+                        {
+                                Mesh::VERTEX_STREAM_POSITIONS,
+                                Mesh::VERTEX_STREAM_TBN_BASES,
+                                Mesh::VERTEX_STREAM_TBN_BASES,
+                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES
+                        },
+                        {
+                                Mesh::VERTEX_STREAM_POSITIONS,
+                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES, 0, 0
+                        },
+                        {
+                                Mesh::VERTEX_STREAM_POSITIONS, 0, 0, 0
+                        }
+                };
+                static const uint8_t vertexAttributeLocations[NUM_OF_RENDERING_PASSES]
+                                                             [MAX_NUM_OF_VERTEX_ATTRIBUTES_PER_PASS] =
+                {
+                        {
+                                LOCATION_ATTRIBUTE_POSITION,
+                                LOCATION_ATTRIBUTE_NORMAL,
+                                LOCATION_ATTRIBUTE_TANGENT,
+                                LOCATION_ATTRIBUTE_TEXTURE_COORDINATES
+                        },
+                        {
+                                LOCATION_ATTRIBUTE_POSITION,
+                                LOCATION_ATTRIBUTE_TEXTURE_COORDINATES, 0, 0
+                        },
+                        {
+                                LOCATION_ATTRIBUTE_POSITION, 0, 0, 0
+                        }
+                };
+                static const uint8_t vertexAttributeSizes[NUM_OF_RENDERING_PASSES]
+                                                         [MAX_NUM_OF_VERTEX_ATTRIBUTES_PER_PASS] =
+                {
+                        {3, 3, 4, 2},
+                        {3, 2, 0, 0},
+                        {3, 0, 0, 0}
+                };
+                static const uint8_t numVertexAttributes[NUM_OF_RENDERING_PASSES] = {4, 2, 1};
+
+                const auto& meshData = glesMesh.getData();
+
+                for(uint8_t vertexAttributeNo = 0; vertexAttributeNo < numVertexAttributes[pass]; ++vertexAttributeNo)
+                {
+                        uint8_t vertexBufferObjectIndex = vertexBufferObjectIndices[pass][vertexAttributeNo];
+                        uint8_t vertexAttributeLocation = vertexAttributeLocations[pass][vertexAttributeNo];
+
+                        // skinned streams have the same layout, as positions and TBN bases of the mesh
+                        GLuint vertexBuffer = glesMesh.vertexBuffers_[vertexBufferObjectIndex];
+                        if(meshSkinner != nullptr)
+                        {
+                                if(vertexBufferObjectIndex == Mesh::VERTEX_STREAM_POSITIONS)
+                                        vertexBuffer = skinnedVertexBuffers_[MeshSkinner::SKINNED_STREAM_POSITIONS];
+                                else if(vertexBufferObjectIndex == Mesh::VERTEX_STREAM_TBN_BASES)
+                                        vertexBuffer = skinnedVertexBuffers_[MeshSkinner::SKINNED_STREAM_TBN_BASES];
+                        }
+
+                        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glBindBuffer");
+
+                        glEnableVertexAttribArray(vertexAttributeLocation);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glEnableVertexAttribArray");
+
+                        auto& vertexStream = meshData.vertices[vertexBufferObjectIndex];
+
+                        glVertexAttribPointer(vertexAttributeLocation,
+                                              vertexAttributeSizes[pass][vertexAttributeNo],
+                                              GL_FLOAT, GL_FALSE, vertexStream.getStride(), nullptr);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glVertexAttribPointer");
+                }
+
+                if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN && meshSkinner != nullptr)
+                {
+                        // skinned vertices are transformed by one identity bone
+                        glDisableVertexAttribArray(LOCATION_ATTRIBUTE_BONE_INDICES);
+                        glDisableVertexAttribArray(LOCATION_ATTRIBUTE_BONE_WEIGHTS);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glDisableVertexAttribArray");
+
+                        glVertexAttrib4f(LOCATION_ATTRIBUTE_BONE_INDICES, 0.0f, 0.0f, 0.0f, 0.0f);
+                        glVertexAttrib4f(LOCATION_ATTRIBUTE_BONE_WEIGHTS, 1.0f, 0.0f, 0.0f, 0.0f);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glVertexAttrib4f");
+                }
+                else if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
+                {
+                        auto& vertexBuffer = glesMesh.vertexBuffers_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+                        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glBindBuffer");
+
+                        // set bone indices
+                        glEnableVertexAttribArray(LOCATION_ATTRIBUTE_BONE_INDICES);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glEnableVertexAttribArray");
+
+                        auto& vertexStream = meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
+                        glVertexAttribPointer(LOCATION_ATTRIBUTE_BONE_INDICES, 4,
+                                              GL_FLOAT, GL_FALSE, vertexStream.getStride(), nullptr);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glVertexAttribPointer");
+
+                        // set bone weights
+                        glEnableVertexAttribArray(LOCATION_ATTRIBUTE_BONE_WEIGHTS);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glEnableVertexAttribArray");
+
+                        glVertexAttribPointer(LOCATION_ATTRIBUTE_BONE_WEIGHTS, 4,
+                                              GL_FLOAT, GL_FALSE, vertexStream.getStride(),
+                                              reinterpret_cast<uint8_t*>(sizeof(Vector4d)));
+                        CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glVertexAttribPointer");
+                }
+
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                CHECK_GLES_ERROR("GlesActorsRenderer::setVertexAttributes: glBindBuffer");
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        bool GlesActorsRenderer::uploadSkinnedVertices(const MeshSkinner& meshSkinner)
+        {
+                // vertices are uploaded once per pass, since pose does not change while frame is rendered
+                if(uploadedMeshSkinner_ == &meshSkinner)
+                        return true;
+
+                for(uint8_t i = 0; i < MeshSkinner::NUM_OF_SKINNED_STREAMS; ++i)
+                {
+                        const auto& vertices = meshSkinner.getVertices(i);
+                        if(skinnedVertexBuffers_[i] == 0 || vertices.isEmpty())
+                                return false;
+
+                        glBindBuffer(GL_ARRAY_BUFFER, skinnedVertexBuffers_[i]);
+                        glBufferData(GL_ARRAY_BUFFER, vertices.getSize() * vertices.getStride(),
+                                     &vertices[0], GL_STREAM_DRAW);
+                        CHECK_GLES_ERROR("GlesActorsRenderer::uploadSkinnedVertices: glBufferData");
+                }
+
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                CHECK_GLES_ERROR("GlesActorsRenderer::uploadSkinnedVertices: glBindBuffer");
+
+                uploadedMeshSkinner_ = &meshSkinner;
+                return true;
         }
 
         //------------------------------------------------------------------------------------------------------------
@@ -559,6 +724,9 @@ namespace selene
                                 return;
                 }
 
+                // skinned vertices of the previous pass are stale
+                uploadedMeshSkinner_ = nullptr;
+
                 // walk through all mesh units
                 for(uint8_t meshUnit = 0; meshUnit < Renderer::Data::NUM_OF_MESH_UNITS; ++meshUnit)
                 {
@@ -627,49 +795,6 @@ namespace selene
                                               uint8_t meshRenderingUnit,
                                               uint8_t pass)
         {
-                static const uint8_t vertexBufferObjectIndices[NUM_OF_RENDERING_PASSES]
-                                                              [MAX_NUM_OF_VERTEX_ATTRIBUTES_PER_PASS] =
-                {
-                        {
-                                Mesh::VERTEX_STREAM_POSITIONS,
-                                Mesh::VERTEX_STREAM_TBN_BASES,
-                                Mesh::VERTEX_STREAM_TBN_BASES,
-                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES
-                        },
-                        {
-                                Mesh::VERTEX_STREAM_POSITIONS,
-                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES, 0, 0
-                        },
-                        {
-                                Mesh::VERTEX_STREAM_POSITIONS, 0, 0, 0
-                        }
-                };
-                static const uint8_t vertexAttributeLocations[NUM_OF_RENDERING_PASSES]
-                                                             [MAX_NUM_OF_VERTEX_ATTRIBUTES_PER_PASS] =
-                {
-                        {
-                                LOCATION_ATTRIBUTE_POSITION,
-                                LOCATION_ATTRIBUTE_NORMAL,
-                                LOCATION_ATTRIBUTE_TANGENT,
-                                LOCATION_ATTRIBUTE_TEXTURE_COORDINATES
-                        },
-                        {
-                                LOCATION_ATTRIBUTE_POSITION,
-                                LOCATION_ATTRIBUTE_TEXTURE_COORDINATES, 0, 0
-                        },
-                        {
-                                LOCATION_ATTRIBUTE_POSITION, 0, 0, 0
-                        }
-                };
-                static const uint8_t vertexAttributeSizes[NUM_OF_RENDERING_PASSES]
-                                                         [MAX_NUM_OF_VERTEX_ATTRIBUTES_PER_PASS] =
-                {
-                        {3, 3, 4, 2},
-                        {3, 2, 0, 0},
-                        {3, 0, 0, 0}
-                };
-                static const uint8_t numVertexAttributes[NUM_OF_RENDERING_PASSES] = {4, 2, 1};
-
                 // walk through all meshes
                 for(bool resultMesh = meshNode.readFirstElement(); resultMesh;
                          resultMesh = meshNode.readNextElement())
@@ -683,56 +808,8 @@ namespace selene
                         if(meshSubsetNode == nullptr)
                                 break;
 
-                        const auto& meshData = glesMesh->getData();
-
-                        for(uint8_t vertexAttributeNo = 0; vertexAttributeNo < numVertexAttributes[pass];
-                            ++vertexAttributeNo)
-                        {
-                                uint8_t vertexBufferObjectIndex = vertexBufferObjectIndices[pass][vertexAttributeNo];
-                                uint8_t vertexAttributeLocation = vertexAttributeLocations[pass][vertexAttributeNo];
-
-                                glBindBuffer(GL_ARRAY_BUFFER, glesMesh->vertexBuffers_[vertexBufferObjectIndex]);
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glBindBuffer");
-
-                                glEnableVertexAttribArray(vertexAttributeLocation);
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glEnableVertexAttribArray");
-
-                                auto& vertexStream = meshData.vertices[vertexBufferObjectIndex];
-
-                                glVertexAttribPointer(vertexAttributeLocation,
-                                                      vertexAttributeSizes[pass][vertexAttributeNo],
-                                                      GL_FLOAT, GL_FALSE, vertexStream.getStride(), nullptr);
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glVertexAttribPointer");
-                        }
-
-                        if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
-                        {
-                                auto& vertexBuffer =
-                                        glesMesh->vertexBuffers_[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
-                                glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glBindBuffer");
-
-                                // set bone indices
-                                glEnableVertexAttribArray(LOCATION_ATTRIBUTE_BONE_INDICES);
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glEnableVertexAttribArray");
-
-                                auto& vertexStream =
-                                        meshData.vertices[Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS];
-                                glVertexAttribPointer(LOCATION_ATTRIBUTE_BONE_INDICES, 4,
-                                                      GL_FLOAT, GL_FALSE, vertexStream.getStride(), nullptr);
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glVertexAttribPointer");
-
-                                // set bone weights
-                                glEnableVertexAttribArray(LOCATION_ATTRIBUTE_BONE_WEIGHTS);
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glEnableVertexAttribArray");
-
-                                glVertexAttribPointer(LOCATION_ATTRIBUTE_BONE_WEIGHTS, 4,
-                                                      GL_FLOAT, GL_FALSE, vertexStream.getStride(),
-                                                      reinterpret_cast<uint8_t*>(sizeof(Vector4d)));
-                                CHECK_GLES_ERROR("GlesActorsRenderer::renderActors:glVertexAttribPointer");
-                        }
+                        setVertexAttributes(*glesMesh, nullptr, meshRenderingUnit, pass);
 
-                        glBindBuffer(GL_ARRAY_BUFFER, 0);
                         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glesMesh->indexBuffer_);
                         CHECK_GLES_ERROR("GlesActorsRenderer::renderActors: glBindBuffer");
 
@@ -746,7 +823,7 @@ namespace selene
                                 if(meshSubset == nullptr || renderingList == nullptr)
                                         break;
 
-                                renderMeshSubsetInstances(*renderingList, variables, *meshSubset,
+                                renderMeshSubsetInstances(*renderingList, variables, *glesMesh, *meshSubset,
                                                           meshRenderingUnit, pass);
                         }
                 }
@@ -755,13 +832,53 @@ namespace selene
         //------------------------------------------------------------------------------------------------------------
         void GlesActorsRenderer::renderMeshSubsetInstances(const Renderer::Data::List<Actor::Instance>& renderingList,
                                                            const GlesActorsRenderer::Variables& variables,
+                                                           GlesMesh& glesMesh,
                                                            const Mesh::Subset& meshSubset,
                                                            uint8_t meshRenderingUnit,
                                                            uint8_t pass)
         {
+                static const Quaternion identityRotation;
+                static const Vector4d zeroPosition;
+                bool areSkinnedVerticesBound = false;
+
                 const auto& instances = renderingList.getElements();
                 for(auto it = instances.begin(); it != instances.end(); ++it)
                 {
+                        if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
+                        {
+                                const MeshSkinner* meshSkinner = (*it).getMeshSkinner();
+
+                                if(meshSkinner != nullptr)
+                                {
+                                        if(!uploadSkinnedVertices(*meshSkinner))
+                                                continue;
+
+                                        // skinned vertex buffers remain bound, while their data changes
+                                        if(!areSkinnedVerticesBound)
+                                                setVertexAttributes(glesMesh, meshSkinner, meshRenderingUnit, pass);
+
+                                        glUniform4fv(variables.locationBonePositions, 1,
+                                                     static_cast<const float*>(zeroPosition));
+                                        glUniform4fv(variables.locationBoneRotations, 1,
+                                                     reinterpret_cast<const float*>(&identityRotation));
+                                        CHECK_GLES_ERROR("GlesActorsRenderer::renderMeshSubsetInstances: glUniform4fv");
+
+                                        areSkinnedVerticesBound = true;
+                                }
+                                else
+                                {
+                                        if(areSkinnedVerticesBound)
+                                        {
+                                                setVertexAttributes(glesMesh, nullptr, meshRenderingUnit, pass);
+                                                areSkinnedVerticesBound = false;
+                                        }
+
+                                        if(!setSkeletonPose((*it).getSkeletonInstance()->getFinalBoneTransforms(),
+                                                            variables))
+                                                continue;
+                                }
+                        }
+
                         const auto& transform = (*it).getViewProjectionTransform();
                         glUniformMatrix4fv(variables.locationWorldViewProjectionMatrix, 1, GL_FALSE,
                                            static_cast<const float*>(transform.getWorldViewProjectionMatrix()));
@@ -773,13 +890,28 @@ namespace selene
                                 CHECK_GLES_ERROR("GlesActorsRenderer::renderMeshSubsetInstances: glUniformMatrix4fv");
                         }
 
-                        if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
-                                setSkeletonPose((*it).getSkeletonInstance()->getFinalBoneTransforms(), variables);
+                        // only faces of the visible clusters are drawn, if instance holds ranges of the faces
+                        if((*it).getFaceRanges() == nullptr)
+                        {
+                                glDrawElements(GL_TRIANGLES, 3 * meshSubset.numFaces, GL_UNSIGNED_SHORT,
+                                               reinterpret_cast<uint8_t*>(3 * meshSubset.faceIndex * sizeof(uint16_t)));
+                                CHECK_GLES_ERROR("GlesActorsRenderer::renderMeshSubsetInstances: glDrawElements");
+                                continue;
+                        }
 
-                        glDrawElements(GL_TRIANGLES, 3 * meshSubset.numFaces, GL_UNSIGNED_SHORT,
-                                       reinterpret_cast<uint8_t*>(3 * meshSubset.faceIndex * sizeof(uint16_t)));
-                        CHECK_GLES_ERROR("GlesActorsRenderer::renderMeshSubsetInstances: glDrawElements");
+                        const Mesh::FaceRange* faceRanges = (*it).getFaceRanges();
+                        for(uint32_t i = 0; i < (*it).getNumFaceRanges(); ++i)
+                        {
+                                glDrawElements(GL_TRIANGLES, 3 * faceRanges[i].numFaces, GL_UNSIGNED_SHORT,
+                                               reinterpret_cast<uint8_t*>(3 * faceRanges[i].faceIndex *
+                                                                          sizeof(uint16_t)));
+                                CHECK_GLES_ERROR("GlesActorsRenderer::renderMeshSubsetInstances: glDrawElements");
+                        }
                 }
+
+                // next mesh subsets are rendered with vertex buffers of the mesh
+                if(areSkinnedVerticesBound)
+                        setVertexAttributes(glesMesh, nullptr, meshRenderingUnit, pass);
         }
 
 }
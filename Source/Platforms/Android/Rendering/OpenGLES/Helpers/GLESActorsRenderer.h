@@ -4,6 +4,7 @@
 #ifndef GLES_ACTORS_RENDERER_H
 #define GLES_ACTORS_RENDERER_H
 
+#include "../../../../../Engine/Core/Resources/Mesh/MeshSkinner.h"
 #include "../../../../../Engine/Core/Resources/Mesh/Mesh.h"
 #include "../../../../../Engine/Rendering/Renderer.h"
 #include "GLESGLSLProgram.h"
@@ -20,13 +21,25 @@ namespace selene
         class GlesRenderTargetContainer;
         class GlesFrameParameters;
         class GlesTextureHandler;
+        class GlesMesh;
 
         /**
          * Represents actors renderer. Renders positions map, normals map, shadow map and shading.
+         *
+         * Instances of the skin meshes, which have been skinned on the CPU (see Actor::Instance::getMeshSkinner),
+         * are rendered with skinned vertices, which are uploaded to the stream vertex buffers, and with one
+         * identity bone. Instances, whose skeletons have more bones than MAX_NUM_OF_BONES_IN_MODEL and which have
+         * not been skinned on the CPU, are not rendered.
          */
         class GlesActorsRenderer
         {
         public:
+                /// Maximum number of bones, which can be held by skinning shaders
+                enum
+                {
+                        MAX_NUM_OF_BONES_IN_MODEL = 50
+                };
+
                 GlesActorsRenderer();
                 GlesActorsRenderer(const GlesActorsRenderer&) = delete;
                 ~GlesActorsRenderer();
@@ -84,7 +97,6 @@ namespace selene
                         NUM_OF_GLSL_PROGRAMS,
 
                         MAX_NUM_OF_VERTEX_ATTRIBUTES_PER_PASS = 4,
-                        MAX_NUM_OF_BONES_IN_MODEL = 50,
 
                         LOCATION_ATTRIBUTE_POSITION = 0,
                         LOCATION_ATTRIBUTE_NORMAL,
@@ -139,6 +151,9 @@ namespace selene
                 GlesFrameParameters* frameParameters_;
                 GlesTextureHandler* textureHandler_;
 
+                GLuint skinnedVertexBuffers_[MeshSkinner::NUM_OF_SKINNED_STREAMS];
+                const MeshSkinner* uploadedMeshSkinner_;
+
                 /**
                  * \brief Sets material.
                  * \param[in] material material, which will be set
@@ -152,10 +167,29 @@ namespace selene
                  * \brief Sets skeleton pose.
                  * \param[in] boneTransforms bone transforms in world space
                  * \param[in] variables container of the variables' locations
+                 * \return true if skeleton pose has been set (false if there are too many bones)
                  */
-                void setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms,
+                bool setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms,
                                      const GlesActorsRenderer::Variables& variables);
 
+                /**
+                 * \brief Sets vertex attributes.
+                 * \param[in] glesMesh mesh, whose vertex buffers are used
+                 * \param[in] meshSkinner mesh skinner, whose skinned vertices are used instead of positions and TBN
+                 * bases of the mesh (if nullptr, then only vertex buffers of the mesh are used)
+                 * \param[in] meshRenderingUnit mesh rendering unit
+                 * \param[in] pass rendering pass
+                 */
+                void setVertexAttributes(GlesMesh& glesMesh, const MeshSkinner* meshSkinner,
+                                         uint8_t meshRenderingUnit, uint8_t pass);
+
+                /**
+                 * \brief Uploads skinned vertices to the stream vertex buffers.
+                 * \param[in] meshSkinner mesh skinner, which holds skinned vertices
+                 * \return true if skinned vertices have been successfully uploaded
+                 */
+                bool uploadSkinnedVertices(const MeshSkinner& meshSkinner);
+
                 /**
                  * \brief Renders actors from given node.
                  * \param[in] actorNode actor node
@@ -180,12 +214,14 @@ namespace selene
                  * \param[in] renderingList rendering list, which contains view-projection
                  * transforms of the given mesh subset
                  * \param[in] variables container of the variables' locations
+                 * \param[in] glesMesh mesh, which contains given subset
                  * \param[in] meshSubset subset of the mesh
                  * \param[in] meshRenderingUnit mesh rendering unit
                  * \param[in] pass rendering pass
                  */
                 void renderMeshSubsetInstances(const Renderer::Data::List<Actor::Instance>& renderingList,
                                                const GlesActorsRenderer::Variables& variables,
+                                               GlesMesh& glesMesh,
                                                const Mesh::Subset& meshSubset,
                                                uint8_t meshRenderingUnit,
                                                uint8_t pass);
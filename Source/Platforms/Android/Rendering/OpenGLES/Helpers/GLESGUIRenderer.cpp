@@ -12,7 +12,8 @@ namespace selene
 
         GlesGuiRenderer::GlesGuiRenderer():
                 framesRenderingProgram_(), textRenderingProgram_(),
-                fontTextureLocation_(-1), fontTexture_(), textureHandler_(nullptr) {}
+                fontTextureLocation_(-1), fontTexture_(), textureHandler_(nullptr),
+                geometryBuilder_(), vertexBuffer_(0), uploadedRevision_(0) {}
         GlesGuiRenderer::~GlesGuiRenderer()
         {
                 destroy();
@@ -95,6 +96,12 @@ namespace selene
                 fontTextureLocation_ = textRenderingProgram_.getUniformLocation("fontTexture");
                 CHECK_GLES_ERROR("GlesGuiRenderer::retain: glGetUniformLocation");
 
+                glGenBuffers(1, &vertexBuffer_);
+                CHECK_GLES_ERROR("GlesGuiRenderer::retain: glGenBuffers");
+
+                // geometry is uploaded to the new vertex buffer on the next frame
+                geometryBuilder_.clear();
+
                 return true;
         }
 
@@ -107,38 +114,40 @@ namespace selene
                 textRenderingProgram_.destroy();
 
                 fontTextureLocation_ = -1;
+
+                if(vertexBuffer_ != 0)
+                        glDeleteBuffers(1, &vertexBuffer_);
+
+                vertexBuffer_ = 0;
+                geometryBuilder_.clear();
         }
 
         //----------------------------------------------------------------------------------------------------------
         void GlesGuiRenderer::renderGui(Gui* gui)
         {
-                if(gui == nullptr)
+                if(gui == nullptr || vertexBuffer_ == 0)
                         return;
 
-                const auto& elements = gui->getElements();
+                geometryBuilder_.build(*gui);
 
-                const uint32_t numFramesPerBatch   = 50;
-                const uint32_t numVerticesPerFrame = 6;
-                const uint32_t numVectorsPerVertex = 2;
-                const float characterSize = 0.0625f;
-                static Vector4d frameVertices[numVectorsPerVertex * numFramesPerBatch * numVerticesPerFrame];
-                static uint32_t vertexIndices[numVerticesPerFrame] = {0, 2, 1, 2, 3, 1};
+                uint32_t numVertices = geometryBuilder_.getNumVertices();
+                if(numVertices == 0)
+                        return;
 
-                static Vector2d vertexOffsets[] =
-                {
-                        Vector2d(),
-                        Vector2d(),
-                        Vector2d(),
-                        Vector2d()
-                };
+                const uint32_t vertexStride = GuiGeometryBuilder::NUM_OF_VECTORS_PER_VERTEX * sizeof(Vector4d);
 
-                static Vector2d fontOffsets[4] =
+                glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+                CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glBindBuffer");
+
+                // geometry is uploaded only when it has been changed
+                if(uploadedRevision_ != geometryBuilder_.getRevision())
                 {
-                        Vector2d(0.0f, 0.0f),
-                        Vector2d(characterSize, 0.0f),
-                        Vector2d(0.0f, characterSize),
-                        Vector2d(characterSize, characterSize)
-                };
+                        glBufferData(GL_ARRAY_BUFFER, numVertices * vertexStride,
+                                     geometryBuilder_.getVertices(), GL_DYNAMIC_DRAW);
+                        CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glBufferData");
+
+                        uploadedRevision_ = geometryBuilder_.getRevision();
+                }
 
                 glDisable(GL_DEPTH_TEST);
                 CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glDisable");
@@ -149,72 +158,23 @@ namespace selene
                 glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
                 CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glBlendFunc");
 
-                // render frames
-                framesRenderingProgram_.set();
-                CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glUseProgram");
-
                 glEnableVertexAttribArray(LOCATION_ATTRIBUTE_POSITION);
                 CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glEnableVertexAttribArray");
 
                 glEnableVertexAttribArray(LOCATION_ATTRIBUTE_COLOR);
                 CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glEnableVertexAttribArray");
 
-                uint32_t numFrames = 0;
-                Vector4d* currentVertex = frameVertices;
-                for(auto it = elements.begin(); it != elements.end(); ++it)
-                {
-                        if(!it->second)
-                                continue;
-
-                        auto element = it->second.get();
-                        if(element->is(GUI_ELEMENT_HIDDEN))
-                                continue;
-
-                        Vector4d color = element->getBackgroundColor(GUI_ELEMENT_COLOR_DEFAULT);
-
-                        if(element->is(GUI_ELEMENT_SELECTED))
-                                color = element->getBackgroundColor(GUI_ELEMENT_COLOR_SELECTED);
-                        else if(element->is(GUI_ELEMENT_TOUCHED))
-                                color = element->getBackgroundColor(GUI_ELEMENT_COLOR_TOUCHED);
-
-                        const auto& size = element->getSize();
-                        const auto& position = element->getPosition();
-
-                        vertexOffsets[1] = Vector2d(size.x, 0.0f);
-                        vertexOffsets[2] = Vector2d(0.0f, size.y);
-                        vertexOffsets[3] = Vector2d(size.x, size.y);
-
-                        for(uint32_t i = 0; i < numVerticesPerFrame; ++i)
-                        {
-                                currentVertex->define(position + vertexOffsets[vertexIndices[i]], 0.0f, 1.0f);
-                                ++currentVertex;
-                                *currentVertex = color;
-                                ++currentVertex;
-                        }
-
-                        ++numFrames;
-
-                        if(numFrames == numFramesPerBatch)
-                        {
-                                glVertexAttribPointer(LOCATION_ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE,
-                                                      2 * sizeof(Vector4d), static_cast<void*>(frameVertices));
-                                glVertexAttribPointer(LOCATION_ATTRIBUTE_COLOR,    4, GL_FLOAT, GL_FALSE,
-                                                      2 * sizeof(Vector4d), static_cast<void*>(frameVertices + 1));
-                                glDrawArrays(GL_TRIANGLES, 0, numFrames * numVerticesPerFrame);
-
-                                numFrames = 0;
-                                currentVertex = frameVertices;
-                        }
-                }
+                glVertexAttribPointer(LOCATION_ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE, vertexStride,
+                                      reinterpret_cast<void*>(0));
+                glVertexAttribPointer(LOCATION_ATTRIBUTE_COLOR,    4, GL_FLOAT, GL_FALSE, vertexStride,
+                                      reinterpret_cast<void*>(sizeof(Vector4d)));
+                CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glVertexAttribPointer");
 
-                if(numFrames != 0)
-                {
-                        glVertexAttribPointer(LOCATION_ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE,
-                                              2 * sizeof(Vector4d), static_cast<void*>(frameVertices));
-                        glVertexAttribPointer(LOCATION_ATTRIBUTE_COLOR,    4, GL_FLOAT, GL_FALSE,
-                                              2 * sizeof(Vector4d), static_cast<void*>(frameVertices + 1));
-                        glDrawArrays(GL_TRIANGLES, 0, numFrames * numVerticesPerFrame);
-                }
+                // render frames
+                framesRenderingProgram_.set();
+                CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glUseProgram");
+
+                renderBatch(GuiGeometryBuilder::GEOMETRY_BATCH_FRAMES);
 
                 // render text
                 textRenderingProgram_.set();
@@ -225,88 +185,29 @@ namespace selene
                 textureHandler_->setTexture(fontTexture_.get(), 0, GlesTextureHandler::DUMMY_TEXTURE_WHITE);
                 textureHandler_->setSamplerState(0, GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
 
-                numFrames = 0;
-                currentVertex = frameVertices;
-                for(auto it = elements.begin(); it != elements.end(); ++it)
-                {
-                        if(!it->second)
-                                continue;
-
-                        auto element = it->second.get();
-                        if(element->is(GUI_ELEMENT_HIDDEN))
-                                continue;
-
-                        const std::string& text = element->getText();
-                        if(text.length() == 0)
-                                continue;
-
-                        Vector4d textColor = element->getTextColor(GUI_ELEMENT_COLOR_DEFAULT);
-
-                        if(element->is(GUI_ELEMENT_SELECTED))
-                                textColor = element->getTextColor(GUI_ELEMENT_COLOR_SELECTED);
-                        else if(element->is(GUI_ELEMENT_TOUCHED))
-                                textColor = element->getTextColor(GUI_ELEMENT_COLOR_TOUCHED);
-
-                        const auto& fontSize = element->getFontSize();
-                        vertexOffsets[1] = Vector2d(fontSize.x, 0.0f);
-                        vertexOffsets[2] = Vector2d(0.0f, fontSize.y);
-                        vertexOffsets[3] = Vector2d(fontSize.x, fontSize.y);
-
-                        auto position = element->getPosition();
-                        float elementRightBoundary = element->getSize().x + position.x;
-
-                        for(size_t i = 0; i < text.length(); ++i)
-                        {
-                                uint8_t c = text[i];
-                                Vector2d textureCoordinates(static_cast<float>(c % 16) * characterSize,
-                                                            static_cast<float>(c >> 4) * characterSize);
-
-                                for(uint32_t j = 0; j < numVerticesPerFrame; ++j)
-                                {
-                                        currentVertex->define(position + vertexOffsets[vertexIndices[j]],
-                                                              textureCoordinates + fontOffsets[vertexIndices[j]]);
-                                        ++currentVertex;
-                                        *currentVertex = textColor;
-                                        ++currentVertex;
-                                }
-
-                                ++numFrames;
-
-                                if(numFrames == numFramesPerBatch)
-                                {
-                                        glVertexAttribPointer(LOCATION_ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE,
-                                                              2 * sizeof(Vector4d),
-                                                              static_cast<void*>(frameVertices));
-                                        glVertexAttribPointer(LOCATION_ATTRIBUTE_COLOR, 4, GL_FLOAT, GL_FALSE,
-                                                              2 * sizeof(Vector4d),
-                                                              static_cast<void*>(frameVertices + 1));
-                                        glDrawArrays(GL_TRIANGLES, 0, numFrames * numVerticesPerFrame);
-
-                                        numFrames = 0;
-                                        currentVertex = frameVertices;
-                                }
-
-                                position.x += fontSize.x;
-                                if(position.x >= elementRightBoundary)
-                                        break;
-                        }
-                }
-
-                if(numFrames != 0)
-                {
-                        glVertexAttribPointer(LOCATION_ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE,
-                                              2 * sizeof(Vector4d), static_cast<void*>(frameVertices));
-                        glVertexAttribPointer(LOCATION_ATTRIBUTE_COLOR,    4, GL_FLOAT, GL_FALSE,
-                                              2 * sizeof(Vector4d), static_cast<void*>(frameVertices + 1));
-                        glDrawArrays(GL_TRIANGLES, 0, numFrames * numVerticesPerFrame);
-                }
+                renderBatch(GuiGeometryBuilder::GEOMETRY_BATCH_TEXT);
 
                 glDisableVertexAttribArray(LOCATION_ATTRIBUTE_POSITION);
                 glDisableVertexAttribArray(LOCATION_ATTRIBUTE_COLOR);
                 CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glDisableVertexAttribArray");
 
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glBindBuffer");
+
                 glDisable(GL_BLEND);
                 CHECK_GLES_ERROR("GlesGuiRenderer::renderGui: glDisable");
         }
 
+        //----------------------------------------------------------------------------------------------------------
+        void GlesGuiRenderer::renderBatch(uint8_t batch)
+        {
+                uint32_t numQuads = geometryBuilder_.getNumQuads(batch);
+                if(numQuads == 0)
+                        return;
+
+                glDrawArrays(GL_TRIANGLES, geometryBuilder_.getFirstVertex(batch),
+                             numQuads * GuiGeometryBuilder::NUM_OF_VERTICES_PER_QUAD);
+                CHECK_GLES_ERROR("GlesGuiRenderer::renderBatch: glDrawArrays");
+        }
+
 }
@@ -4,7 +4,7 @@
 #ifndef GLES_GUI_RENDERER_H
 #define GLES_GUI_RENDERER_H
 
-#include "../../../../../Engine/Core/Math/Vector.h"
+#include "../../../../../Engine/GUI/GUIGeometryBuilder.h"
 #include "../Resources/GLESTexture.h"
 #include "GLESGLSLProgram.h"
 
@@ -19,10 +19,10 @@ namespace selene
         // Forward declaration of classes
         class GlesTextureHandler;
         class FileManager;
-        class Gui;
 
         /**
-         * Represents OpenGL ES GUI renderer.
+         * Represents OpenGL ES GUI renderer. Geometry of the GUI is built by the GuiGeometryBuilder, and it
+         * is uploaded to the vertex buffer only when it has been changed.
          */
         class GlesGuiRenderer
         {
@@ -68,12 +68,15 @@ namespace selene
 
                 GlesTextureHandler* textureHandler_;
 
+                GuiGeometryBuilder geometryBuilder_;
+                GLuint vertexBuffer_;
+                uint32_t uploadedRevision_;
+
                 /**
-                 * \brief Renders GUI geometry.
-                 * \param[in] vertices array of vertices
-                 * \param[in] numFrames number of frames to render
+                 * \brief Renders batch of the GUI geometry.
+                 * \param[in] batch batch (must be one of the selene::GuiGeometryBuilder::GEOMETRY_BATCH)
                  */
-                void renderGeometry(const Vector4d* vertices, uint32_t numFrames);
+                void renderBatch(uint8_t batch);
 
         };
 
@@ -5,6 +5,11 @@
 #include <iostream>
 #include <fstream>
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace selene
 {
 
@@ -104,9 +109,62 @@ namespace selene
                 return 0.1f;
         }
 
+        Platform::FileManager::MappedFile::MappedFile(uint8_t* data, uint32_t size):
+                selene::MappedFile(data, size) {}
+        Platform::FileManager::MappedFile::~MappedFile()
+        {
+                if(data_ != nullptr)
+                        munmap(data_, size_);
+        }
+
         Platform::FileManager::FileManager(): selene::FileManager(Platform::fileExists) {}
         Platform::FileManager::~FileManager() {}
 
+        //------------------------------------------------------------------------------------
+        std::shared_ptr<selene::MappedFile> Platform::FileManager::map(const char* fileName) const
+        {
+                int file = -1;
+
+                {
+                        std::lock_guard<std::mutex> lock(mutex_);
+
+                        const char* fullFileName = find(fileName);
+                        if(fullFileName == nullptr)
+                                return std::shared_ptr<selene::MappedFile>();
+
+                        file = ::open(fullFileName, O_RDONLY);
+                }
+
+                if(file < 0)
+                        return std::shared_ptr<selene::MappedFile>();
+
+                struct stat fileStatus;
+                if(fstat(file, &fileStatus) != 0 || fileStatus.st_size <= 0 ||
+                   static_cast<uint64_t>(fileStatus.st_size) > 0xFFFFFFFFU)
+                {
+                        SAFE_CLOSE(file);
+                        return std::shared_ptr<selene::MappedFile>();
+                }
+
+                // pages are mapped privately, so they can be modified without changing the file
+                uint32_t size = static_cast<uint32_t>(fileStatus.st_size);
+                void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+
+                // mapping remains valid after file is closed
+                SAFE_CLOSE(file);
+
+                if(data == MAP_FAILED)
+                        return std::shared_ptr<selene::MappedFile>();
+
+                std::shared_ptr<selene::MappedFile> mappedFile(new(std::nothrow)
+                        MappedFile(static_cast<uint8_t*>(data), size));
+
+                if(!mappedFile)
+                        munmap(data, size);
+
+                return mappedFile;
+        }
+
         //------------------------------------------------------------------------------------
         bool Platform::fileExists(const char* fileName)
         {
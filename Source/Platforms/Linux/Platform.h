@@ -146,15 +146,37 @@ namespace selene
 
                 /**
                  * Represents file manager. This file manager handles platform-dependent file management.
+                 * Files are mapped into memory with mmap.
                  */
                 class FileManager: public selene::FileManager
                 {
                 public:
+                        /**
+                         * Represents mapped file. Unmaps pages when destroyed.
+                         */
+                        class MappedFile: public selene::MappedFile
+                        {
+                        public:
+                                /**
+                                 * \brief Constructs mapped file with given mapped pages.
+                                 * \param[in] data pointer to the mapped pages
+                                 * \param[in] size size of the file in bytes
+                                 */
+                                MappedFile(uint8_t* data, uint32_t size);
+                                MappedFile(const MappedFile&) = delete;
+                                ~MappedFile();
+                                MappedFile& operator =(const MappedFile&) = delete;
+
+                        };
+
                         FileManager();
                         FileManager(const FileManager&) = delete;
                         ~FileManager();
                         FileManager& operator =(const FileManager&) = delete;
 
+                        // selene::FileManager interface implementation
+                        std::shared_ptr<selene::MappedFile> map(const char* fileName) const;
+
                 };
 
                 /**
@@ -59,7 +59,13 @@ namespace selene
                 if(capabilities_.isR32fRenderTargetFormatSupported())
                         writeLogEntry("note: R32F texture format is supported");
 
-                return initializeHelpers();
+                if(!initializeHelpers())
+                        return false;
+
+                // larger skeletons are skinned on the CPU
+                maxNumBonesInModel_ = D3d9ActorsRenderer::MAX_NUM_OF_BONES_IN_MODEL;
+
+                return true;
         }
 
         //----------------------------------------------------------------------------------------------------------
@@ -111,17 +117,23 @@ namespace selene
                                                            projectionInvMatrix.a[1][1],
                                                            1.0, 0.0);
 
-                const auto& ssao    = camera.getEffect("SSAO");
-                const auto& bloom   = camera.getEffect("Bloom");
-                const auto& shadows = camera.getEffect("Shadows");
+                // get effects (identifiers of the names are computed at compile time)
+                static constexpr Name ssaoName("SSAO"), bloomName("Bloom"), shadowsName("Shadows");
+                static constexpr Name radiusName("Radius"), normalInfluenceBiasName("Normal influence bias");
+                static constexpr Name minCosAlphaName("Minimum cosine alpha");
+                static constexpr Name luminanceName("Luminance"), scaleName("Scale");
+
+                const auto& ssao    = camera.getEffect(ssaoName);
+                const auto& bloom   = camera.getEffect(bloomName);
+                const auto& shadows = camera.getEffect(shadowsName);
 
-                frameParameters_.ssaoParameters.x = ssao.getParameter("Radius").getValue();
-                frameParameters_.ssaoParameters.y = ssao.getParameter("Normal influence bias").getValue();
-                frameParameters_.ssaoParameters.z = ssao.getParameter("Minimum cosine alpha").getValue();
+                frameParameters_.ssaoParameters.x = ssao.getParameter(radiusName).getValue();
+                frameParameters_.ssaoParameters.y = ssao.getParameter(normalInfluenceBiasName).getValue();
+                frameParameters_.ssaoParameters.z = ssao.getParameter(minCosAlphaName).getValue();
                 frameParameters_.ssaoQuality = ssao.getQuality();
 
-                frameParameters_.bloomParameters.define(bloom.getParameter("Luminance").getValue(),
-                                                        bloom.getParameter("Scale").getValue(),
+                frameParameters_.bloomParameters.define(bloom.getParameter(luminanceName).getValue(),
+                                                        bloom.getParameter(scaleName).getValue(),
                                                         0.18f, 0.64f);
                 frameParameters_.bloomQuality = bloom.getQuality();
 
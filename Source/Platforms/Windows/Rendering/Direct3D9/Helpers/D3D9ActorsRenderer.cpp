@@ -6,12 +6,23 @@
 #include "../Resources/D3D9Mesh.h"
 #include "../D3D9Renderer.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace selene
 {
 
         D3d9ActorsRenderer::D3d9ActorsRenderer():
                 d3dMeshVertexDeclaration_(nullptr), d3dDevice_(nullptr), renderTargetContainer_(nullptr),
-                frameParameters_(nullptr), textureHandler_(nullptr), capabilities_(nullptr) {}
+                frameParameters_(nullptr), textureHandler_(nullptr), capabilities_(nullptr),
+                uploadedMeshSkinner_(nullptr)
+        {
+                for(uint8_t i = 0; i < MeshSkinner::NUM_OF_SKINNED_STREAMS; ++i)
+                {
+                        d3dSkinnedVertexBuffers_[i] = nullptr;
+                        skinnedVertexBufferCapacities_[i] = 0;
+                }
+        }
         D3d9ActorsRenderer::~D3d9ActorsRenderer()
         {
                 destroy();
@@ -740,6 +751,14 @@ namespace selene
                 for(uint8_t i = 0; i < NUM_OF_PIXEL_SHADERS; ++i)
                         pixelShaders_[i].destroy();
 
+                for(uint8_t i = 0; i < MeshSkinner::NUM_OF_SKINNED_STREAMS; ++i)
+                {
+                        SAFE_RELEASE(d3dSkinnedVertexBuffers_[i]);
+                        skinnedVertexBufferCapacities_[i] = 0;
+                }
+
+                uploadedMeshSkinner_ = nullptr;
+
                 SAFE_RELEASE(d3dMeshVertexDeclaration_);
                 d3dDevice_ = nullptr;
 
@@ -969,17 +988,19 @@ namespace selene
         }
 
         //------------------------------------------------------------------------------------------------------------
-        void D3d9ActorsRenderer::setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms)
+        bool D3d9ActorsRenderer::setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms)
         {
                 if(boneTransforms.isEmpty())
-                        return;
+                        return true;
+
+                // truncated pose would distort the mesh, such meshes must be skinned on the CPU
+                if(boneTransforms.getSize() > static_cast<uint16_t>(MAX_NUM_OF_BONES_IN_MODEL))
+                        return false;
 
                 static Quaternion rotations[MAX_NUM_OF_BONES_IN_MODEL];
                 static Vector4d   positions[MAX_NUM_OF_BONES_IN_MODEL];
 
-                uint16_t numBoneTransforms =
-                        (boneTransforms.getSize() > static_cast<uint16_t>(MAX_NUM_OF_BONES_IN_MODEL)) ?
-                        static_cast<uint16_t>(MAX_NUM_OF_BONES_IN_MODEL) : boneTransforms.getSize();
+                uint16_t numBoneTransforms = boneTransforms.getSize();
 
                 for(uint16_t i = 0; i < numBoneTransforms; ++i)
                 {
@@ -993,6 +1014,105 @@ namespace selene
                 d3dDevice_->SetVertexShaderConstantF(LOCATION_BONE_POSITIONS,
                                                      reinterpret_cast<const float*>(positions),
                                                      numBoneTransforms);
+                return true;
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        void D3d9ActorsRenderer::setVertexStreams(D3d9Mesh& d3dMesh, const MeshSkinner* meshSkinner,
+                                                  uint8_t meshRenderingUnit, uint8_t pass)
+        {
+                static const uint8_t vertexStreamIndices[NUM_OF_RENDERING_PASSES][MAX_VERTEX_STREAMS_PER_PASS] =
+                {
+                        {Mesh::VERTEX_STREAM_POSITIONS, 0, 0},
+                        {
+                                Mesh::VERTEX_STREAM_POSITIONS,
+                                Mesh::VERTEX_STREAM_TBN_BASES,
+                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES
+                        },
+                        {
+                                Mesh::VERTEX_STREAM_POSITIONS,
+                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES, 0
+                        },
+                        {
+                                Mesh::VERTEX_STREAM_POSITIONS,
+                                Mesh::VERTEX_STREAM_TBN_BASES,
+                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES
+                        }
+                };
+                static const uint8_t numVertexStreams[NUM_OF_RENDERING_PASSES] = {1, 3, 2, 3};
+
+                const auto& meshData = d3dMesh.getData();
+
+                for(uint8_t vertexStream = 0; vertexStream < numVertexStreams[pass]; ++vertexStream)
+                {
+                        UINT streamNo = vertexStreamIndices[pass][vertexStream];
+
+                        // skinned streams have the same layout, as positions and TBN bases of the mesh
+                        LPDIRECT3DVERTEXBUFFER9 d3dVertexBuffer = d3dMesh.d3dVertexBuffers_[streamNo];
+                        if(meshSkinner != nullptr && streamNo == Mesh::VERTEX_STREAM_POSITIONS)
+                                d3dVertexBuffer = d3dSkinnedVertexBuffers_[MeshSkinner::SKINNED_STREAM_POSITIONS];
+                        else if(meshSkinner != nullptr && streamNo == Mesh::VERTEX_STREAM_TBN_BASES)
+                                d3dVertexBuffer = d3dSkinnedVertexBuffers_[MeshSkinner::SKINNED_STREAM_TBN_BASES];
+
+                        d3dDevice_->SetStreamSource(streamNo, d3dVertexBuffer, 0,
+                                                    meshData.vertices[streamNo].getStride());
+                }
+
+                if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
+                {
+                        UINT streamNo = Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS;
+                        d3dDevice_->SetStreamSource(streamNo, d3dMesh.d3dVertexBuffers_[streamNo], 0,
+                                                    meshData.vertices[streamNo].getStride());
+                }
+        }
+
+        //------------------------------------------------------------------------------------------------------------
+        bool D3d9ActorsRenderer::uploadSkinnedVertices(const MeshSkinner& meshSkinner)
+        {
+                // vertices are uploaded once per pass, since pose does not change while frame is rendered
+                if(uploadedMeshSkinner_ == &meshSkinner)
+                        return true;
+
+                uploadedMeshSkinner_ = nullptr;
+
+                for(uint8_t i = 0; i < MeshSkinner::NUM_OF_SKINNED_STREAMS; ++i)
+                {
+                        const auto& vertices = meshSkinner.getVertices(i);
+                        uint32_t size = vertices.getSize() * vertices.getStride();
+                        if(size == 0)
+                                return false;
+
+                        // vertex buffer grows when vertices do not fit
+                        if(size > skinnedVertexBufferCapacities_[i])
+                        {
+                                uint32_t& capacity = skinnedVertexBufferCapacities_[i];
+
+                                SAFE_RELEASE(d3dSkinnedVertexBuffers_[i]);
+                                capacity = std::max(size, 2 * capacity);
+
+                                if(FAILED(d3dDevice_->CreateVertexBuffer(capacity,
+                                                                         D3DUSAGE_WRITEONLY | D3DUSAGE_DYNAMIC,
+                                                                         0, D3DPOOL_DEFAULT,
+                                                                         &d3dSkinnedVertexBuffers_[i], nullptr)))
+                                {
+                                        d3dSkinnedVertexBuffers_[i] = nullptr;
+                                        capacity = 0;
+                                        return false;
+                                }
+                        }
+
+                        uint8_t* destinationBuffer = nullptr;
+                        if(FAILED(d3dSkinnedVertexBuffers_[i]->Lock(0, size,
+                                                                     reinterpret_cast<void**>(&destinationBuffer),
+                                                                     D3DLOCK_DISCARD)))
+                                return false;
+
+                        memcpy(destinationBuffer, &vertices[0], size);
+                        d3dSkinnedVertexBuffers_[i]->Unlock();
+                }
+
+                uploadedMeshSkinner_ = &meshSkinner;
+                return true;
         }
 
         //------------------------------------------------------------------------------------------------------------
@@ -1026,6 +1146,9 @@ namespace selene
                                 return;
                 }
 
+                // skinned vertices of the previous pass are stale
+                uploadedMeshSkinner_ = nullptr;
+
                 // walk through all mesh units
                 for(uint8_t meshUnit = 0; meshUnit < Renderer::Data::NUM_OF_MESH_UNITS; ++meshUnit)
                 {
@@ -1051,7 +1174,7 @@ namespace selene
                                                 break;
 
                                         setMaterial(*material, pass);
-                                        renderMeshes(*meshNode, meshUnit, pass);
+                                        renderMeshes(*meshNode, vertexShaders, meshUnit, pass);
                                 }
                         }
                 }
@@ -1059,29 +1182,10 @@ namespace selene
 
         //------------------------------------------------------------------------------------------------------------
         void D3d9ActorsRenderer::renderMeshes(Renderer::Data::MeshNode& meshNode,
+                                              D3d9VertexShader* vertexShaders,
                                               uint8_t meshRenderingUnit,
                                               uint8_t pass)
         {
-                static const uint8_t vertexStreamIndices[NUM_OF_RENDERING_PASSES][MAX_VERTEX_STREAMS_PER_PASS] =
-                {
-                        {Mesh::VERTEX_STREAM_POSITIONS, 0, 0},
-                        {
-                                Mesh::VERTEX_STREAM_POSITIONS,
-                                Mesh::VERTEX_STREAM_TBN_BASES,
-                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES
-                        },
-                        {
-                                Mesh::VERTEX_STREAM_POSITIONS,
-                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES, 0
-                        },
-                        {
-                                Mesh::VERTEX_STREAM_POSITIONS,
-                                Mesh::VERTEX_STREAM_TBN_BASES,
-                                Mesh::VERTEX_STREAM_TEXTURE_COORDINATES
-                        }
-                };
-                static const uint8_t numVertexStreams[NUM_OF_RENDERING_PASSES] = {1, 3, 2, 3};
-
                 // walk through all meshes
                 for(bool resultMesh = meshNode.readFirstElement(); resultMesh;
                          resultMesh = meshNode.readNextElement())
@@ -1094,22 +1198,7 @@ namespace selene
                         if(meshSubsetNode == nullptr)
                                 break;
 
-                        const auto& meshData = d3dMesh->getData();
-
-                        for(uint8_t vertexStream = 0; vertexStream < numVertexStreams[pass]; ++vertexStream)
-                        {
-                                UINT streamNo = vertexStreamIndices[pass][vertexStream];
-                                d3dDevice_->SetStreamSource(streamNo, d3dMesh->d3dVertexBuffers_[streamNo], 0,
-                                                            meshData.vertices[streamNo].getStride());
-                        }
-
-                        if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
-                        {
-                                UINT streamNo = Mesh::VERTEX_STREAM_BONE_INDICES_AND_WEIGHTS;
-                                d3dDevice_->SetStreamSource(streamNo, d3dMesh->d3dVertexBuffers_[streamNo], 0,
-                                                            meshData.vertices[streamNo].getStride());
-                        }
-
+                        setVertexStreams(*d3dMesh, nullptr, meshRenderingUnit, pass);
                         d3dDevice_->SetIndices(d3dMesh->d3dIndexBuffer_);
 
                         // walk through all mesh subsets
@@ -1122,20 +1211,58 @@ namespace selene
                                 if(meshSubset == nullptr || renderingList == nullptr)
                                         break;
 
-                                renderMeshSubsetInstances(*renderingList, *meshSubset, meshRenderingUnit, pass);
+                                renderMeshSubsetInstances(*renderingList, vertexShaders, *d3dMesh, *meshSubset,
+                                                          meshRenderingUnit, pass);
                         }
                 }
         }
 
         //------------------------------------------------------------------------------------------------------------
         void D3d9ActorsRenderer::renderMeshSubsetInstances(const Renderer::Data::List<Actor::Instance>& renderingList,
+                                                           D3d9VertexShader* vertexShaders,
+                                                           D3d9Mesh& d3dMesh,
                                                            const Mesh::Subset& meshSubset,
                                                            uint8_t meshRenderingUnit,
                                                            uint8_t pass)
         {
+                bool areSkinnedVerticesBound = false;
+
                 const auto& instances = renderingList.getElements();
                 for(auto it = instances.begin(); it != instances.end(); ++it)
                 {
+                        if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
+                        {
+                                const MeshSkinner* meshSkinner = (*it).getMeshSkinner();
+
+                                if(meshSkinner != nullptr)
+                                {
+                                        if(!uploadSkinnedVertices(*meshSkinner))
+                                                continue;
+
+                                        // skinned vertex buffers are bound each time, since they can be recreated
+                                        setVertexStreams(d3dMesh, meshSkinner, meshRenderingUnit, pass);
+
+                                        // skinned vertices are rendered as vertices of the static mesh
+                                        if(!areSkinnedVerticesBound)
+                                        {
+                                                vertexShaders[Renderer::Data::UNIT_MESH_STATIC].set();
+                                                areSkinnedVerticesBound = true;
+                                        }
+                                }
+                                else
+                                {
+                                        if(areSkinnedVerticesBound)
+                                        {
+                                                setVertexStreams(d3dMesh, nullptr, meshRenderingUnit, pass);
+                                                vertexShaders[Renderer::Data::UNIT_MESH_SKIN].set();
+                                                areSkinnedVerticesBound = false;
+                                        }
+
+                                        if(!setSkeletonPose((*it).getSkeletonInstance()->getFinalBoneTransforms()))
+                                                continue;
+                                }
+                        }
+
                         const auto& transform = (*it).getViewProjectionTransform();
                         d3dDevice_->SetVertexShaderConstantF(LOCATION_WORLD_VIEW_PROJECTION_MATRIX,
                                                              transform.getWorldViewProjectionMatrix(),
@@ -1165,12 +1292,29 @@ namespace selene
                                         break;
                         }
 
-                        if(meshRenderingUnit == Renderer::Data::UNIT_MESH_SKIN)
-                                setSkeletonPose((*it).getSkeletonInstance()->getFinalBoneTransforms());
+                        // only faces of the visible clusters are drawn, if instance holds ranges of the faces
+                        if((*it).getFaceRanges() == nullptr)
+                        {
+                                d3dDevice_->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, meshSubset.vertexIndex,
+                                                                 meshSubset.numVertices, 3 * meshSubset.faceIndex,
+                                                                 meshSubset.numFaces);
+                                continue;
+                        }
 
-                        d3dDevice_->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, meshSubset.vertexIndex,
-                                                         meshSubset.numVertices, 3 * meshSubset.faceIndex,
-                                                         meshSubset.numFaces);
+                        const Mesh::FaceRange* faceRanges = (*it).getFaceRanges();
+                        for(uint32_t i = 0; i < (*it).getNumFaceRanges(); ++i)
+                        {
+                                d3dDevice_->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, meshSubset.vertexIndex,
+                                                                 meshSubset.numVertices, 3 * faceRanges[i].faceIndex,
+                                                                 faceRanges[i].numFaces);
+                        }
+                }
+
+                // next mesh subsets are rendered with vertex buffers of the mesh
+                if(areSkinnedVerticesBound)
+                {
+                        setVertexStreams(d3dMesh, nullptr, meshRenderingUnit, pass);
+                        vertexShaders[Renderer::Data::UNIT_MESH_SKIN].set();
                 }
         }
 
@@ -4,6 +4,7 @@
 #ifndef D3D9_ACTORS_RENDERER_H
 #define D3D9_ACTORS_RENDERER_H
 
+#include "../../../../../Engine/Core/Resources/Mesh/MeshSkinner.h"
 #include "../../../../../Engine/Core/Resources/Mesh/Mesh.h"
 #include "../../../../../Engine/Rendering/Renderer.h"
 #include "D3D9Shader.h"
@@ -21,13 +22,25 @@ namespace selene
         class D3d9FrameParameters;
         class D3d9TextureHandler;
         class D3d9Capabilities;
+        class D3d9Mesh;
 
         /**
          * Represents actors renderer. Renders positions map, normals map, shadow map and shading.
+         *
+         * Instances of the skin meshes, which have been skinned on the CPU (see Actor::Instance::getMeshSkinner),
+         * are rendered by the vertex shaders of the static meshes with skinned vertices, which are uploaded to
+         * the dynamic vertex buffers. Instances, whose skeletons have more bones than MAX_NUM_OF_BONES_IN_MODEL
+         * and which have not been skinned on the CPU, are not rendered.
          */
         class D3d9ActorsRenderer
         {
         public:
+                /// Maximum number of bones, which can be held by skinning shaders
+                enum
+                {
+                        MAX_NUM_OF_BONES_IN_MODEL = 100
+                };
+
                 D3d9ActorsRenderer();
                 D3d9ActorsRenderer(const D3d9ActorsRenderer&) = delete;
                 ~D3d9ActorsRenderer();
@@ -104,7 +117,6 @@ namespace selene
                         NUM_OF_OPTIONAL_PIXEL_SHADERS,
 
                         MAX_VERTEX_STREAMS_PER_PASS = 3,
-                        MAX_NUM_OF_BONES_IN_MODEL = 100,
 
                         LOCATION_WORLD_VIEW_PROJECTION_MATRIX = 0,
                         LOCATION_WORLD_VIEW_MATRIX = 4,
@@ -145,6 +157,10 @@ namespace selene
                 D3d9TextureHandler* textureHandler_;
                 D3d9Capabilities* capabilities_;
 
+                LPDIRECT3DVERTEXBUFFER9 d3dSkinnedVertexBuffers_[MeshSkinner::NUM_OF_SKINNED_STREAMS];
+                uint32_t skinnedVertexBufferCapacities_[MeshSkinner::NUM_OF_SKINNED_STREAMS];
+                const MeshSkinner* uploadedMeshSkinner_;
+
                 /**
                  * \brief Sets material.
                  * \param[in] material material, which will be set
@@ -155,8 +171,27 @@ namespace selene
                 /**
                  * \brief Sets skeleton pose.
                  * \param[in] boneTransforms bone transforms in world space
+                 * \return true if skeleton pose has been set (false if there are too many bones)
+                 */
+                bool setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms);
+
+                /**
+                 * \brief Sets vertex streams.
+                 * \param[in] d3dMesh mesh, whose vertex buffers are used
+                 * \param[in] meshSkinner mesh skinner, whose skinned vertices are used instead of positions and TBN
+                 * bases of the mesh (if nullptr, then only vertex buffers of the mesh are used)
+                 * \param[in] meshRenderingUnit mesh rendering unit
+                 * \param[in] pass rendering pass
+                 */
+                void setVertexStreams(D3d9Mesh& d3dMesh, const MeshSkinner* meshSkinner,
+                                      uint8_t meshRenderingUnit, uint8_t pass);
+
+                /**
+                 * \brief Uploads skinned vertices to the dynamic vertex buffers.
+                 * \param[in] meshSkinner mesh skinner, which holds skinned vertices
+                 * \return true if skinned vertices have been successfully uploaded
                  */
-                void setSkeletonPose(const Array<Skeleton::Transform, uint16_t>& boneTransforms);
+                bool uploadSkinnedVertices(const MeshSkinner& meshSkinner);
 
                 /**
                  * \brief Renders actors from given node.
@@ -168,10 +203,12 @@ namespace selene
                 /**
                  * \brief Renders meshes from given node.
                  * \param[in] meshNode mesh node
+                 * \param[in] vertexShaders vertex shaders of the current pass (one for each mesh unit)
                  * \param[in] meshRenderingUnit mesh rendering unit
                  * \param[in] pass rendering pass
                  */
                 void renderMeshes(Renderer::Data::MeshNode& meshNode,
+                                  D3d9VertexShader* vertexShaders,
                                   uint8_t meshRenderingUnit,
                                   uint8_t pass);
 
@@ -179,11 +216,15 @@ namespace selene
                  * \brief Renders instances of the given mesh subset.
                  * \param[in] renderingList rendering list, which contains view-projection
                  * transforms of the given mesh subset
+                 * \param[in] vertexShaders vertex shaders of the current pass (one for each mesh unit)
+                 * \param[in] d3dMesh mesh, which contains given subset
                  * \param[in] meshSubset subset of the mesh
                  * \param[in] meshRenderingUnit mesh rendering unit
                  * \param[in] pass rendering pass
                  */
                 void renderMeshSubsetInstances(const Renderer::Data::List<Actor::Instance>& renderingList,
+                                               D3d9VertexShader* vertexShaders,
+                                               D3d9Mesh& d3dMesh,
                                                const Mesh::Subset& meshSubset,
                                                uint8_t meshRenderingUnit,
                                                uint8_t pass);
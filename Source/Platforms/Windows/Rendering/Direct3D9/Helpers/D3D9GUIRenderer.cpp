@@ -7,21 +7,16 @@
 #include "../../../../../Engine/GUI/GUI.h"
 #include "../D3D9Renderer.h"
 
+#include <algorithm>
+
 namespace selene
 {
 
-        static const uint32_t guiGeometryNumFramesPerBatch   = 256;
-        static const uint32_t guiGeometryNumVerticesPerFrame = 6;
-        static const uint32_t guiGeometryNumVectorsPerVertex = 2;
-        static const uint32_t guiGeometryVertexStride = guiGeometryNumVectorsPerVertex * sizeof(Vector4d);
-        static const uint32_t guiGeometryVertexBufferSize = guiGeometryNumFramesPerBatch *
-                                                            guiGeometryNumVerticesPerFrame *
-                                                            guiGeometryVertexStride;
-
         D3d9GuiRenderer::D3d9GuiRenderer():
                 d3dVertexDeclaration_(nullptr), d3dVertexBuffer_(nullptr), d3dDevice_(nullptr),
                 fontTexture_(), cursorTexture_(), fullScreenQuad_(nullptr),
-                textureHandler_(nullptr), capabilities_(nullptr) {}
+                textureHandler_(nullptr), capabilities_(nullptr), geometryBuilder_(),
+                vertexBufferCapacity_(0), uploadedRevision_(0) {}
         D3d9GuiRenderer::~D3d9GuiRenderer()
         {
                 destroy();
@@ -209,7 +204,7 @@ namespace selene
                         return false;
                 }
 
-                if(FAILED(d3dDevice_->CreateVertexBuffer(guiGeometryVertexBufferSize,
+                if(FAILED(d3dDevice_->CreateVertexBuffer(INITIAL_VERTEX_BUFFER_CAPACITY * VERTEX_STRIDE,
                                                          D3DUSAGE_WRITEONLY | D3DUSAGE_DYNAMIC,
                                                          0, D3DPOOL_DEFAULT, &d3dVertexBuffer_, nullptr)))
                 {
@@ -217,6 +212,8 @@ namespace selene
                         return false;
                 }
 
+                vertexBufferCapacity_ = INITIAL_VERTEX_BUFFER_CAPACITY;
+
                 // load textures
                 TextureFactory<D3d9Texture> textureFactory(fileManager);
                 fontTexture_.reset(static_cast<D3d9Texture*>(textureFactory.createResource("Fonts/Font.dds")));
@@ -259,6 +256,10 @@ namespace selene
 
                 SAFE_RELEASE(d3dVertexDeclaration_);
                 SAFE_RELEASE(d3dVertexBuffer_);
+                vertexBufferCapacity_ = 0;
+
+                // geometry is uploaded to the new vertex buffer on the next frame
+                geometryBuilder_.clear();
 
                 d3dDevice_ = nullptr;
 
@@ -279,30 +280,11 @@ namespace selene
                 if(gui->is(GUI_HIDDEN))
                         return;
 
-                const auto& elements = gui->getElements();
-
-                const float characterSize = 0.0625f;
-                static Vector4d frameVertices[guiGeometryNumFramesPerBatch * guiGeometryNumVerticesPerFrame *
-                                              guiGeometryNumVectorsPerVertex];
-                static uint32_t vertexIndices[guiGeometryNumVerticesPerFrame] = {0, 2, 1, 2, 3, 1};
-
-                static Vector2d vertexOffsets[] =
-                {
-                        Vector2d(),
-                        Vector2d(),
-                        Vector2d(),
-                        Vector2d()
-                };
-
-                static Vector2d fontOffsets[4] =
-                {
-                        Vector2d(0.0f, 0.0f),
-                        Vector2d(characterSize, 0.0f),
-                        Vector2d(0.0f, characterSize),
-                        Vector2d(characterSize, characterSize)
-                };
+                geometryBuilder_.build(*gui);
+                bool hasGeometry = uploadGeometry();
 
                 d3dDevice_->SetVertexDeclaration(d3dVertexDeclaration_);
+                d3dDevice_->SetStreamSource(0, d3dVertexBuffer_, 0, VERTEX_STRIDE);
                 d3dDevice_->SetStreamSource(1, nullptr, 0, 0);
                 d3dDevice_->SetStreamSource(2, nullptr, 0, 0);
                 d3dDevice_->SetStreamSource(3, nullptr, 0, 0);
@@ -314,131 +296,31 @@ namespace selene
                 d3dDevice_->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
                 d3dDevice_->SetRenderState(D3DRS_ALPHABLENDENABLE, TRUE);
 
-                vertexShaders_[VERTEX_SHADER_GUI_FRAMES_PASS].set();
-                pixelShaders_[PIXEL_SHADER_GUI_FRAMES_PASS].set();
-
-                // render frames
-                uint32_t numFrames = 0;
-                Vector4d* currentVertex = frameVertices;
-                for(auto it = elements.begin(); it != elements.end(); ++it)
-                {
-                        if(!it->second)
-                                continue;
-
-                        auto element = it->second.get();
-                        if(element->is(GUI_ELEMENT_HIDDEN))
-                                continue;
-
-                        Vector4d color = element->getBackgroundColor(GUI_ELEMENT_COLOR_DEFAULT);
-
-                        if(element->is(GUI_ELEMENT_SELECTED))
-                                color = element->getBackgroundColor(GUI_ELEMENT_COLOR_SELECTED);
-                        else if(element->is(GUI_ELEMENT_TOUCHED))
-                                color = element->getBackgroundColor(GUI_ELEMENT_COLOR_TOUCHED);
-
-                        const auto& size = element->getSize();
-                        const auto& position = element->getPosition();
-
-                        vertexOffsets[1] = Vector2d(size.x, 0.0f);
-                        vertexOffsets[2] = Vector2d(0.0f, size.y);
-                        vertexOffsets[3] = Vector2d(size.x, size.y);
-
-                        for(uint32_t i = 0; i < guiGeometryNumVerticesPerFrame; ++i)
-                        {
-                                currentVertex->define(position + vertexOffsets[vertexIndices[i]], 0.0f, 1.0f);
-                                ++currentVertex;
-                                *currentVertex = color;
-                                ++currentVertex;
-                        }
-
-                        ++numFrames;
-
-                        if(numFrames == guiGeometryNumFramesPerBatch)
-                        {
-                                renderGeometry(frameVertices, numFrames);
-                                numFrames = 0;
-                                currentVertex = frameVertices;
-                        }
-                }
-
-                if(numFrames != 0)
-                        renderGeometry(frameVertices, numFrames);
-
-                // render text
-                vertexShaders_[VERTEX_SHADER_GUI_TEXT_PASS].set();
-                pixelShaders_[PIXEL_SHADER_GUI_TEXT_PASS].set();
-
-                textureHandler_->setStageState(LOCATION_FONT_TEXTURE,
-                                               D3DTEXF_LINEAR, D3DTEXF_LINEAR, D3DTEXF_LINEAR,
-                                               D3DTADDRESS_CLAMP, D3DTADDRESS_CLAMP);
-                textureHandler_->setTexture(fontTexture_.get(), LOCATION_FONT_TEXTURE,
-                                            D3d9TextureHandler::DUMMY_TEXTURE_WHITE);
-
-                d3dDevice_->SetRenderState(D3DRS_ALPHAREF, static_cast<DWORD>(0x000000AA));
-                d3dDevice_->SetRenderState(D3DRS_ALPHATESTENABLE, TRUE);
-                d3dDevice_->SetRenderState(D3DRS_ALPHAFUNC, D3DCMP_GREATEREQUAL);
-
-                numFrames = 0;
-                currentVertex = frameVertices;
-                for(auto it = elements.begin(); it != elements.end(); ++it)
+                if(hasGeometry)
                 {
-                        if(!it->second)
-                                continue;
-
-                        auto element = it->second.get();
-                        if(element->is(GUI_ELEMENT_HIDDEN))
-                                continue;
+                        // render frames
+                        vertexShaders_[VERTEX_SHADER_GUI_FRAMES_PASS].set();
+                        pixelShaders_[PIXEL_SHADER_GUI_FRAMES_PASS].set();
 
-                        const std::string& text = element->getText();
-                        if(text.length() == 0)
-                                continue;
+                        renderBatch(GuiGeometryBuilder::GEOMETRY_BATCH_FRAMES);
 
-                        Vector4d textColor = element->getTextColor(GUI_ELEMENT_COLOR_DEFAULT);
+                        // render text
+                        vertexShaders_[VERTEX_SHADER_GUI_TEXT_PASS].set();
+                        pixelShaders_[PIXEL_SHADER_GUI_TEXT_PASS].set();
 
-                        if(element->is(GUI_ELEMENT_SELECTED))
-                                textColor = element->getTextColor(GUI_ELEMENT_COLOR_SELECTED);
-                        else if(element->is(GUI_ELEMENT_TOUCHED))
-                                textColor = element->getTextColor(GUI_ELEMENT_COLOR_TOUCHED);
-
-                        const auto& fontSize = element->getFontSize();
-                        vertexOffsets[1] = Vector2d(fontSize.x, 0.0f);
-                        vertexOffsets[2] = Vector2d(0.0f, fontSize.y);
-                        vertexOffsets[3] = Vector2d(fontSize.x, fontSize.y);
+                        textureHandler_->setStageState(LOCATION_FONT_TEXTURE,
+                                                       D3DTEXF_LINEAR, D3DTEXF_LINEAR, D3DTEXF_LINEAR,
+                                                       D3DTADDRESS_CLAMP, D3DTADDRESS_CLAMP);
+                        textureHandler_->setTexture(fontTexture_.get(), LOCATION_FONT_TEXTURE,
+                                                    D3d9TextureHandler::DUMMY_TEXTURE_WHITE);
 
-                        auto position = element->getPosition();
+                        d3dDevice_->SetRenderState(D3DRS_ALPHAREF, static_cast<DWORD>(0x000000AA));
+                        d3dDevice_->SetRenderState(D3DRS_ALPHATESTENABLE, TRUE);
+                        d3dDevice_->SetRenderState(D3DRS_ALPHAFUNC, D3DCMP_GREATEREQUAL);
 
-                        for(size_t i = 0; i < text.length(); ++i)
-                        {
-                                uint8_t c = text[i];
-                                Vector2d textureCoordinates(static_cast<float>(c % 16) * characterSize,
-                                                            static_cast<float>(c >> 4) * characterSize);
-
-                                for(uint32_t j = 0; j < guiGeometryNumVerticesPerFrame; ++j)
-                                {
-                                        currentVertex->define(position + vertexOffsets[vertexIndices[j]],
-                                                              textureCoordinates + fontOffsets[vertexIndices[j]]);
-                                        ++currentVertex;
-                                        *currentVertex = textColor;
-                                        ++currentVertex;
-                                }
-
-                                ++numFrames;
-
-                                if(numFrames == guiGeometryNumFramesPerBatch)
-                                {
-                                        renderGeometry(frameVertices, numFrames);
-
-                                        numFrames = 0;
-                                        currentVertex = frameVertices;
-                                }
-
-                                position.x += fontSize.x;
-                        }
+                        renderBatch(GuiGeometryBuilder::GEOMETRY_BATCH_TEXT);
                 }
 
-                if(numFrames != 0)
-                        renderGeometry(frameVertices, numFrames);
-
                 // render cursor
                 if(!gui->is(GUI_DISABLED))
                 {
@@ -462,18 +344,52 @@ namespace selene
         }
 
         //-----------------------------------------------------------------------------------------------------------
-        void D3d9GuiRenderer::renderGeometry(const Vector4d* vertices, uint32_t numFrames)
+        bool D3d9GuiRenderer::uploadGeometry()
         {
+                uint32_t numVertices = geometryBuilder_.getNumVertices();
+                if(numVertices == 0)
+                        return false;
+
+                if(uploadedRevision_ == geometryBuilder_.getRevision() && d3dVertexBuffer_ != nullptr)
+                        return true;
+
+                // vertex buffer grows when geometry does not fit
+                if(numVertices > vertexBufferCapacity_)
+                {
+                        SAFE_RELEASE(d3dVertexBuffer_);
+                        vertexBufferCapacity_ = std::max(numVertices, 2 * vertexBufferCapacity_);
+
+                        if(FAILED(d3dDevice_->CreateVertexBuffer(vertexBufferCapacity_ * VERTEX_STRIDE,
+                                                                 D3DUSAGE_WRITEONLY | D3DUSAGE_DYNAMIC,
+                                                                 0, D3DPOOL_DEFAULT, &d3dVertexBuffer_, nullptr)))
+                        {
+                                d3dVertexBuffer_ = nullptr;
+                                vertexBufferCapacity_ = 0;
+                                return false;
+                        }
+                }
+
                 uint8_t* destinationBuffer = nullptr;
-                uint32_t size = numFrames * guiGeometryNumVerticesPerFrame * guiGeometryVertexStride;
-                if(FAILED(d3dVertexBuffer_->Lock(0, size, reinterpret_cast<void**>(&destinationBuffer), 0)))
-                        return;
+                uint32_t size = numVertices * VERTEX_STRIDE;
+                if(FAILED(d3dVertexBuffer_->Lock(0, size, reinterpret_cast<void**>(&destinationBuffer),
+                                                 D3DLOCK_DISCARD)))
+                        return false;
 
-                memcpy(destinationBuffer, vertices, size);
+                memcpy(destinationBuffer, geometryBuilder_.getVertices(), size);
                 d3dVertexBuffer_->Unlock();
 
-                d3dDevice_->SetStreamSource(0, d3dVertexBuffer_, 0, guiGeometryVertexStride);
-                d3dDevice_->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 2 * numFrames);
+                uploadedRevision_ = geometryBuilder_.getRevision();
+                return true;
+        }
+
+        //-----------------------------------------------------------------------------------------------------------
+        void D3d9GuiRenderer::renderBatch(uint8_t batch)
+        {
+                uint32_t numQuads = geometryBuilder_.getNumQuads(batch);
+                if(numQuads == 0)
+                        return;
+
+                d3dDevice_->DrawPrimitive(D3DPT_TRIANGLELIST, geometryBuilder_.getFirstVertex(batch), 2 * numQuads);
         }
 
 }
@@ -4,7 +4,7 @@
 #ifndef D3D9_GUI_RENDERER_H
 #define D3D9_GUI_RENDERER_H
 
-#include "../../../../../Engine/Core/Math/Vector.h"
+#include "../../../../../Engine/GUI/GUIGeometryBuilder.h"
 #include "../Resources/D3D9Texture.h"
 #include "D3D9Shader.h"
 
@@ -21,10 +21,10 @@ namespace selene
         class D3d9TextureHandler;
         class D3d9Capabilities;
         class FileManager;
-        class Gui;
 
         /**
-         * Represents D3D9 GUI renderer.
+         * Represents D3D9 GUI renderer. Geometry of the GUI is built by the GuiGeometryBuilder, and it is
+         * uploaded to the vertex buffer only when it has been changed.
          */
         class D3d9GuiRenderer
         {
@@ -74,7 +74,10 @@ namespace selene
 
                         LOCATION_CURSOR_POSITION_AND_SIZE = 0,
                         LOCATION_FONT_TEXTURE = 0,
-                        LOCATION_CURSOR_TEXTURE = 0
+                        LOCATION_CURSOR_TEXTURE = 0,
+
+                        INITIAL_VERTEX_BUFFER_CAPACITY = 256 * GuiGeometryBuilder::NUM_OF_VERTICES_PER_QUAD,
+                        VERTEX_STRIDE = GuiGeometryBuilder::NUM_OF_VECTORS_PER_VERTEX * sizeof(Vector4d)
                 };
 
                 D3d9VertexShader vertexShaders_[NUM_OF_VERTEX_SHADERS];
@@ -90,12 +93,21 @@ namespace selene
                 D3d9TextureHandler* textureHandler_;
                 D3d9Capabilities* capabilities_;
 
+                GuiGeometryBuilder geometryBuilder_;
+                uint32_t vertexBufferCapacity_;
+                uint32_t uploadedRevision_;
+
+                /**
+                 * \brief Uploads geometry of the GUI to the vertex buffer (if geometry has been changed).
+                 * \return true if vertex buffer holds geometry of the GUI
+                 */
+                bool uploadGeometry();
+
                 /**
-                 * \brief Renders GUI geometry.
-                 * \param[in] vertices array of vertices
-                 * \param[in] numFrames number of frames to render
+                 * \brief Renders batch of the GUI geometry.
+                 * \param[in] batch batch (must be one of the selene::GuiGeometryBuilder::GEOMETRY_BATCH)
                  */
-                void renderGeometry(const Vector4d* vertices, uint32_t numFrames);
+                void renderBatch(uint8_t batch);
 
         };
 